@@ -24,7 +24,14 @@
 GFXRECON_BEGIN_NAMESPACE(gfxrecon)
 GFXRECON_BEGIN_NAMESPACE(decode)
 
-CompressionConverter::CompressionConverter() : bytes_written_(0), compressor_(nullptr), decompressing_(false) {}
+// Limits on the amount of data that is held in memory while blocks are waiting to be converted and written.
+const size_t kMaxPendingBytes       = 256 * 1024 * 1024;
+const size_t kPendingTasksPerThread = 64;
+
+CompressionConverter::CompressionConverter() :
+    bytes_written_(0), compressor_(nullptr), decompressing_(false), pending_bytes_(0), max_pending_tasks_(0),
+    stop_threads_(false)
+{}
 
 CompressionConverter::~CompressionConverter()
 {
@@ -34,7 +41,9 @@ CompressionConverter::~CompressionConverter()
 bool CompressionConverter::Initialize(std::string                                filename,
                                       const format::FileHeader&                  file_header,
                                       const std::vector<format::FileOptionPair>& option_list,
-                                      format::CompressionType                    target_compression_type)
+                                      format::CompressionType                    target_compression_type,
+                                      const std::vector<uint8_t>&                target_compression_dictionary,
+                                      uint32_t                                   thread_count)
 {
     bool success = false;
 
@@ -50,7 +59,7 @@ bool CompressionConverter::Initialize(std::string
     else
     {
         decompressing_ = false;
-        compressor_    = format::CreateCompressor(target_compression_type);
+        compressor_    = format::CreateCompressor(target_compression_type, target_compression_dictionary);
 
         if (nullptr == compressor_)
         {
@@ -59,8 +68,8 @@ bool CompressionConverter::Initialize(std::string
         }
     }
 
-    std::vector<format::FileOptionPair> new_option_list = option_list;
-    for (auto& option : new_option_list)
+    std::vector<format::FileOptionPair> new_option_list;
+    for (auto option : option_list)
     {
         switch (option.key)
         {
@@ -68,18 +77,46 @@ bool CompressionConverter::Initialize(std::string
                 // Change the file option to the new compression type
                 option.value = static_cast<uint32_t>(target_compression_type);
                 break;
+            case format::FileOption::kBlockSequenceNumbers:
+                // Blocks are written to a single file in processing order, without sequence numbers.
+                continue;
+            case format::FileOption::kCompressionStreamBlockSize:
+                // Function call blocks are decompressed by the file processor and compressed independently.
+                continue;
+            case format::FileOption::kCompressionDictionarySize:
+                // The dictionary for the new compression type is added below.
+                continue;
             default:
                 GFXRECON_LOG_WARNING("Ignoring unrecognized file header option %u", option.key);
                 break;
         }
+
+        new_option_list.push_back(option);
+    }
+
+    bool write_dictionary = (!decompressing_ && !target_compression_dictionary.empty());
+    if (write_dictionary)
+    {
+        new_option_list.push_back({ format::FileOption::kCompressionDictionarySize,
+                                    static_cast<uint32_t>(target_compression_dictionary.size()) });
     }
 
     if (file_stream_->IsValid())
     {
         bytes_written_ = 0;
-        bytes_written_ += file_stream_->Write(&file_header, sizeof(file_header));
+        format::FileHeader new_file_header = file_header;
+        new_file_header.num_options        = static_cast<uint32_t>(new_option_list.size());
+
+        bytes_written_ += file_stream_->Write(&new_file_header, sizeof(new_file_header));
         bytes_written_ +=
             file_stream_->Write(new_option_list.data(), new_option_list.size() * sizeof(format::FileOptionPair));
+
+        if (write_dictionary)
+        {
+            bytes_written_ +=
+                file_stream_->Write(target_compression_dictionary.data(), target_compression_dictionary.size());
+        }
+
         success = true;
     }
     else
@@ -87,11 +124,18 @@ bool CompressionConverter::Initialize(std::string
         GFXRECON_LOG_ERROR("Failed to open file %s", filename_.c_str());
     }
 
+    if (success && (thread_count > 1))
+    {
+        StartThreads(thread_count);
+    }
+
     return success;
 }
 
 void CompressionConverter::Destroy()
 {
+    StopThreads();
+
     if (nullptr != compressor_)
     {
         delete compressor_;
@@ -99,25 +143,242 @@ void CompressionConverter::Destroy()
     }
 }
 
+void CompressionConverter::Flush()
+{
+    if (IsParallel())
+    {
+        std::unique_lock<std::mutex> lock(task_lock_);
+        task_written_signal_.wait(lock, [this]() { return pending_tasks_.empty(); });
+    }
+
+    if (file_stream_ != nullptr)
+    {
+        file_stream_->Flush();
+    }
+}
+
+void CompressionConverter::StartThreads(uint32_t thread_count)
+{
+    assert(thread_count > 0);
+
+    stop_threads_      = false;
+    pending_bytes_     = 0;
+    max_pending_tasks_ = thread_count * kPendingTasksPerThread;
+
+    for (uint32_t i = 0; i < thread_count; ++i)
+    {
+        worker_threads_.emplace_back(&CompressionConverter::WorkerThreadMain, this);
+    }
+
+    writer_thread_ = std::thread(&CompressionConverter::WriterThreadMain, this);
+}
+
+void CompressionConverter::StopThreads()
+{
+    if (IsParallel())
+    {
+        {
+            std::lock_guard<std::mutex> lock(task_lock_);
+            stop_threads_ = true;
+        }
+
+        // Worker threads process all queued tasks before exiting, and the writer thread writes all pending tasks.
+        work_available_signal_.notify_all();
+        task_complete_signal_.notify_all();
+
+        for (auto& thread : worker_threads_)
+        {
+            thread.join();
+        }
+
+        worker_threads_.clear();
+
+        writer_thread_.join();
+    }
+}
+
+void CompressionConverter::WorkerThreadMain()
+{
+    std::vector<uint8_t>         compressed_buffer;
+    std::unique_lock<std::mutex> lock(task_lock_);
+
+    for (;;)
+    {
+        work_available_signal_.wait(lock, [this]() { return (!work_queue_.empty() || stop_threads_); });
+
+        if (work_queue_.empty())
+        {
+            break;
+        }
+
+        std::shared_ptr<ConversionTask> task = work_queue_.front();
+        work_queue_.pop_front();
+
+        lock.unlock();
+
+        task->convert(&task->output, &compressed_buffer, task->data.data());
+
+        // Release the copy of the block data.
+        task->convert = nullptr;
+        std::vector<uint8_t>().swap(task->data);
+
+        lock.lock();
+
+        task->complete = true;
+        task_complete_signal_.notify_one();
+    }
+}
+
+void CompressionConverter::WriterThreadMain()
+{
+    std::unique_lock<std::mutex> lock(task_lock_);
+
+    for (;;)
+    {
+        task_complete_signal_.wait(lock, [this]() {
+            return ((!pending_tasks_.empty() && pending_tasks_.front()->complete) ||
+                    (pending_tasks_.empty() && stop_threads_));
+        });
+
+        if (pending_tasks_.empty())
+        {
+            break;
+        }
+
+        // Only the writer thread removes tasks from the pending queue, so the front task remains valid while it is
+        // written without the lock.
+        std::shared_ptr<ConversionTask> task = pending_tasks_.front();
+
+        lock.unlock();
+
+        bytes_written_ += file_stream_->Write(task->output.GetData(), task->output.GetDataSize());
+
+        lock.lock();
+
+        pending_tasks_.pop_front();
+        pending_bytes_ -= task->input_size;
+
+        task_written_signal_.notify_all();
+    }
+}
+
+void CompressionConverter::SubmitTask(const std::shared_ptr<ConversionTask>& task, bool needs_conversion)
+{
+    std::unique_lock<std::mutex> lock(task_lock_);
+
+    // Wait for the writer thread to catch up when too much data is pending.  A single task is always accepted, to
+    // allow for blocks that are larger than the limit.
+    task_written_signal_.wait(lock, [this]() {
+        return (pending_tasks_.empty() ||
+                ((pending_tasks_.size() < max_pending_tasks_) && (pending_bytes_ < kMaxPendingBytes)));
+    });
+
+    pending_tasks_.push_back(task);
+    pending_bytes_ += task->input_size;
+
+    if (needs_conversion)
+    {
+        work_queue_.push_back(task);
+        work_available_signal_.notify_one();
+    }
+    else
+    {
+        task_complete_signal_.notify_one();
+    }
+}
+
+void CompressionConverter::WriteUncompressedBlock(const void* header,
+                                                  size_t      header_size,
+                                                  const void* data,
+                                                  size_t      data_size)
+{
+    if (IsParallel())
+    {
+        // The block is written to the task's output stream immediately, and only needs to be ordered with the blocks
+        // that are being converted by the worker threads.
+        auto task = std::make_shared<ConversionTask>();
+
+        task->output.Write(header, header_size);
+
+        if (data_size > 0)
+        {
+            task->output.Write(data, data_size);
+        }
+
+        task->input_size = header_size + data_size;
+        task->complete   = true;
+
+        SubmitTask(task, false);
+    }
+    else
+    {
+        bytes_written_ += file_stream_->Write(header, header_size);
+
+        if (data_size > 0)
+        {
+            bytes_written_ += file_stream_->Write(data, data_size);
+        }
+    }
+}
+
+void CompressionConverter::WriteConvertedBlock(const uint8_t* data, size_t data_size, ConvertFunc&& convert)
+{
+    if (IsParallel())
+    {
+        // The data is only valid for the duration of the decode call, so the task must keep a copy.
+        auto task = std::make_shared<ConversionTask>();
+
+        task->convert    = std::move(convert);
+        task->data       = std::vector<uint8_t>(data, data + data_size);
+        task->input_size = data_size;
+
+        SubmitTask(task, true);
+    }
+    else
+    {
+        bytes_written_ += convert(file_stream_.get(), &compressed_buffer_, data);
+    }
+}
+
 void CompressionConverter::DecodeFunctionCall(format::ApiCallId  call_id,
                                               const ApiCallInfo& call_info,
                                               const uint8_t*     buffer,
                                               size_t             buffer_size)
 {
-    bool write_uncompressed = decompressing_;
+    format::ThreadId thread_id = call_info.thread_id;
+
+    WriteConvertedBlock(buffer,
+                        buffer_size,
+                        [this, call_id, thread_id, buffer_size](util::OutputStream*   stream,
+                                                                std::vector<uint8_t>* compressed_buffer,
+                                                                const uint8_t*        block_data) {
+                            return WriteFunctionCall(
+                                stream, compressed_buffer, call_id, thread_id, block_data, buffer_size);
+                        });
+}
+
+size_t CompressionConverter::WriteFunctionCall(util::OutputStream*   stream,
+                                               std::vector<uint8_t>* compressed_buffer,
+                                               format::ApiCallId     call_id,
+                                               format::ThreadId      thread_id,
+                                               const uint8_t*        buffer,
+                                               size_t                buffer_size) const
+{
+    size_t bytes_written      = 0;
+    bool   write_uncompressed = decompressing_;
 
     if (!decompressing_)
     {
         // Compress the buffer with the new compression format and write to the new file.
         format::CompressedFunctionCallHeader compressed_func_call_header = {};
         size_t                               packet_size                 = 0;
-        size_t compressed_size = compressor_->Compress(buffer_size, buffer, &compressed_buffer_);
+        size_t compressed_size = compressor_->Compress(buffer_size, buffer, compressed_buffer);
 
         if (0 < compressed_size && compressed_size < buffer_size)
         {
             compressed_func_call_header.block_header.type = format::BlockType::kCompressedFunctionCallBlock;
             compressed_func_call_header.api_call_id       = call_id;
-            compressed_func_call_header.thread_id         = call_info.thread_id;
+            compressed_func_call_header.thread_id         = thread_id;
             compressed_func_call_header.uncompressed_size = buffer_size;
 
             packet_size += sizeof(compressed_func_call_header.api_call_id) +
@@ -127,10 +388,10 @@ void CompressionConverter::DecodeFunctionCall(format::ApiCallId  call_id,
             compressed_func_call_header.block_header.size = packet_size;
 
             // Write compressed function call block header.
-            bytes_written_ += file_stream_->Write(&compressed_func_call_header, sizeof(compressed_func_call_header));
+            bytes_written += stream->Write(&compressed_func_call_header, sizeof(compressed_func_call_header));
 
             // Write parameter data.
-            bytes_written_ += file_stream_->Write(compressed_buffer_.data(), compressed_size);
+            bytes_written += stream->Write(compressed_buffer->data(), compressed_size);
         }
         else
         {
@@ -147,18 +408,20 @@ void CompressionConverter::DecodeFunctionCall(format::ApiCallId  call_id,
 
         func_call_header.block_header.type = format::BlockType::kFunctionCallBlock;
         func_call_header.api_call_id       = call_id;
-        func_call_header.thread_id         = call_info.thread_id;
+        func_call_header.thread_id         = thread_id;
 
         packet_size += sizeof(func_call_header.api_call_id) + sizeof(func_call_header.thread_id) + buffer_size;
 
         func_call_header.block_header.size = packet_size;
 
         // Write compressed function call block header.
-        bytes_written_ += file_stream_->Write(&func_call_header, sizeof(func_call_header));
+        bytes_written += stream->Write(&func_call_header, sizeof(func_call_header));
 
         // Write parameter data.
-        bytes_written_ += file_stream_->Write(buffer, buffer_size);
+        bytes_written += stream->Write(buffer, buffer_size);
     }
+
+    return bytes_written;
 }
 
 void CompressionConverter::DispatchStateBeginMarker(uint64_t frame_number)
@@ -169,7 +432,7 @@ void CompressionConverter::DispatchStateBeginMarker(uint64_t frame_number)
     marker.marker_type  = format::kBeginMarker;
     marker.frame_number = frame_number;
 
-    bytes_written_ += file_stream_->Write(&marker, sizeof(marker));
+    WriteUncompressedBlock(&marker, sizeof(marker), nullptr, 0);
 }
 
 void CompressionConverter::DispatchStateEndMarker(uint64_t frame_number)
@@ -180,7 +443,7 @@ void CompressionConverter::DispatchStateEndMarker(uint64_t frame_number)
     marker.marker_type  = format::kEndMarker;
     marker.frame_number = frame_number;
 
-    bytes_written_ += file_stream_->Write(&marker, sizeof(marker));
+    WriteUncompressedBlock(&marker, sizeof(marker), nullptr, 0);
 }
 
 void CompressionConverter::DispatchDisplayMessageCommand(format::ThreadId thread_id, const std::string& message)
@@ -193,20 +456,39 @@ void CompressionConverter::DispatchDisplayMessageCommand(format::ThreadId thread
     message_cmd.meta_header.meta_data_type = format::MetaDataType::kDisplayMessageCommand;
     message_cmd.thread_id                  = thread_id;
 
-    bytes_written_ += file_stream_->Write(&message_cmd, sizeof(message_cmd));
-    bytes_written_ += file_stream_->Write(message.c_str(), message_length);
+    WriteUncompressedBlock(&message_cmd, sizeof(message_cmd), message.c_str(), message_length);
 }
 
 void CompressionConverter::DispatchFillMemoryCommand(
     format::ThreadId thread_id, uint64_t memory_id, uint64_t offset, uint64_t size, const uint8_t* data)
+{
+    GFXRECON_CHECK_CONVERSION_DATA_LOSS(size_t, size);
+    size_t write_size = static_cast<size_t>(size);
+
+    WriteConvertedBlock(data,
+                        write_size,
+                        [this, thread_id, memory_id, offset, write_size](util::OutputStream*   stream,
+                                                                         std::vector<uint8_t>* compressed_buffer,
+                                                                         const uint8_t*        block_data) {
+                            return WriteFillMemoryCommand(
+                                stream, compressed_buffer, thread_id, memory_id, offset, write_size, block_data);
+                        });
+}
+
+size_t CompressionConverter::WriteFillMemoryCommand(util::OutputStream*   stream,
+                                                    std::vector<uint8_t>* compressed_buffer,
+                                                    format::ThreadId      thread_id,
+                                                    uint64_t              memory_id,
+                                                    uint64_t              offset,
+                                                    size_t                size,
+                                                    const uint8_t*        data) const
 {
     // NOTE: Don't apply the offset to the write_address here since it's coming from the file_processor
     //       at the start of the stream.  We only need to record the writing offset for future info.
     format::FillMemoryCommandHeader fill_cmd;
     const uint8_t*                  write_address = data;
-
-    GFXRECON_CHECK_CONVERSION_DATA_LOSS(size_t, size);
-    size_t write_size = static_cast<size_t>(size);
+    size_t                          write_size    = size;
+    size_t                          bytes_written = 0;
 
     fill_cmd.meta_header.block_header.type = format::BlockType::kMetaDataBlock;
     fill_cmd.meta_header.meta_data_type    = format::MetaDataType::kFillMemoryCommand;
@@ -217,14 +499,14 @@ void CompressionConverter::DispatchFillMemoryCommand(
 
     if ((!decompressing_) && (compressor_ != nullptr))
     {
-        size_t compressed_size = compressor_->Compress(write_size, write_address, &compressed_buffer_);
+        size_t compressed_size = compressor_->Compress(write_size, write_address, compressed_buffer);
         if ((compressed_size > 0) && (compressed_size < write_size))
         {
             // We don't have a special header for compressed fill commands because the header always includes
             // the uncompressed size, so we just change the type to indicate the data is compressed.
             fill_cmd.meta_header.block_header.type = format::BlockType::kCompressedMetaDataBlock;
 
-            write_address = compressed_buffer_.data();
+            write_address = compressed_buffer->data();
             write_size    = compressed_size;
         }
     }
@@ -234,8 +516,10 @@ void CompressionConverter::DispatchFillMemoryCommand(
                                              sizeof(fill_cmd.memory_id) + sizeof(fill_cmd.memory_offset) +
                                              sizeof(fill_cmd.memory_size) + write_size;
 
-    bytes_written_ += file_stream_->Write(&fill_cmd, sizeof(fill_cmd));
-    bytes_written_ += file_stream_->Write(write_address, write_size);
+    bytes_written += stream->Write(&fill_cmd, sizeof(fill_cmd));
+    bytes_written += stream->Write(write_address, write_size);
+
+    return bytes_written;
 }
 
 void CompressionConverter::DispatchResizeWindowCommand(format::ThreadId thread_id,
@@ -254,7 +538,7 @@ void CompressionConverter::DispatchResizeWindowCommand(format::ThreadId thread_i
     resize_cmd.width                      = width;
     resize_cmd.height                     = height;
 
-    bytes_written_ += file_stream_->Write(&resize_cmd, sizeof(resize_cmd));
+    WriteUncompressedBlock(&resize_cmd, sizeof(resize_cmd), nullptr, 0);
 }
 
 void CompressionConverter::DispatchSetSwapchainImageStateCommand(
@@ -288,8 +572,7 @@ void CompressionConverter::DispatchSetSwapchainImageStateCommand(
     header.last_presented_image       = last_presented_image;
     header.image_info_count           = static_cast<uint32_t>(image_count);
 
-    bytes_written_ += file_stream_->Write(&header, sizeof(header));
-    bytes_written_ += file_stream_->Write(image_state.data(), image_state_size);
+    WriteUncompressedBlock(&header, sizeof(header), image_state.data(), image_state_size);
 }
 
 void CompressionConverter::DispatchBeginResourceInitCommand(format::ThreadId thread_id,
@@ -306,7 +589,7 @@ void CompressionConverter::DispatchBeginResourceInitCommand(format::ThreadId thr
     begin_cmd.max_resource_size             = max_resource_size;
     begin_cmd.max_copy_size                 = max_copy_size;
 
-    bytes_written_ += file_stream_->Write(&begin_cmd, sizeof(begin_cmd));
+    WriteUncompressedBlock(&begin_cmd, sizeof(begin_cmd), nullptr, 0);
 }
 
 void CompressionConverter::DispatchEndResourceInitCommand(format::ThreadId thread_id, format::HandleId device_id)
@@ -318,7 +601,7 @@ void CompressionConverter::DispatchEndResourceInitCommand(format::ThreadId threa
     end_cmd.thread_id                     = thread_id;
     end_cmd.device_id                     = device_id;
 
-    bytes_written_ += file_stream_->Write(&end_cmd, sizeof(end_cmd));
+    WriteUncompressedBlock(&end_cmd, sizeof(end_cmd), nullptr, 0);
 }
 
 void CompressionConverter::DispatchInitBufferCommand(format::ThreadId thread_id,
@@ -327,11 +610,31 @@ void CompressionConverter::DispatchInitBufferCommand(format::ThreadId thread_id,
                                                      uint64_t         data_size,
                                                      const uint8_t*   data)
 {
-    const uint8_t* write_address = data;
-
     GFXRECON_CHECK_CONVERSION_DATA_LOSS(size_t, data_size);
     size_t write_size = static_cast<size_t>(data_size);
 
+    WriteConvertedBlock(data,
+                        write_size,
+                        [this, thread_id, device_id, buffer_id, write_size](util::OutputStream*   stream,
+                                                                            std::vector<uint8_t>* compressed_buffer,
+                                                                            const uint8_t*        block_data) {
+                            return WriteInitBufferCommand(
+                                stream, compressed_buffer, thread_id, device_id, buffer_id, write_size, block_data);
+                        });
+}
+
+size_t CompressionConverter::WriteInitBufferCommand(util::OutputStream*   stream,
+                                                    std::vector<uint8_t>* compressed_buffer,
+                                                    format::ThreadId      thread_id,
+                                                    format::HandleId      device_id,
+                                                    format::HandleId      buffer_id,
+                                                    size_t                data_size,
+                                                    const uint8_t*        data) const
+{
+    const uint8_t* write_address = data;
+    size_t         write_size    = data_size;
+    size_t         bytes_written = 0;
+
     format::InitBufferCommandHeader init_cmd;
 
     init_cmd.meta_header.block_header.type = format::kMetaDataBlock;
@@ -343,13 +646,13 @@ void CompressionConverter::DispatchInitBufferCommand(format::ThreadId thread_id,
 
     if (compressor_ != nullptr)
     {
-        size_t compressed_size = compressor_->Compress(write_size, write_address, &compressed_buffer_);
+        size_t compressed_size = compressor_->Compress(write_size, write_address, compressed_buffer);
 
         if ((compressed_size > 0) && (compressed_size < write_size))
         {
             init_cmd.meta_header.block_header.type = format::BlockType::kCompressedMetaDataBlock;
 
-            write_address = compressed_buffer_.data();
+            write_address = compressed_buffer->data();
             write_size    = compressed_size;
         }
     }
@@ -358,8 +661,10 @@ void CompressionConverter::DispatchInitBufferCommand(format::ThreadId thread_id,
     init_cmd.meta_header.block_header.size =
         (sizeof(init_cmd) - sizeof(init_cmd.meta_header.block_header)) + write_size;
 
-    bytes_written_ += file_stream_->Write(&init_cmd, sizeof(init_cmd));
-    bytes_written_ += file_stream_->Write(write_address, write_size);
+    bytes_written += stream->Write(&init_cmd, sizeof(init_cmd));
+    bytes_written += stream->Write(write_address, write_size);
+
+    return bytes_written;
 }
 
 void CompressionConverter::DispatchInitImageCommand(format::ThreadId             thread_id,
@@ -370,8 +675,41 @@ void CompressionConverter::DispatchInitImageCommand(format::ThreadId
                                                     uint32_t                     layout,
                                                     const std::vector<uint64_t>& level_sizes,
                                                     const uint8_t*               data)
+{
+    GFXRECON_CHECK_CONVERSION_DATA_LOSS(size_t, data_size);
+    size_t write_size = static_cast<size_t>(data_size);
+
+    WriteConvertedBlock(
+        data,
+        write_size,
+        [this, thread_id, device_id, image_id, write_size, aspect, layout, level_sizes](
+            util::OutputStream* stream, std::vector<uint8_t>* compressed_buffer, const uint8_t* block_data) {
+            return WriteInitImageCommand(stream,
+                                         compressed_buffer,
+                                         thread_id,
+                                         device_id,
+                                         image_id,
+                                         write_size,
+                                         aspect,
+                                         layout,
+                                         level_sizes,
+                                         block_data);
+        });
+}
+
+size_t CompressionConverter::WriteInitImageCommand(util::OutputStream*          stream,
+                                                   std::vector<uint8_t>*        compressed_buffer,
+                                                   format::ThreadId             thread_id,
+                                                   format::HandleId             device_id,
+                                                   format::HandleId             image_id,
+                                                   size_t                       data_size,
+                                                   uint32_t                     aspect,
+                                                   uint32_t                     layout,
+                                                   const std::vector<uint64_t>& level_sizes,
+                                                   const uint8_t*               data) const
 {
     format::InitImageCommandHeader init_cmd;
+    size_t                         bytes_written = 0;
 
     // Packet size without the resource data.
     init_cmd.meta_header.block_header.size = sizeof(init_cmd) - sizeof(init_cmd.meta_header.block_header);
@@ -388,9 +726,7 @@ void CompressionConverter::DispatchInitImageCommand(format::ThreadId
         assert(!level_sizes.empty());
 
         const uint8_t* write_address = data;
-
-        GFXRECON_CHECK_CONVERSION_DATA_LOSS(size_t, data_size);
-        size_t write_size = static_cast<size_t>(data_size);
+        size_t         write_size    = data_size;
 
         // Store uncompressed data size in packet.
         init_cmd.data_size   = write_size;
@@ -398,13 +734,13 @@ void CompressionConverter::DispatchInitImageCommand(format::ThreadId
 
         if (compressor_ != nullptr)
         {
-            size_t compressed_size = compressor_->Compress(write_size, write_address, &compressed_buffer_);
+            size_t compressed_size = compressor_->Compress(write_size, write_address, compressed_buffer);
 
             if ((compressed_size > 0) && (compressed_size < write_size))
             {
                 init_cmd.meta_header.block_header.type = format::BlockType::kCompressedMetaDataBlock;
 
-                write_address = compressed_buffer_.data();
+                write_address = compressed_buffer->data();
                 write_size    = compressed_size;
             }
         }
@@ -414,9 +750,9 @@ void CompressionConverter::DispatchInitImageCommand(format::ThreadId
 
         init_cmd.meta_header.block_header.size += levels_size + write_size;
 
-        bytes_written_ += file_stream_->Write(&init_cmd, sizeof(init_cmd));
-        bytes_written_ += file_stream_->Write(level_sizes.data(), levels_size);
-        bytes_written_ += file_stream_->Write(write_address, write_size);
+        bytes_written += stream->Write(&init_cmd, sizeof(init_cmd));
+        bytes_written += stream->Write(level_sizes.data(), levels_size);
+        bytes_written += stream->Write(write_address, write_size);
     }
     else
     {
@@ -425,8 +761,10 @@ void CompressionConverter::DispatchInitImageCommand(format::ThreadId
         init_cmd.data_size   = 0;
         init_cmd.level_count = 0;
 
-        bytes_written_ += file_stream_->Write(&init_cmd, sizeof(init_cmd));
+        bytes_written += stream->Write(&init_cmd, sizeof(init_cmd));
     }
+
+    return bytes_written;
 }
 
 GFXRECON_END_NAMESPACE(decode)
@@ -24,11 +24,21 @@
 
 #include "decode/api_decoder.h"
 
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
 
 GFXRECON_BEGIN_NAMESPACE(gfxrecon)
 GFXRECON_BEGIN_NAMESPACE(decode)
 
+// Converts the compression format of a capture file.  When initialized with more than one thread, blocks are
+// compressed by a pool of worker threads while the file processor continues to read the file, and a writer thread
+// writes the converted blocks to the new file in their original order.
 class CompressionConverter : public ApiDecoder
 {
   public:
@@ -39,10 +49,15 @@ class CompressionConverter : public ApiDecoder
     bool Initialize(std::string                                filename,
                     const format::FileHeader&                  file_header,
                     const std::vector<format::FileOptionPair>& option_list,
-                    format::CompressionType                    target_compression_type);
+                    format::CompressionType                    target_compression_type,
+                    const std::vector<uint8_t>&                target_compression_dictionary,
+                    uint32_t                                   thread_count);
 
     void Destroy();
 
+    // Waits for all pending blocks to be written to the file.
+    void Flush();
+
     virtual bool SupportsApiCall(format::ApiCallId call_id) override
     {
         // Blocks are not decoded, just compressed or decmpressed, so all are supported.
@@ -100,12 +115,90 @@ class CompressionConverter : public ApiDecoder
     uint64_t NumBytesWritten() { return bytes_written_; }
 
   private:
-    std::unique_ptr<util::FileOutputStream> file_stream_;
-    std::string                             filename_;
-    uint64_t                                bytes_written_;
-    std::vector<uint8_t>                    compressed_buffer_;
-    util::Compressor*                       compressor_;
-    bool                                    decompressing_;
+    // Writes a converted block with the specified data to the output stream, using the compressed buffer for
+    // intermediate storage.  Returns the number of bytes written.
+    typedef std::function<size_t(util::OutputStream*, std::vector<uint8_t>*, const uint8_t*)> ConvertFunc;
+
+    struct ConversionTask
+    {
+        ConvertFunc              convert;
+        std::vector<uint8_t>     data;
+        size_t                   input_size{ 0 };
+        util::MemoryOutputStream output;
+        bool                     complete{ false };
+    };
+
+  private:
+    bool IsParallel() const { return !worker_threads_.empty(); }
+
+    void StartThreads(uint32_t thread_count);
+
+    void StopThreads();
+
+    void WorkerThreadMain();
+
+    void WriterThreadMain();
+
+    void SubmitTask(const std::shared_ptr<ConversionTask>& task, bool needs_conversion);
+
+    // Writes a block that is never compressed, consisting of a header and optional trailing data.
+    void WriteUncompressedBlock(const void* header, size_t header_size, const void* data, size_t data_size);
+
+    // Writes a block with data that is compressed.  The data is copied when it will be compressed by a worker thread.
+    void WriteConvertedBlock(const uint8_t* data, size_t data_size, ConvertFunc&& convert);
+
+    size_t WriteFunctionCall(util::OutputStream*   stream,
+                             std::vector<uint8_t>* compressed_buffer,
+                             format::ApiCallId     call_id,
+                             format::ThreadId      thread_id,
+                             const uint8_t*        buffer,
+                             size_t                buffer_size) const;
+
+    size_t WriteFillMemoryCommand(util::OutputStream*   stream,
+                                  std::vector<uint8_t>* compressed_buffer,
+                                  format::ThreadId      thread_id,
+                                  uint64_t              memory_id,
+                                  uint64_t              offset,
+                                  size_t                size,
+                                  const uint8_t*        data) const;
+
+    size_t WriteInitBufferCommand(util::OutputStream*   stream,
+                                  std::vector<uint8_t>* compressed_buffer,
+                                  format::ThreadId      thread_id,
+                                  format::HandleId      device_id,
+                                  format::HandleId      buffer_id,
+                                  size_t                data_size,
+                                  const uint8_t*        data) const;
+
+    size_t WriteInitImageCommand(util::OutputStream*          stream,
+                                 std::vector<uint8_t>*        compressed_buffer,
+                                 format::ThreadId             thread_id,
+                                 format::HandleId             device_id,
+                                 format::HandleId             image_id,
+                                 size_t                       data_size,
+                                 uint32_t                     aspect,
+                                 uint32_t                     layout,
+                                 const std::vector<uint64_t>& level_sizes,
+                                 const uint8_t*               data) const;
+
+  private:
+    std::unique_ptr<util::FileOutputStream>     file_stream_;
+    std::string                                 filename_;
+    uint64_t                                    bytes_written_;
+    std::vector<uint8_t>                        compressed_buffer_;
+    util::Compressor*                           compressor_;
+    bool                                        decompressing_;
+    std::vector<std::thread>                    worker_threads_;
+    std::thread                                 writer_thread_;
+    std::mutex                                  task_lock_;
+    std::condition_variable                     work_available_signal_;
+    std::condition_variable                     task_complete_signal_;
+    std::condition_variable                     task_written_signal_;
+    std::deque<std::shared_ptr<ConversionTask>> work_queue_;    // Tasks waiting for a worker thread.
+    std::deque<std::shared_ptr<ConversionTask>> pending_tasks_; // All tasks that have not been written, in order.
+    size_t                                      pending_bytes_;
+    size_t                                      max_pending_tasks_;
+    bool                                        stop_threads_;
 };
 
 GFXRECON_END_NAMESPACE(decode)
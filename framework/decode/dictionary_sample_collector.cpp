@@ -0,0 +1,49 @@
+/*
+** Copyright (c) 2019 LunarG, Inc.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+#include "decode/dictionary_sample_collector.h"
+
+#include <cassert>
+
+GFXRECON_BEGIN_NAMESPACE(gfxrecon)
+GFXRECON_BEGIN_NAMESPACE(decode)
+
+DictionarySampleCollector::DictionarySampleCollector(size_t max_sample_bytes, size_t max_sample_size) :
+    max_sample_bytes_(max_sample_bytes), max_sample_size_(max_sample_size)
+{}
+
+void DictionarySampleCollector::DecodeFunctionCall(format::ApiCallId  call_id,
+                                                   const ApiCallInfo& call_info,
+                                                   const uint8_t*     buffer,
+                                                   size_t             buffer_size)
+{
+    GFXRECON_UNREFERENCED_PARAMETER(call_id);
+    GFXRECON_UNREFERENCED_PARAMETER(call_info);
+
+    assert(buffer != nullptr);
+
+    // Large parameter buffers are dominated by resource data, which does not contain the repeated structure that a
+    // dictionary captures.
+    if ((buffer_size > 0) && (buffer_size <= max_sample_size_) &&
+        ((samples_.size() + buffer_size) <= max_sample_bytes_))
+    {
+        samples_.insert(samples_.end(), buffer, buffer + buffer_size);
+        sample_sizes_.push_back(buffer_size);
+    }
+}
+
+GFXRECON_END_NAMESPACE(decode)
+GFXRECON_END_NAMESPACE(gfxrecon)
@@ -0,0 +1,60 @@
+/*
+** Copyright (c) 2019 LunarG, Inc.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+#ifndef GFXRECON_DECODE_DICTIONARY_SAMPLE_COLLECTOR_H
+#define GFXRECON_DECODE_DICTIONARY_SAMPLE_COLLECTOR_H
+
+#include "decode/api_decoder.h"
+#include "util/defines.h"
+
+#include <cstdint>
+#include <vector>
+
+GFXRECON_BEGIN_NAMESPACE(gfxrecon)
+GFXRECON_BEGIN_NAMESPACE(decode)
+
+// Collects function call parameter buffers from a capture file, to be used as training samples for a compression
+// dictionary.  Function call blocks are small and numerous, and benefit the most from a shared dictionary.  Collection
+// stops once the sample buffer reaches the specified size.
+class DictionarySampleCollector : public ApiDecoder
+{
+  public:
+    DictionarySampleCollector(size_t max_sample_bytes, size_t max_sample_size);
+
+    virtual ~DictionarySampleCollector() override {}
+
+    virtual bool SupportsApiCall(format::ApiCallId call_id) override { return true; }
+
+    virtual void DecodeFunctionCall(format::ApiCallId  call_id,
+                                    const ApiCallInfo& call_info,
+                                    const uint8_t*     buffer,
+                                    size_t             buffer_size) override;
+
+    const std::vector<uint8_t>& GetSamples() const { return samples_; }
+
+    const std::vector<size_t>& GetSampleSizes() const { return sample_sizes_; }
+
+  private:
+    size_t               max_sample_bytes_;
+    size_t               max_sample_size_;
+    std::vector<uint8_t> samples_;
+    std::vector<size_t>  sample_sizes_;
+};
+
+GFXRECON_END_NAMESPACE(decode)
+GFXRECON_END_NAMESPACE(gfxrecon)
+
+#endif // GFXRECON_DECODE_DICTIONARY_SAMPLE_COLLECTOR_H
@@ -19,18 +19,21 @@
 
 #include "format/format_util.h"
 #include "util/compressor.h"
+#include "util/file_path.h"
 #include "util/logging.h"
 #include "util/platform.h"
 
 #include <cassert>
+#include <cinttypes>
 #include <numeric>
 
 GFXRECON_BEGIN_NAMESPACE(gfxrecon)
 GFXRECON_BEGIN_NAMESPACE(decode)
 
 FileProcessor::FileProcessor() :
-    file_descriptor_(nullptr), current_frame_number_(0), bytes_read_(0), error_state_(kErrorInvalidFileDescriptor),
-    compressor_(nullptr)
+    file_descriptor_(nullptr), primary_file_descriptor_(nullptr), primary_file_complete_(false),
+    current_frame_number_(0), bytes_read_(0), error_state_(kErrorInvalidFileDescriptor), compressor_(nullptr),
+    block_group_offset_(0), duplicate_command_(nullptr)
 {}
 
 FileProcessor::~FileProcessor()
@@ -41,9 +44,19 @@ FileProcessor::~FileProcessor()
         compressor_ = nullptr;
     }
 
-    if (file_descriptor_)
+    for (auto& stream_file : stream_files_)
     {
-        fclose(file_descriptor_);
+        fclose(stream_file.file_descriptor);
+    }
+
+    for (auto& reference_file : reference_files_)
+    {
+        fclose(reference_file.second->file_descriptor);
+    }
+
+    if (primary_file_descriptor_)
+    {
+        fclose(primary_file_descriptor_);
     }
 }
 
@@ -59,8 +72,9 @@ bool FileProcessor::Initialize(const std::string& filename)
 
         if (success)
         {
-            filename_    = filename;
-            error_state_ = kErrorNone;
+            filename_                = filename;
+            primary_file_descriptor_ = file_descriptor_;
+            error_state_             = kErrorNone;
         }
         else
         {
@@ -131,20 +145,20 @@ bool FileProcessor::ProcessFileHeader()
 
             if (success)
             {
-                for (const auto& option : file_options_)
+                ProcessFileOptions(file_options_, &enabled_options_);
+
+                // The compression dictionary immediately follows the file options.
+                compression_dictionary_.resize(enabled_options_.compression_dictionary_size);
+
+                if (!compression_dictionary_.empty() &&
+                    !ReadBytes(compression_dictionary_.data(), compression_dictionary_.size()))
                 {
-                    switch (option.key)
-                    {
-                        case format::FileOption::kCompressionType:
-                            enabled_options_.compression_type = static_cast<format::CompressionType>(option.value);
-                            break;
-                        default:
-                            GFXRECON_LOG_WARNING("Ignoring unrecognized file header option %u", option.key);
-                            break;
-                    }
+                    GFXRECON_LOG_ERROR("Failed to read compression dictionary from file header");
+                    error_state_ = kErrorReadingFileHeader;
+                    return false;
                 }
 
-                compressor_ = format::CreateCompressor(enabled_options_.compression_type);
+                compressor_ = format::CreateCompressor(enabled_options_.compression_type, compression_dictionary_);
 
                 if ((compressor_ == nullptr) && (enabled_options_.compression_type != format::CompressionType::kNone))
                 {
@@ -171,6 +185,332 @@ bool FileProcessor::ProcessFileHeader()
     return success;
 }
 
+void FileProcessor::ProcessFileOptions(const std::vector<format::FileOptionPair>& file_options,
+                                       format::EnabledOptions*                    enabled_options)
+{
+    assert(enabled_options != nullptr);
+
+    for (const auto& option : file_options)
+    {
+        switch (option.key)
+        {
+            case format::FileOption::kCompressionType:
+                enabled_options->compression_type = static_cast<format::CompressionType>(option.value);
+                break;
+            case format::FileOption::kBlockSequenceNumbers:
+                enabled_options->block_sequence_numbers = (option.value != 0);
+                break;
+            case format::FileOption::kCompressionStreamBlockSize:
+                enabled_options->compression_stream_block_size = option.value;
+                break;
+            case format::FileOption::kCompressionDictionarySize:
+                enabled_options->compression_dictionary_size = option.value;
+                break;
+            default:
+                GFXRECON_LOG_WARNING("Ignoring unrecognized file header option %u", option.key);
+                break;
+        }
+    }
+}
+
+bool FileProcessor::OpenStreamFile(const std::string& filename)
+{
+    bool       success = false;
+    StreamFile stream_file;
+
+    // Stream file names are relative to the directory containing the primary capture file.
+    stream_file.filename = util::filepath::Join(util::filepath::GetDirectory(filename_), filename);
+
+    int32_t result = util::platform::FileOpen(&stream_file.file_descriptor, stream_file.filename.c_str(), "rb");
+
+    if ((result == 0) && (stream_file.file_descriptor != nullptr))
+    {
+        format::FileHeader file_header;
+
+        if (ReadBytes(stream_file.file_descriptor, &file_header, sizeof(file_header)) &&
+            format::ValidateFileHeader(file_header))
+        {
+            std::vector<format::FileOptionPair> file_options(file_header.num_options);
+            format::EnabledOptions              enabled_options;
+
+            if (ReadBytes(stream_file.file_descriptor,
+                          file_options.data(),
+                          file_header.num_options * sizeof(format::FileOptionPair)))
+            {
+                ProcessFileOptions(file_options, &enabled_options);
+
+                // Stream files share the primary file's compressor, and must contain sequenced blocks.
+                if ((enabled_options.compression_type == enabled_options_.compression_type) &&
+                    enabled_options.block_sequence_numbers)
+                {
+                    success = true;
+                }
+                else
+                {
+                    GFXRECON_LOG_ERROR("Stream file %s has options that are incompatible with the primary capture file",
+                                       stream_file.filename.c_str());
+                }
+            }
+            else
+            {
+                GFXRECON_LOG_ERROR("Failed to read file options for stream file %s", stream_file.filename.c_str());
+            }
+        }
+        else
+        {
+            GFXRECON_LOG_ERROR("Failed to read valid file header for stream file %s", stream_file.filename.c_str());
+        }
+
+        if (success)
+        {
+            stream_files_.push_back(stream_file);
+        }
+        else
+        {
+            fclose(stream_file.file_descriptor);
+            error_state_ = kErrorInvalidStreamFile;
+        }
+    }
+    else
+    {
+        GFXRECON_LOG_ERROR("Failed to open stream file %s", stream_file.filename.c_str());
+        error_state_ = kErrorOpeningStreamFile;
+    }
+
+    return success;
+}
+
+bool FileProcessor::OpenReferenceFile(const std::string& filename, ReferenceFile* reference_file)
+{
+    assert(reference_file != nullptr);
+
+    bool success = false;
+
+    // Reference file names are relative to the directory containing the primary capture file.
+    std::string path = util::filepath::Join(util::filepath::GetDirectory(filename_), filename);
+
+    int32_t result = util::platform::FileOpen(&reference_file->file_descriptor, path.c_str(), "rb");
+
+    if ((result != 0) || (reference_file->file_descriptor == nullptr))
+    {
+        GFXRECON_LOG_ERROR("Failed to open reference file %s", path.c_str());
+        error_state_ = kErrorOpeningReferenceFile;
+        return false;
+    }
+
+    FILE*                               file = reference_file->file_descriptor;
+    format::FileHeader                  file_header;
+    std::vector<format::FileOptionPair> file_options;
+    format::EnabledOptions              enabled_options;
+
+    if (ReadBytes(file, &file_header, sizeof(file_header)) && format::ValidateFileHeader(file_header))
+    {
+        file_options.resize(file_header.num_options);
+
+        if (ReadBytes(file, file_options.data(), file_header.num_options * sizeof(format::FileOptionPair)))
+        {
+            ProcessFileOptions(file_options, &enabled_options);
+
+            std::vector<uint8_t> compression_dictionary(enabled_options.compression_dictionary_size);
+
+            if (compression_dictionary.empty() ||
+                ReadBytes(file, compression_dictionary.data(), compression_dictionary.size()))
+            {
+                // The reference file has its own compressor, as it was written with its own file options.
+                reference_file->compressor = std::unique_ptr<util::Compressor>(
+                    format::CreateCompressor(enabled_options.compression_type, compression_dictionary));
+
+                success = (reference_file->compressor != nullptr) ||
+                          (enabled_options.compression_type == format::CompressionType::kNone);
+            }
+        }
+    }
+
+    if (!success)
+    {
+        GFXRECON_LOG_ERROR("Failed to read valid file header for reference file %s", path.c_str());
+        error_state_ = kErrorInvalidReferenceFile;
+        return false;
+    }
+
+    // Record the location of each resource initialization block from the state snapshot, which is written to the
+    // start of the file, without sequence numbers.
+    for (;;)
+    {
+        int64_t             offset = util::platform::FileTell(file);
+        format::BlockHeader block_header;
+
+        if (!ReadBytes(file, &block_header, sizeof(block_header)))
+        {
+            break;
+        }
+
+        if (block_header.type == format::BlockType::kStateMarkerBlock)
+        {
+            format::MarkerType marker_type = format::MarkerType::kUnknownMarker;
+
+            if (ReadBytes(file, &marker_type, sizeof(marker_type)) && (marker_type == format::kEndMarker))
+            {
+                break;
+            }
+        }
+        else if (format::RemoveCompressedBlockBit(block_header.type) == format::BlockType::kMetaDataBlock)
+        {
+            format::MetaDataType meta_type   = format::MetaDataType::kUnknownMetaDataType;
+            format::ThreadId     thread_id   = 0;
+            format::HandleId     device_id   = 0;
+            format::HandleId     resource_id = 0;
+
+            if (ReadBytes(file, &meta_type, sizeof(meta_type)) &&
+                ((meta_type == format::MetaDataType::kInitBufferCommand) ||
+                 (meta_type == format::MetaDataType::kInitImageCommand)) &&
+                ReadBytes(file, &thread_id, sizeof(thread_id)) && ReadBytes(file, &device_id, sizeof(device_id)) &&
+                ReadBytes(file, &resource_id, sizeof(resource_id)))
+            {
+                uint64_t data_size = 0;
+                uint32_t aspect    = 0;
+
+                if ((meta_type == format::MetaDataType::kInitBufferCommand) ||
+                    (ReadBytes(file, &data_size, sizeof(data_size)) && ReadBytes(file, &aspect, sizeof(aspect))))
+                {
+                    reference_file->resource_offsets[std::make_pair(resource_id, aspect)] = offset;
+                }
+            }
+        }
+
+        // Move to the start of the next block.
+        if (!util::platform::FileSeek(file,
+                                      offset + static_cast<int64_t>(sizeof(block_header) + block_header.size),
+                                      util::platform::FileSeekSet))
+        {
+            break;
+        }
+    }
+
+    return true;
+}
+
+bool FileProcessor::ProcessResourceReference(const std::string& filename,
+                                             format::HandleId   resource_id,
+                                             uint32_t           aspect)
+{
+    auto entry = reference_files_.find(filename);
+
+    if (entry == reference_files_.end())
+    {
+        auto reference_file = std::make_unique<ReferenceFile>();
+
+        if (!OpenReferenceFile(filename, reference_file.get()))
+        {
+            if (reference_file->file_descriptor != nullptr)
+            {
+                fclose(reference_file->file_descriptor);
+            }
+
+            return false;
+        }
+
+        entry = reference_files_.emplace(filename, std::move(reference_file)).first;
+    }
+
+    ReferenceFile* reference_file = entry->second.get();
+    auto           offset_entry   = reference_file->resource_offsets.find(std::make_pair(resource_id, aspect));
+
+    if (offset_entry == reference_file->resource_offsets.end())
+    {
+        GFXRECON_LOG_ERROR(
+            "Reference file %s does not contain data for resource %" PRIu64, filename.c_str(), resource_id);
+        error_state_ = kErrorInvalidReferenceFile;
+        return false;
+    }
+
+    return ProcessResourceBlock(
+        reference_file->file_descriptor, reference_file->compressor.get(), offset_entry->second);
+}
+
+bool FileProcessor::ProcessDuplicateResource(const format::InitDuplicateResourceCommand& command)
+{
+    auto entry = resource_offsets_.find(std::make_pair(command.source_id, command.aspect));
+
+    if (entry == resource_offsets_.end())
+    {
+        GFXRECON_LOG_ERROR("State snapshot does not contain data for resource %" PRIu64
+                           ", which is duplicated by resource %" PRIu64,
+                           command.source_id,
+                           command.resource_id);
+        error_state_ = kErrorInvalidDuplicateResource;
+        return false;
+    }
+
+    // The source block is read from earlier in the primary file, which must then return to the block that follows
+    // this command.
+    int64_t current_offset = util::platform::FileTell(primary_file_descriptor_);
+
+    duplicate_command_ = &command;
+
+    bool success = ProcessResourceBlock(primary_file_descriptor_, compressor_, entry->second);
+
+    duplicate_command_ = nullptr;
+
+    if (!util::platform::FileSeek(primary_file_descriptor_, current_offset, util::platform::FileSeekSet))
+    {
+        GFXRECON_LOG_ERROR("Failed to restore the file position after processing duplicate resource %" PRIu64,
+                           command.resource_id);
+        error_state_ = kErrorReadingFile;
+        success      = false;
+    }
+
+    return success;
+}
+
+bool FileProcessor::ProcessResourceBlock(FILE* file, util::Compressor* compressor, int64_t offset)
+{
+    format::BlockHeader  block_header;
+    format::MetaDataType meta_type = format::MetaDataType::kUnknownMetaDataType;
+
+    if (!util::platform::FileSeek(file, offset, util::platform::FileSeekSet) ||
+        !ReadBytes(file, &block_header, sizeof(block_header)) || !ReadBytes(file, &meta_type, sizeof(meta_type)))
+    {
+        GFXRECON_LOG_ERROR("Failed to read resource initialization block at file offset %" PRId64, offset);
+        error_state_ = kErrorReadingBlockHeader;
+        return false;
+    }
+
+    // Process the block as if it had been read from the current file, with the compressor for the block's file.
+    FILE*                current_file         = file_descriptor_;
+    util::Compressor*    current_compressor   = compressor_;
+    size_t               current_group_offset = block_group_offset_;
+    std::vector<uint8_t> current_group_buffer;
+
+    std::swap(current_group_buffer, block_group_buffer_);
+
+    file_descriptor_    = file;
+    compressor_         = compressor;
+    block_group_offset_ = 0;
+
+    bool success = ProcessMetaData(block_header, meta_type);
+
+    file_descriptor_    = current_file;
+    compressor_         = current_compressor;
+    block_group_offset_ = current_group_offset;
+
+    std::swap(current_group_buffer, block_group_buffer_);
+
+    return success;
+}
+
+int64_t FileProcessor::GetMetaDataBlockOffset() const
+{
+    if ((file_descriptor_ != primary_file_descriptor_) || (block_group_offset_ < block_group_buffer_.size()))
+    {
+        return -1;
+    }
+
+    // The block header and meta-data type have already been read.
+    return util::platform::FileTell(file_descriptor_) -
+           static_cast<int64_t>(sizeof(format::BlockHeader) + sizeof(format::MetaDataType));
+}
+
 bool FileProcessor::ProcessBlocks()
 {
     format::BlockHeader block_header;
@@ -266,14 +606,171 @@ bool FileProcessor::ReadBlockHeader(format::BlockHeader* block_header)
 
     bool success = false;
 
-    if (ReadBytes(block_header, sizeof(*block_header)))
+    // Blocks from the current block group are read before any blocks that follow the group in the file.
+    if (block_group_offset_ < block_group_buffer_.size())
+    {
+        return ReadBytes(block_header, sizeof(*block_header));
+    }
+
+    if (!stream_files_.empty())
+    {
+        success = ReadStreamBlockHeader(block_header);
+    }
+    else if (enabled_options_.block_sequence_numbers)
+    {
+        // Sequence numbers are only needed to merge stream files, and are ignored when a stream file is processed on
+        // its own.
+        uint64_t sequence = 0;
+        success           = ReadSequencedBlockHeader(file_descriptor_, block_header, &sequence);
+    }
+    else if (ReadBytes(block_header, sizeof(*block_header)))
+    {
+        success = true;
+    }
+
+    if (success && (block_header->type == format::BlockType::kCompressedBlockGroup))
+    {
+        // Replace the group header with the header of the first block from the group.
+        success = ReadBlockGroup(*block_header) && ReadBytes(block_header, sizeof(*block_header));
+    }
+
+    return success;
+}
+
+bool FileProcessor::ReadBlockGroup(const format::BlockHeader& block_header)
+{
+    uint64_t uncompressed_size = 0;
+
+    if (compressor_ == nullptr)
+    {
+        GFXRECON_LOG_ERROR("Compressed block group found in a file that does not specify a compression type");
+        error_state_ = kErrorUnsupportedCompressionType;
+        return false;
+    }
+
+    if (!ReadBytes(&uncompressed_size, sizeof(uncompressed_size)))
+    {
+        HandleBlockReadError(kErrorReadingCompressedBlockHeader, "Failed to read compressed block group header");
+        return false;
+    }
+
+    GFXRECON_CHECK_CONVERSION_DATA_LOSS(size_t, block_header.size);
+    GFXRECON_CHECK_CONVERSION_DATA_LOSS(size_t, uncompressed_size);
+
+    size_t compressed_size = static_cast<size_t>(block_header.size) - sizeof(uncompressed_size);
+    size_t expected_size   = static_cast<size_t>(uncompressed_size);
+
+    if (compressed_size > compressed_parameter_buffer_.size())
+    {
+        compressed_parameter_buffer_.resize(compressed_size);
+    }
+
+    if (!ReadBytes(compressed_parameter_buffer_.data(), compressed_size))
+    {
+        HandleBlockReadError(kErrorReadingCompressedBlockData, "Failed to read compressed block group data");
+        return false;
+    }
+
+    block_group_buffer_.resize(expected_size);
+    block_group_offset_ = 0;
+
+    size_t decompressed_size =
+        compressor_->Decompress(compressed_size, compressed_parameter_buffer_, expected_size, &block_group_buffer_);
+
+    if ((decompressed_size == 0) || (decompressed_size != expected_size))
+    {
+        GFXRECON_LOG_ERROR("Failed to decompress block group data");
+        error_state_ = kErrorReadingCompressedBlockData;
+        block_group_buffer_.clear();
+        return false;
+    }
+
+    return true;
+}
+
+bool FileProcessor::ReadSequencedBlockHeader(FILE* file, format::BlockHeader* block_header, uint64_t* sequence)
+{
+    assert((block_header != nullptr) && (sequence != nullptr));
+
+    bool success = false;
+
+    if (ReadBytes(file, block_header, sizeof(*block_header)) && ReadBytes(file, sequence, sizeof(*sequence)))
     {
+        // Remove the sequence number from the block size, so that the size only covers the block contents that follow.
+        block_header->size -= sizeof(*sequence);
         success = true;
     }
 
     return success;
 }
 
+bool FileProcessor::ReadStreamBlockHeader(format::BlockHeader* block_header)
+{
+    assert(block_header != nullptr);
+
+    // The primary file contains the stream file declarations and any state setup blocks, which are not sequenced and
+    // are processed before the blocks from the stream files.
+    if (!primary_file_complete_)
+    {
+        file_descriptor_ = primary_file_descriptor_;
+
+        if (ReadBytes(block_header, sizeof(*block_header)))
+        {
+            return true;
+        }
+        else if (ferror(primary_file_descriptor_))
+        {
+            return false;
+        }
+
+        primary_file_complete_ = true;
+    }
+
+    // Read the next block header from each stream file that does not have a pending block, and select the pending
+    // block with the lowest sequence number.
+    StreamFile* next_stream_file = nullptr;
+
+    for (auto& stream_file : stream_files_)
+    {
+        if (!stream_file.has_block && !stream_file.complete)
+        {
+            if (ReadSequencedBlockHeader(stream_file.file_descriptor, &stream_file.block_header, &stream_file.sequence))
+            {
+                stream_file.has_block = true;
+            }
+            else if (feof(stream_file.file_descriptor) && !ferror(stream_file.file_descriptor))
+            {
+                stream_file.complete = true;
+            }
+            else
+            {
+                // Make the file with the read error current, so that it is reported by the caller.
+                file_descriptor_ = stream_file.file_descriptor;
+                return false;
+            }
+        }
+
+        if (stream_file.has_block &&
+            ((next_stream_file == nullptr) || (stream_file.sequence < next_stream_file->sequence)))
+        {
+            next_stream_file = &stream_file;
+        }
+    }
+
+    if (next_stream_file == nullptr)
+    {
+        // All blocks have been processed.  The primary file is made current to report the end of file condition.
+        file_descriptor_ = primary_file_descriptor_;
+        return false;
+    }
+
+    (*block_header)             = next_stream_file->block_header;
+    next_stream_file->has_block = false;
+    file_descriptor_            = next_stream_file->file_descriptor;
+
+    return true;
+}
+
 bool FileProcessor::ReadParameterBuffer(size_t buffer_size)
 {
     if (buffer_size > parameter_buffer_.size())
@@ -287,9 +784,18 @@ bool FileProcessor::ReadParameterBuffer(size_t buffer_size)
 bool FileProcessor::ReadCompressedParameterBuffer(size_t  compressed_buffer_size,
                                                   size_t  expected_uncompressed_size,
                                                   size_t* uncompressed_buffer_size)
+{
+    return ReadCompressedParameterBuffer(
+        compressor_, compressed_buffer_size, expected_uncompressed_size, uncompressed_buffer_size);
+}
+
+bool FileProcessor::ReadCompressedParameterBuffer(util::Compressor* compressor,
+                                                  size_t            compressed_buffer_size,
+                                                  size_t            expected_uncompressed_size,
+                                                  size_t*           uncompressed_buffer_size)
 {
     // This should only be null if initialization failed.
-    assert(compressor_ != nullptr);
+    assert(compressor != nullptr);
 
     if (compressed_buffer_size > compressed_parameter_buffer_.size())
     {
@@ -303,7 +809,7 @@ bool FileProcessor::ReadCompressedParameterBuffer(size_t  compressed_buffer_size
             parameter_buffer_.resize(expected_uncompressed_size);
         }
 
-        size_t uncompressed_size = compressor_->Decompress(
+        size_t uncompressed_size = compressor->Decompress(
             compressed_buffer_size, compressed_parameter_buffer_, expected_uncompressed_size, &parameter_buffer_);
         if ((0 < uncompressed_size) && (uncompressed_size == expected_uncompressed_size))
         {
@@ -314,15 +820,72 @@ bool FileProcessor::ReadCompressedParameterBuffer(size_t  compressed_buffer_size
     return false;
 }
 
+util::Compressor* FileProcessor::GetStreamCompressor(format::ThreadId thread_id)
+{
+    auto entry = stream_compressors_.find(thread_id);
+    if (entry != stream_compressors_.end())
+    {
+        return entry->second.get();
+    }
+
+    if (enabled_options_.compression_stream_block_size == 0)
+    {
+        GFXRECON_LOG_ERROR("Stream compressed block found in a file that does not specify a compression stream block "
+                           "size");
+        return nullptr;
+    }
+
+    util::Compressor* compressor = format::CreateStreamCompressor(enabled_options_.compression_type,
+                                                                  enabled_options_.compression_stream_block_size);
+
+    if (compressor != nullptr)
+    {
+        stream_compressors_.emplace(thread_id, std::unique_ptr<util::Compressor>(compressor));
+    }
+
+    return compressor;
+}
+
 bool FileProcessor::ReadBytes(void* buffer, size_t buffer_size)
 {
-    size_t bytes_read = util::platform::FileRead(buffer, 1, buffer_size, file_descriptor_);
+    if (block_group_offset_ < block_group_buffer_.size())
+    {
+        // Blocks from a block group never extend past the end of the group.
+        if (buffer_size > (block_group_buffer_.size() - block_group_offset_))
+        {
+            return false;
+        }
+
+        util::platform::MemoryCopy(buffer, buffer_size, block_group_buffer_.data() + block_group_offset_, buffer_size);
+        block_group_offset_ += buffer_size;
+
+        return true;
+    }
+
+    return ReadBytes(file_descriptor_, buffer, buffer_size);
+}
+
+bool FileProcessor::ReadBytes(FILE* file, void* buffer, size_t buffer_size)
+{
+    size_t bytes_read = util::platform::FileRead(buffer, 1, buffer_size, file);
     bytes_read_ += bytes_read;
     return (bytes_read == buffer_size);
 }
 
 bool FileProcessor::SkipBytes(size_t skip_size)
 {
+    if (block_group_offset_ < block_group_buffer_.size())
+    {
+        if (skip_size > (block_group_buffer_.size() - block_group_offset_))
+        {
+            return false;
+        }
+
+        block_group_offset_ += skip_size;
+
+        return true;
+    }
+
     bool success = util::platform::FileSeek(file_descriptor_, skip_size, util::platform::FileSeekCurrent);
 
     if (success)
@@ -369,9 +932,21 @@ bool FileProcessor::ProcessFunctionCall(const format::BlockHeader& block_header,
             {
                 GFXRECON_CHECK_CONVERSION_DATA_LOSS(size_t, uncompressed_size);
 
+                // Stream compressed blocks depend on the history of previous blocks from the same thread.
+                util::Compressor* compressor = compressor_;
+                if (format::IsBlockStreamCompressed(block_header.type))
+                {
+                    compressor = GetStreamCompressor(call_info.thread_id);
+                }
+
                 size_t actual_size = 0;
-                success            = ReadCompressedParameterBuffer(
-                    parameter_buffer_size, static_cast<size_t>(uncompressed_size), &actual_size);
+                success            = (compressor != nullptr);
+
+                if (success)
+                {
+                    success = ReadCompressedParameterBuffer(
+                        compressor, parameter_buffer_size, static_cast<size_t>(uncompressed_size), &actual_size);
+                }
 
                 if (success)
                 {
@@ -641,6 +1216,7 @@ bool FileProcessor::ProcessMetaData(const format::BlockHeader& block_header, for
     else if (meta_type == format::MetaDataType::kInitBufferCommand)
     {
         format::InitBufferCommandHeader header;
+        int64_t                         block_offset = GetMetaDataBlockOffset();
 
         success = ReadBytes(&header.thread_id, sizeof(header.thread_id));
         success = success && ReadBytes(&header.device_id, sizeof(header.device_id));
@@ -649,6 +1225,14 @@ bool FileProcessor::ProcessMetaData(const format::BlockHeader& block_header, for
 
         if (success)
         {
+            if (duplicate_command_ != nullptr)
+            {
+                // The data from this block initializes a duplicate resource.
+                header.thread_id = duplicate_command_->thread_id;
+                header.device_id = duplicate_command_->device_id;
+                header.buffer_id = duplicate_command_->resource_id;
+            }
+
             GFXRECON_CHECK_CONVERSION_DATA_LOSS(size_t, header.data_size);
 
             if (format::IsBlockCompressed(block_header.type))
@@ -667,6 +1251,11 @@ bool FileProcessor::ProcessMetaData(const format::BlockHeader& block_header, for
 
             if (success)
             {
+                if (block_offset >= 0)
+                {
+                    resource_offsets_[std::make_pair(header.buffer_id, 0u)] = block_offset;
+                }
+
                 for (auto decoder : decoders_)
                 {
                     decoder->DispatchInitBufferCommand(header.thread_id,
@@ -698,6 +1287,7 @@ bool FileProcessor::ProcessMetaData(const format::BlockHeader& block_header, for
     {
         format::InitImageCommandHeader header;
         std::vector<uint64_t>          level_sizes;
+        int64_t                        block_offset = GetMetaDataBlockOffset();
 
         success = ReadBytes(&header.thread_id, sizeof(header.thread_id));
         success = success && ReadBytes(&header.device_id, sizeof(header.device_id));
@@ -707,6 +1297,15 @@ bool FileProcessor::ProcessMetaData(const format::BlockHeader& block_header, for
         success = success && ReadBytes(&header.layout, sizeof(header.layout));
         success = success && ReadBytes(&header.level_count, sizeof(header.level_count));
 
+        if (success && (duplicate_command_ != nullptr))
+        {
+            // The data from this block initializes a duplicate resource.
+            header.thread_id = duplicate_command_->thread_id;
+            header.device_id = duplicate_command_->device_id;
+            header.image_id  = duplicate_command_->resource_id;
+            header.layout    = duplicate_command_->layout;
+        }
+
         if (success && (header.level_count > 0))
         {
             level_sizes.resize(header.level_count);
@@ -736,6 +1335,11 @@ bool FileProcessor::ProcessMetaData(const format::BlockHeader& block_header, for
 
         if (success)
         {
+            if ((block_offset >= 0) && (header.data_size > 0))
+            {
+                resource_offsets_[std::make_pair(header.image_id, header.aspect)] = block_offset;
+            }
+
             for (auto decoder : decoders_)
             {
                 decoder->DispatchInitImageCommand(header.thread_id,
@@ -761,6 +1365,129 @@ bool FileProcessor::ProcessMetaData(const format::BlockHeader& block_header, for
             }
         }
     }
+    else if (meta_type == format::MetaDataType::kAddStreamFileCommand)
+    {
+        // This command does not support compression.
+        assert(block_header.type != format::BlockType::kCompressedMetaDataBlock);
+
+        format::AddStreamFileCommandHeader header;
+
+        success = ReadBytes(&header.thread_id, sizeof(header.thread_id));
+
+        if (success)
+        {
+            uint64_t filename_size = block_header.size - sizeof(meta_type) - sizeof(header.thread_id);
+
+            GFXRECON_CHECK_CONVERSION_DATA_LOSS(size_t, filename_size);
+
+            success = ReadParameterBuffer(static_cast<size_t>(filename_size));
+
+            if (success)
+            {
+                // The stream file is opened here instead of being dispatched to the decoders; its blocks will be
+                // merged with the blocks from the other streams.
+                std::string filename(parameter_buffer_.begin(), parameter_buffer_.begin() + filename_size);
+                success = OpenStreamFile(filename);
+            }
+            else
+            {
+                HandleBlockReadError(kErrorReadingBlockData, "Failed to read add stream file meta-data block");
+            }
+        }
+        else
+        {
+            HandleBlockReadError(kErrorReadingBlockHeader, "Failed to read add stream file meta-data block header");
+        }
+    }
+    else if (meta_type == format::MetaDataType::kInitResourceReferenceCommand)
+    {
+        // This command does not support compression.
+        assert(block_header.type != format::BlockType::kCompressedMetaDataBlock);
+
+        format::InitResourceReferenceCommandHeader header;
+
+        success = ReadBytes(&header.thread_id, sizeof(header.thread_id));
+        success = success && ReadBytes(&header.device_id, sizeof(header.device_id));
+        success = success && ReadBytes(&header.resource_id, sizeof(header.resource_id));
+        success = success && ReadBytes(&header.aspect, sizeof(header.aspect));
+
+        if (success)
+        {
+            uint64_t filename_size = block_header.size - (sizeof(header) - sizeof(header.meta_header.block_header));
+
+            GFXRECON_CHECK_CONVERSION_DATA_LOSS(size_t, filename_size);
+
+            success = ReadParameterBuffer(static_cast<size_t>(filename_size));
+
+            if (success)
+            {
+                // The referenced resource initialization block is read from the other capture file and dispatched to
+                // the decoders in place of this command.
+                std::string filename(parameter_buffer_.begin(), parameter_buffer_.begin() + filename_size);
+                success = ProcessResourceReference(filename, header.resource_id, header.aspect);
+            }
+            else
+            {
+                HandleBlockReadError(kErrorReadingBlockData, "Failed to read init resource reference meta-data block");
+            }
+        }
+        else
+        {
+            HandleBlockReadError(kErrorReadingBlockHeader,
+                                 "Failed to read init resource reference meta-data block header");
+        }
+    }
+    else if (meta_type == format::MetaDataType::kInitDuplicateResourceCommand)
+    {
+        // This command does not support compression.
+        assert(block_header.type != format::BlockType::kCompressedMetaDataBlock);
+
+        format::InitDuplicateResourceCommand command;
+
+        success = ReadBytes(&command.thread_id, sizeof(command.thread_id));
+        success = success && ReadBytes(&command.device_id, sizeof(command.device_id));
+        success = success && ReadBytes(&command.resource_id, sizeof(command.resource_id));
+        success = success && ReadBytes(&command.source_id, sizeof(command.source_id));
+        success = success && ReadBytes(&command.aspect, sizeof(command.aspect));
+        success = success && ReadBytes(&command.layout, sizeof(command.layout));
+
+        if (success)
+        {
+            // The initialization block for the source resource is read again and dispatched to the decoders for the
+            // duplicate resource in place of this command.
+            success = ProcessDuplicateResource(command);
+        }
+        else
+        {
+            HandleBlockReadError(kErrorReadingBlockHeader,
+                                 "Failed to read init duplicate resource meta-data block header");
+        }
+    }
+    else if (meta_type == format::MetaDataType::kResetCompressionStreamCommand)
+    {
+        // This command does not support compression.
+        assert(block_header.type != format::BlockType::kCompressedMetaDataBlock);
+
+        format::ResetCompressionStreamCommand command;
+
+        success = ReadBytes(&command.thread_id, sizeof(command.thread_id));
+
+        if (success)
+        {
+            // The command only affects the decompression of the blocks that follow it, so it is handled here instead
+            // of being dispatched to the decoders.
+            auto entry = stream_compressors_.find(command.thread_id);
+            if (entry != stream_compressors_.end())
+            {
+                entry->second->Reset();
+            }
+        }
+        else
+        {
+            HandleBlockReadError(kErrorReadingBlockHeader,
+                                 "Failed to read reset compression stream meta-data block header");
+        }
+    }
     else
     {
         // Unrecognized metadata type.
@@ -26,7 +26,11 @@
 
 #include <algorithm>
 #include <cstdio>
+#include <map>
+#include <memory>
 #include <string>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 GFXRECON_BEGIN_NAMESPACE(gfxrecon)
@@ -47,7 +51,12 @@ class FileProcessor
         kErrorReadingBlockData             = -7,
         kErrorReadingCompressedBlockData   = -8,
         kErrorInvalidFourCC                = -9,
-        kErrorUnsupportedCompressionType   = -10
+        kErrorUnsupportedCompressionType   = -10,
+        kErrorOpeningStreamFile            = -11,
+        kErrorInvalidStreamFile            = -12,
+        kErrorOpeningReferenceFile         = -13,
+        kErrorInvalidReferenceFile         = -14,
+        kErrorInvalidDuplicateResource     = -15
     };
 
   public:
@@ -74,6 +83,7 @@ class FileProcessor
     const format::FileHeader& GetFileHeader() const { return file_header_; }
 
     const std::vector<format::FileOptionPair>& GetFileOptions() const { return file_options_; }
+    const std::vector<uint8_t>& GetCompressionDictionary() const { return compression_dictionary_; }
 
     uint32_t GetCurrentFrameNumber() const { return current_frame_number_; }
 
@@ -81,21 +91,78 @@ class FileProcessor
 
     Error GetErrorState() const { return error_state_; }
 
+  private:
+    // Secondary capture file containing the blocks written by a single thread, which are merged with the blocks from
+    // other stream files in sequence number order.
+    struct StreamFile
+    {
+        FILE*               file_descriptor{ nullptr };
+        std::string         filename;
+        format::BlockHeader block_header{};
+        uint64_t            sequence{ 0 };
+        bool                has_block{ false }; // A block header has been read, but the block has not been processed.
+        bool                complete{ false };
+    };
+
+    // Capture file from an earlier trim range, containing resource data that is referenced by the state snapshot of an
+    // incremental trim capture file.  Stores the file offsets of the resource initialization blocks from the file's
+    // state snapshot, keyed by resource ID and image aspect.
+    struct ReferenceFile
+    {
+        FILE*                                                    file_descriptor{ nullptr };
+        std::unique_ptr<util::Compressor>                        compressor;
+        std::map<std::pair<format::HandleId, uint32_t>, int64_t> resource_offsets;
+    };
+
   private:
     bool ProcessFileHeader();
 
+    void ProcessFileOptions(const std::vector<format::FileOptionPair>& file_options,
+                            format::EnabledOptions*                    enabled_options);
+
+    bool OpenStreamFile(const std::string& filename);
+
+    bool OpenReferenceFile(const std::string& filename, ReferenceFile* reference_file);
+
+    bool ProcessResourceReference(const std::string& filename, format::HandleId resource_id, uint32_t aspect);
+
+    bool ProcessDuplicateResource(const format::InitDuplicateResourceCommand& command);
+
+    // Processes the resource initialization block at the specified offset of a file, which may be a different file than
+    // the one that blocks are currently being read from.
+    bool ProcessResourceBlock(FILE* file, util::Compressor* compressor, int64_t offset);
+
+    // Returns the file offset of the meta-data block being processed, or -1 if the block was not read directly from the
+    // primary file.
+    int64_t GetMetaDataBlockOffset() const;
+
     bool ProcessBlocks();
 
     bool ReadBlockHeader(format::BlockHeader* block_header);
 
+    bool ReadSequencedBlockHeader(FILE* file, format::BlockHeader* block_header, uint64_t* sequence);
+
+    bool ReadStreamBlockHeader(format::BlockHeader* block_header);
+
+    bool ReadBlockGroup(const format::BlockHeader& block_header);
+
     bool ReadParameterBuffer(size_t buffer_size);
 
     bool ReadCompressedParameterBuffer(size_t  compressed_buffer_size,
                                        size_t  expected_uncompressed_size,
                                        size_t* uncompressed_buffer_size);
 
+    bool ReadCompressedParameterBuffer(util::Compressor* compressor,
+                                       size_t            compressed_buffer_size,
+                                       size_t            expected_uncompressed_size,
+                                       size_t*           uncompressed_buffer_size);
+
+    util::Compressor* GetStreamCompressor(format::ThreadId thread_id);
+
     bool ReadBytes(void* buffer, size_t buffer_size);
 
+    bool ReadBytes(FILE* file, void* buffer, size_t buffer_size);
+
     bool SkipBytes(size_t skip_size);
 
     void HandleBlockReadError(Error error_code, const char* error_message);
@@ -113,7 +180,10 @@ class FileProcessor
     bool IsFileValid() const { return (file_descriptor_ && !feof(file_descriptor_) && !ferror(file_descriptor_)); }
 
   private:
-    FILE*                               file_descriptor_;
+    FILE*                               file_descriptor_; // File that blocks are currently being read from.
+    FILE*                               primary_file_descriptor_;
+    bool                                primary_file_complete_;
+    std::vector<StreamFile>             stream_files_;
     std::string                         filename_;
     format::FileHeader                  file_header_;
     std::vector<format::FileOptionPair> file_options_;
@@ -125,6 +195,22 @@ class FileProcessor
     std::vector<uint8_t>                parameter_buffer_;
     std::vector<uint8_t>                compressed_parameter_buffer_;
     util::Compressor*                   compressor_;
+    std::vector<uint8_t>                compression_dictionary_;
+    std::vector<uint8_t>                block_group_buffer_; // Decompressed blocks from a kCompressedBlockGroup.
+    size_t                              block_group_offset_;
+
+    // Decompression history for kStreamCompressedFunctionCallBlock, tracked separately for each thread.
+    std::unordered_map<format::ThreadId, std::unique_ptr<util::Compressor>> stream_compressors_;
+
+    // Capture files referenced by kInitResourceReferenceCommand, keyed by the filename from the command.
+    std::unordered_map<std::string, std::unique_ptr<ReferenceFile>> reference_files_;
+
+    // File offsets of the resource initialization blocks from the primary file, keyed by resource ID and image aspect,
+    // for the resources that are initialized by kInitDuplicateResourceCommand.
+    std::map<std::pair<format::HandleId, uint32_t>, int64_t> resource_offsets_;
+
+    // Command for the duplicate resource that the resource initialization block being processed is dispatched for.
+    const format::InitDuplicateResourceCommand* duplicate_command_;
 };
 
 GFXRECON_END_NAMESPACE(decode)
@@ -35,12 +35,28 @@ GFXRECON_BEGIN_NAMESPACE(encode)
 // clang-format off
 #define CAPTURE_COMPRESSION_TYPE_LOWER      "capture_compression_type"
 #define CAPTURE_COMPRESSION_TYPE_UPPER      "CAPTURE_COMPRESSION_TYPE"
+#define COMPRESSION_CHUNK_SIZE_LOWER        "capture_compression_chunk_size"
+#define COMPRESSION_CHUNK_SIZE_UPPER        "CAPTURE_COMPRESSION_CHUNK_SIZE"
+#define COMPRESSION_DICTIONARY_LOWER        "capture_compression_dictionary"
+#define COMPRESSION_DICTIONARY_UPPER        "CAPTURE_COMPRESSION_DICTIONARY"
+#define COMPRESSION_ADAPTIVE_LOWER          "capture_compression_adaptive"
+#define COMPRESSION_ADAPTIVE_UPPER          "CAPTURE_COMPRESSION_ADAPTIVE"
+#define COMPRESSION_MIN_BLOCK_SIZE_LOWER    "capture_compression_min_block_size"
+#define COMPRESSION_MIN_BLOCK_SIZE_UPPER    "CAPTURE_COMPRESSION_MIN_BLOCK_SIZE"
 #define CAPTURE_FILE_NAME_LOWER             "capture_file"
 #define CAPTURE_FILE_NAME_UPPER             "CAPTURE_FILE"
 #define CAPTURE_FILE_USE_TIMESTAMP_LOWER    "capture_file_timestamp"
 #define CAPTURE_FILE_USE_TIMESTAMP_UPPER    "CAPTURE_FILE_TIMESTAMP"
 #define CAPTURE_FILE_FLUSH_LOWER            "capture_file_flush"
 #define CAPTURE_FILE_FLUSH_UPPER            "CAPTURE_FILE_FLUSH"
+#define CAPTURE_FILE_ASYNC_WRITE_LOWER      "capture_file_async_write"
+#define CAPTURE_FILE_ASYNC_WRITE_UPPER      "CAPTURE_FILE_ASYNC_WRITE"
+#define CAPTURE_FILE_BATCH_SIZE_LOWER       "capture_file_batch_size"
+#define CAPTURE_FILE_BATCH_SIZE_UPPER       "CAPTURE_FILE_BATCH_SIZE"
+#define CAPTURE_FILE_THREAD_STREAMS_LOWER   "capture_file_thread_streams"
+#define CAPTURE_FILE_THREAD_STREAMS_UPPER   "CAPTURE_FILE_THREAD_STREAMS"
+#define CAPTURE_FILE_OUTPUT_MODE_LOWER      "capture_file_output_mode"
+#define CAPTURE_FILE_OUTPUT_MODE_UPPER      "CAPTURE_FILE_OUTPUT_MODE"
 #define LOG_ALLOW_INDENTS_LOWER             "log_allow_indents"
 #define LOG_ALLOW_INDENTS_UPPER             "LOG_ALLOW_INDENTS"
 #define LOG_BREAK_ON_ERROR_LOWER            "log_break_on_error"
@@ -67,14 +83,34 @@ GFXRECON_BEGIN_NAMESPACE(encode)
 #define MEMORY_TRACKING_MODE_UPPER          "MEMORY_TRACKING_MODE"
 #define CAPTURE_FRAMES_LOWER                "capture_frames"
 #define CAPTURE_FRAMES_UPPER                "CAPTURE_FRAMES"
+#define CAPTURE_FRAMES_INCREMENTAL_LOWER    "capture_frames_incremental"
+#define CAPTURE_FRAMES_INCREMENTAL_UPPER    "CAPTURE_FRAMES_INCREMENTAL"
+#define CAPTURE_FRAMES_THREADS_LOWER        "capture_frames_threads"
+#define CAPTURE_FRAMES_THREADS_UPPER        "CAPTURE_FRAMES_THREADS"
+#define FLIGHT_RECORDER_SIZE_LOWER          "flight_recorder_size"
+#define FLIGHT_RECORDER_SIZE_UPPER          "FLIGHT_RECORDER_SIZE"
+#define FLIGHT_RECORDER_SIGNAL_LOWER        "flight_recorder_signal"
+#define FLIGHT_RECORDER_SIGNAL_UPPER        "FLIGHT_RECORDER_SIGNAL"
 #define PAGE_GUARD_COPY_ON_MAP_LOWER        "page_guard_copy_on_map"
 #define PAGE_GUARD_COPY_ON_MAP_UPPER        "PAGE_GUARD_COPY_ON_MAP"
 #define PAGE_GUARD_LAZY_COPY_LOWER          "page_guard_lazy_copy"
 #define PAGE_GUARD_LAZY_COPY_UPPER          "PAGE_GUARD_LAZY_COPY"
+#define PAGE_GUARD_PREFETCH_LOWER           "page_guard_prefetch"
+#define PAGE_GUARD_PREFETCH_UPPER           "PAGE_GUARD_PREFETCH"
 #define PAGE_GUARD_SEPARATE_READ_LOWER      "page_guard_separate_read"
 #define PAGE_GUARD_SEPARATE_READ_UPPER      "PAGE_GUARD_SEPARATE_READ"
 #define PAGE_GUARD_EXTERNAL_MEMORY_LOWER    "page_guard_external_memory"
 #define PAGE_GUARD_EXTERNAL_MEMORY_UPPER    "PAGE_GUARD_EXTERNAL_MEMORY"
+#define PAGE_GUARD_USERFAULTFD_LOWER        "page_guard_userfaultfd"
+#define PAGE_GUARD_USERFAULTFD_UPPER        "PAGE_GUARD_USERFAULTFD"
+#define PAGE_GUARD_HUGE_PAGES_LOWER         "page_guard_huge_pages"
+#define PAGE_GUARD_HUGE_PAGES_UPPER         "PAGE_GUARD_HUGE_PAGES"
+#define PAGE_GUARD_DIFF_GRANULARITY_LOWER   "page_guard_diff_granularity"
+#define PAGE_GUARD_DIFF_GRANULARITY_UPPER   "PAGE_GUARD_DIFF_GRANULARITY"
+#define PAGE_GUARD_THREADS_LOWER            "page_guard_threads"
+#define PAGE_GUARD_THREADS_UPPER            "PAGE_GUARD_THREADS"
+#define UNASSISTED_DIFF_GRANULARITY_LOWER   "unassisted_diff_granularity"
+#define UNASSISTED_DIFF_GRANULARITY_UPPER   "UNASSISTED_DIFF_GRANULARITY"
 // clang-format on
 
 #if defined(__ANDROID__)
@@ -83,7 +119,15 @@ const char CaptureSettings::kDefaultCaptureFileName[] = "/sdcard/gfxrecon_captur
 // Android Properties
 #define GFXRECON_ENV_VAR_PREFIX "debug.gfxrecon."
 const char kCaptureCompressionTypeEnvVar[]   = GFXRECON_ENV_VAR_PREFIX CAPTURE_COMPRESSION_TYPE_LOWER;
+const char kCompressionChunkSizeEnvVar[]     = GFXRECON_ENV_VAR_PREFIX COMPRESSION_CHUNK_SIZE_LOWER;
+const char kCompressionDictionaryEnvVar[]    = GFXRECON_ENV_VAR_PREFIX COMPRESSION_DICTIONARY_LOWER;
+const char kCompressionAdaptiveEnvVar[]      = GFXRECON_ENV_VAR_PREFIX COMPRESSION_ADAPTIVE_LOWER;
+const char kCompressionMinBlockSizeEnvVar[]  = GFXRECON_ENV_VAR_PREFIX COMPRESSION_MIN_BLOCK_SIZE_LOWER;
 const char kCaptureFileFlushEnvVar[]         = GFXRECON_ENV_VAR_PREFIX CAPTURE_FILE_FLUSH_LOWER;
+const char kCaptureFileAsyncWriteEnvVar[]    = GFXRECON_ENV_VAR_PREFIX CAPTURE_FILE_ASYNC_WRITE_LOWER;
+const char kCaptureFileBatchSizeEnvVar[]     = GFXRECON_ENV_VAR_PREFIX CAPTURE_FILE_BATCH_SIZE_LOWER;
+const char kCaptureFileThreadStreamsEnvVar[] = GFXRECON_ENV_VAR_PREFIX CAPTURE_FILE_THREAD_STREAMS_LOWER;
+const char kCaptureFileOutputModeEnvVar[]    = GFXRECON_ENV_VAR_PREFIX CAPTURE_FILE_OUTPUT_MODE_LOWER;
 const char kCaptureFileNameEnvVar[]          = GFXRECON_ENV_VAR_PREFIX CAPTURE_FILE_NAME_LOWER;
 const char kCaptureFileUseTimestampEnvVar[]  = GFXRECON_ENV_VAR_PREFIX CAPTURE_FILE_USE_TIMESTAMP_LOWER;
 const char kLogAllowIndentsEnvVar[]          = GFXRECON_ENV_VAR_PREFIX LOG_ALLOW_INDENTS_LOWER;
@@ -99,10 +143,20 @@ const char kLogOutputToConsoleEnvVar[]       = GFXRECON_ENV_VAR_PREFIX LOG_OUTPU
 const char kLogOutputToOsDebugStringEnvVar[] = GFXRECON_ENV_VAR_PREFIX LOG_OUTPUT_TO_OS_DEBUG_STRING_LOWER;
 const char kMemoryTrackingModeEnvVar[]       = GFXRECON_ENV_VAR_PREFIX MEMORY_TRACKING_MODE_LOWER;
 const char kCaptureFramesEnvVar[]            = GFXRECON_ENV_VAR_PREFIX CAPTURE_FRAMES_LOWER;
+const char kCaptureFramesIncrementalEnvVar[] = GFXRECON_ENV_VAR_PREFIX CAPTURE_FRAMES_INCREMENTAL_LOWER;
+const char kCaptureFramesThreadsEnvVar[]     = GFXRECON_ENV_VAR_PREFIX CAPTURE_FRAMES_THREADS_LOWER;
+const char kFlightRecorderSizeEnvVar[]       = GFXRECON_ENV_VAR_PREFIX FLIGHT_RECORDER_SIZE_LOWER;
+const char kFlightRecorderSignalEnvVar[]     = GFXRECON_ENV_VAR_PREFIX FLIGHT_RECORDER_SIGNAL_LOWER;
 const char kPageGuardCopyOnMapEnvVar[]       = GFXRECON_ENV_VAR_PREFIX PAGE_GUARD_COPY_ON_MAP_LOWER;
 const char kPageGuardLazyCopyEnvVar[]        = GFXRECON_ENV_VAR_PREFIX PAGE_GUARD_LAZY_COPY_LOWER;
+const char kPageGuardPrefetchEnvVar[]        = GFXRECON_ENV_VAR_PREFIX PAGE_GUARD_PREFETCH_LOWER;
 const char kPageGuardSeparateReadEnvVar[]    = GFXRECON_ENV_VAR_PREFIX PAGE_GUARD_SEPARATE_READ_LOWER;
 const char kPageGuardExternalMemoryEnvVar[]  = GFXRECON_ENV_VAR_PREFIX PAGE_GUARD_EXTERNAL_MEMORY_LOWER;
+const char kPageGuardUserfaultfdEnvVar[]     = GFXRECON_ENV_VAR_PREFIX PAGE_GUARD_USERFAULTFD_LOWER;
+const char kPageGuardHugePagesEnvVar[]       = GFXRECON_ENV_VAR_PREFIX PAGE_GUARD_HUGE_PAGES_LOWER;
+const char kPageGuardDiffGranularityEnvVar[] = GFXRECON_ENV_VAR_PREFIX PAGE_GUARD_DIFF_GRANULARITY_LOWER;
+const char kPageGuardThreadsEnvVar[]         = GFXRECON_ENV_VAR_PREFIX PAGE_GUARD_THREADS_LOWER;
+const char kUnassistedGranularityEnvVar[]    = GFXRECON_ENV_VAR_PREFIX UNASSISTED_DIFF_GRANULARITY_LOWER;
 
 #else
 const char CaptureSettings::kDefaultCaptureFileName[] = "gfxrecon_capture" GFXRECON_FILE_EXTENSION;
@@ -110,7 +164,15 @@ const char CaptureSettings::kDefaultCaptureFileName[] = "gfxrecon_capture" GFXRE
 // Desktop environment settings
 #define GFXRECON_ENV_VAR_PREFIX "GFXRECON_"
 const char kCaptureCompressionTypeEnvVar[]            = GFXRECON_ENV_VAR_PREFIX CAPTURE_COMPRESSION_TYPE_UPPER;
+const char kCompressionChunkSizeEnvVar[]              = GFXRECON_ENV_VAR_PREFIX COMPRESSION_CHUNK_SIZE_UPPER;
+const char kCompressionDictionaryEnvVar[]             = GFXRECON_ENV_VAR_PREFIX COMPRESSION_DICTIONARY_UPPER;
+const char kCompressionAdaptiveEnvVar[]               = GFXRECON_ENV_VAR_PREFIX COMPRESSION_ADAPTIVE_UPPER;
+const char kCompressionMinBlockSizeEnvVar[]           = GFXRECON_ENV_VAR_PREFIX COMPRESSION_MIN_BLOCK_SIZE_UPPER;
 const char kCaptureFileFlushEnvVar[]                  = GFXRECON_ENV_VAR_PREFIX CAPTURE_FILE_FLUSH_UPPER;
+const char kCaptureFileAsyncWriteEnvVar[]             = GFXRECON_ENV_VAR_PREFIX CAPTURE_FILE_ASYNC_WRITE_UPPER;
+const char kCaptureFileBatchSizeEnvVar[]              = GFXRECON_ENV_VAR_PREFIX CAPTURE_FILE_BATCH_SIZE_UPPER;
+const char kCaptureFileThreadStreamsEnvVar[]          = GFXRECON_ENV_VAR_PREFIX CAPTURE_FILE_THREAD_STREAMS_UPPER;
+const char kCaptureFileOutputModeEnvVar[]             = GFXRECON_ENV_VAR_PREFIX CAPTURE_FILE_OUTPUT_MODE_UPPER;
 const char kCaptureFileNameEnvVar[]                   = GFXRECON_ENV_VAR_PREFIX CAPTURE_FILE_NAME_UPPER;
 const char kCaptureFileUseTimestampEnvVar[]           = GFXRECON_ENV_VAR_PREFIX CAPTURE_FILE_USE_TIMESTAMP_UPPER;
 const char kLogAllowIndentsEnvVar[]                   = GFXRECON_ENV_VAR_PREFIX LOG_ALLOW_INDENTS_UPPER;
@@ -126,10 +188,20 @@ const char kLogOutputToConsoleEnvVar[]                = GFXRECON_ENV_VAR_PREFIX
 const char kLogOutputToOsDebugStringEnvVar[]          = GFXRECON_ENV_VAR_PREFIX LOG_OUTPUT_TO_OS_DEBUG_STRING_UPPER;
 const char kMemoryTrackingModeEnvVar[]                = GFXRECON_ENV_VAR_PREFIX MEMORY_TRACKING_MODE_UPPER;
 const char kCaptureFramesEnvVar[]                     = GFXRECON_ENV_VAR_PREFIX CAPTURE_FRAMES_UPPER;
+const char kCaptureFramesIncrementalEnvVar[]          = GFXRECON_ENV_VAR_PREFIX CAPTURE_FRAMES_INCREMENTAL_UPPER;
+const char kCaptureFramesThreadsEnvVar[]              = GFXRECON_ENV_VAR_PREFIX CAPTURE_FRAMES_THREADS_UPPER;
+const char kFlightRecorderSizeEnvVar[]                = GFXRECON_ENV_VAR_PREFIX FLIGHT_RECORDER_SIZE_UPPER;
+const char kFlightRecorderSignalEnvVar[]              = GFXRECON_ENV_VAR_PREFIX FLIGHT_RECORDER_SIGNAL_UPPER;
 const char kPageGuardCopyOnMapEnvVar[]                = GFXRECON_ENV_VAR_PREFIX PAGE_GUARD_COPY_ON_MAP_UPPER;
 const char kPageGuardLazyCopyEnvVar[]                 = GFXRECON_ENV_VAR_PREFIX PAGE_GUARD_LAZY_COPY_UPPER;
+const char kPageGuardPrefetchEnvVar[]                 = GFXRECON_ENV_VAR_PREFIX PAGE_GUARD_PREFETCH_UPPER;
 const char kPageGuardSeparateReadEnvVar[]             = GFXRECON_ENV_VAR_PREFIX PAGE_GUARD_SEPARATE_READ_UPPER;
 const char kPageGuardExternalMemoryEnvVar[]           = GFXRECON_ENV_VAR_PREFIX PAGE_GUARD_EXTERNAL_MEMORY_UPPER;
+const char kPageGuardUserfaultfdEnvVar[]              = GFXRECON_ENV_VAR_PREFIX PAGE_GUARD_USERFAULTFD_UPPER;
+const char kPageGuardHugePagesEnvVar[]                = GFXRECON_ENV_VAR_PREFIX PAGE_GUARD_HUGE_PAGES_UPPER;
+const char kPageGuardDiffGranularityEnvVar[]          = GFXRECON_ENV_VAR_PREFIX PAGE_GUARD_DIFF_GRANULARITY_UPPER;
+const char kPageGuardThreadsEnvVar[]                  = GFXRECON_ENV_VAR_PREFIX PAGE_GUARD_THREADS_UPPER;
+const char kUnassistedGranularityEnvVar[]             = GFXRECON_ENV_VAR_PREFIX UNASSISTED_DIFF_GRANULARITY_UPPER;
 #endif
 
 // Capture options for settings file.
@@ -137,9 +209,17 @@ const char kPageGuardExternalMemoryEnvVar[]           = GFXRECON_ENV_VAR_PREFIX
 const char kSettingsFilter[] = "lunarg_gfxrecon.";
 
 const std::string kOptionKeyCaptureCompressionType   = std::string(kSettingsFilter) + std::string(CAPTURE_COMPRESSION_TYPE_LOWER);
+const std::string kOptionKeyCompressionChunkSize     = std::string(kSettingsFilter) + std::string(COMPRESSION_CHUNK_SIZE_LOWER);
+const std::string kOptionKeyCompressionDictionary    = std::string(kSettingsFilter) + std::string(COMPRESSION_DICTIONARY_LOWER);
+const std::string kOptionKeyCompressionAdaptive      = std::string(kSettingsFilter) + std::string(COMPRESSION_ADAPTIVE_LOWER);
+const std::string kOptionKeyCompressionMinBlockSize  = std::string(kSettingsFilter) + std::string(COMPRESSION_MIN_BLOCK_SIZE_LOWER);
 const std::string kOptionKeyCaptureFile              = std::string(kSettingsFilter) + std::string(CAPTURE_FILE_NAME_LOWER);
 const std::string kOptionKeyCaptureFileForceFlush    = std::string(kSettingsFilter) + std::string(CAPTURE_FILE_FLUSH_LOWER);
 const std::string kOptionKeyCaptureFileUseTimestamp  = std::string(kSettingsFilter) + std::string(CAPTURE_FILE_USE_TIMESTAMP_LOWER);
+const std::string kOptionKeyCaptureFileAsyncWrite    = std::string(kSettingsFilter) + std::string(CAPTURE_FILE_ASYNC_WRITE_LOWER);
+const std::string kOptionKeyCaptureFileBatchSize     = std::string(kSettingsFilter) + std::string(CAPTURE_FILE_BATCH_SIZE_LOWER);
+const std::string kOptionKeyCaptureFileThreadStreams = std::string(kSettingsFilter) + std::string(CAPTURE_FILE_THREAD_STREAMS_LOWER);
+const std::string kOptionKeyCaptureFileOutputMode    = std::string(kSettingsFilter) + std::string(CAPTURE_FILE_OUTPUT_MODE_LOWER);
 const std::string kOptionKeyLogAllowIndents          = std::string(kSettingsFilter) + std::string(LOG_ALLOW_INDENTS_LOWER);
 const std::string kOptionKeyLogBreakOnError          = std::string(kSettingsFilter) + std::string(LOG_BREAK_ON_ERROR_LOWER);
 const std::string kOptionKeyLogDetailed              = std::string(kSettingsFilter) + std::string(LOG_DETAILED_LOWER);
@@ -153,10 +233,20 @@ const std::string kOptionKeyLogOutputToConsole       = std::string(kSettingsFilt
 const std::string kOptionKeyLogOutputToOsDebugString = std::string(kSettingsFilter) + std::string(LOG_OUTPUT_TO_OS_DEBUG_STRING_LOWER);
 const std::string kOptionKeyMemoryTrackingMode       = std::string(kSettingsFilter) + std::string(MEMORY_TRACKING_MODE_LOWER);
 const std::string kOptionKeyCaptureFrames            = std::string(kSettingsFilter) + std::string(CAPTURE_FRAMES_LOWER);
+const std::string kOptionKeyCaptureFramesIncremental = std::string(kSettingsFilter) + std::string(CAPTURE_FRAMES_INCREMENTAL_LOWER);
+const std::string kOptionKeyCaptureFramesThreads     = std::string(kSettingsFilter) + std::string(CAPTURE_FRAMES_THREADS_LOWER);
+const std::string kOptionKeyFlightRecorderSize       = std::string(kSettingsFilter) + std::string(FLIGHT_RECORDER_SIZE_LOWER);
+const std::string kOptionKeyFlightRecorderSignal     = std::string(kSettingsFilter) + std::string(FLIGHT_RECORDER_SIGNAL_LOWER);
 const std::string kOptionKeyPageGuardCopyOnMap       = std::string(kSettingsFilter) + std::string(PAGE_GUARD_COPY_ON_MAP_LOWER);
 const std::string kOptionKeyPageGuardLazyCopy        = std::string(kSettingsFilter) + std::string(PAGE_GUARD_LAZY_COPY_LOWER);
+const std::string kOptionKeyPageGuardPrefetch        = std::string(kSettingsFilter) + std::string(PAGE_GUARD_PREFETCH_LOWER);
 const std::string kOptionKeyPageGuardSeparateRead    = std::string(kSettingsFilter) + std::string(PAGE_GUARD_SEPARATE_READ_LOWER);
 const std::string kOptionKeyPageGuardExternalMemory  = std::string(kSettingsFilter) + std::string(PAGE_GUARD_EXTERNAL_MEMORY_LOWER);
+const std::string kOptionKeyPageGuardUserfaultfd     = std::string(kSettingsFilter) + std::string(PAGE_GUARD_USERFAULTFD_LOWER);
+const std::string kOptionKeyPageGuardHugePages       = std::string(kSettingsFilter) + std::string(PAGE_GUARD_HUGE_PAGES_LOWER);
+const std::string kOptionKeyPageGuardDiffGranularity = std::string(kSettingsFilter) + std::string(PAGE_GUARD_DIFF_GRANULARITY_LOWER);
+const std::string kOptionKeyPageGuardThreads         = std::string(kSettingsFilter) + std::string(PAGE_GUARD_THREADS_LOWER);
+const std::string kOptionKeyUnassistedGranularity    = std::string(kSettingsFilter) + std::string(UNASSISTED_DIFF_GRANULARITY_LOWER);
 // clang-format on
 
 #if defined(ENABLE_LZ4_COMPRESSION)
@@ -215,7 +305,15 @@ void CaptureSettings::LoadOptionsEnvVar(OptionsMap* options)
     LoadSingleOptionEnvVar(options, kCaptureFileNameEnvVar, kOptionKeyCaptureFile);
     LoadSingleOptionEnvVar(options, kCaptureFileUseTimestampEnvVar, kOptionKeyCaptureFileUseTimestamp);
     LoadSingleOptionEnvVar(options, kCaptureCompressionTypeEnvVar, kOptionKeyCaptureCompressionType);
+    LoadSingleOptionEnvVar(options, kCompressionChunkSizeEnvVar, kOptionKeyCompressionChunkSize);
+    LoadSingleOptionEnvVar(options, kCompressionDictionaryEnvVar, kOptionKeyCompressionDictionary);
+    LoadSingleOptionEnvVar(options, kCompressionAdaptiveEnvVar, kOptionKeyCompressionAdaptive);
+    LoadSingleOptionEnvVar(options, kCompressionMinBlockSizeEnvVar, kOptionKeyCompressionMinBlockSize);
     LoadSingleOptionEnvVar(options, kCaptureFileFlushEnvVar, kOptionKeyCaptureFileForceFlush);
+    LoadSingleOptionEnvVar(options, kCaptureFileAsyncWriteEnvVar, kOptionKeyCaptureFileAsyncWrite);
+    LoadSingleOptionEnvVar(options, kCaptureFileBatchSizeEnvVar, kOptionKeyCaptureFileBatchSize);
+    LoadSingleOptionEnvVar(options, kCaptureFileThreadStreamsEnvVar, kOptionKeyCaptureFileThreadStreams);
+    LoadSingleOptionEnvVar(options, kCaptureFileOutputModeEnvVar, kOptionKeyCaptureFileOutputMode);
 
     // Logging environment variables
     LoadSingleOptionEnvVar(options, kLogAllowIndentsEnvVar, kOptionKeyLogAllowIndents);
@@ -235,12 +333,24 @@ void CaptureSettings::LoadOptionsEnvVar(OptionsMap* options)
 
     // Trimming environment variables
     LoadSingleOptionEnvVar(options, kCaptureFramesEnvVar, kOptionKeyCaptureFrames);
+    LoadSingleOptionEnvVar(options, kCaptureFramesIncrementalEnvVar, kOptionKeyCaptureFramesIncremental);
+    LoadSingleOptionEnvVar(options, kCaptureFramesThreadsEnvVar, kOptionKeyCaptureFramesThreads);
+
+    // Flight recorder environment variables
+    LoadSingleOptionEnvVar(options, kFlightRecorderSizeEnvVar, kOptionKeyFlightRecorderSize);
+    LoadSingleOptionEnvVar(options, kFlightRecorderSignalEnvVar, kOptionKeyFlightRecorderSignal);
 
     // Page guard environment variables
     LoadSingleOptionEnvVar(options, kPageGuardCopyOnMapEnvVar, kOptionKeyPageGuardCopyOnMap);
     LoadSingleOptionEnvVar(options, kPageGuardLazyCopyEnvVar, kOptionKeyPageGuardLazyCopy);
+    LoadSingleOptionEnvVar(options, kPageGuardPrefetchEnvVar, kOptionKeyPageGuardPrefetch);
     LoadSingleOptionEnvVar(options, kPageGuardSeparateReadEnvVar, kOptionKeyPageGuardSeparateRead);
     LoadSingleOptionEnvVar(options, kPageGuardExternalMemoryEnvVar, kOptionKeyPageGuardExternalMemory);
+    LoadSingleOptionEnvVar(options, kPageGuardUserfaultfdEnvVar, kOptionKeyPageGuardUserfaultfd);
+    LoadSingleOptionEnvVar(options, kPageGuardHugePagesEnvVar, kOptionKeyPageGuardHugePages);
+    LoadSingleOptionEnvVar(options, kPageGuardDiffGranularityEnvVar, kOptionKeyPageGuardDiffGranularity);
+    LoadSingleOptionEnvVar(options, kPageGuardThreadsEnvVar, kOptionKeyPageGuardThreads);
+    LoadSingleOptionEnvVar(options, kUnassistedGranularityEnvVar, kOptionKeyUnassistedGranularity);
 }
 
 void CaptureSettings::LoadOptionsFile(OptionsMap* options)
@@ -273,12 +383,28 @@ void CaptureSettings::ProcessOptions(OptionsMap* options, CaptureSettings* setti
     // Capture file options
     settings->trace_settings_.capture_file_options.compression_type =
         ParseCompressionTypeString(FindOption(options, kOptionKeyCaptureCompressionType), kDefaultCompressionType);
+    settings->trace_settings_.compression_chunk_size = ParseUnsignedIntegerString(
+        FindOption(options, kOptionKeyCompressionChunkSize), settings->trace_settings_.compression_chunk_size);
+    settings->trace_settings_.compression_dictionary =
+        FindOption(options, kOptionKeyCompressionDictionary, settings->trace_settings_.compression_dictionary);
+    settings->trace_settings_.compression_adaptive = ParseBoolString(
+        FindOption(options, kOptionKeyCompressionAdaptive), settings->trace_settings_.compression_adaptive);
+    settings->trace_settings_.compression_min_block_size = ParseUnsignedIntegerString(
+        FindOption(options, kOptionKeyCompressionMinBlockSize), settings->trace_settings_.compression_min_block_size);
     settings->trace_settings_.capture_file =
         FindOption(options, kOptionKeyCaptureFile, settings->trace_settings_.capture_file);
     settings->trace_settings_.time_stamp_file = ParseBoolString(FindOption(options, kOptionKeyCaptureFileUseTimestamp),
                                                                 settings->trace_settings_.time_stamp_file);
     settings->trace_settings_.force_flush =
         ParseBoolString(FindOption(options, kOptionKeyCaptureFileForceFlush), settings->trace_settings_.force_flush);
+    settings->trace_settings_.async_write =
+        ParseBoolString(FindOption(options, kOptionKeyCaptureFileAsyncWrite), settings->trace_settings_.async_write);
+    settings->trace_settings_.batch_size = ParseUnsignedIntegerString(
+        FindOption(options, kOptionKeyCaptureFileBatchSize), settings->trace_settings_.batch_size);
+    settings->trace_settings_.thread_streams = ParseBoolString(FindOption(options, kOptionKeyCaptureFileThreadStreams),
+                                                               settings->trace_settings_.thread_streams);
+    settings->trace_settings_.file_output_mode = ParseFileOutputModeString(
+        FindOption(options, kOptionKeyCaptureFileOutputMode), settings->trace_settings_.file_output_mode);
 
     // Memory tracking options
     settings->trace_settings_.memory_tracking_mode = ParseMemoryTrackingModeString(
@@ -286,16 +412,38 @@ void CaptureSettings::ProcessOptions(OptionsMap* options, CaptureSettings* setti
 
     // Trimming options
     ParseTrimRangeString(FindOption(options, kOptionKeyCaptureFrames), &settings->trace_settings_.trim_ranges);
+    settings->trace_settings_.trim_incremental = ParseBoolString(
+        FindOption(options, kOptionKeyCaptureFramesIncremental), settings->trace_settings_.trim_incremental);
+    settings->trace_settings_.trim_threads = ParseUnsignedIntegerString(
+        FindOption(options, kOptionKeyCaptureFramesThreads), settings->trace_settings_.trim_threads);
+
+    // Flight recorder options
+    settings->trace_settings_.flight_recorder_size = ParseUnsignedIntegerString(
+        FindOption(options, kOptionKeyFlightRecorderSize), settings->trace_settings_.flight_recorder_size);
+    settings->trace_settings_.flight_recorder_signal = ParseBoolString(
+        FindOption(options, kOptionKeyFlightRecorderSignal), settings->trace_settings_.flight_recorder_signal);
 
     // Page guard environment variables
     settings->trace_settings_.page_guard_copy_on_map = ParseBoolString(
         FindOption(options, kOptionKeyPageGuardCopyOnMap), settings->trace_settings_.page_guard_copy_on_map);
     settings->trace_settings_.page_guard_lazy_copy = ParseBoolString(FindOption(options, kOptionKeyPageGuardLazyCopy),
                                                                      settings->trace_settings_.page_guard_lazy_copy);
+    settings->trace_settings_.page_guard_prefetch = ParseBoolString(FindOption(options, kOptionKeyPageGuardPrefetch),
+                                                                    settings->trace_settings_.page_guard_prefetch);
     settings->trace_settings_.page_guard_separate_read = ParseBoolString(
         FindOption(options, kOptionKeyPageGuardSeparateRead), settings->trace_settings_.page_guard_separate_read);
     settings->trace_settings_.page_guard_external_memory = ParseBoolString(
         FindOption(options, kOptionKeyPageGuardExternalMemory), settings->trace_settings_.page_guard_external_memory);
+    settings->trace_settings_.page_guard_userfaultfd = ParseBoolString(
+        FindOption(options, kOptionKeyPageGuardUserfaultfd), settings->trace_settings_.page_guard_userfaultfd);
+    settings->trace_settings_.page_guard_huge_pages = ParseBoolString(
+        FindOption(options, kOptionKeyPageGuardHugePages), settings->trace_settings_.page_guard_huge_pages);
+    settings->trace_settings_.page_guard_diff_granularity = ParseUnsignedIntegerString(
+        FindOption(options, kOptionKeyPageGuardDiffGranularity), settings->trace_settings_.page_guard_diff_granularity);
+    settings->trace_settings_.page_guard_threads = ParseUnsignedIntegerString(
+        FindOption(options, kOptionKeyPageGuardThreads), settings->trace_settings_.page_guard_threads);
+    settings->trace_settings_.unassisted_diff_granularity = ParseUnsignedIntegerString(
+        FindOption(options, kOptionKeyUnassistedGranularity), settings->trace_settings_.unassisted_diff_granularity);
 
     // Log options
     settings->log_settings_.use_indent =
@@ -366,6 +514,28 @@ bool CaptureSettings::ParseBoolString(const std::string& value_string, bool defa
     return result;
 }
 
+size_t CaptureSettings::ParseUnsignedIntegerString(const std::string& value_string, size_t default_value)
+{
+    size_t result = default_value;
+
+    if (!value_string.empty())
+    {
+        // Check that the value string only contains numbers.
+        size_t count = std::count_if(value_string.begin(), value_string.end(), ::isdigit);
+        if (count == value_string.length())
+        {
+            result = static_cast<size_t>(std::stoull(value_string));
+        }
+        else
+        {
+            GFXRECON_LOG_WARNING("Settings Loader: Ignoring invalid unsigned integer option value \"%s\"",
+                                 value_string.c_str());
+        }
+    }
+
+    return result;
+}
+
 CaptureSettings::MemoryTrackingMode
 CaptureSettings::ParseMemoryTrackingModeString(const std::string&                  value_string,
                                                CaptureSettings::MemoryTrackingMode default_value)
@@ -384,6 +554,10 @@ CaptureSettings::ParseMemoryTrackingModeString(const std::string&
     {
         result = MemoryTrackingMode::kUnassisted;
     }
+    else if (util::platform::StringCompareNoCase("soft_dirty", value_string.c_str()) == 0)
+    {
+        result = MemoryTrackingMode::kSoftDirty;
+    }
     else
     {
         if (!value_string.empty())
@@ -396,6 +570,35 @@ CaptureSettings::ParseMemoryTrackingModeString(const std::string&
     return result;
 }
 
+CaptureSettings::FileOutputMode CaptureSettings::ParseFileOutputModeString(const std::string& value_string,
+                                                                          FileOutputMode     default_value)
+{
+    CaptureSettings::FileOutputMode result = default_value;
+
+    if (util::platform::StringCompareNoCase("stdio", value_string.c_str()) == 0)
+    {
+        result = FileOutputMode::kStdio;
+    }
+    else if (util::platform::StringCompareNoCase("aligned", value_string.c_str()) == 0)
+    {
+        result = FileOutputMode::kAligned;
+    }
+    else if (util::platform::StringCompareNoCase("direct", value_string.c_str()) == 0)
+    {
+        result = FileOutputMode::kDirect;
+    }
+    else
+    {
+        if (!value_string.empty())
+        {
+            GFXRECON_LOG_WARNING("Settings Loader: Ignoring unrecognized file output mode option value \"%s\"",
+                                 value_string.c_str());
+        }
+    }
+
+    return result;
+}
+
 format::CompressionType CaptureSettings::ParseCompressionTypeString(const std::string&      value_string,
                                                                     format::CompressionType default_value)
 {
@@ -413,6 +616,10 @@ format::CompressionType CaptureSettings::ParseCompressionTypeString(const std::s
     {
         result = format::CompressionType::kZlib;
     }
+    else if (util::platform::StringCompareNoCase("zstd", value_string.c_str()) == 0)
+    {
+        result = format::CompressionType::kZstd;
+    }
     else
     {
         if (!value_string.empty())
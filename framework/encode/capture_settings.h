@@ -45,7 +45,24 @@ class CaptureSettings
         // Use guard pages to determine which regions of memory to write on unmap and queue submit.  This mode replaces
         // the mapped memory value returned by the driver with a shadow allocation that the capture layer can monitor
         // to determine which regions of memory have been modified by the application.
-        kPageGuard = 2
+        kPageGuard = 2,
+        // Use the kernel's page table dirty tracking to determine which regions of memory to write on unmap and queue
+        // submit.  Like kPageGuard, this mode replaces the mapped memory value returned by the driver with a shadow
+        // allocation, but finds modified pages with PAGEMAP_SCAN, which reads and clears the written state of each
+        // page atomically, instead of guard page faults.  Only available on Linux and Android with kernel version 6.7
+        // or later.
+        kSoftDirty = 3
+    };
+
+    enum FileOutputMode : uint32_t
+    {
+        // Write the capture file with the C runtime's buffered file I/O.
+        kStdio = 0,
+        // Write the capture file with large, aligned writes that bypass the C runtime's buffering.
+        kAligned = 1,
+        // Write the capture file with aligned direct I/O writes that bypass both the C runtime's buffering and the
+        // operating system's page cache.
+        kDirect = 2
     };
 
     struct TrimRange
@@ -58,12 +75,25 @@ class CaptureSettings
     {
         std::string            capture_file{ kDefaultCaptureFileName };
         format::EnabledOptions capture_file_options;
+        size_t                 compression_chunk_size{ 0 };
+        std::string            compression_dictionary;
+        bool                   compression_adaptive{ false };
+        size_t                 compression_min_block_size{ 0 };
         bool                   time_stamp_file{ true };
         bool                   force_flush{ false };
+        bool                   async_write{ false };
+        size_t                 batch_size{ 0 };
+        bool                   thread_streams{ false };
+        FileOutputMode         file_output_mode{ kStdio };
         MemoryTrackingMode     memory_tracking_mode{ kPageGuard };
         std::vector<TrimRange> trim_ranges;
+        bool                   trim_incremental{ false };
+        size_t                 trim_threads{ 1 };
+        size_t                 flight_recorder_size{ 0 };
+        bool                   flight_recorder_signal{ false };
         bool                   page_guard_copy_on_map{ util::PageGuardManager::kDefaultEnableCopyOnMap };
         bool                   page_guard_lazy_copy{ util::PageGuardManager::kDefaultEnableLazyCopy };
+        bool                   page_guard_prefetch{ util::PageGuardManager::kDefaultEnablePrefetch };
         bool                   page_guard_separate_read{ util::PageGuardManager::kDefaultEnableSeparateRead };
 
         // An optimization for the page_guard memory tracking mode that eliminates the need for shadow memory by
@@ -71,6 +101,25 @@ class CaptureSettings
         // memory allocation that the capture layer can monitor to determine which regions of memory have been modified
         // by the application.
         bool page_guard_external_memory{ false };
+
+        // Use userfaultfd write-protect mode instead of memory protection and a SIGSEGV handler to track writes to
+        // shadow memory.  Only available on Linux and Android.
+        bool page_guard_userfaultfd{ util::PageGuardManager::kDefaultEnableUserfaultfd };
+
+        // Back shadow memory allocations that are at least the size of a transparent huge page with huge pages.  Only
+        // available on Linux and Android.
+        bool page_guard_huge_pages{ util::PageGuardManager::kDefaultEnableHugePages };
+
+        // Granularity, in bytes, at which the page_guard memory tracking mode compares modified shadow memory pages
+        // with the mapped memory, to only write the modified parts of each page.  A value of 0 writes entire pages.
+        size_t page_guard_diff_granularity{ 0 };
+        // Number of threads used by the page_guard memory tracking mode to process modified memory at queue submit.  A
+        // value of 0 uses one thread per hardware thread and a value of 1 processes memory on the submitting thread.
+        size_t page_guard_threads{ 1 };
+
+        // Granularity, in bytes, at which the unassisted memory tracking mode compares mapped memory with its content
+        // from the previous write, to only write modified ranges.  A value of 0 writes the entire mapped range.
+        size_t unassisted_diff_granularity{ 0 };
     };
 
   public:
@@ -101,9 +150,13 @@ class CaptureSettings
 
     static bool ParseBoolString(const std::string& value_string, bool default_value);
 
+    static size_t ParseUnsignedIntegerString(const std::string& value_string, size_t default_value);
+
     static MemoryTrackingMode ParseMemoryTrackingModeString(const std::string& value_string,
                                                             MemoryTrackingMode default_value);
 
+    static FileOutputMode ParseFileOutputModeString(const std::string& value_string, FileOutputMode default_value);
+
     static format::CompressionType ParseCompressionTypeString(const std::string&      value_string,
                                                               format::CompressionType default_value);
 
@@ -0,0 +1,262 @@
+/*
+** Copyright (c) 2019 LunarG, Inc.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+#include "encode/compression_policy.h"
+
+#include "util/logging.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <utility>
+#include <vector>
+
+GFXRECON_BEGIN_NAMESPACE(gfxrecon)
+GFXRECON_BEGIN_NAMESPACE(encode)
+
+// Data smaller than the minimum size is always compressed, as the cost of compressing it is small.
+const size_t   kMinTrackedSize   = 1024;
+const uint32_t kMinSampleCount   = 4;
+const float    kBypassRatio      = 0.95f; // Compressed to uncompressed size ratio with no meaningful benefit.
+const float    kRatioWeight      = 0.25f; // Weight of the newest sample in the running ratio.
+const uint32_t kMinSkipInterval  = 8;
+const uint32_t kMaxSkipInterval  = 256;
+const size_t   kMaxLoggedSources = 8;
+
+std::atomic<uint64_t> CompressionPolicy::policy_id_counter_{ 0 };
+
+CompressionPolicy::CompressionPolicy() : enabled_(false), policy_id_(++policy_id_counter_) {}
+
+bool CompressionPolicy::ShouldCompress(uint64_t key, size_t data_size)
+{
+    if (!enabled_ || (data_size < kMinTrackedSize))
+    {
+        return true;
+    }
+
+    ThreadSources*              thread_sources = GetThreadSources();
+    std::lock_guard<std::mutex> lock(thread_sources->lock);
+
+    SourceInfo& info = thread_sources->sources[key];
+
+    if (info.skip_count > 0)
+    {
+        --info.skip_count;
+        ++info.bypassed_count;
+        info.bypassed_bytes += data_size;
+
+        ++thread_sources->bypassed_count;
+        thread_sources->bypassed_bytes += data_size;
+
+        return false;
+    }
+
+    return true;
+}
+
+void CompressionPolicy::RecordResult(uint64_t key, size_t uncompressed_size, size_t compressed_size)
+{
+    if (!enabled_ || (uncompressed_size < kMinTrackedSize))
+    {
+        return;
+    }
+
+    // Failed compression is treated as no reduction in size.
+    float sample_ratio = 1.0f;
+    if ((compressed_size > 0) && (compressed_size < uncompressed_size))
+    {
+        sample_ratio = static_cast<float>(compressed_size) / static_cast<float>(uncompressed_size);
+    }
+
+    ThreadSources*              thread_sources = GetThreadSources();
+    std::lock_guard<std::mutex> lock(thread_sources->lock);
+
+    SourceInfo& info = thread_sources->sources[key];
+
+    ++thread_sources->compressed_count;
+    thread_sources->compressed_input_bytes += uncompressed_size;
+    thread_sources->compressed_output_bytes +=
+        (compressed_size > 0) ? std::min(compressed_size, uncompressed_size) : uncompressed_size;
+
+    if (info.skip_interval > 0)
+    {
+        // This is a retry for a source that was bypassed.  The interval is increased if the data is still
+        // incompressible, and the source returns to normal tracking otherwise.
+        if (sample_ratio >= kBypassRatio)
+        {
+            info.skip_interval = std::min(info.skip_interval * 2, kMaxSkipInterval);
+            info.skip_count    = info.skip_interval;
+            return;
+        }
+
+        info.ratio         = sample_ratio;
+        info.sample_count  = 1;
+        info.skip_interval = 0;
+        return;
+    }
+
+    if (info.sample_count == 0)
+    {
+        info.ratio = sample_ratio;
+    }
+    else
+    {
+        info.ratio = ((1.0f - kRatioWeight) * info.ratio) + (kRatioWeight * sample_ratio);
+    }
+
+    ++info.sample_count;
+
+    if ((info.sample_count >= kMinSampleCount) && (info.ratio >= kBypassRatio))
+    {
+        info.skip_interval = kMinSkipInterval;
+        info.skip_count    = kMinSkipInterval;
+    }
+}
+
+void CompressionPolicy::RemoveSource(uint64_t key)
+{
+    if (enabled_)
+    {
+        std::lock_guard<std::mutex> lock(thread_sources_lock_);
+        for (const auto& thread_sources : thread_sources_)
+        {
+            std::lock_guard<std::mutex> sources_lock(thread_sources->lock);
+            thread_sources->sources.erase(key);
+        }
+    }
+}
+
+void CompressionPolicy::LogStatistics(const char* source_description)
+{
+    if (!enabled_)
+    {
+        return;
+    }
+
+    uint64_t compressed_count        = 0;
+    uint64_t compressed_input_bytes  = 0;
+    uint64_t compressed_output_bytes = 0;
+    uint64_t bypassed_count          = 0;
+    uint64_t bypassed_bytes          = 0;
+
+    // Combine the bypassed data for sources that were compressed by more than one thread, reporting the compression
+    // ratio from the thread that bypassed the most data for the source.
+    std::unordered_map<uint64_t, SourceInfo> bypassed_sources;
+
+    {
+        std::lock_guard<std::mutex> lock(thread_sources_lock_);
+
+        for (const auto& thread_sources : thread_sources_)
+        {
+            std::lock_guard<std::mutex> sources_lock(thread_sources->lock);
+
+            compressed_count += thread_sources->compressed_count;
+            compressed_input_bytes += thread_sources->compressed_input_bytes;
+            compressed_output_bytes += thread_sources->compressed_output_bytes;
+            bypassed_count += thread_sources->bypassed_count;
+            bypassed_bytes += thread_sources->bypassed_bytes;
+
+            thread_sources->compressed_count        = 0;
+            thread_sources->compressed_input_bytes  = 0;
+            thread_sources->compressed_output_bytes = 0;
+            thread_sources->bypassed_count          = 0;
+            thread_sources->bypassed_bytes          = 0;
+
+            for (auto& entry : thread_sources->sources)
+            {
+                SourceInfo& info = entry.second;
+
+                if (info.bypassed_count > 0)
+                {
+                    SourceInfo& combined = bypassed_sources[entry.first];
+
+                    if (info.bypassed_bytes > combined.bypassed_bytes)
+                    {
+                        combined.ratio = info.ratio;
+                    }
+
+                    combined.bypassed_count += info.bypassed_count;
+                    combined.bypassed_bytes += info.bypassed_bytes;
+
+                    info.bypassed_count = 0;
+                    info.bypassed_bytes = 0;
+                }
+            }
+        }
+    }
+
+    uint64_t total_bytes = compressed_input_bytes + bypassed_bytes;
+    if (total_bytes == 0)
+    {
+        return;
+    }
+
+    GFXRECON_LOG_INFO("Adaptive compression statistics for %s data:", source_description);
+    GFXRECON_LOG_INFO("  Compressed %" PRIu64 " blocks, reducing %" PRIu64 " bytes to %" PRIu64 " bytes",
+                      compressed_count,
+                      compressed_input_bytes,
+                      compressed_output_bytes);
+    GFXRECON_LOG_INFO("  Bypassed compression for %" PRIu64 " blocks, totaling %" PRIu64 " bytes (%.2f%% of data)",
+                      bypassed_count,
+                      bypassed_bytes,
+                      100.0 * static_cast<double>(bypassed_bytes) / static_cast<double>(total_bytes));
+
+    // Report the sources with the most bypassed data.
+    std::vector<std::pair<uint64_t, const SourceInfo*>> sorted_sources;
+    for (const auto& entry : bypassed_sources)
+    {
+        sorted_sources.emplace_back(entry.first, &entry.second);
+    }
+
+    std::sort(sorted_sources.begin(),
+              sorted_sources.end(),
+              [](const std::pair<uint64_t, const SourceInfo*>& lhs, const std::pair<uint64_t, const SourceInfo*>& rhs) {
+                  return lhs.second->bypassed_bytes > rhs.second->bypassed_bytes;
+              });
+
+    size_t count = std::min(sorted_sources.size(), kMaxLoggedSources);
+    for (size_t i = 0; i < count; ++i)
+    {
+        const SourceInfo* info = sorted_sources[i].second;
+        GFXRECON_LOG_INFO("  Source 0x%" PRIx64 ": bypassed %" PRIu64 " blocks, totaling %" PRIu64
+                          " bytes (compression ratio %.2f)",
+                          sorted_sources[i].first,
+                          info->bypassed_count,
+                          info->bypassed_bytes,
+                          info->ratio);
+    }
+}
+
+CompressionPolicy::ThreadSources* CompressionPolicy::GetThreadSources()
+{
+    // The sources for each policy that the thread has used are cached by policy ID, rather than by address, as a
+    // policy may be destroyed and another created at the same address.
+    static thread_local std::unordered_map<uint64_t, std::shared_ptr<ThreadSources>> cached_sources;
+
+    std::shared_ptr<ThreadSources>& thread_sources = cached_sources[policy_id_];
+
+    if (thread_sources == nullptr)
+    {
+        thread_sources = std::make_shared<ThreadSources>();
+
+        std::lock_guard<std::mutex> lock(thread_sources_lock_);
+        thread_sources_.push_back(thread_sources);
+    }
+
+    return thread_sources.get();
+}
+
+GFXRECON_END_NAMESPACE(encode)
+GFXRECON_END_NAMESPACE(gfxrecon)
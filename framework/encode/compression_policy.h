@@ -0,0 +1,97 @@
+/*
+** Copyright (c) 2019 LunarG, Inc.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+#ifndef GFXRECON_ENCODE_COMPRESSION_POLICY_H
+#define GFXRECON_ENCODE_COMPRESSION_POLICY_H
+
+#include "util/defines.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+GFXRECON_BEGIN_NAMESPACE(gfxrecon)
+GFXRECON_BEGIN_NAMESPACE(encode)
+
+// Tracks the compression ratio achieved for a set of data sources, such as API calls or memory objects, and decides
+// when compression should be skipped for sources that consistently produce incompressible data.  Once a source has
+// been bypassed, compression is periodically retried to detect changes to the data, with the retry interval
+// increasing for as long as the data remains incompressible.  Each thread tracks the sources that it compresses
+// separately, so that threads do not contend for a shared lock; the statistics are only combined when they are logged.
+class CompressionPolicy
+{
+  public:
+    CompressionPolicy();
+
+    void SetEnabled(bool enabled) { enabled_ = enabled; }
+
+    bool IsEnabled() const { return enabled_; }
+
+    // Returns false if the data should be written without compression.
+    bool ShouldCompress(uint64_t key, size_t data_size);
+
+    // Updates the compression ratio for a source.  A compressed size of 0 indicates that compression failed.
+    void RecordResult(uint64_t key, size_t uncompressed_size, size_t compressed_size);
+
+    // Discards the compression ratio for a source that will not produce any more data.
+    void RemoveSource(uint64_t key);
+
+    // Writes compression statistics to the log, using the specified description for the data sources, and resets the
+    // statistics for the next capture file.
+    void LogStatistics(const char* source_description);
+
+  private:
+    struct SourceInfo
+    {
+        float    ratio{ 1.0f };
+        uint32_t sample_count{ 0 };
+        uint32_t skip_count{ 0 };
+        uint32_t skip_interval{ 0 };
+        uint64_t bypassed_count{ 0 };
+        uint64_t bypassed_bytes{ 0 };
+    };
+
+    // Sources compressed by a single thread.  The lock is only contended when the statistics are logged or a source is
+    // removed.
+    struct ThreadSources
+    {
+        std::mutex                               lock;
+        std::unordered_map<uint64_t, SourceInfo> sources;
+        uint64_t                                 compressed_count{ 0 };
+        uint64_t                                 compressed_input_bytes{ 0 };
+        uint64_t                                 compressed_output_bytes{ 0 };
+        uint64_t                                 bypassed_count{ 0 };
+        uint64_t                                 bypassed_bytes{ 0 };
+    };
+
+  private:
+    ThreadSources* GetThreadSources();
+
+  private:
+    static std::atomic<uint64_t>                policy_id_counter_;
+    bool                                        enabled_;
+    uint64_t                                    policy_id_;
+    std::mutex                                  thread_sources_lock_;
+    std::vector<std::shared_ptr<ThreadSources>> thread_sources_;
+};
+
+GFXRECON_END_NAMESPACE(encode)
+GFXRECON_END_NAMESPACE(gfxrecon)
+
+#endif // GFXRECON_ENCODE_COMPRESSION_POLICY_H
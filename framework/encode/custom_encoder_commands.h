@@ -41,8 +41,10 @@ struct CustomEncoderPostCall
     {}
 
     template <typename... Args>
-    static void Dispatch(TraceManager*, VkResult, Args...)
-    {}
+    static void Dispatch(TraceManager* manager, VkResult result, Args...)
+    {
+        manager->CheckDeviceLostResult(result);
+    }
 };
 
 // Dispatch custom command to initialize capture at instance creation.
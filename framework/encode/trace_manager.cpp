@@ -21,13 +21,22 @@
 #include "encode/vulkan_state_writer.h"
 #include "format/format_util.h"
 #include "generated/generated_vulkan_struct_handle_wrappers.h"
+#include "util/aligned_file_output_stream.h"
 #include "util/compressor.h"
 #include "util/file_path.h"
 #include "util/logging.h"
-#include "util/page_guard_manager.h"
+#include "util/memory_copy.h"
+#include "util/memory_diff.h"
 #include "util/platform.h"
 
+#include <algorithm>
 #include <cassert>
+#include <cinttypes>
+#include <limits>
+
+#if !defined(WIN32)
+#include <csignal>
+#endif
 
 GFXRECON_BEGIN_NAMESPACE(gfxrecon)
 GFXRECON_BEGIN_NAMESPACE(encode)
@@ -38,6 +47,16 @@ const util::Log::Severity kDefaultLogLevel = util::Log::Severity::kInfoSeverity;
 // One based frame count.
 const uint32_t kFirstFrame = 1;
 
+// Limit on the amount of data that is held in memory while blocks are waiting to be written by the write thread.
+const size_t kMaxPendingBytes = 64 * 1024 * 1024;
+
+// Maximum uncompressed size of the function call blocks that are compressed with the per-thread compression streams.
+// Larger blocks are compressed independently, as they have less to gain from the history of previous blocks.
+const size_t kCompressionStreamBlockSize = 64 * 1024;
+
+// Uncompressed size at which a block group is compressed and written to the capture file.
+const size_t kBlockGroupSize = 64 * 1024;
+
 std::mutex                                     TraceManager::ThreadData::count_lock_;
 format::ThreadId                               TraceManager::ThreadData::thread_count_ = 0;
 std::unordered_map<uint64_t, format::ThreadId> TraceManager::ThreadData::id_map_;
@@ -48,11 +67,19 @@ std::mutex                                             TraceManager::instance_lo
 thread_local std::unique_ptr<TraceManager::ThreadData> TraceManager::thread_data_;
 LayerTable                                             TraceManager::layer_table_;
 std::atomic<format::ThreadId>                          TraceManager::unique_id_counter_{ 0 };
+std::atomic<uint64_t>                                  TraceManager::block_sequence_counter_{ 0 };
+std::atomic<bool>                                      TraceManager::flight_recorder_triggered_{ false };
+
+#if !defined(WIN32)
+// Action that was registered for SIGUSR1 before the flight recorder signal handler was installed.
+static struct sigaction flight_recorder_previous_action;
+#endif
 
 TraceManager::ThreadData::ThreadData() : thread_id_(GetThreadId()), call_id_(format::ApiCallId::ApiCall_Unknown)
 {
     parameter_buffer_  = std::make_unique<util::MemoryOutputStream>();
     parameter_encoder_ = std::make_unique<ParameterEncoder>(parameter_buffer_.get());
+    thread_stream_     = std::make_shared<ThreadStream>();
 }
 
 format::ThreadId TraceManager::ThreadData::GetThreadId()
@@ -77,17 +104,39 @@ format::ThreadId TraceManager::ThreadData::GetThreadId()
 }
 
 TraceManager::TraceManager() :
-    force_file_flush_(false), bytes_written_(0), timestamp_filename_(true),
-    memory_tracking_mode_(CaptureSettings::MemoryTrackingMode::kPageGuard), page_guard_external_memory_(false),
-    trim_enabled_(false), trim_current_range_(0), current_frame_(kFirstFrame), capture_mode_(kModeWrite)
+    force_file_flush_(false), file_output_mode_(CaptureSettings::FileOutputMode::kStdio), async_write_(false),
+    pending_block_count_(0), pending_block_bytes_(0), write_thread_waiting_(false), write_thread_exit_(false),
+    batch_size_(0), thread_streams_(false), flight_recorder_dump_count_(0), flight_recorder_device_lost_(false),
+    flight_recorder_snapshot_size_(0), flight_recorder_snapshots_(true), flight_recorder_signal_installed_(false),
+    bytes_written_(0), compression_chunk_size_(0), block_group_threshold_(0), compression_stream_generation_(0),
+    timestamp_filename_(true), memory_tracking_mode_(CaptureSettings::MemoryTrackingMode::kPageGuard),
+    page_guard_external_memory_(false), unassisted_diff_granularity_(0), trim_enabled_(false), trim_current_range_(0),
+    current_frame_(kFirstFrame), capture_mode_(kModeWrite)
 {}
 
 TraceManager::~TraceManager()
 {
+    StopWriteThread();
+    FlushBlockGroup();
+    FlushBlockBatch();
+    CloseThreadStreams();
+
+    if (file_stream_ != nullptr)
+    {
+        LogCompressionStatistics();
+    }
+
     if (memory_tracking_mode_ == CaptureSettings::MemoryTrackingMode::kPageGuard)
     {
         util::PageGuardManager::Destroy();
     }
+
+#if !defined(WIN32)
+    if (flight_recorder_signal_installed_)
+    {
+        sigaction(SIGUSR1, &flight_recorder_previous_action, nullptr);
+    }
+#endif
 }
 
 void TraceManager::SetLayerFuncs(PFN_vkCreateInstance create_instance, PFN_vkCreateDevice create_device)
@@ -195,11 +244,95 @@ bool TraceManager::Initialize(std::string base_filename, const CaptureSettings::
 {
     bool success = true;
 
-    base_filename_        = base_filename;
-    file_options_         = trace_settings.capture_file_options;
-    timestamp_filename_   = trace_settings.time_stamp_file;
-    memory_tracking_mode_ = trace_settings.memory_tracking_mode;
-    force_file_flush_     = trace_settings.force_flush;
+    base_filename_          = base_filename;
+    file_options_           = trace_settings.capture_file_options;
+    timestamp_filename_     = trace_settings.time_stamp_file;
+    memory_tracking_mode_   = trace_settings.memory_tracking_mode;
+    force_file_flush_       = trace_settings.force_flush;
+    file_output_mode_       = trace_settings.file_output_mode;
+    async_write_            = trace_settings.async_write;
+    batch_size_             = trace_settings.batch_size;
+    thread_streams_         = trace_settings.thread_streams;
+    compression_chunk_size_ = trace_settings.compression_chunk_size;
+    block_group_threshold_  = trace_settings.compression_min_block_size;
+
+    if (memory_tracking_mode_ == CaptureSettings::kUnassisted)
+    {
+        unassisted_diff_granularity_ = trace_settings.unassisted_diff_granularity;
+    }
+
+    if (thread_streams_ && (async_write_ || (batch_size_ > 0)))
+    {
+        // Each thread writes to its own file, so there is no shared file lock to avoid.
+        GFXRECON_LOG_WARNING("Asynchronous file writes and block batching are disabled when per-thread capture file "
+                             "streams are enabled");
+        async_write_ = false;
+        batch_size_  = 0;
+    }
+
+    if (compression_chunk_size_ > 0)
+    {
+        if (file_options_.compression_type != format::CompressionType::kLz4)
+        {
+            GFXRECON_LOG_WARNING("Ignoring capture compression chunk size option: streaming compression is only "
+                                 "supported with LZ4 compression");
+            compression_chunk_size_ = 0;
+        }
+        else if (trace_settings.flight_recorder_size > 0)
+        {
+            // Blocks evicted from the flight recorder would remove the history that the retained blocks depend on.
+            GFXRECON_LOG_WARNING("Ignoring capture compression chunk size option: streaming compression is not "
+                                 "supported when the flight recorder is enabled");
+            compression_chunk_size_ = 0;
+        }
+        else
+        {
+            file_options_.compression_stream_block_size = static_cast<uint32_t>(kCompressionStreamBlockSize);
+        }
+    }
+
+    if (block_group_threshold_ > 0)
+    {
+        if (file_options_.compression_type == format::CompressionType::kNone)
+        {
+            GFXRECON_LOG_WARNING("Ignoring capture compression minimum block size option: compression is disabled");
+            block_group_threshold_ = 0;
+        }
+        else if (thread_streams_)
+        {
+            // A block group is written with a single sequence number, which cannot represent the ordering of its
+            // blocks relative to the blocks from other threads.
+            GFXRECON_LOG_WARNING("Ignoring capture compression minimum block size option: block groups are not "
+                                 "supported with per-thread capture file streams");
+            block_group_threshold_ = 0;
+        }
+        else
+        {
+            block_group_threshold_ = std::min(block_group_threshold_, kBlockGroupSize);
+        }
+    }
+
+    if (!trace_settings.compression_dictionary.empty())
+    {
+        if (file_options_.compression_type != format::CompressionType::kZstd)
+        {
+            GFXRECON_LOG_WARNING("Ignoring capture compression dictionary option: compression dictionaries are only "
+                                 "supported with zstd compression");
+        }
+        else if (LoadCompressionDictionary(trace_settings.compression_dictionary))
+        {
+            file_options_.compression_dictionary_size = static_cast<uint32_t>(compression_dictionary_.size());
+        }
+    }
+
+    bool page_guard_write_scan = false;
+    if (memory_tracking_mode_ == CaptureSettings::kSoftDirty)
+    {
+        // Soft-dirty tracking is a variant of page guard tracking, which only changes how PageGuardManager detects
+        // modified shadow memory pages: the kernel records writes in the page table, which is scanned on processing.
+        memory_tracking_mode_ = CaptureSettings::kPageGuard;
+        page_guard_write_scan = true;
+    }
 
     if (memory_tracking_mode_ == CaptureSettings::kPageGuard)
     {
@@ -219,7 +352,40 @@ bool TraceManager::Initialize(std::string base_filename, const CaptureSettings::
         page_guard_external_memory_ = false;
     }
 
-    if (trace_settings.trim_ranges.empty())
+    if (trace_settings.flight_recorder_size > 0)
+    {
+        // Blocks are retained in memory and only written to a capture file when a dump is triggered, so the state
+        // tracker is required to write the resource state that the retained blocks depend on.
+        if (!trace_settings.trim_ranges.empty() || async_write_ || (batch_size_ > 0) || thread_streams_)
+        {
+            GFXRECON_LOG_WARNING("Capture frame ranges, asynchronous file writes, block batching, and per-thread "
+                                 "capture file streams are disabled when the flight recorder is enabled");
+            async_write_    = false;
+            batch_size_     = 0;
+            thread_streams_ = false;
+        }
+
+        flight_recorder_ = std::make_unique<util::BlockRingBuffer>(trace_settings.flight_recorder_size);
+
+        if (flight_recorder_->IsValid())
+        {
+            capture_mode_ = kModeWriteAndTrack;
+
+            GFXRECON_LOG_INFO("Recording graphics API capture to %" PRIuPTR " byte flight recorder buffer",
+                              flight_recorder_->GetCapacity());
+
+            if (trace_settings.flight_recorder_signal)
+            {
+                InstallFlightRecorderSignalHandler();
+            }
+        }
+        else
+        {
+            flight_recorder_ = nullptr;
+            success          = false;
+        }
+    }
+    else if (trace_settings.trim_ranges.empty())
     {
         // Use default kModeWrite capture mode.
         success = CreateCaptureFile(base_filename_);
@@ -250,11 +416,17 @@ bool TraceManager::Initialize(std::string base_filename, const CaptureSettings::
 
     if (success)
     {
-        compressor_ = std::unique_ptr<util::Compressor>(format::CreateCompressor(file_options_.compression_type));
+        compressor_ = std::unique_ptr<util::Compressor>(
+            format::CreateCompressor(file_options_.compression_type, compression_dictionary_));
         if ((nullptr == compressor_) && (format::CompressionType::kNone != file_options_.compression_type))
         {
             success = false;
         }
+        else if (nullptr != compressor_)
+        {
+            call_compression_policy_.SetEnabled(trace_settings.compression_adaptive);
+            memory_compression_policy_.SetEnabled(trace_settings.compression_adaptive);
+        }
     }
 
     if (success)
@@ -264,17 +436,45 @@ bool TraceManager::Initialize(std::string base_filename, const CaptureSettings::
             util::PageGuardManager::Create(!page_guard_external_memory_,
                                            trace_settings.page_guard_copy_on_map,
                                            trace_settings.page_guard_lazy_copy,
+                                           trace_settings.page_guard_prefetch,
                                            trace_settings.page_guard_separate_read,
-                                           util::PageGuardManager::kDefaultEnableReadWriteSamePage);
+                                           util::PageGuardManager::kDefaultEnableReadWriteSamePage,
+                                           trace_settings.page_guard_userfaultfd,
+                                           page_guard_write_scan,
+                                           trace_settings.page_guard_huge_pages,
+                                           trace_settings.page_guard_diff_granularity);
+
+            if (trace_settings.page_guard_threads != 1)
+            {
+                memory_thread_pool_ = std::make_unique<util::ThreadPool>(trace_settings.page_guard_threads);
+            }
         }
 
         if ((capture_mode_ & kModeTrack) == kModeTrack)
         {
             state_tracker_ = std::make_unique<VulkanStateTracker>();
+
+            if (trim_enabled_ && trace_settings.trim_incremental)
+            {
+                // Capture files for trim ranges after the first reference the unmodified resource data from the files
+                // for earlier ranges, which must be kept in the same directory for replay.
+                state_tracker_->EnableIncrementalSnapshots();
+            }
+
+            if (trace_settings.trim_threads != 1)
+            {
+                state_thread_pool_ = std::make_unique<util::ThreadPool>(trace_settings.trim_threads);
+            }
+        }
+
+        if (async_write_)
+        {
+            StartWriteThread();
         }
     }
     else
     {
+        async_write_  = false;
         capture_mode_ = kModeDisabled;
     }
 
@@ -301,83 +501,761 @@ void TraceManager::EndApiCallTrace(ParameterEncoder* encoder)
         assert((parameter_buffer != nullptr) && (thread_data->parameter_encoder_ != nullptr) &&
                (thread_data->parameter_encoder_.get() == encoder));
 
-        bool                                 not_compressed      = true;
-        format::CompressedFunctionCallHeader compressed_header   = {};
-        format::FunctionCallHeader           uncompressed_header = {};
-        size_t                               uncompressed_size   = parameter_buffer->GetDataSize();
-        size_t                               header_size         = 0;
-        const void*                          header_pointer      = nullptr;
-        size_t                               data_size           = 0;
-        const void*                          data_pointer        = nullptr;
+        if (async_write_)
+        {
+            // Hand the parameter data off to the write thread, which will perform compression and file I/O.
+            PendingBlock block;
+            block.type      = PendingBlockType::kFunctionCallBlock;
+            block.call_id   = thread_data->call_id_;
+            block.thread_id = thread_data->thread_id_;
+            block.data.assign(parameter_buffer->GetData(),
+                              parameter_buffer->GetData() + parameter_buffer->GetDataSize());
+
+            EnqueueBlock(std::move(block));
+        }
+        else
+        {
+            WriteFunctionCall(thread_data->call_id_,
+                              thread_data->thread_id_,
+                              parameter_buffer->GetDataSize(),
+                              parameter_buffer->GetData(),
+                              &thread_data->compressed_buffer_,
+                              &thread_data->compression_stream_);
+        }
+
+        encoder->Reset();
+    }
+    else if (encoder != nullptr)
+    {
+        encoder->Reset();
+    }
+}
+
+void TraceManager::WriteFunctionCall(format::ApiCallId     call_id,
+                                     format::ThreadId      thread_id,
+                                     size_t                data_size,
+                                     const uint8_t*        data,
+                                     std::vector<uint8_t>* compressed_buffer,
+                                     CompressionStream*    compression_stream)
+{
+    assert(compressed_buffer != nullptr);
 
-        if (nullptr != compressor_)
+    if (data_size < block_group_threshold_)
+    {
+        AppendToBlockGroup(call_id, thread_id, data_size, data);
+        return;
+    }
+
+    bool                                 not_compressed      = true;
+    format::CompressedFunctionCallHeader compressed_header   = {};
+    format::FunctionCallHeader           uncompressed_header = {};
+    size_t                               uncompressed_size   = data_size;
+    size_t                               header_size         = 0;
+    const void*                          header_pointer      = nullptr;
+    const void*                          data_pointer        = nullptr;
+
+    if ((nullptr != compressor_) && call_compression_policy_.ShouldCompress(call_id, uncompressed_size))
+    {
+        size_t packet_size       = 0;
+        bool   stream_compressed = false;
+        size_t compressed_size   = CompressFunctionCall(
+            thread_id, uncompressed_size, data, compressed_buffer, compression_stream, &stream_compressed);
+
+        call_compression_policy_.RecordResult(call_id, uncompressed_size, compressed_size);
+
+        // Stream compressed blocks are always written compressed, as the decompressor requires them to maintain the
+        // stream history.
+        if ((0 < compressed_size) && (stream_compressed || (compressed_size < uncompressed_size)))
         {
-            size_t packet_size = 0;
-            size_t compressed_size =
-                compressor_->Compress(uncompressed_size, parameter_buffer->GetData(), &thread_data->compressed_buffer_);
+            data_pointer   = reinterpret_cast<const void*>(compressed_buffer->data());
+            data_size      = compressed_size;
+            header_pointer = reinterpret_cast<const void*>(&compressed_header);
+            header_size    = sizeof(format::CompressedFunctionCallHeader);
+
+            compressed_header.block_header.type = stream_compressed
+                                                      ? format::BlockType::kStreamCompressedFunctionCallBlock
+                                                      : format::BlockType::kCompressedFunctionCallBlock;
+            compressed_header.api_call_id       = call_id;
+            compressed_header.thread_id         = thread_id;
+            compressed_header.uncompressed_size = uncompressed_size;
+
+            packet_size += sizeof(compressed_header.api_call_id) + sizeof(compressed_header.uncompressed_size) +
+                           sizeof(compressed_header.thread_id) + compressed_size;
+
+            compressed_header.block_header.size = packet_size;
+            not_compressed                      = false;
+        }
+    }
+
+    if (not_compressed)
+    {
+        size_t packet_size = 0;
+        data_pointer       = reinterpret_cast<const void*>(data);
+        data_size          = uncompressed_size;
+        header_pointer     = reinterpret_cast<const void*>(&uncompressed_header);
+        header_size        = sizeof(format::FunctionCallHeader);
+
+        uncompressed_header.block_header.type = format::BlockType::kFunctionCallBlock;
+        uncompressed_header.api_call_id       = call_id;
+        uncompressed_header.thread_id         = thread_id;
+
+        packet_size += sizeof(uncompressed_header.api_call_id) + sizeof(uncompressed_header.thread_id) + data_size;
+
+        uncompressed_header.block_header.size = packet_size;
+    }
 
-            if ((0 < compressed_size) && (compressed_size < uncompressed_size))
+    WriteToFile(header_pointer, header_size, data_pointer, data_size);
+}
+
+size_t TraceManager::CompressFunctionCall(format::ThreadId      thread_id,
+                                          size_t                data_size,
+                                          const uint8_t*        data,
+                                          std::vector<uint8_t>* compressed_buffer,
+                                          CompressionStream*    compression_stream,
+                                          bool*                 stream_compressed)
+{
+    assert((compressor_ != nullptr) && (stream_compressed != nullptr));
+
+    (*stream_compressed) = false;
+
+    if ((compression_chunk_size_ > 0) && (compression_stream != nullptr) && (data_size <= kCompressionStreamBlockSize))
+    {
+        if (compression_stream->compressor == nullptr)
+        {
+            compression_stream->compressor = std::unique_ptr<util::Compressor>(
+                format::CreateStreamCompressor(file_options_.compression_type, kCompressionStreamBlockSize));
+        }
+
+        if (compression_stream->compressor != nullptr)
+        {
+            uint32_t generation = compression_stream_generation_.load();
+
+            if ((compression_stream->generation != generation) ||
+                (compression_stream->chunk_size >= compression_chunk_size_))
             {
-                data_pointer   = reinterpret_cast<const void*>(thread_data->compressed_buffer_.data());
-                data_size      = compressed_size;
-                header_pointer = reinterpret_cast<const void*>(&compressed_header);
-                header_size    = sizeof(format::CompressedFunctionCallHeader);
+                // The reset point is written before the first block that is compressed with the new stream history.
+                compression_stream->compressor->Reset();
+                compression_stream->chunk_size = 0;
+                compression_stream->generation = generation;
 
-                compressed_header.block_header.type = format::BlockType::kCompressedFunctionCallBlock;
-                compressed_header.api_call_id       = thread_data->call_id_;
-                compressed_header.thread_id         = thread_data->thread_id_;
-                compressed_header.uncompressed_size = uncompressed_size;
+                WriteResetCompressionStreamCmd(thread_id);
+            }
 
-                packet_size += sizeof(compressed_header.api_call_id) + sizeof(compressed_header.uncompressed_size) +
-                               sizeof(compressed_header.thread_id) + compressed_size;
+            size_t compressed_size = compression_stream->compressor->Compress(data_size, data, compressed_buffer);
 
-                compressed_header.block_header.size = packet_size;
-                not_compressed                      = false;
+            if (compressed_size > 0)
+            {
+                compression_stream->chunk_size += data_size;
+                (*stream_compressed) = true;
+                return compressed_size;
             }
+
+            // The stream history no longer matches the history of the decompressor, so it must be reset before it is
+            // used for the next block.
+            compression_stream->chunk_size = compression_chunk_size_;
+        }
+    }
+
+    return compressor_->Compress(data_size, data, compressed_buffer);
+}
+
+void TraceManager::WriteBlock(const void* header, size_t header_size, const void* data, size_t data_size)
+{
+    if (async_write_)
+    {
+        // Blocks are written by the write thread in the order that they are queued, so all blocks must pass through
+        // the queue to keep them ordered with respect to the function call blocks.
+        PendingBlock block;
+        block.data.reserve(header_size + data_size);
+        block.data.insert(block.data.end(),
+                          reinterpret_cast<const uint8_t*>(header),
+                          reinterpret_cast<const uint8_t*>(header) + header_size);
+
+        if (data_size > 0)
+        {
+            block.data.insert(block.data.end(),
+                              reinterpret_cast<const uint8_t*>(data),
+                              reinterpret_cast<const uint8_t*>(data) + data_size);
+        }
+
+        EnqueueBlock(std::move(block));
+    }
+    else
+    {
+        WriteToFile(header, header_size, data, data_size);
+    }
+}
+
+void TraceManager::WriteToFile(const void* header, size_t header_size, const void* data, size_t data_size)
+{
+    if (thread_streams_)
+    {
+        WriteToThreadStream(header, header_size, data, data_size);
+    }
+    else if (IsBatchingBlocks())
+    {
+        BatchBlock(header, header_size, data, data_size, false);
+    }
+    else
+    {
+        std::lock_guard<std::mutex> lock(file_lock_);
+
+        // The blocks held by the block group were recorded before the current block, so they must be written first.
+        FlushBlockGroupUnlocked();
+        WriteToFileUnlocked(header, header_size, data, data_size);
+    }
+}
+
+void TraceManager::WriteToFileUnlocked(const void* header, size_t header_size, const void* data, size_t data_size)
+{
+    if (flight_recorder_ != nullptr)
+    {
+        if (!flight_recorder_->Write(header, header_size, data, data_size))
+        {
+            GFXRECON_LOG_WARNING("Block of %" PRIuPTR " bytes exceeds the flight recorder buffer size; the recorded "
+                                 "blocks have been discarded",
+                                 header_size + data_size);
         }
 
-        if (not_compressed)
+        return;
+    }
+
+    // Write appropriate block header.
+    bytes_written_ += file_stream_->Write(header, header_size);
+
+    // Write block data.
+    if (data_size > 0)
+    {
+        bytes_written_ += file_stream_->Write(data, data_size);
+    }
+
+    if (force_file_flush_)
+    {
+        file_stream_->Flush();
+    }
+}
+
+void TraceManager::AppendToBlockGroup(format::ApiCallId call_id,
+                                      format::ThreadId  thread_id,
+                                      size_t            data_size,
+                                      const uint8_t*    data)
+{
+    format::FunctionCallHeader header = {};
+    header.block_header.type          = format::BlockType::kFunctionCallBlock;
+    header.block_header.size          = sizeof(header.api_call_id) + sizeof(header.thread_id) + data_size;
+    header.api_call_id                = call_id;
+    header.thread_id                  = thread_id;
+
+    if (IsBatchingBlocks())
+    {
+        // The block is added to the thread's batch uncompressed, and is grouped with the blocks that are adjacent to it
+        // in sequence order, which may be from other threads, when the batches are merged.  This keeps the application
+        // threads from sharing a block group, and keeps the file in the order that the blocks were recorded.
+        BatchBlock(&header, sizeof(header), data, data_size, true);
+    }
+    else
+    {
+        std::lock_guard<std::mutex> lock(file_lock_);
+        AppendToBlockGroupUnlocked(&header, sizeof(header), data, data_size);
+    }
+}
+
+void TraceManager::AppendToBlockGroupUnlocked(const void* header,
+                                              size_t      header_size,
+                                              const void* data,
+                                              size_t      data_size)
+{
+    const uint8_t* header_bytes = reinterpret_cast<const uint8_t*>(header);
+    block_group_.data.insert(block_group_.data.end(), header_bytes, header_bytes + header_size);
+
+    if (data_size > 0)
+    {
+        const uint8_t* data_bytes = reinterpret_cast<const uint8_t*>(data);
+        block_group_.data.insert(block_group_.data.end(), data_bytes, data_bytes + data_size);
+    }
+
+    if (block_group_.data.size() >= kBlockGroupSize)
+    {
+        FlushBlockGroupUnlocked();
+    }
+}
+
+void TraceManager::FlushBlockGroup()
+{
+    if (block_group_threshold_ > 0)
+    {
+        std::lock_guard<std::mutex> lock(file_lock_);
+        FlushBlockGroupUnlocked();
+    }
+}
+
+void TraceManager::FlushBlockGroupUnlocked()
+{
+    if (block_group_.data.empty())
+    {
+        return;
+    }
+
+    assert(compressor_ != nullptr);
+
+    size_t uncompressed_size = block_group_.data.size();
+    size_t compressed_size =
+        compressor_->Compress(uncompressed_size, block_group_.data.data(), &block_group_.compressed_data);
+
+    if ((compressed_size > 0) && ((compressed_size + sizeof(format::CompressedBlockGroupHeader)) < uncompressed_size))
+    {
+        format::CompressedBlockGroupHeader group_header;
+        group_header.block_header.type = format::BlockType::kCompressedBlockGroup;
+        group_header.block_header.size = sizeof(group_header.uncompressed_size) + compressed_size;
+        group_header.uncompressed_size = uncompressed_size;
+
+        WriteToFileUnlocked(&group_header, sizeof(group_header), block_group_.compressed_data.data(), compressed_size);
+    }
+    else
+    {
+        // The group contains complete blocks, which can be written as they are when compression provides no benefit.
+        WriteToFileUnlocked(block_group_.data.data(), uncompressed_size, nullptr, 0);
+    }
+
+    block_group_.data.clear();
+}
+
+void TraceManager::WriteToThreadStream(const void* header, size_t header_size, const void* data, size_t data_size)
+{
+    assert(header_size >= sizeof(format::BlockHeader));
+
+    auto thread_data = GetThreadData();
+    assert(thread_data != nullptr);
+
+    ThreadStream*               thread_stream = thread_data->thread_stream_.get();
+    std::lock_guard<std::mutex> lock(thread_stream->lock);
+
+    if ((thread_stream->file_stream != nullptr) || CreateThreadStream(thread_data))
+    {
+        util::OutputStream* file_stream  = thread_stream->file_stream.get();
+        const uint8_t*      header_bytes = reinterpret_cast<const uint8_t*>(header);
+        uint64_t            sequence     = block_sequence_counter_++;
+        format::BlockHeader block_header;
+
+        // The sequence number is written after the block header and is included in the block size.
+        util::platform::MemoryCopy(&block_header, sizeof(block_header), header_bytes, sizeof(block_header));
+        block_header.size += sizeof(sequence);
+
+        file_stream->Write(&block_header, sizeof(block_header));
+        file_stream->Write(&sequence, sizeof(sequence));
+        file_stream->Write(header_bytes + sizeof(block_header), header_size - sizeof(block_header));
+
+        if (data_size > 0)
+        {
+            file_stream->Write(data, data_size);
+        }
+
+        if (force_file_flush_)
+        {
+            file_stream->Flush();
+        }
+    }
+}
+
+bool TraceManager::CreateThreadStream(ThreadData* thread_data)
+{
+    assert(thread_data != nullptr);
+
+    std::lock_guard<std::mutex> lock(file_lock_);
+
+    if (file_stream_ == nullptr)
+    {
+        // The capture file has been closed.
+        return false;
+    }
+
+    std::string stream_filename = util::filepath::InsertFilenamePostfix(
+        capture_filename_, "_thread_" + std::to_string(thread_data->thread_id_));
+
+    auto file_stream = CreateFileOutputStream(stream_filename);
+
+    if (!file_stream->IsValid())
+    {
+        GFXRECON_LOG_FATAL("Failed to create capture file stream %s; capture has been disabled",
+                           stream_filename.c_str());
+        trim_enabled_ = false;
+        capture_mode_ = kModeDisabled;
+        return false;
+    }
+
+    // Stream files share the primary file's compressor, so the dictionary is only stored in the primary file.
+    format::EnabledOptions stream_options      = file_options_;
+    stream_options.block_sequence_numbers      = true;
+    stream_options.compression_dictionary_size = 0;
+
+    WriteFileHeader(file_stream.get(), stream_options);
+
+    // Record the new stream in the primary capture file, so that it can be opened and merged with the other streams
+    // during replay.  The name is written without a path, as the streams are always in the same directory as the
+    // primary capture file.
+    std::string                        stream_name = util::filepath::GetFilename(stream_filename);
+    format::AddStreamFileCommandHeader add_stream_cmd;
+
+    add_stream_cmd.meta_header.block_header.type = format::BlockType::kMetaDataBlock;
+    add_stream_cmd.meta_header.block_header.size =
+        sizeof(add_stream_cmd.meta_header.meta_data_type) + sizeof(add_stream_cmd.thread_id) + stream_name.length();
+    add_stream_cmd.meta_header.meta_data_type = format::MetaDataType::kAddStreamFileCommand;
+    add_stream_cmd.thread_id                  = thread_data->thread_id_;
+
+    WriteToFileUnlocked(&add_stream_cmd, sizeof(add_stream_cmd), stream_name.data(), stream_name.length());
+
+    thread_data->thread_stream_->file_stream = std::move(file_stream);
+    active_thread_streams_.push_back(thread_data->thread_stream_);
+
+    return true;
+}
+
+void TraceManager::CloseThreadStreams()
+{
+    std::vector<std::shared_ptr<ThreadStream>> thread_streams;
+
+    {
+        std::lock_guard<std::mutex> lock(file_lock_);
+        thread_streams.swap(active_thread_streams_);
+    }
+
+    // The file lock is not held while acquiring the stream locks, which are acquired before the file lock when a
+    // stream is created.  A thread will create a new stream for the next capture file on its next write.
+    for (auto& thread_stream : thread_streams)
+    {
+        std::lock_guard<std::mutex> lock(thread_stream->lock);
+        thread_stream->file_stream = nullptr;
+    }
+}
+
+void TraceManager::BatchBlock(const void* header,
+                              size_t      header_size,
+                              const void* data,
+                              size_t      data_size,
+                              bool        groupable)
+{
+    auto thread_data = GetThreadData();
+    assert(thread_data != nullptr);
+
+    if (thread_data->block_batch_ == nullptr)
+    {
+        thread_data->block_batch_ = std::make_shared<BlockBatch>();
+
+        std::lock_guard<std::mutex> lock(file_lock_);
+        active_block_batches_.push_back(thread_data->block_batch_);
+    }
+
+    BlockBatch* batch = thread_data->block_batch_.get();
+    bool        full  = false;
+
+    {
+        // The sequence number is acquired while holding the batch lock, so a block cannot be missing from its batch
+        // while FlushBlockBatch() writes the blocks with later sequence numbers from the other batches.
+        std::lock_guard<std::mutex> batch_lock(batch->lock);
+        uint64_t                    sequence     = block_sequence_counter_++;
+        const uint8_t*              header_bytes = reinterpret_cast<const uint8_t*>(header);
+
+        batch->data.insert(batch->data.end(), header_bytes, header_bytes + header_size);
+
+        if (data_size > 0)
         {
-            size_t packet_size = 0;
-            data_pointer       = reinterpret_cast<const void*>(parameter_buffer->GetData());
-            data_size          = uncompressed_size;
-            header_pointer     = reinterpret_cast<const void*>(&uncompressed_header);
-            header_size        = sizeof(format::FunctionCallHeader);
+            const uint8_t* data_bytes = reinterpret_cast<const uint8_t*>(data);
+            batch->data.insert(batch->data.end(), data_bytes, data_bytes + data_size);
+        }
 
-            uncompressed_header.block_header.type = format::BlockType::kFunctionCallBlock;
-            uncompressed_header.api_call_id       = thread_data->call_id_;
-            uncompressed_header.thread_id         = thread_data->thread_id_;
+        batch->blocks.push_back({ sequence, batch->data.size(), groupable });
+        full = (batch->data.size() >= batch_size_);
+    }
+
+    if (full)
+    {
+        FlushBlockBatch();
+    }
+}
+
+void TraceManager::FlushBlockBatch()
+{
+    std::lock_guard<std::mutex> lock(file_lock_);
 
-            packet_size += sizeof(uncompressed_header.api_call_id) + sizeof(uncompressed_header.thread_id) + data_size;
+    size_t batch_count = active_block_batches_.size();
+    if (batch_count == 0)
+    {
+        return;
+    }
+
+    // Holding the locks of all batches ensures that every block that was assigned a sequence number before a batch was
+    // locked is written with this flush, and that every block added after the flush has a later sequence number.
+    std::vector<std::unique_lock<std::mutex>> batch_locks;
+    batch_locks.reserve(batch_count);
+    for (const auto& batch : active_block_batches_)
+    {
+        batch_locks.emplace_back(batch->lock);
+    }
+
+    // Merge the batches by sequence number.  Each batch is already in sequence order, so the blocks from a batch that
+    // precede the next block of every other batch are written together with a single write.
+    std::vector<size_t> next_block(batch_count, 0);
+
+    for (;;)
+    {
+        size_t   current_batch    = batch_count;
+        uint64_t current_sequence = std::numeric_limits<uint64_t>::max();
+        uint64_t other_sequence   = std::numeric_limits<uint64_t>::max();
 
-            uncompressed_header.block_header.size = packet_size;
+        for (size_t i = 0; i < batch_count; ++i)
+        {
+            const auto& blocks = active_block_batches_[i]->blocks;
+            if (next_block[i] < blocks.size())
+            {
+                uint64_t sequence = blocks[next_block[i]].sequence;
+                if (sequence < current_sequence)
+                {
+                    other_sequence   = current_sequence;
+                    current_sequence = sequence;
+                    current_batch    = i;
+                }
+                else if (sequence < other_sequence)
+                {
+                    other_sequence = sequence;
+                }
+            }
         }
 
+        if (current_batch == batch_count)
         {
-            std::lock_guard<std::mutex> lock(file_lock_);
+            break;
+        }
 
-            // Write appropriate function call block header.
-            bytes_written_ += file_stream_->Write(header_pointer, header_size);
+        const BlockBatch* batch = active_block_batches_[current_batch].get();
+        size_t            first = next_block[current_batch];
+        size_t            last  = first + 1;
 
-            // Write parameter data.
-            bytes_written_ += file_stream_->Write(data_pointer, data_size);
+        while ((last < batch->blocks.size()) && (batch->blocks[last].sequence < other_sequence))
+        {
+            ++last;
+        }
 
-            if (force_file_flush_)
+        // Blocks that can be grouped are added to the block group one at a time, so that the group is written when it
+        // reaches its size limit.  The group is written before the next block that cannot be grouped, and consecutive
+        // blocks that cannot be grouped are written together.
+        while (first < last)
+        {
+            size_t start_offset = (first > 0) ? batch->blocks[first - 1].end_offset : 0;
+
+            if (batch->blocks[first].groupable)
+            {
+                AppendToBlockGroupUnlocked(batch->data.data() + start_offset,
+                                           batch->blocks[first].end_offset - start_offset,
+                                           nullptr,
+                                           0);
+                ++first;
+            }
+            else
             {
-                file_stream_->Flush();
+                size_t end = first + 1;
+
+                while ((end < last) && !batch->blocks[end].groupable)
+                {
+                    ++end;
+                }
+
+                FlushBlockGroupUnlocked();
+                WriteToFileUnlocked(
+                    batch->data.data() + start_offset, batch->blocks[end - 1].end_offset - start_offset, nullptr, 0);
+
+                first = end;
             }
         }
 
-        encoder->Reset();
+        next_block[current_batch] = last;
     }
-    else if (encoder != nullptr)
+
+    FlushBlockGroupUnlocked();
+
+    for (const auto& batch : active_block_batches_)
     {
-        encoder->Reset();
+        batch->data.clear();
+        batch->blocks.clear();
+    }
+
+    batch_locks.clear();
+
+    // Release the batches of threads that have exited, which hold no further references to them.
+    active_block_batches_.erase(
+        std::remove_if(active_block_batches_.begin(),
+                       active_block_batches_.end(),
+                       [](const std::shared_ptr<BlockBatch>& batch) { return batch.use_count() == 1; }),
+        active_block_batches_.end());
+}
+
+void TraceManager::StartWriteThread()
+{
+    assert(!write_thread_.joinable());
+
+    write_thread_exit_ = false;
+    write_thread_      = std::thread(&TraceManager::ProcessPendingBlocks, this);
+}
+
+void TraceManager::StopWriteThread()
+{
+    if (write_thread_.joinable())
+    {
+        // The write thread exits after all pending blocks have been written.
+        {
+            std::lock_guard<std::mutex> lock(write_thread_lock_);
+            write_thread_exit_ = true;
+            write_thread_signal_.notify_one();
+        }
+
+        write_thread_.join();
+    }
+}
+
+void TraceManager::EnqueueBlock(PendingBlock&& block)
+{
+    size_t block_size = block.data.size();
+
+    if (pending_block_bytes_ >= kMaxPendingBytes)
+    {
+        // Wait for the write thread to catch up when too much data is pending.  A single block is always accepted, to
+        // allow for blocks that are larger than the limit.
+        std::unique_lock<std::mutex> lock(write_thread_lock_);
+        pending_written_signal_.wait(
+            lock, [this]() { return (pending_block_bytes_ < kMaxPendingBytes) || (pending_block_count_ == 0); });
+    }
+
+    // Increment the count before the block is visible to the write thread, so that FlushPendingBlocks() cannot
+    // observe a count of zero while the block is still pending.
+    ++pending_block_count_;
+    pending_block_bytes_ += block_size;
+    pending_blocks_.Push(std::move(block));
+
+    // The write thread is only signaled when it is waiting for blocks, so that producers do not acquire its lock while
+    // it is busy.  The write thread sets the waiting flag before it checks the queue, and the producer checks the flag
+    // after it pushes, so either the write thread finds the block or the producer finds the flag set.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    if (write_thread_waiting_.load(std::memory_order_relaxed))
+    {
+        std::lock_guard<std::mutex> lock(write_thread_lock_);
+        write_thread_signal_.notify_one();
+    }
+}
+
+void TraceManager::FlushPendingBlocks()
+{
+    if (write_thread_.joinable())
+    {
+        std::unique_lock<std::mutex> lock(write_thread_lock_);
+        pending_written_signal_.wait(lock, [this]() { return (pending_block_count_ == 0); });
+    }
+}
+
+void TraceManager::ProcessPendingBlocks()
+{
+    PendingBlock                                            block;
+    std::vector<uint8_t>                                    compressed_buffer;
+    std::unordered_map<format::ThreadId, CompressionStream> compression_streams;
+
+    for (;;)
+    {
+        if (pending_blocks_.TryPop(&block))
+        {
+            size_t block_size = block.data.size();
+
+            if (block.type == PendingBlockType::kFunctionCallBlock)
+            {
+                WriteFunctionCall(block.call_id,
+                                  block.thread_id,
+                                  block.data.size(),
+                                  block.data.data(),
+                                  &compressed_buffer,
+                                  &compression_streams[block.thread_id]);
+            }
+            else if (block.type == PendingBlockType::kFillMemoryBlock)
+            {
+                format::FillMemoryCommandHeader fill_cmd;
+                const uint8_t*                  write_address   = block.data.data();
+                size_t                          write_size      = block.data.size();
+                size_t                          compressed_size = 0;
+
+                if (compressor_ != nullptr)
+                {
+                    compressed_size =
+                        CompressFillMemoryData(block.memory_id, write_address, write_size, &compressed_buffer);
+                }
+
+                InitializeFillMemoryHeader(
+                    &fill_cmd, block.thread_id, block.memory_id, block.memory_offset, write_size, compressed_size);
+
+                if (compressed_size > 0)
+                {
+                    write_address = compressed_buffer.data();
+                    write_size    = compressed_size;
+                }
+
+                WriteToFile(&fill_cmd, sizeof(fill_cmd), write_address, write_size);
+            }
+            else
+            {
+                WriteToFile(block.data.data(), block.data.size(), nullptr, 0);
+            }
+
+            // Producers that are waiting for the pending data to drop below the limit, and threads that are waiting for
+            // all pending blocks to be written, are signaled when the corresponding limit is crossed.  The lock is
+            // acquired before signaling so that the signal cannot be missed by a thread that is about to wait.
+            size_t previous_bytes = pending_block_bytes_.fetch_sub(block_size);
+            size_t previous_count = pending_block_count_.fetch_sub(1);
+
+            if ((previous_count == 1) ||
+                ((previous_bytes >= kMaxPendingBytes) && ((previous_bytes - block_size) < kMaxPendingBytes)))
+            {
+                std::lock_guard<std::mutex> lock(write_thread_lock_);
+                pending_written_signal_.notify_all();
+            }
+        }
+        else if (write_thread_exit_ && (pending_block_count_ == 0))
+        {
+            break;
+        }
+        else
+        {
+            std::unique_lock<std::mutex> lock(write_thread_lock_);
+
+            write_thread_waiting_.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+
+            write_thread_signal_.wait(lock, [this]() { return !pending_blocks_.IsEmpty() || write_thread_exit_; });
+
+            write_thread_waiting_.store(false, std::memory_order_relaxed);
+        }
     }
 }
 
 void TraceManager::EndFrame()
 {
+    if ((capture_mode_ & kModeWrite) == kModeWrite)
+    {
+        FlushBlockGroup();
+        FlushBlockBatch();
+    }
+
+    if (flight_recorder_ != nullptr)
+    {
+        ++current_frame_;
+
+        if (flight_recorder_triggered_.exchange(false))
+        {
+            DumpFlightRecorder("signal");
+        }
+
+        // The device cannot be used to read resource data for a state snapshot after it has been lost.
+        if (flight_recorder_snapshots_ && !flight_recorder_device_lost_)
+        {
+            WriteFlightRecorderSnapshot();
+        }
+    }
+
     if (trim_enabled_)
     {
         ++current_frame_;
@@ -390,8 +1268,13 @@ void TraceManager::EndFrame()
             {
                 // Stop recording and close file.
                 capture_mode_ &= ~kModeWrite;
+                FlushPendingBlocks();
+                FlushBlockGroup();
+                FlushBlockBatch();
+                CloseThreadStreams();
                 file_stream_ = nullptr;
                 GFXRECON_LOG_INFO("Finished recording graphics API capture");
+                LogCompressionStatistics();
 
                 // Advance to next range
                 ++trim_current_range_;
@@ -427,77 +1310,245 @@ std::string TraceManager::CreateTrimFilename(const std::string&                b
 {
     assert(trim_range.total > 0);
 
-    std::string range_string = "_";
+    std::string range_string = "_";
+
+    if (trim_range.total == 1)
+    {
+        range_string += "frame_";
+        range_string += std::to_string(trim_range.first);
+    }
+    else
+    {
+        range_string += "frames_";
+        range_string += std::to_string(trim_range.first);
+        range_string += "_through_";
+        range_string += std::to_string((trim_range.first + trim_range.total) - 1);
+    }
+
+    return util::filepath::InsertFilenamePostfix(base_filename, range_string);
+}
+
+std::unique_ptr<util::OutputStream> TraceManager::CreateFileOutputStream(const std::string& filename)
+{
+#if !defined(WIN32)
+    if (file_output_mode_ != CaptureSettings::FileOutputMode::kStdio)
+    {
+        return std::make_unique<util::AlignedFileOutputStream>(
+            filename, (file_output_mode_ == CaptureSettings::FileOutputMode::kDirect));
+    }
+#endif
+
+    return std::make_unique<util::FileOutputStream>(filename);
+}
+
+bool TraceManager::CreateCaptureFile(const std::string& base_filename)
+{
+    bool        success          = true;
+    std::string capture_filename = base_filename;
+
+    if (timestamp_filename_)
+    {
+        capture_filename = util::filepath::GenerateTimestampedFilename(capture_filename);
+    }
+
+    // Blocks that are still pending belong to the previous capture file.
+    FlushPendingBlocks();
+    FlushBlockGroup();
+    FlushBlockBatch();
+    CloseThreadStreams();
+
+    // The per-thread compression streams are reset before their first block is written to the new file.
+    ++compression_stream_generation_;
+
+    file_stream_ = CreateFileOutputStream(capture_filename);
+
+    if (file_stream_->IsValid())
+    {
+        capture_filename_ = capture_filename;
+
+        GFXRECON_LOG_INFO("Recording graphics API capture to %s", capture_filename.c_str());
+        WriteFileHeader();
+    }
+    else
+    {
+        file_stream_ = nullptr;
+        success      = false;
+    }
+
+    return success;
+}
+
+void TraceManager::ActivateTrimming()
+{
+    const CaptureSettings::TrimRange& trim_range = trim_ranges_[trim_current_range_];
+    bool                              success    = CreateCaptureFile(CreateTrimFilename(base_filename_, trim_range));
+    if (success)
+    {
+        capture_mode_ |= kModeWrite;
+
+        auto thread_data = GetThreadData();
+        assert(thread_data != nullptr);
+
+        VulkanStateWriter state_writer(file_stream_.get(), compressor_.get(), thread_data->thread_id_);
+        state_writer.SetCaptureFilename(capture_filename_);
+        state_writer.SetThreadPool(state_thread_pool_.get());
+        state_tracker_->WriteState(&state_writer, trim_range.first);
+    }
+    else
+    {
+        GFXRECON_LOG_FATAL("Failed to initialize capture for trim range; capture has been disabled");
+        trim_enabled_ = false;
+        capture_mode_ = kModeDisabled;
+    }
+}
+
+void TraceManager::WriteFlightRecorderSnapshot()
+{
+    assert((flight_recorder_ != nullptr) && (state_tracker_ != nullptr));
+
+    // Blocks held by the block group were recorded before the snapshot, so they must be added to the flight recorder
+    // first, and no other blocks can be added to the flight recorder while the snapshot is written.
+    std::lock_guard<std::mutex> lock(file_lock_);
+
+    FlushBlockGroupUnlocked();
+
+    // A new snapshot is written when the blocks recorded since the previous snapshot fill half of the space that is
+    // not used by the previous snapshot, so that the previous snapshot is retained until the new snapshot is written.
+    size_t capacity      = flight_recorder_->GetCapacity();
+    size_t snapshot_size = std::min(flight_recorder_snapshot_size_, capacity);
+
+    if (flight_recorder_->HasStartPoint() &&
+        ((flight_recorder_->GetSizeSinceStartPoint() - snapshot_size) < ((capacity - snapshot_size) / 2)))
+    {
+        return;
+    }
+
+    auto thread_data = GetThreadData();
+    assert(thread_data != nullptr);
 
-    if (trim_range.total == 1)
+    util::BlockRingBufferOutputStream snapshot_stream(flight_recorder_.get());
+
+    VulkanStateWriter state_writer(&snapshot_stream, compressor_.get(), thread_data->thread_id_);
+    state_writer.SetThreadPool(state_thread_pool_.get());
+    state_tracker_->WriteState(&state_writer, current_frame_);
+
+    if (snapshot_stream.IsValid())
     {
-        range_string += "frame_";
-        range_string += std::to_string(trim_range.first);
+        flight_recorder_snapshot_size_ = flight_recorder_->GetSizeSinceStartPoint();
     }
     else
     {
-        range_string += "frames_";
-        range_string += std::to_string(trim_range.first);
-        range_string += "_through_";
-        range_string += std::to_string((trim_range.first + trim_range.total) - 1);
+        // Writing another snapshot would also fail, and would discard the recorded blocks again.
+        GFXRECON_LOG_ERROR("The state snapshot exceeds the flight recorder buffer size; the flight recorder capture "
+                           "will not be written");
+        flight_recorder_snapshots_ = false;
     }
-
-    return util::filepath::InsertFilenamePostfix(base_filename, range_string);
 }
 
-bool TraceManager::CreateCaptureFile(const std::string& base_filename)
+void TraceManager::DumpFlightRecorder(const char* reason)
 {
-    bool        success          = true;
-    std::string capture_filename = base_filename;
+    assert(flight_recorder_ != nullptr);
 
+    // The dump only writes the recorded blocks, which start with the state snapshot that was written at the start of
+    // the oldest retained frame range, and does not access the device, which may have been lost.
+    std::lock_guard<std::mutex> lock(file_lock_);
+
+    // Blocks held by the block group must be added to the flight recorder before it is written.
+    FlushBlockGroupUnlocked();
+
+    if (!flight_recorder_->HasStartPoint() || (flight_recorder_->GetSizeSinceStartPoint() == 0))
+    {
+        GFXRECON_LOG_ERROR("Skipping flight recorder dump: the flight recorder does not contain a state snapshot");
+        return;
+    }
+
+    std::string postfix = "_flight_recorder_";
+    postfix += reason;
+    postfix += "_";
+    postfix += std::to_string(++flight_recorder_dump_count_);
+
+    std::string capture_filename = util::filepath::InsertFilenamePostfix(base_filename_, postfix);
     if (timestamp_filename_)
     {
         capture_filename = util::filepath::GenerateTimestampedFilename(capture_filename);
     }
 
-    file_stream_ = std::make_unique<util::FileOutputStream>(capture_filename);
+    // The file is created directly instead of with CreateCaptureFile(), which acquires the file lock that is held here
+    // to keep blocks from being added to the flight recorder while it is written.
+    auto file_stream = CreateFileOutputStream(capture_filename);
 
-    if (file_stream_->IsValid())
+    if (file_stream->IsValid())
     {
-        GFXRECON_LOG_INFO("Recording graphics API capture to %s", capture_filename.c_str());
-        WriteFileHeader();
+        GFXRECON_LOG_INFO("Writing flight recorder capture to %s", capture_filename.c_str());
+
+        WriteFileHeader(file_stream.get(), file_options_);
+        bytes_written_ += flight_recorder_->Dump(file_stream.get());
+        file_stream->Flush();
+
+        // The blocks recorded after the dump depend on the blocks that were written, so a new snapshot is required
+        // before the flight recorder can be written again.
+        flight_recorder_->Clear();
+        flight_recorder_snapshot_size_ = 0;
+
+        GFXRECON_LOG_INFO("Finished writing flight recorder capture");
     }
     else
     {
-        file_stream_ = nullptr;
-        success      = false;
+        GFXRECON_LOG_ERROR("Failed to create capture file for flight recorder dump");
     }
-
-    return success;
 }
 
-void TraceManager::ActivateTrimming()
+void TraceManager::InstallFlightRecorderSignalHandler()
 {
-    const CaptureSettings::TrimRange& trim_range = trim_ranges_[trim_current_range_];
-    bool                              success    = CreateCaptureFile(CreateTrimFilename(base_filename_, trim_range));
-    if (success)
-    {
-        capture_mode_ |= kModeWrite;
-
-        auto thread_data = GetThreadData();
-        assert(thread_data != nullptr);
+#if defined(WIN32)
+    GFXRECON_LOG_WARNING("Ignoring flight recorder signal option on unsupported platform (Windows is not supported)");
+#else
+    struct sigaction action = {};
+    action.sa_sigaction     = [](int signal, siginfo_t* info, void* context) {
+        flight_recorder_triggered_ = true;
+
+        // Forward the signal to the handler registered by the application, if there is one.  The default action for
+        // SIGUSR1, which terminates the process, is not performed.
+        const struct sigaction& previous = flight_recorder_previous_action;
+        if ((previous.sa_flags & SA_SIGINFO) != 0)
+        {
+            if (previous.sa_sigaction != nullptr)
+            {
+                previous.sa_sigaction(signal, info, context);
+            }
+        }
+        else if ((previous.sa_handler != SIG_DFL) && (previous.sa_handler != SIG_IGN))
+        {
+            previous.sa_handler(signal);
+        }
+    };
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART | SA_SIGINFO;
 
-        VulkanStateWriter state_writer(file_stream_.get(), compressor_.get(), thread_data->thread_id_);
-        state_tracker_->WriteState(&state_writer, trim_range.first);
+    if (sigaction(SIGUSR1, &action, &flight_recorder_previous_action) == 0)
+    {
+        flight_recorder_signal_installed_ = true;
+        GFXRECON_LOG_INFO("Send SIGUSR1 to write the flight recorder contents to a capture file");
     }
     else
     {
-        GFXRECON_LOG_FATAL("Failed to initialize capture for trim range; capture has been disabled");
-        trim_enabled_ = false;
-        capture_mode_ = kModeDisabled;
+        GFXRECON_LOG_WARNING("Failed to install the flight recorder SIGUSR1 handler");
     }
+#endif
 }
 
 void TraceManager::WriteFileHeader()
 {
+    WriteFileHeader(file_stream_.get(), file_options_);
+}
+
+void TraceManager::WriteFileHeader(util::OutputStream* file_stream, const format::EnabledOptions& enabled_options)
+{
+    assert(file_stream != nullptr);
+
     std::vector<format::FileOptionPair> option_list;
 
-    BuildOptionList(file_options_, &option_list);
+    BuildOptionList(enabled_options, &option_list);
 
     format::FileHeader file_header;
     file_header.fourcc        = GFXRECON_FOURCC;
@@ -505,12 +1556,18 @@ void TraceManager::WriteFileHeader()
     file_header.minor_version = 0;
     file_header.num_options   = static_cast<uint32_t>(option_list.size());
 
-    bytes_written_ += file_stream_->Write(&file_header, sizeof(file_header));
-    bytes_written_ += file_stream_->Write(option_list.data(), option_list.size() * sizeof(format::FileOptionPair));
+    bytes_written_ += file_stream->Write(&file_header, sizeof(file_header));
+    bytes_written_ += file_stream->Write(option_list.data(), option_list.size() * sizeof(format::FileOptionPair));
+
+    if (enabled_options.compression_dictionary_size > 0)
+    {
+        assert(enabled_options.compression_dictionary_size == compression_dictionary_.size());
+        bytes_written_ += file_stream->Write(compression_dictionary_.data(), compression_dictionary_.size());
+    }
 
     if (force_file_flush_)
     {
-        file_stream_->Flush();
+        file_stream->Flush();
     }
 }
 
@@ -520,6 +1577,72 @@ void TraceManager::BuildOptionList(const format::EnabledOptions&        enabled_
     assert(option_list != nullptr);
 
     option_list->push_back({ format::FileOption::kCompressionType, enabled_options.compression_type });
+
+    if (enabled_options.block_sequence_numbers)
+    {
+        option_list->push_back({ format::FileOption::kBlockSequenceNumbers, 1 });
+    }
+
+    if (enabled_options.compression_stream_block_size > 0)
+    {
+        option_list->push_back(
+            { format::FileOption::kCompressionStreamBlockSize, enabled_options.compression_stream_block_size });
+    }
+
+    if (enabled_options.compression_dictionary_size > 0)
+    {
+        option_list->push_back(
+            { format::FileOption::kCompressionDictionarySize, enabled_options.compression_dictionary_size });
+    }
+}
+
+void TraceManager::LogCompressionStatistics()
+{
+    call_compression_policy_.LogStatistics("API call");
+    memory_compression_policy_.LogStatistics("mapped memory");
+}
+
+bool TraceManager::LoadCompressionDictionary(const std::string& filename)
+{
+    bool  success = false;
+    FILE* file    = nullptr;
+
+    int32_t result = util::platform::FileOpen(&file, filename.c_str(), "rb");
+    if ((result == 0) && (file != nullptr))
+    {
+        int64_t size = -1;
+
+        if (util::platform::FileSeek(file, 0, util::platform::FileSeekEnd))
+        {
+            size = util::platform::FileTell(file);
+        }
+
+        if ((size > 0) && (size <= std::numeric_limits<uint32_t>::max()) &&
+            util::platform::FileSeek(file, 0, util::platform::FileSeekSet))
+        {
+            compression_dictionary_.resize(static_cast<size_t>(size));
+
+            if (util::platform::FileRead(compression_dictionary_.data(), 1, compression_dictionary_.size(), file) ==
+                compression_dictionary_.size())
+            {
+                success = true;
+            }
+            else
+            {
+                compression_dictionary_.clear();
+            }
+        }
+
+        util::platform::FileClose(file);
+    }
+
+    if (!success)
+    {
+        GFXRECON_LOG_ERROR("Failed to load compression dictionary from file %s; compressing without a dictionary",
+                           filename.c_str());
+    }
+
+    return success;
 }
 
 void TraceManager::WriteDisplayMessageCmd(const char* message)
@@ -535,20 +1658,24 @@ void TraceManager::WriteDisplayMessageCmd(const char* message)
         message_cmd.meta_header.meta_data_type = format::MetaDataType::kDisplayMessageCommand;
         message_cmd.thread_id                  = GetThreadData()->thread_id_;
 
-        {
-            std::lock_guard<std::mutex> lock(file_lock_);
-
-            bytes_written_ += file_stream_->Write(&message_cmd, sizeof(message_cmd));
-            bytes_written_ += file_stream_->Write(message, message_length);
-
-            if (force_file_flush_)
-            {
-                file_stream_->Flush();
-            }
-        }
+        WriteBlock(&message_cmd, sizeof(message_cmd), message, message_length);
     }
 }
 
+void TraceManager::WriteResetCompressionStreamCmd(format::ThreadId thread_id)
+{
+    format::ResetCompressionStreamCommand reset_cmd;
+    reset_cmd.meta_header.block_header.type = format::BlockType::kMetaDataBlock;
+    reset_cmd.meta_header.block_header.size =
+        sizeof(reset_cmd.meta_header.meta_data_type) + sizeof(reset_cmd.thread_id);
+    reset_cmd.meta_header.meta_data_type = format::MetaDataType::kResetCompressionStreamCommand;
+    reset_cmd.thread_id                  = thread_id;
+
+    // Written directly to the file instead of with WriteBlock(), as this is called by the thread that compresses the
+    // function call blocks, which is the write thread when asynchronous writes are enabled.
+    WriteToFile(&reset_cmd, sizeof(reset_cmd), nullptr, 0);
+}
+
 void TraceManager::WriteResizeWindowCmd(format::HandleId surface_id, uint32_t width, uint32_t height)
 {
     if ((capture_mode_ & kModeWrite) == kModeWrite)
@@ -565,15 +1692,7 @@ void TraceManager::WriteResizeWindowCmd(format::HandleId surface_id, uint32_t wi
         resize_cmd.width      = width;
         resize_cmd.height     = height;
 
-        {
-            std::lock_guard<std::mutex> lock(file_lock_);
-            bytes_written_ += file_stream_->Write(&resize_cmd, sizeof(resize_cmd));
-
-            if (force_file_flush_)
-            {
-                file_stream_->Flush();
-            }
-        }
+        WriteBlock(&resize_cmd, sizeof(resize_cmd), nullptr, 0);
     }
 }
 
@@ -586,52 +1705,213 @@ void TraceManager::WriteFillMemoryCmd(format::HandleId memory_id,
     {
         GFXRECON_CHECK_CONVERSION_DATA_LOSS(size_t, size);
 
-        format::FillMemoryCommandHeader fill_cmd;
-        const uint8_t*                  write_address = (static_cast<const uint8_t*>(data) + offset);
-        size_t                          write_size    = static_cast<size_t>(size);
+        const uint8_t* write_address   = (static_cast<const uint8_t*>(data) + offset);
+        size_t         write_size      = static_cast<size_t>(size);
+        const uint8_t* compressed_data = nullptr;
+        size_t         compressed_size = 0;
 
-        fill_cmd.meta_header.block_header.type = format::BlockType::kMetaDataBlock;
-        fill_cmd.meta_header.meta_data_type    = format::MetaDataType::kFillMemoryCommand;
-        fill_cmd.thread_id                     = GetThreadData()->thread_id_;
-        fill_cmd.memory_id                     = memory_id;
-        fill_cmd.memory_offset                 = offset;
-        fill_cmd.memory_size                   = size;
+        if (async_write_)
+        {
+            // Hand the uncompressed memory data off to the write thread, which will perform compression and file I/O.
+            PendingBlock block;
+            block.type          = PendingBlockType::kFillMemoryBlock;
+            block.thread_id     = GetThreadData()->thread_id_;
+            block.memory_id     = memory_id;
+            block.memory_offset = offset;
+            block.data.assign(write_address, write_address + write_size);
+
+            EnqueueBlock(std::move(block));
+            return;
+        }
 
         if (compressor_ != nullptr)
         {
             auto thread_data = GetThreadData();
             assert(thread_data != nullptr);
 
-            size_t compressed_size = compressor_->Compress(write_size, write_address, &thread_data->compressed_buffer_);
+            compressed_size =
+                CompressFillMemoryData(memory_id, write_address, write_size, &thread_data->compressed_buffer_);
+            compressed_data = thread_data->compressed_buffer_.data();
+        }
 
-            if ((compressed_size > 0) && (compressed_size < write_size))
-            {
-                // We don't have a special header for compressed fill commands because the header always includes
-                // the uncompressed size, so we just change the type to indicate the data is compressed.
-                fill_cmd.meta_header.block_header.type = format::BlockType::kCompressedMetaDataBlock;
+        WriteFillMemoryBlock(memory_id, offset, write_size, write_address, compressed_data, compressed_size);
+    }
+}
 
-                write_address = thread_data->compressed_buffer_.data();
-                write_size    = compressed_size;
+void TraceManager::WriteFillMemoryCmds(const std::vector<util::PageGuardManager::ModifiedMemoryRange>& ranges)
+{
+    if ((capture_mode_ & kModeWrite) == kModeWrite)
+    {
+        size_t range_count = ranges.size();
+
+        if (compressor_ != nullptr)
+        {
+            if (fill_memory_buffers_.size() < range_count)
+            {
+                fill_memory_buffers_.resize(range_count);
             }
-        }
 
-        // Calculate size of packet with compressed or uncompressed data size.
-        fill_cmd.meta_header.block_header.size =
-            sizeof(fill_cmd.meta_header.meta_data_type) + sizeof(fill_cmd.thread_id) + sizeof(fill_cmd.memory_id) +
-            sizeof(fill_cmd.memory_offset) + sizeof(fill_cmd.memory_size) + write_size;
+            fill_memory_sizes_.resize(range_count);
 
-        {
-            std::lock_guard<std::mutex> lock(file_lock_);
+            memory_thread_pool_->Run(range_count, [this, &ranges](size_t index) {
+                const auto& range = ranges[index];
+                auto        data  = static_cast<const uint8_t*>(range.start_address) + range.offset;
+
+                fill_memory_sizes_[index] =
+                    CompressFillMemoryData(range.memory_id, data, range.size, &fill_memory_buffers_[index]);
+            });
+        }
 
-            bytes_written_ += file_stream_->Write(&fill_cmd, sizeof(fill_cmd));
-            bytes_written_ += file_stream_->Write(write_address, write_size);
+        for (size_t i = 0; i < range_count; ++i)
+        {
+            const auto&    range           = ranges[i];
+            auto           data            = static_cast<const uint8_t*>(range.start_address) + range.offset;
+            const uint8_t* compressed_data = nullptr;
+            size_t         compressed_size = 0;
 
-            if (force_file_flush_)
+            if (compressor_ != nullptr)
             {
-                file_stream_->Flush();
+                compressed_data = fill_memory_buffers_[i].data();
+                compressed_size = fill_memory_sizes_[i];
             }
+
+            WriteFillMemoryBlock(range.memory_id, range.offset, range.size, data, compressed_data, compressed_size);
+        }
+    }
+}
+
+size_t TraceManager::CompressFillMemoryData(format::HandleId      memory_id,
+                                            const uint8_t*        data,
+                                            size_t                size,
+                                            std::vector<uint8_t>* compressed_data)
+{
+    assert(compressor_ != nullptr);
+
+    size_t compressed_size = 0;
+
+    if (memory_compression_policy_.ShouldCompress(memory_id, size))
+    {
+        compressed_size = compressor_->Compress(size, data, compressed_data);
+
+        memory_compression_policy_.RecordResult(memory_id, size, compressed_size);
+
+        if (compressed_size >= size)
+        {
+            compressed_size = 0;
         }
     }
+
+    return compressed_size;
+}
+
+void TraceManager::WriteFillMemoryBlock(format::HandleId memory_id,
+                                        VkDeviceSize     offset,
+                                        size_t           size,
+                                        const uint8_t*   data,
+                                        const uint8_t*   compressed_data,
+                                        size_t           compressed_size)
+{
+    format::FillMemoryCommandHeader fill_cmd;
+    const uint8_t*                  write_address = data;
+    size_t                          write_size    = size;
+
+    InitializeFillMemoryHeader(&fill_cmd, GetThreadData()->thread_id_, memory_id, offset, size, compressed_size);
+
+    if (compressed_size > 0)
+    {
+        write_address = compressed_data;
+        write_size    = compressed_size;
+    }
+
+    WriteBlock(&fill_cmd, sizeof(fill_cmd), write_address, write_size);
+}
+
+void TraceManager::InitializeFillMemoryHeader(format::FillMemoryCommandHeader* fill_cmd,
+                                              format::ThreadId                 thread_id,
+                                              format::HandleId                 memory_id,
+                                              VkDeviceSize                     offset,
+                                              size_t                           size,
+                                              size_t                           compressed_size)
+{
+    assert(fill_cmd != nullptr);
+
+    size_t write_size = size;
+
+    fill_cmd->meta_header.block_header.type = format::BlockType::kMetaDataBlock;
+    fill_cmd->meta_header.meta_data_type    = format::MetaDataType::kFillMemoryCommand;
+    fill_cmd->thread_id                     = thread_id;
+    fill_cmd->memory_id                     = memory_id;
+    fill_cmd->memory_offset                 = offset;
+    fill_cmd->memory_size                   = size;
+
+    if (compressed_size > 0)
+    {
+        // We don't have a special header for compressed fill commands because the header always includes
+        // the uncompressed size, so we just change the type to indicate the data is compressed.
+        fill_cmd->meta_header.block_header.type = format::BlockType::kCompressedMetaDataBlock;
+
+        write_size = compressed_size;
+    }
+
+    // Calculate size of packet with compressed or uncompressed data size.
+    fill_cmd->meta_header.block_header.size = sizeof(fill_cmd->meta_header.meta_data_type) +
+                                              sizeof(fill_cmd->thread_id) + sizeof(fill_cmd->memory_id) +
+                                              sizeof(fill_cmd->memory_offset) + sizeof(fill_cmd->memory_size) +
+                                              write_size;
+}
+
+void TraceManager::WriteUnassistedMemory(DeviceMemoryWrapper* wrapper)
+{
+    assert((wrapper != nullptr) && (wrapper->mapped_data != nullptr));
+
+    // We set offset to 0, because the pointer returned by vkMapMemory already includes the offset.
+    VkDeviceSize size = wrapper->mapped_size;
+    if (size == VK_WHOLE_SIZE)
+    {
+        size = wrapper->allocation_size - wrapper->mapped_offset;
+    }
+
+    GFXRECON_CHECK_CONVERSION_DATA_LOSS(size_t, size);
+
+    size_t      mapped_size = static_cast<size_t>(size);
+    const void* mapped_data = wrapper->mapped_data;
+    auto&       snapshot    = wrapper->mapped_snapshot;
+
+    if (wrapper->mapped_uncached)
+    {
+        // Reading write-combined or uncached memory with regular loads is very slow, so the memory is copied to cached
+        // memory with streaming loads before it is compared, compressed, and written.
+        uncached_staging_buffer_.resize(mapped_size);
+        util::StreamingMemoryCopy(uncached_staging_buffer_.data(), mapped_data, mapped_size);
+        mapped_data = uncached_staging_buffer_.data();
+    }
+
+    if (unassisted_diff_granularity_ == 0)
+    {
+        // Write the entire mapped region.
+        WriteFillMemoryCmd(wrapper->handle_id, 0, size, mapped_data);
+    }
+    else if (snapshot.size() != mapped_size)
+    {
+        // First write since the memory was mapped.  The content of the memory at replay is unknown, so the entire
+        // mapped region is written and retained for comparison with the next write.
+        auto mapped_bytes = static_cast<const uint8_t*>(mapped_data);
+        snapshot.assign(mapped_bytes, mapped_bytes + mapped_size);
+
+        WriteFillMemoryCmd(wrapper->handle_id, 0, size, snapshot.data());
+    }
+    else
+    {
+        // Only write the ranges that changed since the last write.  The ranges are written from the updated snapshot,
+        // so the snapshot matches the written data if the application modifies the memory during the write.
+        util::FindModifiedRanges(mapped_data,
+                                 snapshot.data(),
+                                 mapped_size,
+                                 unassisted_diff_granularity_,
+                                 [this, wrapper, &snapshot](size_t offset, size_t range_size) {
+                                     WriteFillMemoryCmd(wrapper->handle_id, offset, range_size, snapshot.data());
+                                 });
+    }
 }
 
 void TraceManager::SetDescriptorUpdateTemplateInfo(VkDescriptorUpdateTemplate                  update_template,
@@ -813,6 +2093,7 @@ VkResult TraceManager::OverrideCreateDevice(VkPhysicalDevice             physica
     VkPhysicalDevice    physicalDevice_unwrapped = GetWrappedHandle<VkPhysicalDevice>(physicalDevice);
     VkDeviceCreateInfo* pCreateInfo_unwrapped =
         const_cast<VkDeviceCreateInfo*>(UnwrapStructPtrHandles(pCreateInfo, handle_unwrap_memory));
+    VkResult result = VK_SUCCESS;
 
     if (page_guard_external_memory_)
     {
@@ -865,25 +2146,33 @@ VkResult TraceManager::OverrideCreateDevice(VkPhysicalDevice             physica
         pCreateInfo_unwrapped->enabledExtensionCount   = static_cast<uint32_t>(modified_extensions.size());
         pCreateInfo_unwrapped->ppEnabledExtensionNames = modified_extensions.data();
 
-        VkResult result =
-            layer_table_.CreateDevice(physicalDevice_unwrapped, pCreateInfo_unwrapped, pAllocator, pDevice);
+        result = layer_table_.CreateDevice(physicalDevice_unwrapped, pCreateInfo_unwrapped, pAllocator, pDevice);
+    }
+    else
+    {
+        result = layer_table_.CreateDevice(physicalDevice_unwrapped, pCreateInfo_unwrapped, pAllocator, pDevice);
+    }
+
+    if (result == VK_SUCCESS)
+    {
+        assert((pDevice != nullptr) && (*pDevice != VK_NULL_HANDLE));
 
-        if ((result == VK_SUCCESS) && (capture_mode_ & kModeTrack) != kModeTrack)
-        {
-            assert((pDevice != nullptr) && (*pDevice != VK_NULL_HANDLE));
+        auto physical_device_wrapper = reinterpret_cast<PhysicalDeviceWrapper*>(physicalDevice);
 
+        if ((capture_mode_ & kModeTrack) != kModeTrack)
+        {
             // The state tracker will set this value when it is enabled. When state tracking is disabled it is set
-            // here to ensure it is available for memory allocation.
+            // here to ensure it is available for memory allocation and mapping.
             auto wrapper             = reinterpret_cast<DeviceWrapper*>(*pDevice);
-            wrapper->physical_device = reinterpret_cast<PhysicalDeviceWrapper*>(physicalDevice);
+            wrapper->physical_device = physical_device_wrapper;
         }
 
-        return result;
-    }
-    else
-    {
-        return layer_table_.CreateDevice(physicalDevice_unwrapped, pCreateInfo_unwrapped, pAllocator, pDevice);
+        // The memory types are retrieved before the device can be used, so that they can be read by any thread that
+        // uses the device without further synchronization.
+        InitializeMemoryTypes(physical_device_wrapper);
     }
+
+    return result;
 }
 
 VkResult TraceManager::OverrideAllocateMemory(VkDevice                     device,
@@ -960,8 +2249,9 @@ VkResult TraceManager::OverrideAllocateMemory(VkDevice                     devic
         {
             // The state tracker will set this value when it is enabled. When state tracking is disabled it is set
             // here to ensure it is available for mapped memory tracking.
-            auto wrapper             = reinterpret_cast<DeviceMemoryWrapper*>(*pMemory);
-            wrapper->allocation_size = pAllocateInfo->allocationSize;
+            auto wrapper               = reinterpret_cast<DeviceMemoryWrapper*>(*pMemory);
+            wrapper->memory_type_index = pAllocateInfo->memoryTypeIndex;
+            wrapper->allocation_size   = pAllocateInfo->allocationSize;
         }
     }
     else if (external_memory != nullptr)
@@ -976,41 +2266,34 @@ VkResult TraceManager::OverrideAllocateMemory(VkDevice                     devic
     return result;
 }
 
-VkMemoryPropertyFlags TraceManager::GetMemoryProperties(DeviceWrapper* device_wrapper, uint32_t memory_type_index)
+void TraceManager::InitializeMemoryTypes(PhysicalDeviceWrapper* physical_device_wrapper)
 {
-    VkMemoryPropertyFlags  flags                   = 0;
-    PhysicalDeviceWrapper* physical_device_wrapper = device_wrapper->physical_device;
+    assert(physical_device_wrapper != nullptr);
 
-    if (memory_type_index >= physical_device_wrapper->memory_types.size())
-    {
-        // When trimming is enabled, the state tracker would populate this list when the application queried for
-        // available memory types.  If state tracking is not enabled, or the application didn't make the appropriate
-        // query, the query is made here.
+    // When state tracking is enabled and the application has already retrieved the memory properties, the state tracker
+    // has set the memory types and the query is skipped.
+    std::call_once(physical_device_wrapper->memory_types_flag, [physical_device_wrapper]() {
         InstanceTable* instance_table = physical_device_wrapper->layer_table_ref;
         assert(instance_table != nullptr);
 
         VkPhysicalDeviceMemoryProperties memory_properties;
         instance_table->GetPhysicalDeviceMemoryProperties(physical_device_wrapper->handle, &memory_properties);
 
-        if ((capture_mode_ & kModeTrack) == kModeTrack)
-        {
-            assert(state_tracker_ != nullptr);
-            state_tracker_->TrackPhysicalDeviceMemoryProperties(
-                reinterpret_cast<VkPhysicalDevice>(physical_device_wrapper), &memory_properties);
-            assert(memory_type_index < physical_device_wrapper->memory_types.size());
-        }
-        else
-        {
-            for (size_t i = 0; i < memory_properties.memoryTypeCount; ++i)
-            {
-                physical_device_wrapper->memory_types.push_back(memory_properties.memoryTypes[i]);
-            }
-        }
-    }
+        physical_device_wrapper->memory_types.assign(memory_properties.memoryTypes,
+                                                     memory_properties.memoryTypes + memory_properties.memoryTypeCount);
+    });
+}
+
+VkMemoryPropertyFlags TraceManager::GetMemoryProperties(const DeviceWrapper* device_wrapper,
+                                                        uint32_t             memory_type_index) const
+{
+    const PhysicalDeviceWrapper* physical_device_wrapper = device_wrapper->physical_device;
+    assert(physical_device_wrapper != nullptr);
 
+    // The memory types were set by InitializeMemoryTypes when the device was created, and are not modified.
     assert(memory_type_index < physical_device_wrapper->memory_types.size());
 
-    return flags = physical_device_wrapper->memory_types[memory_type_index].propertyFlags;
+    return physical_device_wrapper->memory_types[memory_type_index].propertyFlags;
 }
 
 void TraceManager::PreProcess_vkCreateSwapchain(VkDevice                        device,
@@ -1060,6 +2343,16 @@ void TraceManager::PostProcess_vkMapMemory(VkResult         result,
                 wrapper->mapped_size   = size;
             }
 
+            if ((memory_tracking_mode_ == CaptureSettings::MemoryTrackingMode::kPageGuard) ||
+                (memory_tracking_mode_ == CaptureSettings::MemoryTrackingMode::kUnassisted))
+            {
+                // Host visible memory without VK_MEMORY_PROPERTY_HOST_CACHED_BIT is typically write-combined or
+                // uncached, and is read with streaming loads when its content is captured.
+                VkMemoryPropertyFlags properties =
+                    GetMemoryProperties(reinterpret_cast<DeviceWrapper*>(device), wrapper->memory_type_index);
+                wrapper->mapped_uncached = ((properties & VK_MEMORY_PROPERTY_HOST_CACHED_BIT) == 0);
+            }
+
             if (memory_tracking_mode_ == CaptureSettings::MemoryTrackingMode::kPageGuard)
             {
                 if (size == VK_WHOLE_SIZE)
@@ -1076,7 +2369,8 @@ void TraceManager::PostProcess_vkMapMemory(VkResult         result,
 
                     // Return the pointer provided by the pageguard manager, which may be a pointer to shadow memory,
                     // not the mapped memory.
-                    (*ppData) = manager->AddMemory(wrapper->handle_id, (*ppData), static_cast<size_t>(size));
+                    (*ppData) = manager->AddMemory(
+                        wrapper->handle_id, (*ppData), static_cast<size_t>(size), wrapper->mapped_uncached);
                 }
             }
             else if (memory_tracking_mode_ == CaptureSettings::MemoryTrackingMode::kUnassisted)
@@ -1188,20 +2482,6 @@ void TraceManager::PreProcess_vkUnmapMemory(VkDevice device, VkDeviceMemory memo
 
     if (wrapper->mapped_data != nullptr)
     {
-        if ((capture_mode_ & kModeTrack) == kModeTrack)
-        {
-            assert(state_tracker_ != nullptr);
-            state_tracker_->TrackMappedMemory(device, memory, nullptr, 0, 0, 0);
-        }
-        else
-        {
-            // Perform subset of the state tracking performed by VulkanStateTracker::TrackMappedMemory, only storing
-            // values needed for non-tracking capture.
-            wrapper->mapped_data   = nullptr;
-            wrapper->mapped_offset = 0;
-            wrapper->mapped_size   = 0;
-        }
-
         if (memory_tracking_mode_ == CaptureSettings::MemoryTrackingMode::kPageGuard)
         {
             util::PageGuardManager* manager = util::PageGuardManager::Get();
@@ -1216,20 +2496,27 @@ void TraceManager::PreProcess_vkUnmapMemory(VkDevice device, VkDeviceMemory memo
         }
         else if (memory_tracking_mode_ == CaptureSettings::MemoryTrackingMode::kUnassisted)
         {
-            // Write the entire mapped region.
-            // We set offset to 0, because the pointer returned by vkMapMemory already includes the offset.
-            VkDeviceSize size = wrapper->mapped_size;
-            if (size == VK_WHOLE_SIZE)
-            {
-                size = wrapper->allocation_size;
-            }
+            std::lock_guard<std::mutex> lock(mapped_memory_lock_);
 
-            WriteFillMemoryCmd(wrapper->handle_id, 0, size, wrapper->mapped_data);
+            WriteUnassistedMemory(wrapper);
 
-            {
-                std::lock_guard<std::mutex> lock(mapped_memory_lock_);
-                mapped_memory_.erase(wrapper);
-            }
+            std::vector<uint8_t>().swap(wrapper->mapped_snapshot);
+            mapped_memory_.erase(wrapper);
+        }
+
+        // The mapped memory state is cleared after the memory tracking modes have processed the mapped memory.
+        if ((capture_mode_ & kModeTrack) == kModeTrack)
+        {
+            assert(state_tracker_ != nullptr);
+            state_tracker_->TrackMappedMemory(device, memory, nullptr, 0, 0, 0);
+        }
+        else
+        {
+            // Perform subset of the state tracking performed by VulkanStateTracker::TrackMappedMemory, only storing
+            // values needed for non-tracking capture.
+            wrapper->mapped_data   = nullptr;
+            wrapper->mapped_offset = 0;
+            wrapper->mapped_size   = 0;
         }
     }
     else
@@ -1250,6 +2537,8 @@ void TraceManager::PreProcess_vkFreeMemory(VkDevice                     device,
     {
         auto wrapper = reinterpret_cast<DeviceMemoryWrapper*>(memory);
 
+        memory_compression_policy_.RemoveSource(wrapper->handle_id);
+
         if ((memory_tracking_mode_ == CaptureSettings::MemoryTrackingMode::kPageGuard) &&
             (wrapper->mapped_data != nullptr))
         {
@@ -1264,6 +2553,13 @@ void TraceManager::PreProcess_vkFreeMemory(VkDevice                     device,
                 manager->FreeMemory(wrapper->external_allocation, external_memory_size);
             }
         }
+        else if ((memory_tracking_mode_ == CaptureSettings::MemoryTrackingMode::kUnassisted) &&
+                 (wrapper->mapped_data != nullptr))
+        {
+            // Memory that is freed while mapped is implicitly unmapped.
+            std::lock_guard<std::mutex> lock(mapped_memory_lock_);
+            mapped_memory_.erase(wrapper);
+        }
     }
 }
 
@@ -1282,9 +2578,20 @@ void TraceManager::PreProcess_vkQueueSubmit(VkQueue             queue,
         util::PageGuardManager* manager = util::PageGuardManager::Get();
         assert(manager != nullptr);
 
-        manager->ProcessMemoryEntries([this](uint64_t memory_id, void* start_address, size_t offset, size_t size) {
-            WriteFillMemoryCmd(memory_id, offset, size, start_address);
-        });
+        if (memory_thread_pool_ != nullptr)
+        {
+            manager->ProcessMemoryEntries(
+                memory_thread_pool_.get(),
+                [this](const std::vector<util::PageGuardManager::ModifiedMemoryRange>& ranges) {
+                    WriteFillMemoryCmds(ranges);
+                });
+        }
+        else
+        {
+            manager->ProcessMemoryEntries([this](uint64_t memory_id, void* start_address, size_t offset, size_t size) {
+                WriteFillMemoryCmd(memory_id, offset, size, start_address);
+            });
+        }
     }
     else if (memory_tracking_mode_ == CaptureSettings::MemoryTrackingMode::kUnassisted)
     {
@@ -1292,9 +2599,7 @@ void TraceManager::PreProcess_vkQueueSubmit(VkQueue             queue,
 
         for (auto wrapper : mapped_memory_)
         {
-            // If the memory is mapped, write the entire mapped region.
-            // We set offset to 0, because the pointer returned by vkMapMemory already includes the offset.
-            WriteFillMemoryCmd(wrapper->handle_id, 0, wrapper->mapped_size, wrapper->mapped_data);
+            WriteUnassistedMemory(wrapper);
         }
     }
 }
@@ -19,6 +19,7 @@
 #define GFXRECON_ENCODE_TRACE_MANAGER_H
 
 #include "encode/capture_settings.h"
+#include "encode/compression_policy.h"
 #include "encode/descriptor_update_template_info.h"
 #include "encode/parameter_encoder.h"
 #include "encode/vulkan_handle_wrapper_util.h"
@@ -28,19 +29,25 @@
 #include "format/format.h"
 #include "generated/generated_vulkan_dispatch_table.h"
 #include "generated/generated_vulkan_command_buffer_util.h"
+#include "util/block_ring_buffer.h"
 #include "util/compressor.h"
 #include "util/defines.h"
 #include "util/file_output_stream.h"
 #include "util/memory_output_stream.h"
+#include "util/mpsc_queue.h"
+#include "util/page_guard_manager.h"
+#include "util/thread_pool.h"
 
 #include "vulkan/vulkan.h"
 
 #include <atomic>
 #include <cassert>
+#include <condition_variable>
 #include <memory>
 #include <mutex>
 #include <set>
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <vector>
 
@@ -280,6 +287,17 @@ class TraceManager
 
     void EndFrame();
 
+    // Writes the contents of the flight recorder to a new capture file when the result indicates that the device was
+    // lost.  Only the first device loss triggers a dump, and no state snapshots are written after the device is lost.
+    void CheckDeviceLostResult(VkResult result)
+    {
+        if ((result == VK_ERROR_DEVICE_LOST) && (flight_recorder_ != nullptr) &&
+            !flight_recorder_device_lost_.exchange(true))
+        {
+            DumpFlightRecorder("device_lost");
+        }
+    }
+
     void WriteDisplayMessageCmd(const char* message);
 
     bool GetDescriptorUpdateTemplateInfo(VkDescriptorUpdateTemplate update_template,
@@ -455,6 +473,7 @@ class TraceManager
                 pPresentInfo->swapchainCount, pPresentInfo->pSwapchains, pPresentInfo->pImageIndices, queue);
         }
 
+        CheckDeviceLostResult(result);
         EndFrame();
     }
 
@@ -589,6 +608,8 @@ class TraceManager
                                                           pSubmits[i].pSignalSemaphores);
             }
         }
+
+        CheckDeviceLostResult(result);
     }
 
     void PostProcess_vkUpdateDescriptorSets(VkDevice,
@@ -795,6 +816,47 @@ class TraceManager
 
     typedef uint32_t CaptureMode;
 
+    struct BatchedBlock
+    {
+        uint64_t sequence;
+        size_t   end_offset; // End offset of the block in BlockBatch::data.
+        bool     groupable;  // Small uncompressed function call block that is written to the block group.
+    };
+
+    // Per-thread staging buffer for complete blocks, which are written to the capture file when a buffer is full or at
+    // the end of a frame.  Each block is tagged with a sequence number, which is used to merge the blocks from all of
+    // the buffers into the order that they were recorded when the buffers are written.
+    struct BlockBatch
+    {
+        std::mutex                lock;
+        std::vector<uint8_t>      data;
+        std::vector<BatchedBlock> blocks;
+    };
+
+    // Small function call blocks that are waiting to be compressed together and written as a single block group.
+    // Guarded by the file lock.
+    struct BlockGroup
+    {
+        std::vector<uint8_t> data;
+        std::vector<uint8_t> compressed_data;
+    };
+
+    // Capture file stream for a single thread, used when each thread writes its blocks to a separate file.
+    struct ThreadStream
+    {
+        std::mutex                          lock;
+        std::unique_ptr<util::OutputStream> file_stream;
+    };
+
+    // Per-thread compression context for function call blocks, used when streaming compression is enabled.  The
+    // context is reset when the chunk size is reached or a new capture file is created.
+    struct CompressionStream
+    {
+        std::unique_ptr<util::Compressor> compressor;
+        size_t                            chunk_size{ 0 }; // Uncompressed bytes compressed since the last reset.
+        uint32_t                          generation{ 0 }; // Capture file generation at the last reset.
+    };
+
     class ThreadData
     {
       public:
@@ -808,7 +870,10 @@ class TraceManager
         std::unique_ptr<util::MemoryOutputStream> parameter_buffer_;
         std::unique_ptr<ParameterEncoder>         parameter_encoder_;
         std::vector<uint8_t>                      compressed_buffer_;
+        CompressionStream                         compression_stream_;
         HandleUnwrapMemory                        handle_unwrap_memory_;
+        std::shared_ptr<BlockBatch>               block_batch_;
+        std::shared_ptr<ThreadStream>             thread_stream_;
 
       private:
         static format::ThreadId GetThreadId();
@@ -819,6 +884,26 @@ class TraceManager
         static std::unordered_map<uint64_t, format::ThreadId> id_map_;
     };
 
+    enum class PendingBlockType
+    {
+        kFormattedBlock,
+        kFunctionCallBlock,
+        kFillMemoryBlock
+    };
+
+    // Block data handed off to the write thread when asynchronous file writes are enabled.  Function call and fill
+    // memory blocks store the uncompressed data, which is compressed by the write thread.  All other blocks are stored
+    // fully formatted.
+    struct PendingBlock
+    {
+        PendingBlockType     type{ PendingBlockType::kFormattedBlock };
+        format::ApiCallId    call_id{ format::ApiCallId::ApiCall_Unknown };
+        format::ThreadId     thread_id{ 0 };
+        format::HandleId     memory_id{ 0 };
+        VkDeviceSize         memory_offset{ 0 };
+        std::vector<uint8_t> data;
+    };
+
   private:
     ThreadData* GetThreadData()
     {
@@ -829,19 +914,96 @@ class TraceManager
         return thread_data_.get();
     }
 
+    std::unique_ptr<util::OutputStream> CreateFileOutputStream(const std::string& filename);
+
     std::string CreateTrimFilename(const std::string& base_filename, const CaptureSettings::TrimRange& trim_range);
     bool        CreateCaptureFile(const std::string& base_filename);
+    bool        LoadCompressionDictionary(const std::string& filename);
+    void        LogCompressionStatistics();
     void        ActivateTrimming();
 
+    void WriteFlightRecorderSnapshot();
+    void DumpFlightRecorder(const char* reason);
+    void InstallFlightRecorderSignalHandler();
+
     void WriteFileHeader();
+    void WriteFileHeader(util::OutputStream* file_stream, const format::EnabledOptions& enabled_options);
     void BuildOptionList(const format::EnabledOptions&        enabled_options,
                          std::vector<format::FileOptionPair>* option_list);
 
     ParameterEncoder* InitApiCallTrace(format::ApiCallId call_id);
 
+    void WriteFunctionCall(format::ApiCallId     call_id,
+                           format::ThreadId      thread_id,
+                           size_t                data_size,
+                           const uint8_t*        data,
+                           std::vector<uint8_t>* compressed_buffer,
+                           CompressionStream*    compression_stream);
+
+    size_t CompressFunctionCall(format::ThreadId      thread_id,
+                                size_t                data_size,
+                                const uint8_t*        data,
+                                std::vector<uint8_t>* compressed_buffer,
+                                CompressionStream*    compression_stream,
+                                bool*                 stream_compressed);
+
+    void WriteBlock(const void* header, size_t header_size, const void* data, size_t data_size);
+    void WriteToFile(const void* header, size_t header_size, const void* data, size_t data_size);
+    void WriteToFileUnlocked(const void* header, size_t header_size, const void* data, size_t data_size);
+
+    void
+    AppendToBlockGroup(format::ApiCallId call_id, format::ThreadId thread_id, size_t data_size, const uint8_t* data);
+    void AppendToBlockGroupUnlocked(const void* header, size_t header_size, const void* data, size_t data_size);
+    void FlushBlockGroup();
+    void FlushBlockGroupUnlocked();
+
+    void WriteToThreadStream(const void* header, size_t header_size, const void* data, size_t data_size);
+    bool CreateThreadStream(ThreadData* thread_data);
+    void CloseThreadStreams();
+
+    // Blocks are batched by the application threads, unless asynchronous writes are enabled, in which case the write
+    // thread is the only thread that writes to the file and there is no lock contention for batching to avoid.
+    bool IsBatchingBlocks() const { return (batch_size_ > 0) && !async_write_; }
+
+    void BatchBlock(const void* header, size_t header_size, const void* data, size_t data_size, bool groupable);
+    void FlushBlockBatch();
+
+    void StartWriteThread();
+    void StopWriteThread();
+    void EnqueueBlock(PendingBlock&& block);
+    void FlushPendingBlocks();
+    void ProcessPendingBlocks();
+
+    void WriteResetCompressionStreamCmd(format::ThreadId thread_id);
     void WriteResizeWindowCmd(format::HandleId surface_id, uint32_t width, uint32_t height);
     void WriteFillMemoryCmd(format::HandleId memory_id, VkDeviceSize offset, VkDeviceSize size, const void* data);
 
+    // Writes fill memory commands for the ranges reported by PageGuardManager, compressing the ranges in parallel with
+    // memory_thread_pool_ and writing them in order.
+    void WriteFillMemoryCmds(const std::vector<util::PageGuardManager::ModifiedMemoryRange>& ranges);
+
+    // Returns the compressed size of the data, or 0 if the data was not compressed.
+    size_t CompressFillMemoryData(format::HandleId      memory_id,
+                                  const uint8_t*        data,
+                                  size_t                size,
+                                  std::vector<uint8_t>* compressed_data);
+
+    void WriteFillMemoryBlock(format::HandleId memory_id,
+                              VkDeviceSize     offset,
+                              size_t           size,
+                              const uint8_t*   data,
+                              const uint8_t*   compressed_data,
+                              size_t           compressed_size);
+    void InitializeFillMemoryHeader(format::FillMemoryCommandHeader* fill_cmd,
+                                    format::ThreadId                 thread_id,
+                                    format::HandleId                 memory_id,
+                                    VkDeviceSize                     offset,
+                                    size_t                           size,
+                                    size_t                           compressed_size);
+
+    // Writes mapped memory for the unassisted memory tracking mode.  Requires mapped_memory_lock_ to be held.
+    void WriteUnassistedMemory(DeviceMemoryWrapper* wrapper);
+
     void SetDescriptorUpdateTemplateInfo(VkDescriptorUpdateTemplate                  update_template,
                                          const VkDescriptorUpdateTemplateCreateInfo* create_info);
 
@@ -849,7 +1011,9 @@ class TraceManager
                                               VkDescriptorUpdateTemplate update_templat,
                                               const void*                data);
 
-    VkMemoryPropertyFlags GetMemoryProperties(DeviceWrapper* device_wrapper, uint32_t memory_type_index);
+    void InitializeMemoryTypes(PhysicalDeviceWrapper* physical_device_wrapper);
+
+    VkMemoryPropertyFlags GetMemoryProperties(const DeviceWrapper* device_wrapper, uint32_t memory_type_index) const;
 
   private:
     static TraceManager*                            instance_;
@@ -858,23 +1022,60 @@ class TraceManager
     static thread_local std::unique_ptr<ThreadData> thread_data_;
     static LayerTable                               layer_table_;
     static std::atomic<format::HandleId>            unique_id_counter_;
+    static std::atomic<uint64_t>                    block_sequence_counter_;
+    static std::atomic<bool>                        flight_recorder_triggered_;
     format::EnabledOptions                          file_options_;
-    std::unique_ptr<util::FileOutputStream>         file_stream_;
+    std::unique_ptr<util::OutputStream>             file_stream_;
     std::string                                     base_filename_;
+    std::string                                     capture_filename_;
     std::mutex                                      file_lock_;
     bool                                            timestamp_filename_;
     bool                                            force_file_flush_;
+    CaptureSettings::FileOutputMode                 file_output_mode_;
+    bool                                            async_write_;
+    util::MpscQueue<PendingBlock>                   pending_blocks_;
+    std::atomic<size_t>                             pending_block_count_;
+    std::atomic<size_t>                             pending_block_bytes_;
+    std::thread                                     write_thread_;
+    std::mutex                                      write_thread_lock_;
+    std::condition_variable                         write_thread_signal_;
+    std::condition_variable                         pending_written_signal_;
+    std::atomic<bool>                               write_thread_waiting_;
+    std::atomic<bool>                               write_thread_exit_;
+    size_t                                          batch_size_;
+    std::vector<std::shared_ptr<BlockBatch>>        active_block_batches_;
+    bool                                            thread_streams_;
+    std::vector<std::shared_ptr<ThreadStream>>      active_thread_streams_;
+    std::unique_ptr<util::BlockRingBuffer>          flight_recorder_;
+    uint32_t                                        flight_recorder_dump_count_;
+    std::atomic<bool>                               flight_recorder_device_lost_;
+    size_t                                          flight_recorder_snapshot_size_;
+    bool                                            flight_recorder_snapshots_;
+    bool                                            flight_recorder_signal_installed_;
     uint64_t                                        bytes_written_;
     std::unique_ptr<util::Compressor>               compressor_;
+    std::vector<uint8_t>                            compression_dictionary_;
+    CompressionPolicy                               call_compression_policy_;
+    CompressionPolicy                               memory_compression_policy_;
+    size_t                                          compression_chunk_size_;
+    size_t                                          block_group_threshold_;
+    BlockGroup                                      block_group_;
+    std::atomic<uint32_t>                           compression_stream_generation_;
     CaptureSettings::MemoryTrackingMode             memory_tracking_mode_;
     bool                                            page_guard_external_memory_;
     std::mutex                                      mapped_memory_lock_;
     std::set<DeviceMemoryWrapper*>                  mapped_memory_; // Track mapped memory for unassisted tracking mode.
+    size_t                                          unassisted_diff_granularity_;
+    std::vector<uint8_t>                            uncached_staging_buffer_; // Guarded by mapped_memory_lock_.
+    std::unique_ptr<util::ThreadPool>               memory_thread_pool_;
+    std::vector<std::vector<uint8_t>>               fill_memory_buffers_; // Only accessed by WriteFillMemoryCmds.
+    std::vector<size_t>                             fill_memory_sizes_;   // Only accessed by WriteFillMemoryCmds.
     bool                                            trim_enabled_;
     std::vector<CaptureSettings::TrimRange>         trim_ranges_;
     size_t                                          trim_current_range_;
     uint32_t                                        current_frame_;
     std::unique_ptr<VulkanStateTracker>             state_tracker_;
+    std::unique_ptr<util::ThreadPool>               state_thread_pool_; // Compresses resource data for state snapshots.
     CaptureMode                                     capture_mode_;
 };
 
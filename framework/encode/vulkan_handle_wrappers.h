@@ -28,6 +28,7 @@
 
 #include <limits>
 #include <memory>
+#include <mutex>
 #include <set>
 #include <unordered_map>
 #include <vector>
@@ -94,8 +95,11 @@ struct PhysicalDeviceWrapper : public HandleWrapper<VkPhysicalDevice>
     InstanceTable*                  layer_table_ref{ nullptr };
     std::vector<DisplayKHRWrapper*> child_displays;
 
-    // Track memory types for use when creating snapshots of buffer and image resource memory content.
+    // Track memory types for use when creating snapshots of buffer and image resource memory content, and for checking
+    // memory properties during capture.  The memory types are set once, when the application retrieves the memory
+    // properties or creates a device, whichever happens first, and may then be read without synchronization.
     std::vector<VkMemoryType> memory_types;
+    std::once_flag            memory_types_flag;
 
     // Track queue family properties retrieval call data to write to state snapshot after physical device creation.
     // The queue family data is only written to the state snapshot if the application made the API call to retrieve it.
@@ -146,7 +150,14 @@ struct DeviceMemoryWrapper : public HandleWrapper<VkDeviceMemory>
     VkDeviceSize     mapped_offset{ 0 };
     VkDeviceSize     mapped_size{ 0 };
     VkMemoryMapFlags mapped_flags{ 0 };
+    bool             mapped_uncached{ false }; // Mapped memory is write-combined or uncached.
     void*            external_allocation{ nullptr };
+
+    // Mapped memory content from the last write, for finding modified ranges with unassisted memory tracking.
+    std::vector<uint8_t> mapped_snapshot;
+
+    // State tracker generation at which the memory was last mapped or unmapped, for incremental state snapshots.
+    uint64_t modified_generation{ 0 };
 };
 
 struct BufferWrapper : public HandleWrapper<VkBuffer>
@@ -156,6 +167,10 @@ struct BufferWrapper : public HandleWrapper<VkBuffer>
     VkDeviceSize     bind_offset{ 0 };
     uint32_t         queue_family_index{ 0 };
     VkDeviceSize     created_size{ 0 };
+
+    // State tracker generation at which the buffer was last referenced by a queue submission, for incremental state
+    // snapshots.
+    uint64_t modified_generation{ 0 };
 };
 
 struct ImageWrapper : public HandleWrapper<VkImage>
@@ -172,6 +187,10 @@ struct ImageWrapper : public HandleWrapper<VkImage>
     VkSampleCountFlagBits samples{};
     VkImageTiling         tiling{};
     VkImageLayout         current_layout{ VK_IMAGE_LAYOUT_UNDEFINED };
+
+    // State tracker generation at which the image was last referenced by a queue submission, for incremental state
+    // snapshots.
+    uint64_t modified_generation{ 0 };
 };
 
 struct BufferViewWrapper : public HandleWrapper<VkBufferView>
@@ -234,6 +253,9 @@ struct CommandBufferWrapper : public HandleWrapper<VkCommandBuffer>
     CommandPoolWrapper* parent_pool{ nullptr };
 
     // Members for trimming state tracking.
+    // Guards the trimming state members, which are updated while commands are recorded, independently of the state
+    // tracker's handle table locks.  Mutable so that the lock can be acquired while visiting the const state table.
+    mutable std::mutex         state_lock;
     VkCommandBufferLevel       level{ VK_COMMAND_BUFFER_LEVEL_PRIMARY };
     util::MemoryOutputStream   command_data;
     std::set<format::HandleId> command_handles[CommandHandleType::NumHandleTypes];
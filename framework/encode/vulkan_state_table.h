@@ -32,6 +32,53 @@ GFXRECON_BEGIN_NAMESPACE(encode)
 
 class VulkanStateTable
 {
+  public:
+    // Identifies the lock that guards the table entries for a handle type.  Shards for parent objects that implicitly
+    // destroy or create child objects are ordered before the shards of those children, and the image shard is ordered
+    // before the query pool shard; locks must be acquired in ascending shard order when more than one is required.
+    enum ShardIndex : uint32_t
+    {
+        InstanceShard = 0,
+        PhysicalDeviceShard,
+        DisplayKHRShard,
+        DisplayModeKHRShard,
+        SurfaceKHRShard,
+        DeviceShard,
+        QueueShard,
+        SemaphoreShard,
+        FenceShard,
+        EventShard,
+        DeviceMemoryShard,
+        BufferShard,
+        BufferViewShard,
+        SwapchainKHRShard,
+        ImageShard,
+        ImageViewShard,
+        QueryPoolShard,
+        ShaderModuleShard,
+        PipelineCacheShard,
+        PipelineLayoutShard,
+        RenderPassShard,
+        PipelineShard,
+        DescriptorSetLayoutShard,
+        SamplerShard,
+        SamplerYcbcrConversionShard,
+        DescriptorUpdateTemplateShard,
+        DescriptorPoolShard,
+        DescriptorSetShard,
+        FramebufferShard,
+        CommandPoolShard,
+        CommandBufferShard,
+        DebugReportCallbackEXTShard,
+        DebugUtilsMessengerEXTShard,
+        ValidationCacheEXTShard,
+        ObjectTableNVXShard,
+        IndirectCommandsLayoutNVXShard,
+        AccelerationStructureNVShard,
+        PerformanceConfigurationINTELShard,
+        NumShards
+    };
+
   public:
     VulkanStateTable() {}
 
@@ -116,6 +163,45 @@ class VulkanStateTable
     bool RemoveWrapper(const AccelerationStructureNVWrapper* wrapper)       { return RemoveEntry(wrapper, acceleration_structure_nv_map_); }
     bool RemoveWrapper(const PerformanceConfigurationINTELWrapper* wrapper) { return RemoveEntry(wrapper, performance_configuration_intel_map_); }
 
+    static ShardIndex GetShardIndex(const InstanceWrapper*)                      { return InstanceShard; }
+    static ShardIndex GetShardIndex(const PhysicalDeviceWrapper*)                { return PhysicalDeviceShard; }
+    static ShardIndex GetShardIndex(const DisplayKHRWrapper*)                    { return DisplayKHRShard; }
+    static ShardIndex GetShardIndex(const DisplayModeKHRWrapper*)                { return DisplayModeKHRShard; }
+    static ShardIndex GetShardIndex(const SurfaceKHRWrapper*)                    { return SurfaceKHRShard; }
+    static ShardIndex GetShardIndex(const DeviceWrapper*)                        { return DeviceShard; }
+    static ShardIndex GetShardIndex(const QueueWrapper*)                         { return QueueShard; }
+    static ShardIndex GetShardIndex(const SemaphoreWrapper*)                     { return SemaphoreShard; }
+    static ShardIndex GetShardIndex(const FenceWrapper*)                         { return FenceShard; }
+    static ShardIndex GetShardIndex(const EventWrapper*)                         { return EventShard; }
+    static ShardIndex GetShardIndex(const DeviceMemoryWrapper*)                  { return DeviceMemoryShard; }
+    static ShardIndex GetShardIndex(const BufferWrapper*)                        { return BufferShard; }
+    static ShardIndex GetShardIndex(const BufferViewWrapper*)                    { return BufferViewShard; }
+    static ShardIndex GetShardIndex(const SwapchainKHRWrapper*)                  { return SwapchainKHRShard; }
+    static ShardIndex GetShardIndex(const ImageWrapper*)                         { return ImageShard; }
+    static ShardIndex GetShardIndex(const ImageViewWrapper*)                     { return ImageViewShard; }
+    static ShardIndex GetShardIndex(const QueryPoolWrapper*)                     { return QueryPoolShard; }
+    static ShardIndex GetShardIndex(const ShaderModuleWrapper*)                  { return ShaderModuleShard; }
+    static ShardIndex GetShardIndex(const PipelineCacheWrapper*)                 { return PipelineCacheShard; }
+    static ShardIndex GetShardIndex(const PipelineLayoutWrapper*)                { return PipelineLayoutShard; }
+    static ShardIndex GetShardIndex(const RenderPassWrapper*)                    { return RenderPassShard; }
+    static ShardIndex GetShardIndex(const PipelineWrapper*)                      { return PipelineShard; }
+    static ShardIndex GetShardIndex(const DescriptorSetLayoutWrapper*)           { return DescriptorSetLayoutShard; }
+    static ShardIndex GetShardIndex(const SamplerWrapper*)                       { return SamplerShard; }
+    static ShardIndex GetShardIndex(const SamplerYcbcrConversionWrapper*)        { return SamplerYcbcrConversionShard; }
+    static ShardIndex GetShardIndex(const DescriptorUpdateTemplateWrapper*)      { return DescriptorUpdateTemplateShard; }
+    static ShardIndex GetShardIndex(const DescriptorPoolWrapper*)                { return DescriptorPoolShard; }
+    static ShardIndex GetShardIndex(const DescriptorSetWrapper*)                 { return DescriptorSetShard; }
+    static ShardIndex GetShardIndex(const FramebufferWrapper*)                   { return FramebufferShard; }
+    static ShardIndex GetShardIndex(const CommandPoolWrapper*)                   { return CommandPoolShard; }
+    static ShardIndex GetShardIndex(const CommandBufferWrapper*)                 { return CommandBufferShard; }
+    static ShardIndex GetShardIndex(const DebugReportCallbackEXTWrapper*)        { return DebugReportCallbackEXTShard; }
+    static ShardIndex GetShardIndex(const DebugUtilsMessengerEXTWrapper*)        { return DebugUtilsMessengerEXTShard; }
+    static ShardIndex GetShardIndex(const ValidationCacheEXTWrapper*)            { return ValidationCacheEXTShard; }
+    static ShardIndex GetShardIndex(const ObjectTableNVXWrapper*)                { return ObjectTableNVXShard; }
+    static ShardIndex GetShardIndex(const IndirectCommandsLayoutNVXWrapper*)     { return IndirectCommandsLayoutNVXShard; }
+    static ShardIndex GetShardIndex(const AccelerationStructureNVWrapper*)       { return AccelerationStructureNVShard; }
+    static ShardIndex GetShardIndex(const PerformanceConfigurationINTELWrapper*) { return PerformanceConfigurationINTELShard; }
+
     void VisitWrappers(std::function<void(const InstanceWrapper*)> visitor) const                      { for (auto entry : instance_map_) { visitor(entry.second); } }
     void VisitWrappers(std::function<void(const PhysicalDeviceWrapper*)> visitor) const                { for (auto entry : physical_device_map_) { visitor(entry.second); } }
     void VisitWrappers(std::function<void(const DeviceWrapper*)> visitor) const                        { for (auto entry : device_map_) { visitor(entry.second); } }
@@ -17,16 +17,50 @@
 #include "encode/vulkan_state_tracker.h"
 
 #include "encode/vulkan_state_info.h"
+#include "util/memory_range_overlap.h"
 
 #include <algorithm>
+#include <vector>
 
 GFXRECON_BEGIN_NAMESPACE(gfxrecon)
 GFXRECON_BEGIN_NAMESPACE(encode)
 
-VulkanStateTracker::VulkanStateTracker() {}
+VulkanStateTracker::VulkanStateTracker() : incremental_snapshots_(false), modification_generation_(1) {}
 
 VulkanStateTracker::~VulkanStateTracker() {}
 
+void VulkanStateTracker::WriteState(VulkanStateWriter* writer, uint64_t frame_number)
+{
+    if (writer != nullptr)
+    {
+        // Block all state tracking while the state is written, acquiring every shard lock in ascending order, followed
+        // by the state locks of the tracked command buffers.
+        std::vector<std::unique_lock<std::mutex>> locks;
+        locks.reserve(VulkanStateTable::NumShards);
+
+        for (auto& shard_lock : shard_locks_)
+        {
+            locks.emplace_back(shard_lock);
+        }
+
+        state_table_.VisitWrappers(
+            [&locks](const CommandBufferWrapper* wrapper) { locks.emplace_back(wrapper->state_lock); });
+
+        if (incremental_snapshots_)
+        {
+            MarkAliasedResources();
+
+            // Wrappers that are modified after this snapshot is written are marked with the next generation.
+            uint64_t generation = modification_generation_++;
+            writer->WriteState(state_table_, frame_number, generation, &snapshot_history_);
+        }
+        else
+        {
+            writer->WriteState(state_table_, frame_number);
+        }
+    }
+}
+
 void VulkanStateTracker::TrackCommandExecution(CommandBufferWrapper*           wrapper,
                                                format::ApiCallId               call_id,
                                                const util::MemoryOutputStream* parameter_buffer)
@@ -37,14 +71,7 @@ void VulkanStateTracker::TrackCommandExecution(CommandBufferWrapper*           w
         (call_id == format::ApiCallId::ApiCall_vkResetCommandBuffer))
     {
         // Clear command data on command buffer reset.
-        wrapper->command_data.Reset();
-        wrapper->pending_layouts.clear();
-        wrapper->recorded_queries.clear();
-
-        for (size_t i = 0; i < CommandHandleType::NumHandleTypes; ++i)
-        {
-            wrapper->command_handles[i].clear();
-        }
+        ResetCommandBufferState(wrapper);
     }
 
     if (call_id != format::ApiCallId::ApiCall_vkResetCommandBuffer)
@@ -57,24 +84,30 @@ void VulkanStateTracker::TrackCommandExecution(CommandBufferWrapper*           w
     }
 }
 
+void VulkanStateTracker::ResetCommandBufferState(CommandBufferWrapper* wrapper)
+{
+    assert(wrapper != nullptr);
+
+    wrapper->command_data.Reset();
+    wrapper->pending_layouts.clear();
+    wrapper->recorded_queries.clear();
+
+    for (size_t i = 0; i < CommandHandleType::NumHandleTypes; ++i)
+    {
+        wrapper->command_handles[i].clear();
+    }
+}
+
 void VulkanStateTracker::TrackResetCommandPool(VkCommandPool command_pool)
 {
     assert(command_pool != VK_NULL_HANDLE);
 
-    std::unique_lock<std::mutex> lock(mutex_);
-
     auto wrapper = reinterpret_cast<CommandPoolWrapper*>(command_pool);
 
     for (const auto& entry : wrapper->child_buffers)
     {
-        entry.second->command_data.Reset();
-        entry.second->pending_layouts.clear();
-        entry.second->recorded_queries.clear();
-
-        for (size_t i = 0; i < CommandHandleType::NumHandleTypes; ++i)
-        {
-            entry.second->command_handles[i].clear();
-        }
+        std::unique_lock<std::mutex> lock(entry.second->state_lock);
+        ResetCommandBufferState(entry.second);
     }
 }
 
@@ -83,14 +116,12 @@ void VulkanStateTracker::TrackPhysicalDeviceMemoryProperties(VkPhysicalDevice
 {
     assert((physical_device != VK_NULL_HANDLE) && (properties != nullptr));
 
-    std::unique_lock<std::mutex> lock(mutex_);
-
     auto wrapper = reinterpret_cast<PhysicalDeviceWrapper*>(physical_device);
 
-    for (uint32_t i = 0; i < properties->memoryTypeCount; ++i)
-    {
-        wrapper->memory_types.push_back(properties->memoryTypes[i]);
-    }
+    // The memory properties do not change, so only the first query is stored.
+    std::call_once(wrapper->memory_types_flag, [wrapper, properties]() {
+        wrapper->memory_types.assign(properties->memoryTypes, properties->memoryTypes + properties->memoryTypeCount);
+    });
 }
 
 void VulkanStateTracker::TrackPhysicalDeviceQueueFamilyProperties(VkPhysicalDevice               physical_device,
@@ -99,7 +130,7 @@ void VulkanStateTracker::TrackPhysicalDeviceQueueFamilyProperties(VkPhysicalDevi
 {
     assert((physical_device != VK_NULL_HANDLE) && (properties != nullptr));
 
-    std::unique_lock<std::mutex> lock(mutex_);
+    std::unique_lock<std::mutex> lock(GetShardLock<PhysicalDeviceWrapper>());
 
     auto wrapper                             = reinterpret_cast<PhysicalDeviceWrapper*>(physical_device);
     wrapper->queue_family_properties_call_id = format::ApiCallId::ApiCall_vkGetPhysicalDeviceQueueFamilyProperties;
@@ -115,7 +146,7 @@ void VulkanStateTracker::TrackPhysicalDeviceQueueFamilyProperties2(format::ApiCa
 {
     assert((physical_device != VK_NULL_HANDLE) && (properties != nullptr));
 
-    std::unique_lock<std::mutex> lock(mutex_);
+    std::unique_lock<std::mutex> lock(GetShardLock<PhysicalDeviceWrapper>());
 
     auto wrapper                             = reinterpret_cast<PhysicalDeviceWrapper*>(physical_device);
     wrapper->queue_family_properties_call_id = call_id;
@@ -164,7 +195,7 @@ void VulkanStateTracker::TrackPhysicalDeviceSurfaceSupport(VkPhysicalDevice phys
 {
     assert((physical_device != VK_NULL_HANDLE) && (surface != VK_NULL_HANDLE));
 
-    std::unique_lock<std::mutex> lock(mutex_);
+    std::unique_lock<std::mutex> lock(GetShardLock<SurfaceKHRWrapper>());
 
     auto  wrapper             = reinterpret_cast<SurfaceKHRWrapper*>(surface);
     auto& entry               = wrapper->surface_support[GetWrappedId(physical_device)];
@@ -177,7 +208,7 @@ void VulkanStateTracker::TrackPhysicalDeviceSurfaceCapabilities(VkPhysicalDevice
 {
     assert((physical_device != VK_NULL_HANDLE) && (surface != VK_NULL_HANDLE));
 
-    std::unique_lock<std::mutex> lock(mutex_);
+    std::unique_lock<std::mutex> lock(GetShardLock<SurfaceKHRWrapper>());
 
     auto wrapper                                                 = reinterpret_cast<SurfaceKHRWrapper*>(surface);
     wrapper->surface_capabilities[GetWrappedId(physical_device)] = capabilities;
@@ -190,7 +221,7 @@ void VulkanStateTracker::TrackPhysicalDeviceSurfaceFormats(VkPhysicalDevice
 {
     assert((physical_device != VK_NULL_HANDLE) && (surface != VK_NULL_HANDLE) && (formats != nullptr));
 
-    std::unique_lock<std::mutex> lock(mutex_);
+    std::unique_lock<std::mutex> lock(GetShardLock<SurfaceKHRWrapper>());
 
     auto  wrapper = reinterpret_cast<SurfaceKHRWrapper*>(surface);
     auto& entry   = wrapper->surface_formats[GetWrappedId(physical_device)];
@@ -204,7 +235,7 @@ void VulkanStateTracker::TrackPhysicalDeviceSurfacePresentModes(VkPhysicalDevice
 {
     assert((physical_device != VK_NULL_HANDLE) && (surface != VK_NULL_HANDLE) && (modes != nullptr));
 
-    std::unique_lock<std::mutex> lock(mutex_);
+    std::unique_lock<std::mutex> lock(GetShardLock<SurfaceKHRWrapper>());
 
     auto  wrapper = reinterpret_cast<SurfaceKHRWrapper*>(surface);
     auto& entry   = wrapper->surface_present_modes[GetWrappedId(physical_device)];
@@ -218,7 +249,7 @@ void VulkanStateTracker::TrackBufferMemoryBinding(VkDevice       device,
 {
     assert((device != VK_NULL_HANDLE) && (buffer != VK_NULL_HANDLE) && (memory != VK_NULL_HANDLE));
 
-    std::unique_lock<std::mutex> lock(mutex_);
+    std::unique_lock<std::mutex> lock(GetShardLock<BufferWrapper>());
 
     auto wrapper            = reinterpret_cast<BufferWrapper*>(buffer);
     wrapper->bind_device    = reinterpret_cast<DeviceWrapper*>(device);
@@ -233,7 +264,7 @@ void VulkanStateTracker::TrackImageMemoryBinding(VkDevice       device,
 {
     assert((device != VK_NULL_HANDLE) && (image != VK_NULL_HANDLE) && (memory != VK_NULL_HANDLE));
 
-    std::unique_lock<std::mutex> lock(mutex_);
+    std::unique_lock<std::mutex> lock(GetShardLock<ImageWrapper>());
 
     auto wrapper            = reinterpret_cast<ImageWrapper*>(image);
     wrapper->bind_device    = reinterpret_cast<DeviceWrapper*>(device);
@@ -250,7 +281,7 @@ void VulkanStateTracker::TrackMappedMemory(VkDevice         device,
 {
     assert((device != VK_NULL_HANDLE) && (memory != VK_NULL_HANDLE));
 
-    std::unique_lock<std::mutex> lock(mutex_);
+    std::unique_lock<std::mutex> lock(GetShardLock<DeviceMemoryWrapper>());
 
     auto wrapper           = reinterpret_cast<DeviceMemoryWrapper*>(memory);
     wrapper->map_device    = reinterpret_cast<DeviceWrapper*>(device);
@@ -258,15 +289,19 @@ void VulkanStateTracker::TrackMappedMemory(VkDevice         device,
     wrapper->mapped_offset = mapped_offset;
     wrapper->mapped_size   = mapped_size;
     wrapper->mapped_flags  = mapped_flags;
+
+    // Memory may be written by the host while it is mapped.
+    wrapper->modified_generation = modification_generation_;
 }
 
 void VulkanStateTracker::TrackBeginRenderPass(VkCommandBuffer command_buffer, const VkRenderPassBeginInfo* begin_info)
 {
     assert((command_buffer != VK_NULL_HANDLE) && (begin_info != nullptr));
 
-    std::unique_lock<std::mutex> lock(mutex_);
+    auto wrapper = reinterpret_cast<CommandBufferWrapper*>(command_buffer);
+
+    std::unique_lock<std::mutex> lock(wrapper->state_lock);
 
-    auto wrapper                     = reinterpret_cast<CommandBufferWrapper*>(command_buffer);
     wrapper->active_render_pass      = reinterpret_cast<RenderPassWrapper*>(begin_info->renderPass);
     wrapper->render_pass_framebuffer = reinterpret_cast<FramebufferWrapper*>(begin_info->framebuffer);
 }
@@ -275,9 +310,10 @@ void VulkanStateTracker::TrackEndRenderPass(VkCommandBuffer command_buffer)
 {
     assert(command_buffer != VK_NULL_HANDLE);
 
-    std::unique_lock<std::mutex> lock(mutex_);
-
     auto wrapper = reinterpret_cast<CommandBufferWrapper*>(command_buffer);
+
+    std::unique_lock<std::mutex> lock(wrapper->state_lock);
+
     assert((wrapper->active_render_pass != VK_NULL_HANDLE) && (wrapper->render_pass_framebuffer != VK_NULL_HANDLE));
 
     auto render_pass_wrapper = wrapper->active_render_pass;
@@ -304,8 +340,6 @@ void VulkanStateTracker::TrackExecuteCommands(VkCommandBuffer        command_buf
 {
     assert((command_buffer != VK_NULL_HANDLE) && (command_buffers != nullptr));
 
-    std::unique_lock<std::mutex> lock(mutex_);
-
     auto primary_wrapper = reinterpret_cast<CommandBufferWrapper*>(command_buffer);
 
     for (uint32_t i = 0; i < command_buffer_count; ++i)
@@ -313,6 +347,12 @@ void VulkanStateTracker::TrackExecuteCommands(VkCommandBuffer        command_buf
         auto secondary_wrapper = reinterpret_cast<CommandBufferWrapper*>(command_buffers[i]);
         assert(secondary_wrapper != nullptr);
 
+        // Command buffer locks are not acquired in a fixed order, so use the deadlock avoidance algorithm of std::lock
+        // when both locks are required.
+        std::unique_lock<std::mutex> primary_lock(primary_wrapper->state_lock, std::defer_lock);
+        std::unique_lock<std::mutex> secondary_lock(secondary_wrapper->state_lock, std::defer_lock);
+        std::lock(primary_lock, secondary_lock);
+
         for (const auto& layout_entry : secondary_wrapper->pending_layouts)
         {
             primary_wrapper->pending_layouts[layout_entry.first] = layout_entry.second;
@@ -346,10 +386,10 @@ void VulkanStateTracker::TrackImageBarriers(VkCommandBuffer             command_
 
     if ((image_barrier_count > 0) && (image_barriers != nullptr))
     {
-        std::unique_lock<std::mutex> lock(mutex_);
-
         auto wrapper = reinterpret_cast<CommandBufferWrapper*>(command_buffer);
 
+        std::unique_lock<std::mutex> lock(wrapper->state_lock);
+
         for (uint32_t i = 0; i < image_barrier_count; ++i)
         {
             auto image_wrapper                      = reinterpret_cast<ImageWrapper*>(image_barriers[i].image);
@@ -362,7 +402,34 @@ void VulkanStateTracker::TrackCommandBufferSubmissions(uint32_t submit_count, co
 {
     if ((submit_count > 0) && (submits != nullptr) && (submits->commandBufferCount > 0))
     {
-        std::unique_lock<std::mutex> lock(mutex_);
+        // Pending state is applied to the image and query pool wrappers, with shard locks acquired in ascending order.
+        // Marking the resources referenced by the command buffers for incremental state snapshots requires the shard
+        // locks for the handle types that are used to find the resources.
+        static const VulkanStateTable::ShardIndex kSubmitShards[] = { VulkanStateTable::ImageShard,
+                                                                       VulkanStateTable::QueryPoolShard };
+        static const VulkanStateTable::ShardIndex kIncrementalSubmitShards[] = {
+            VulkanStateTable::BufferShard,      VulkanStateTable::BufferViewShard,
+            VulkanStateTable::ImageShard,       VulkanStateTable::ImageViewShard,
+            VulkanStateTable::QueryPoolShard,   VulkanStateTable::DescriptorSetShard,
+            VulkanStateTable::FramebufferShard, VulkanStateTable::CommandBufferShard
+        };
+
+        std::vector<std::unique_lock<std::mutex>> locks;
+
+        if (incremental_snapshots_)
+        {
+            for (auto shard : kIncrementalSubmitShards)
+            {
+                locks.emplace_back(shard_locks_[shard]);
+            }
+        }
+        else
+        {
+            for (auto shard : kSubmitShards)
+            {
+                locks.emplace_back(shard_locks_[shard]);
+            }
+        }
 
         for (uint32_t submit = 0; submit < submit_count; ++submit)
         {
@@ -374,6 +441,8 @@ void VulkanStateTracker::TrackCommandBufferSubmissions(uint32_t submit_count, co
                 auto command_wrapper = reinterpret_cast<CommandBufferWrapper*>(command_buffers[cmd]);
                 assert(command_wrapper != nullptr);
 
+                std::unique_lock<std::mutex> command_lock(command_wrapper->state_lock);
+
                 // Apply pending image layouts.
                 for (const auto& layout_entry : command_wrapper->pending_layouts)
                 {
@@ -402,6 +471,186 @@ void VulkanStateTracker::TrackCommandBufferSubmissions(uint32_t submit_count, co
                         }
                     }
                 }
+
+                if (incremental_snapshots_)
+                {
+                    MarkCommandBufferResources(command_wrapper);
+                }
+            }
+        }
+    }
+}
+
+void VulkanStateTracker::MarkCommandBufferResources(const CommandBufferWrapper* wrapper)
+{
+    assert(wrapper != nullptr);
+
+    auto mark_buffer = [this](format::HandleId buffer_id) {
+        BufferWrapper* buffer_wrapper = state_table_.GetBufferWrapper(buffer_id);
+        if (buffer_wrapper != nullptr)
+        {
+            buffer_wrapper->modified_generation = modification_generation_;
+        }
+    };
+
+    auto mark_image = [this](format::HandleId image_id) {
+        ImageWrapper* image_wrapper = state_table_.GetImageWrapper(image_id);
+        if (image_wrapper != nullptr)
+        {
+            image_wrapper->modified_generation = modification_generation_;
+        }
+    };
+
+    auto mark_image_view = [this, &mark_image](format::HandleId view_id) {
+        const ImageViewWrapper* view_wrapper = state_table_.GetImageViewWrapper(view_id);
+        if (view_wrapper != nullptr)
+        {
+            mark_image(view_wrapper->image_id);
+        }
+    };
+
+    // Resources that are referenced directly by commands, such as transfer destinations.
+    for (auto buffer_id : wrapper->command_handles[CommandHandleType::BufferHandle])
+    {
+        mark_buffer(buffer_id);
+    }
+
+    for (auto image_id : wrapper->command_handles[CommandHandleType::ImageHandle])
+    {
+        mark_image(image_id);
+    }
+
+    for (auto view_id : wrapper->command_handles[CommandHandleType::ImageViewHandle])
+    {
+        mark_image_view(view_id);
+    }
+
+    // Render pass attachments.
+    for (auto framebuffer_id : wrapper->command_handles[CommandHandleType::FramebufferHandle])
+    {
+        const FramebufferWrapper* framebuffer_wrapper = state_table_.GetFramebufferWrapper(framebuffer_id);
+        if (framebuffer_wrapper != nullptr)
+        {
+            for (auto view_id : framebuffer_wrapper->image_view_ids)
+            {
+                mark_image_view(view_id);
+            }
+        }
+    }
+
+    // Descriptors that can be written by shaders.
+    for (auto set_id : wrapper->command_handles[CommandHandleType::DescriptorSetHandle])
+    {
+        const DescriptorSetWrapper* set_wrapper = state_table_.GetDescriptorSetWrapper(set_id);
+        if (set_wrapper == nullptr)
+        {
+            continue;
+        }
+
+        for (const auto& binding_entry : set_wrapper->bindings)
+        {
+            const DescriptorInfo& binding = binding_entry.second;
+
+            for (uint32_t i = 0; i < binding.count; ++i)
+            {
+                if (!binding.written[i])
+                {
+                    continue;
+                }
+
+                switch (binding.type)
+                {
+                    case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER:
+                    case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC:
+                        mark_buffer(binding.handle_ids[i]);
+                        break;
+                    case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE:
+                        mark_image_view(binding.handle_ids[i]);
+                        break;
+                    case VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER:
+                    {
+                        const BufferViewWrapper* view_wrapper =
+                            state_table_.GetBufferViewWrapper(binding.handle_ids[i]);
+                        if (view_wrapper != nullptr)
+                        {
+                            mark_buffer(view_wrapper->buffer_id);
+                        }
+                        break;
+                    }
+                    default:
+                        break;
+                }
+            }
+        }
+    }
+
+    // Secondary command buffers executed by the command buffer.
+    for (auto command_buffer_id : wrapper->command_handles[CommandHandleType::CommandBufferHandle])
+    {
+        const CommandBufferWrapper* secondary_wrapper = state_table_.GetCommandBufferWrapper(command_buffer_id);
+        if (secondary_wrapper != nullptr)
+        {
+            std::unique_lock<std::mutex> secondary_lock(secondary_wrapper->state_lock);
+            MarkCommandBufferResources(secondary_wrapper);
+        }
+    }
+}
+
+void VulkanStateTracker::MarkAliasedResources()
+{
+    // Resource bindings are collected with the buffers first, so that a range index below the buffer count identifies
+    // a buffer and the remaining indices identify images.
+    std::vector<util::MemoryRange> ranges;
+    std::vector<format::HandleId>  buffer_ids;
+    std::vector<format::HandleId>  image_ids;
+
+    state_table_.VisitWrappers([&](const BufferWrapper* wrapper) {
+        if (wrapper->bind_memory_id != 0)
+        {
+            ranges.push_back({ wrapper->bind_memory_id,
+                               wrapper->bind_offset,
+                               wrapper->bind_offset + wrapper->created_size,
+                               ranges.size(),
+                               wrapper->modified_generation == modification_generation_ });
+            buffer_ids.push_back(wrapper->handle_id);
+        }
+    });
+
+    state_table_.VisitWrappers([&](const ImageWrapper* wrapper) {
+        if ((wrapper->bind_memory_id != 0) && (wrapper->bind_device != nullptr))
+        {
+            // The size of the memory range that is bound to an image is only known to the driver.
+            const DeviceWrapper* device_wrapper      = wrapper->bind_device;
+            VkMemoryRequirements memory_requirements = {};
+
+            device_wrapper->layer_table.GetImageMemoryRequirements(
+                device_wrapper->handle, wrapper->handle, &memory_requirements);
+
+            ranges.push_back({ wrapper->bind_memory_id,
+                               wrapper->bind_offset,
+                               wrapper->bind_offset + memory_requirements.size,
+                               ranges.size(),
+                               wrapper->modified_generation == modification_generation_ });
+            image_ids.push_back(wrapper->handle_id);
+        }
+    });
+
+    util::MarkOverlappingRanges(&ranges);
+
+    for (const auto& range : ranges)
+    {
+        if (range.marked)
+        {
+            if (range.index < buffer_ids.size())
+            {
+                BufferWrapper* buffer_wrapper       = state_table_.GetBufferWrapper(buffer_ids[range.index]);
+                buffer_wrapper->modified_generation = modification_generation_;
+            }
+            else
+            {
+                ImageWrapper* image_wrapper = state_table_.GetImageWrapper(image_ids[range.index - buffer_ids.size()]);
+
+                image_wrapper->modified_generation = modification_generation_;
             }
         }
     }
@@ -412,7 +661,7 @@ void VulkanStateTracker::TrackUpdateDescriptorSets(uint32_t                    w
                                                    uint32_t                    copy_count,
                                                    const VkCopyDescriptorSet*  copies)
 {
-    std::unique_lock<std::mutex> lock(mutex_);
+    std::unique_lock<std::mutex> lock(GetShardLock<DescriptorSetWrapper>());
 
     // When processing descriptor updates, we pack the unique handle ID into the stored
     // VkWriteDescriptorSet/VkCopyDescriptorSet handles so that the state writer can determine if the object still
@@ -655,7 +904,7 @@ void VulkanStateTracker::TrackUpdateDescriptorSetWithTemplate(VkDescriptorSet
     // exists at state write time by checking for the ID in the active state table.
     if ((template_info != nullptr) && (data != nullptr))
     {
-        std::unique_lock<std::mutex> lock(mutex_);
+        std::unique_lock<std::mutex> lock(GetShardLock<DescriptorSetWrapper>());
 
         auto           wrapper = reinterpret_cast<DescriptorSetWrapper*>(set);
         const uint8_t* bytes   = reinterpret_cast<const uint8_t*>(data);
@@ -824,7 +1073,7 @@ void VulkanStateTracker::TrackResetDescriptorPool(VkDescriptorPool descriptor_po
 {
     assert(descriptor_pool != VK_NULL_HANDLE);
 
-    std::unique_lock<std::mutex> lock(mutex_);
+    std::unique_lock<std::mutex> lock(GetShardLock<DescriptorSetWrapper>());
 
     auto wrapper = reinterpret_cast<DescriptorPoolWrapper*>(descriptor_pool);
 
@@ -840,11 +1089,11 @@ void VulkanStateTracker::TrackQueryActivation(
 {
     assert((command_buffer != VK_NULL_HANDLE) && (query_pool != VK_NULL_HANDLE));
 
-    std::unique_lock<std::mutex> lock(mutex_);
-
     auto                      wrapper              = reinterpret_cast<CommandBufferWrapper*>(command_buffer);
     const CommandPoolWrapper* command_pool_wrapper = wrapper->parent_pool;
 
+    std::unique_lock<std::mutex> lock(wrapper->state_lock);
+
     auto& query_pool_info         = wrapper->recorded_queries[reinterpret_cast<QueryPoolWrapper*>(query_pool)];
     auto& query_info              = query_pool_info[query];
     query_info.active             = true;
@@ -860,9 +1109,10 @@ void VulkanStateTracker::TrackQueryReset(VkCommandBuffer command_buffer,
 {
     assert((command_buffer != VK_NULL_HANDLE) && (query_pool != VK_NULL_HANDLE));
 
-    std::unique_lock<std::mutex> lock(mutex_);
+    auto wrapper = reinterpret_cast<CommandBufferWrapper*>(command_buffer);
+
+    std::unique_lock<std::mutex> lock(wrapper->state_lock);
 
-    auto  wrapper         = reinterpret_cast<CommandBufferWrapper*>(command_buffer);
     auto& query_pool_info = wrapper->recorded_queries[reinterpret_cast<QueryPoolWrapper*>(query_pool)];
 
     for (uint32_t i = first_query; i < query_count; ++i)
@@ -875,7 +1125,7 @@ void VulkanStateTracker::TrackQueryReset(VkQueryPool query_pool, uint32_t first_
 {
     assert(query_pool != VK_NULL_HANDLE);
 
-    std::unique_lock<std::mutex> lock(mutex_);
+    std::unique_lock<std::mutex> lock(GetShardLock<QueryPoolWrapper>());
 
     auto wrapper = reinterpret_cast<QueryPoolWrapper*>(query_pool);
     assert((first_query + query_count) <= wrapper->pending_queries.size());
@@ -890,7 +1140,7 @@ void VulkanStateTracker::TrackSemaphoreSignalState(VkSemaphore signal)
 {
     if (signal != VK_NULL_HANDLE)
     {
-        std::unique_lock<std::mutex> lock(mutex_);
+        std::unique_lock<std::mutex> lock(GetShardLock<SemaphoreWrapper>());
 
         auto wrapper = reinterpret_cast<SemaphoreWrapper*>(signal);
         assert(wrapper != nullptr);
@@ -905,7 +1155,7 @@ void VulkanStateTracker::TrackSemaphoreSignalState(uint32_t           wait_count
 {
     if (((waits != nullptr) && (wait_count > 0)) || ((signals != nullptr) && (signal_count > 0)))
     {
-        std::unique_lock<std::mutex> lock(mutex_);
+        std::unique_lock<std::mutex> lock(GetShardLock<SemaphoreWrapper>());
 
         if (waits != nullptr)
         {
@@ -934,7 +1184,7 @@ void VulkanStateTracker::TrackAcquireImage(
 {
     assert(swapchain != VK_NULL_HANDLE);
 
-    std::unique_lock<std::mutex> lock(mutex_);
+    std::unique_lock<std::mutex> lock(GetShardLock<SwapchainKHRWrapper>());
 
     auto wrapper = reinterpret_cast<SwapchainKHRWrapper*>(swapchain);
 
@@ -951,7 +1201,7 @@ void VulkanStateTracker::TrackPresentedImages(uint32_t              count,
 {
     assert((count > 0) && (swapchains != nullptr) && (image_indices != nullptr));
 
-    std::unique_lock<std::mutex> lock(mutex_);
+    std::unique_lock<std::mutex> lock(GetShardLock<SwapchainKHRWrapper>());
 
     for (uint32_t i = 0; i < count; ++i)
     {
@@ -972,6 +1222,10 @@ void VulkanStateTracker::DestroyState(InstanceWrapper* wrapper)
 
     // Physical devices are not explicitly destroyed, so need to be removed from the state tracker when their parent
     // instance is destroyed.
+    std::unique_lock<std::mutex> physical_device_lock(GetShardLock<PhysicalDeviceWrapper>());
+    std::unique_lock<std::mutex> display_lock(GetShardLock<DisplayKHRWrapper>());
+    std::unique_lock<std::mutex> display_mode_lock(GetShardLock<DisplayModeKHRWrapper>());
+
     for (const auto physical_device_entry : wrapper->child_physical_devices)
     {
         for (const auto display_entry : physical_device_entry->child_displays)
@@ -995,6 +1249,8 @@ void VulkanStateTracker::DestroyState(DeviceWrapper* wrapper)
 
     // Queues are not explicitly destroyed, so need to be removed from the state tracker when their parent device is
     // destroyed.
+    std::unique_lock<std::mutex> lock(GetShardLock<QueueWrapper>());
+
     for (const auto& entry : wrapper->child_queues)
     {
         state_table_.RemoveWrapper(entry);
@@ -1008,6 +1264,8 @@ void VulkanStateTracker::DestroyState(CommandPoolWrapper* wrapper)
 
     // Destroying the pool implicitly destroys objects allocated from the pool, which need to be removed from state
     // tracking.
+    std::unique_lock<std::mutex> lock(GetShardLock<CommandBufferWrapper>());
+
     for (const auto& entry : wrapper->child_buffers)
     {
         state_table_.RemoveWrapper(entry.second);
@@ -1021,6 +1279,8 @@ void VulkanStateTracker::DestroyState(DescriptorPoolWrapper* wrapper)
 
     // Destroying the pool implicitly destroys objects allocated from the pool, which need to be removed from state
     // tracking.
+    std::unique_lock<std::mutex> lock(GetShardLock<DescriptorSetWrapper>());
+
     for (const auto& entry : wrapper->child_sets)
     {
         state_table_.RemoveWrapper(entry.second);
@@ -1034,6 +1294,8 @@ void VulkanStateTracker::DestroyState(SwapchainKHRWrapper* wrapper)
 
     // Swapchain images are not explicitly destroyed, so need to be removed from state tracking when the parent
     // swapchain is destroyed.
+    std::unique_lock<std::mutex> lock(GetShardLock<ImageWrapper>());
+
     for (auto entry : wrapper->child_images)
     {
         state_table_.RemoveWrapper(entry);
@@ -35,6 +35,7 @@
 #include <cassert>
 #include <functional>
 #include <mutex>
+#include <type_traits>
 
 GFXRECON_BEGIN_NAMESPACE(gfxrecon)
 GFXRECON_BEGIN_NAMESPACE(encode)
@@ -46,14 +47,12 @@ class VulkanStateTracker
 
     ~VulkanStateTracker();
 
-    void WriteState(VulkanStateWriter* writer, uint64_t frame_number)
-    {
-        if (writer != nullptr)
-        {
-            std::unique_lock<std::mutex> lock(mutex_);
-            writer->WriteState(state_table_, frame_number);
-        }
-    }
+    // Track the buffers, images, and memory that are modified between state snapshots, so that each snapshot after the
+    // first only writes the data for resources that were modified after the previous snapshot, and references the data
+    // written by earlier snapshots for the rest.  Must be called before any state is tracked.
+    void EnableIncrementalSnapshots() { incremental_snapshots_ = true; }
+
+    void WriteState(VulkanStateWriter* writer, uint64_t frame_number);
 
     template <typename ParentHandle, typename Wrapper, typename CreateInfo>
     void AddEntry(ParentHandle                    parent_handle,
@@ -70,7 +69,7 @@ class VulkanStateTracker
             auto wrapper = reinterpret_cast<Wrapper*>(*new_handle);
 
             {
-                std::unique_lock<std::mutex> lock(mutex_);
+                std::unique_lock<std::mutex> lock(GetShardLock<Wrapper>());
 
                 // Adds the handle wrapper to the object state table, filtering for duplicate handle retrieval.
                 if (state_table_.InsertWrapper(wrapper->handle_id, wrapper))
@@ -102,7 +101,7 @@ class VulkanStateTracker
             create_parameter_buffer->GetData(), create_parameter_buffer->GetDataSize());
 
         {
-            std::unique_lock<std::mutex> lock(mutex_);
+            std::unique_lock<std::mutex> lock(GetShardLock<Wrapper>());
 
             for (uint32_t i = 0; i < count; ++i)
             {
@@ -136,7 +135,15 @@ class VulkanStateTracker
             create_parameter_buffer->GetData(), create_parameter_buffer->GetDataSize());
 
         {
-            std::unique_lock<std::mutex> lock(mutex_);
+            // Swapchain images update the acquire state of their parent swapchain, which is guarded by the swapchain
+            // shard; it is ordered before the image shard.
+            std::unique_lock<std::mutex> swapchain_lock(GetShardLock<SwapchainKHRWrapper>(), std::defer_lock);
+            if (std::is_same<Wrapper, ImageWrapper>::value)
+            {
+                swapchain_lock.lock();
+            }
+
+            std::unique_lock<std::mutex> lock(GetShardLock<Wrapper>());
 
             AddGroupHandles<ParentHandle, SecondaryHandle, Wrapper, CreateInfo>(
                 parent_handle, secondary_handle, count, new_handles, create_infos, create_call_id, create_parameters);
@@ -159,7 +166,7 @@ class VulkanStateTracker
             create_parameter_buffer->GetData(), create_parameter_buffer->GetDataSize());
 
         {
-            std::unique_lock<std::mutex> lock(mutex_);
+            std::unique_lock<std::mutex> lock(GetShardLock<Wrapper>());
 
             for (uint32_t i = 0; i < count; ++i)
             {
@@ -192,7 +199,7 @@ class VulkanStateTracker
             create_parameter_buffer->GetData(), create_parameter_buffer->GetDataSize());
 
         {
-            std::unique_lock<std::mutex> lock(mutex_);
+            std::unique_lock<std::mutex> lock(GetShardLock<PhysicalDeviceWrapper>());
 
             for (uint32_t i = 0; i < count; ++i)
             {
@@ -214,7 +221,7 @@ class VulkanStateTracker
         {
             auto wrapper = reinterpret_cast<Wrapper*>(handle);
 
-            std::unique_lock<std::mutex> lock(mutex_);
+            std::unique_lock<std::mutex> lock(GetShardLock<Wrapper>());
 
             if (!state_table_.RemoveWrapper(wrapper))
             {
@@ -234,7 +241,8 @@ class VulkanStateTracker
         {
             auto wrapper = reinterpret_cast<CommandBufferWrapper*>(command_buffer);
 
-            std::unique_lock<std::mutex> lock(mutex_);
+            // Command recording only needs to synchronize with other access to the same command buffer.
+            std::unique_lock<std::mutex> lock(wrapper->state_lock);
             TrackCommandExecution(wrapper, call_id, parameter_buffer);
         }
     }
@@ -250,7 +258,7 @@ class VulkanStateTracker
         {
             auto wrapper = reinterpret_cast<CommandBufferWrapper*>(command_buffer);
 
-            std::unique_lock<std::mutex> lock(mutex_);
+            std::unique_lock<std::mutex> lock(wrapper->state_lock);
             TrackCommandExecution(wrapper, call_id, parameter_buffer);
             func(wrapper, args...);
         }
@@ -397,10 +405,30 @@ class VulkanStateTracker
         }
     }
 
+    template <typename Wrapper>
+    std::mutex& GetShardLock()
+    {
+        return shard_locks_[VulkanStateTable::GetShardIndex(static_cast<const Wrapper*>(nullptr))];
+    }
+
+    // Requires the command buffer wrapper's state_lock to be held.
     void TrackCommandExecution(CommandBufferWrapper*           wrapper,
                                format::ApiCallId               call_id,
                                const util::MemoryOutputStream* parameter_buffer);
 
+    // Requires the command buffer wrapper's state_lock to be held.
+    void ResetCommandBufferState(CommandBufferWrapper* wrapper);
+
+    // Marks the buffers and images that may be written by the commands recorded to a submitted command buffer as
+    // modified at the current generation.  Requires the command buffer wrapper's state_lock to be held, along with the
+    // Buffer, BufferView, Image, ImageView, DescriptorSet, Framebuffer, and CommandBuffer shard locks.
+    void MarkCommandBufferResources(const CommandBufferWrapper* wrapper);
+
+    // Marks the buffers and images that are bound to memory overlapping a buffer or image that was modified at the
+    // current generation, as writes through one resource modify the content of the resources that alias its memory.
+    // Requires all shard locks to be held.
+    void MarkAliasedResources();
+
     template <typename Wrapper>
     void DestroyState(Wrapper* wrapper)
     {
@@ -419,8 +447,17 @@ class VulkanStateTracker
     void DestroyState(SwapchainKHRWrapper* wrapper);
 
   private:
-    std::mutex       mutex_;
+    // Each shard lock guards the state table entries for one handle type, along with the tracked state of the wrappers
+    // of that type.  Command buffer recording state is guarded by the per-wrapper CommandBufferWrapper::state_lock,
+    // which is always acquired after any shard locks.
+    std::mutex       shard_locks_[VulkanStateTable::NumShards];
     VulkanStateTable state_table_;
+
+    // Incremental state snapshot support.  The modification generation is incremented by WriteState while all shard
+    // locks are held, so it may be read by any thread that holds at least one shard lock.
+    bool                       incremental_snapshots_;
+    uint64_t                   modification_generation_;
+    VulkanStateSnapshotHistory snapshot_history_;
 };
 
 GFXRECON_END_NAMESPACE(encode)
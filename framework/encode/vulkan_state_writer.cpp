@@ -19,10 +19,13 @@
 #include "encode/struct_pointer_encoder.h"
 #include "encode/vulkan_state_info.h"
 #include "format/format_util.h"
+#include "util/file_path.h"
+#include "util/hash.h"
 #include "util/logging.h"
 
 #include <algorithm>
 #include <cassert>
+#include <cstring>
 #include <limits>
 #include <unordered_map>
 
@@ -31,6 +34,14 @@ GFXRECON_BEGIN_NAMESPACE(encode)
 
 const uint32_t kDefaultQueueFamilyIndex = 0;
 
+// Limits for the number of staging buffers used to pipeline resource memory copies, and their combined size.
+const size_t       kMaxStagingCopies     = 3;
+const VkDeviceSize kMaxStagingCopiesSize = 256 * 1024 * 1024;
+
+// Limit for the combined size of the resource data that is copied so that later resources can be compared with it
+// for deduplication.  Resources without a copy are only compared with resources from the same batch.
+const size_t kMaxRetainedContentSize = 64 * 1024 * 1024;
+
 // Temporary resource IDs for state processing.
 const format::HandleId kTempQueueId         = std::numeric_limits<format::HandleId>::max() - 1;
 const format::HandleId kTempCommandPoolId   = std::numeric_limits<format::HandleId>::max() - 2;
@@ -70,11 +81,12 @@ static bool IsImageReadable(VkMemoryPropertyFlags      property_flags,
                                                    (memory_wrapper->mapped_size == VK_WHOLE_SIZE)))));
 }
 
-VulkanStateWriter::VulkanStateWriter(util::FileOutputStream* output_stream,
-                                     util::Compressor*       compressor,
-                                     format::ThreadId        thread_id) :
+VulkanStateWriter::VulkanStateWriter(util::OutputStream* output_stream,
+                                     util::Compressor*   compressor,
+                                     format::ThreadId    thread_id) :
     output_stream_(output_stream),
-    compressor_(compressor), thread_id_(thread_id), encoder_(&parameter_stream_)
+    compressor_(compressor), thread_id_(thread_id), encoder_(&parameter_stream_), snapshot_history_(nullptr),
+    next_staging_copy_(0), thread_pool_(nullptr), retained_content_size_(0)
 {
     assert(output_stream != nullptr);
     assert(compressor != nullptr);
@@ -84,6 +96,22 @@ VulkanStateWriter::~VulkanStateWriter() {}
 
 void VulkanStateWriter::WriteState(const VulkanStateTable& state_table, uint64_t frame_number)
 {
+    WriteState(state_table, frame_number, 0, nullptr);
+}
+
+void VulkanStateWriter::WriteState(const VulkanStateTable&     state_table,
+                                   uint64_t                    frame_number,
+                                   uint64_t                    generation,
+                                   VulkanStateSnapshotHistory* history)
+{
+    // Resource data can only be referenced by a later snapshot when the name of the file that it is written to is
+    // known.  Without a filename, a full snapshot is written and the history is left unchanged.
+    if ((history != nullptr) && !capture_filename_.empty())
+    {
+        snapshot_history_ = history;
+        snapshot_history_->filenames.push_back(capture_filename_);
+    }
+
     // clang-format off
 
     format::Marker marker;
@@ -164,6 +192,15 @@ void VulkanStateWriter::WriteState(const VulkanStateTable& state_table, uint64_t
     output_stream_->Write(&marker, sizeof(marker));
 
     // clang-format on
+
+    if (snapshot_history_ != nullptr)
+    {
+        // Entries for resources that were destroyed since the previous snapshot are dropped with the previous table.
+        snapshot_history_->generation = generation;
+        snapshot_history_->resources.swap(snapshot_resources_);
+        snapshot_resources_.clear();
+        snapshot_history_ = nullptr;
+    }
 }
 
 void VulkanStateWriter::WritePhysicalDeviceState(const VulkanStateTable& state_table)
@@ -776,11 +813,7 @@ void VulkanStateWriter::WriteSwapchainKhrState(const VulkanStateTable& state_tab
 void VulkanStateWriter::ProcessBufferMemory(const DeviceWrapper*                   device_wrapper,
                                             const std::vector<BufferSnapshotInfo>& buffer_snapshot_info,
                                             uint32_t                               queue_family_index,
-                                            VkQueue                                queue,
-                                            VkCommandBuffer                        command_buffer,
-                                            VkBuffer                               staging_buffer,
-                                            VkDeviceMemory                         staging_memory,
-                                            bool                                   is_staging_memory_coherent)
+                                            VkQueue                                queue)
 {
     assert(device_wrapper != nullptr);
 
@@ -790,18 +823,28 @@ void VulkanStateWriter::ProcessBufferMemory(const DeviceWrapper*
     {
         const BufferWrapper*       buffer_wrapper = snapshot_entry.buffer_wrapper;
         const DeviceMemoryWrapper* memory_wrapper = snapshot_entry.memory_wrapper;
-        const uint8_t*             bytes          = nullptr;
 
         assert((buffer_wrapper != nullptr) && (memory_wrapper != nullptr));
 
+        if (snapshot_entry.is_unmodified)
+        {
+            WriteInitResourceReferenceCmd(device_wrapper->handle_id, buffer_wrapper->handle_id, 0);
+            RecordSnapshotResource(buffer_wrapper->handle_id, 0, 0, true);
+            continue;
+        }
+
         if (snapshot_entry.need_staging_copy)
         {
+            // The buffer data is written when the copy completes, while the GPU is copying the resources that follow.
+            StagingCopy* staging_copy = AcquireStagingCopy(device_wrapper);
+            assert(staging_copy != nullptr);
+
             VkCommandBufferBeginInfo begin_info = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO };
             begin_info.pNext                    = nullptr;
             begin_info.flags                    = 0;
             begin_info.pInheritanceInfo         = nullptr;
 
-            VkResult result = device_table->BeginCommandBuffer(command_buffer, &begin_info);
+            VkResult result = device_table->BeginCommandBuffer(staging_copy->command_buffer, &begin_info);
 
             if (result == VK_SUCCESS)
             {
@@ -810,36 +853,37 @@ void VulkanStateWriter::ProcessBufferMemory(const DeviceWrapper*
                 copy_region.dstOffset = 0;
                 copy_region.size      = buffer_wrapper->created_size;
 
-                device_table->CmdCopyBuffer(command_buffer, buffer_wrapper->handle, staging_buffer, 1, &copy_region);
-                device_table->EndCommandBuffer(command_buffer);
+                device_table->CmdCopyBuffer(
+                    staging_copy->command_buffer, buffer_wrapper->handle, staging_copy->buffer, 1, &copy_region);
+                device_table->EndCommandBuffer(staging_copy->command_buffer);
 
-                result = SubmitCommandBuffer(queue, command_buffer, device_table);
-                if (result == VK_SUCCESS)
-                {
-                    void* data = nullptr;
-                    result     = device_table->MapMemory(
-                        device_wrapper->handle, staging_memory, 0, buffer_wrapper->created_size, 0, &data);
-                    if (result == VK_SUCCESS)
-                    {
-                        bytes = reinterpret_cast<uint8_t*>(data);
+                result = SubmitStagingCopy(queue, staging_copy, device_table);
+            }
 
-                        if (!is_staging_memory_coherent)
-                        {
-                            InvalidateMappedMemoryRange(
-                                device_wrapper, staging_memory, 0, buffer_wrapper->created_size);
-                        }
-                    }
-                }
+            if (result == VK_SUCCESS)
+            {
+                staging_copy->buffer_info = &snapshot_entry;
+            }
+            else
+            {
+                AddBufferData(device_wrapper, buffer_wrapper, nullptr, VK_NULL_HANDLE);
             }
         }
         else
         {
             assert((memory_wrapper->mapped_data == nullptr) || (memory_wrapper->mapped_offset == 0));
 
-            VkResult result = VK_SUCCESS;
+            const uint8_t* bytes  = nullptr;
+            VkResult       result = VK_SUCCESS;
 
             if (memory_wrapper->mapped_data == nullptr)
             {
+                if (IsPendingUnmap(memory_wrapper->handle))
+                {
+                    // The memory is still mapped for a resource that shares the memory allocation.
+                    FlushResourceData();
+                }
+
                 void* data = nullptr;
                 result     = device_table->MapMemory(device_wrapper->handle,
                                                  memory_wrapper->handle,
@@ -862,58 +906,15 @@ void VulkanStateWriter::ProcessBufferMemory(const DeviceWrapper*
                 InvalidateMappedMemoryRange(
                     device_wrapper, memory_wrapper->handle, buffer_wrapper->bind_offset, buffer_wrapper->created_size);
             }
-        }
-
-        if (bytes != nullptr)
-        {
-            GFXRECON_CHECK_CONVERSION_DATA_LOSS(size_t, buffer_wrapper->created_size);
-
-            size_t                          data_size = static_cast<size_t>(buffer_wrapper->created_size);
-            format::InitBufferCommandHeader upload_cmd;
-
-            upload_cmd.meta_header.block_header.type = format::kMetaDataBlock;
-            upload_cmd.meta_header.meta_data_type    = format::kInitBufferCommand;
-            upload_cmd.thread_id                     = thread_id_;
-            upload_cmd.device_id                     = device_wrapper->handle_id;
-            upload_cmd.buffer_id                     = buffer_wrapper->handle_id;
-            upload_cmd.data_size                     = data_size;
 
-            if (compressor_ != nullptr)
+            // Memory that was mapped for the snapshot is unmapped after the data has been written.
+            VkDeviceMemory unmap_memory = VK_NULL_HANDLE;
+            if ((bytes != nullptr) && (memory_wrapper->mapped_data == nullptr))
             {
-                size_t compressed_size = compressor_->Compress(data_size, bytes, &compressed_parameter_buffer_);
-
-                if ((compressed_size > 0) && (compressed_size < data_size))
-                {
-                    upload_cmd.meta_header.block_header.type = format::BlockType::kCompressedMetaDataBlock;
-
-                    bytes     = compressed_parameter_buffer_.data();
-                    data_size = compressed_size;
-                }
+                unmap_memory = memory_wrapper->handle;
             }
 
-            // Calculate size of packet with compressed or uncompressed data size.
-            upload_cmd.meta_header.block_header.size =
-                (sizeof(upload_cmd) - sizeof(upload_cmd.meta_header.block_header)) + data_size;
-
-            output_stream_->Write(&upload_cmd, sizeof(upload_cmd));
-            output_stream_->Write(bytes, data_size);
-
-            if (snapshot_entry.need_staging_copy)
-            {
-                device_table->UnmapMemory(device_wrapper->handle, staging_memory);
-            }
-            else
-            {
-                if (memory_wrapper->mapped_data == nullptr)
-                {
-                    device_table->UnmapMemory(device_wrapper->handle, memory_wrapper->handle);
-                }
-            }
-        }
-        else
-        {
-            GFXRECON_LOG_ERROR("Trimming state snapshot failed to retrieve memory content for buffer %" PRIu64,
-                               buffer_wrapper->handle_id);
+            AddBufferData(device_wrapper, buffer_wrapper, bytes, unmap_memory);
         }
     }
 }
@@ -922,10 +923,6 @@ void VulkanStateWriter::ProcessImageMemory(const DeviceWrapper*
                                            const std::vector<ImageSnapshotInfo>& image_snapshot_info,
                                            uint32_t                              queue_family_index,
                                            VkQueue                               queue,
-                                           VkCommandBuffer                       command_buffer,
-                                           VkBuffer                              staging_buffer,
-                                           VkDeviceMemory                        staging_memory,
-                                           bool                                  is_staging_memory_coherent,
                                            const VulkanStateTable&               state_table)
 {
     assert(device_wrapper != nullptr);
@@ -936,15 +933,30 @@ void VulkanStateWriter::ProcessImageMemory(const DeviceWrapper*
     {
         const ImageWrapper*        image_wrapper  = snapshot_entry.image_wrapper;
         const DeviceMemoryWrapper* memory_wrapper = snapshot_entry.memory_wrapper;
-        const uint8_t*             bytes          = nullptr;
 
         assert((image_wrapper != nullptr) && (memory_wrapper != nullptr));
 
+        if (snapshot_entry.is_unmodified)
+        {
+            WriteInitResourceReferenceCmd(
+                device_wrapper->handle_id, image_wrapper->handle_id, static_cast<uint32_t>(snapshot_entry.aspect));
+            RecordSnapshotResource(image_wrapper->handle_id,
+                                   static_cast<uint32_t>(snapshot_entry.aspect),
+                                   static_cast<uint32_t>(image_wrapper->current_layout),
+                                   true);
+            continue;
+        }
+
         if (snapshot_entry.need_staging_copy)
         {
-            VkImage        resolve_image  = VK_NULL_HANDLE;
-            VkDeviceMemory resolve_memory = VK_NULL_HANDLE;
-            VkResult       result         = VK_SUCCESS;
+            // The image data is written when the copy completes, while the GPU is copying the resources that follow.
+            StagingCopy* staging_copy = AcquireStagingCopy(device_wrapper);
+            assert(staging_copy != nullptr);
+
+            VkCommandBuffer command_buffer = staging_copy->command_buffer;
+            VkImage         resolve_image  = VK_NULL_HANDLE;
+            VkDeviceMemory  resolve_memory = VK_NULL_HANDLE;
+            VkResult        result         = VK_SUCCESS;
 
             if (image_wrapper->samples != VK_SAMPLE_COUNT_1_BIT)
             {
@@ -954,6 +966,7 @@ void VulkanStateWriter::ProcessImageMemory(const DeviceWrapper*
                                           image_wrapper,
                                           queue,
                                           command_buffer,
+                                          staging_copy->fence,
                                           &resolve_image,
                                           &resolve_memory,
                                           state_table);
@@ -1050,7 +1063,7 @@ void VulkanStateWriter::ProcessImageMemory(const DeviceWrapper*
                     device_table->CmdCopyImageToBuffer(command_buffer,
                                                        copy_image,
                                                        VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
-                                                       staging_buffer,
+                                                       staging_copy->buffer,
                                                        static_cast<uint32_t>(copy_regions.size()),
                                                        copy_regions.data());
 
@@ -1078,32 +1091,26 @@ void VulkanStateWriter::ProcessImageMemory(const DeviceWrapper*
 
                     device_table->EndCommandBuffer(command_buffer);
 
-                    result = SubmitCommandBuffer(queue, command_buffer, device_table);
-
-                    if (result == VK_SUCCESS)
-                    {
-                        void* data = nullptr;
-                        result     = device_table->MapMemory(
-                            device_wrapper->handle, staging_memory, 0, snapshot_entry.resource_size, 0, &data);
-
-                        if (result == VK_SUCCESS)
-                        {
-                            bytes = reinterpret_cast<uint8_t*>(data);
-
-                            if (!is_staging_memory_coherent)
-                            {
-                                InvalidateMappedMemoryRange(
-                                    device_wrapper, staging_memory, 0, snapshot_entry.resource_size);
-                            }
-                        }
-                    }
+                    result = SubmitStagingCopy(queue, staging_copy, device_table);
                 }
+            }
 
-                if (image_wrapper->samples != VK_SAMPLE_COUNT_1_BIT)
+            if (result == VK_SUCCESS)
+            {
+                // The resolved image is destroyed after the copy completes.
+                staging_copy->image_info     = &snapshot_entry;
+                staging_copy->resolve_image  = resolve_image;
+                staging_copy->resolve_memory = resolve_memory;
+            }
+            else
+            {
+                if (resolve_image != VK_NULL_HANDLE)
                 {
                     device_table->DestroyImage(device_wrapper->handle, resolve_image, nullptr);
                     device_table->FreeMemory(device_wrapper->handle, resolve_memory, nullptr);
                 }
+
+                AddImageData(device_wrapper, snapshot_entry, nullptr, VK_NULL_HANDLE);
             }
         }
         else
@@ -1111,10 +1118,17 @@ void VulkanStateWriter::ProcessImageMemory(const DeviceWrapper*
             assert((memory_wrapper != nullptr) &&
                    ((memory_wrapper->mapped_data == nullptr) || (memory_wrapper->mapped_offset == 0)));
 
-            VkResult result = VK_SUCCESS;
+            const uint8_t* bytes  = nullptr;
+            VkResult       result = VK_SUCCESS;
 
             if (memory_wrapper->mapped_data == nullptr)
             {
+                if (IsPendingUnmap(memory_wrapper->handle))
+                {
+                    // The memory is still mapped for a resource that shares the memory allocation.
+                    FlushResourceData();
+                }
+
                 void* data = nullptr;
                 result     = device_table->MapMemory(device_wrapper->handle,
                                                  memory_wrapper->handle,
@@ -1137,76 +1151,549 @@ void VulkanStateWriter::ProcessImageMemory(const DeviceWrapper*
                 InvalidateMappedMemoryRange(
                     device_wrapper, memory_wrapper->handle, image_wrapper->bind_offset, snapshot_entry.resource_size);
             }
+
+            // Memory that was mapped for the snapshot is unmapped after the data has been written.
+            VkDeviceMemory unmap_memory = VK_NULL_HANDLE;
+            if ((bytes != nullptr) && (memory_wrapper->mapped_data == nullptr))
+            {
+                unmap_memory = memory_wrapper->handle;
+            }
+
+            AddImageData(device_wrapper, snapshot_entry, bytes, unmap_memory);
         }
+    }
+}
+
+void VulkanStateWriter::AddBufferData(const DeviceWrapper* device_wrapper,
+                                      const BufferWrapper* buffer_wrapper,
+                                      const uint8_t*       bytes,
+                                      VkDeviceMemory       unmap_memory)
+{
+    assert((device_wrapper != nullptr) && (buffer_wrapper != nullptr));
 
-        format::InitImageCommandHeader upload_cmd;
+    GFXRECON_CHECK_CONVERSION_DATA_LOSS(size_t, buffer_wrapper->created_size);
 
-        // Packet size without the resource data.
-        upload_cmd.meta_header.block_header.size = (sizeof(upload_cmd) - sizeof(upload_cmd.meta_header.block_header));
-        upload_cmd.meta_header.block_header.type = format::kMetaDataBlock;
-        upload_cmd.meta_header.meta_data_type    = format::kInitImageCommand;
-        upload_cmd.thread_id                     = thread_id_;
-        upload_cmd.device_id                     = device_wrapper->handle_id;
-        upload_cmd.image_id                      = image_wrapper->handle_id;
-        upload_cmd.aspect                        = snapshot_entry.aspect;
-        upload_cmd.layout                        = image_wrapper->current_layout;
+    ResourceData resource_data;
+    resource_data.device_wrapper = device_wrapper;
+    resource_data.buffer_wrapper = buffer_wrapper;
+    resource_data.bytes          = bytes;
+    resource_data.data_size      = static_cast<size_t>(buffer_wrapper->created_size);
+    resource_data.unmap_memory   = unmap_memory;
 
-        if (bytes != nullptr)
+    pending_resource_data_.push_back(resource_data);
+
+    if (pending_resource_data_.size() >= GetResourceDataBatchSize())
+    {
+        FlushResourceData();
+    }
+}
+
+void VulkanStateWriter::AddImageData(const DeviceWrapper*     device_wrapper,
+                                     const ImageSnapshotInfo& snapshot_entry,
+                                     const uint8_t*           bytes,
+                                     VkDeviceMemory           unmap_memory)
+{
+    assert((device_wrapper != nullptr) && (snapshot_entry.image_wrapper != nullptr));
+
+    GFXRECON_CHECK_CONVERSION_DATA_LOSS(size_t, snapshot_entry.resource_size);
+
+    ResourceData resource_data;
+    resource_data.device_wrapper = device_wrapper;
+    resource_data.image_info     = &snapshot_entry;
+    resource_data.bytes          = bytes;
+    resource_data.data_size      = static_cast<size_t>(snapshot_entry.resource_size);
+    resource_data.unmap_memory   = unmap_memory;
+
+    pending_resource_data_.push_back(resource_data);
+
+    if (pending_resource_data_.size() >= GetResourceDataBatchSize())
+    {
+        FlushResourceData();
+    }
+}
+
+size_t VulkanStateWriter::GetResourceDataBatchSize() const
+{
+    return (thread_pool_ != nullptr) ? thread_pool_->GetThreadCount() : 1;
+}
+
+bool VulkanStateWriter::IsPendingUnmap(VkDeviceMemory memory) const
+{
+    for (const auto& resource_data : pending_resource_data_)
+    {
+        if (resource_data.unmap_memory == memory)
         {
-            GFXRECON_CHECK_CONVERSION_DATA_LOSS(size_t, snapshot_entry.resource_size);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void VulkanStateWriter::FlushResourceData()
+{
+    size_t data_count = pending_resource_data_.size();
 
-            size_t data_size = static_cast<size_t>(snapshot_entry.resource_size);
+    if (data_count > 0)
+    {
+        if (resource_data_buffers_.size() < data_count)
+        {
+            resource_data_buffers_.resize(data_count);
+        }
 
-            // Store uncompressed data size in packet.
-            upload_cmd.data_size   = data_size;
-            upload_cmd.level_count = image_wrapper->mip_levels;
+        RunResourceDataTasks(data_count, [this](size_t index) {
+            auto& resource_data = pending_resource_data_[index];
 
-            if (compressor_ != nullptr)
+            if (resource_data.bytes != nullptr)
             {
-                size_t compressed_size = compressor_->Compress(data_size, bytes, &compressed_parameter_buffer_);
+                resource_data.content_hash =
+                    util::hash::ComputeHash64(resource_data.bytes, resource_data.data_size);
+            }
+        });
 
-                if ((compressed_size > 0) && (compressed_size < data_size))
-                {
-                    upload_cmd.meta_header.block_header.type = format::BlockType::kCompressedMetaDataBlock;
+        // Duplicates are found in the order that the resource data was added, so that the source of a duplicate is
+        // always written before the duplicate.
+        for (auto& resource_data : pending_resource_data_)
+        {
+            FindDuplicateResourceData(&resource_data);
+        }
+
+        if (compressor_ != nullptr)
+        {
+            RunResourceDataTasks(data_count, [this](size_t index) {
+                auto& resource_data = pending_resource_data_[index];
 
-                    bytes     = compressed_parameter_buffer_.data();
-                    data_size = compressed_size;
+                if ((resource_data.bytes != nullptr) && !resource_data.is_duplicate)
+                {
+                    resource_data.compressed_size = compressor_->Compress(
+                        resource_data.data_size, resource_data.bytes, &resource_data_buffers_[index]);
                 }
+            });
+        }
+
+        // Blocks are written in the order that the resource data was added.
+        for (size_t i = 0; i < data_count; ++i)
+        {
+            const auto& resource_data = pending_resource_data_[i];
+
+            if (resource_data.is_duplicate)
+            {
+                WriteInitDuplicateResourceCmd(resource_data);
+            }
+            else if (resource_data.buffer_wrapper != nullptr)
+            {
+                WriteBufferData(resource_data, resource_data_buffers_[i].data());
+            }
+            else
+            {
+                WriteImageData(resource_data, resource_data_buffers_[i].data());
+            }
+
+            if (resource_data.unmap_memory != VK_NULL_HANDLE)
+            {
+                const DeviceWrapper* device_wrapper = resource_data.device_wrapper;
+                device_wrapper->layer_table.UnmapMemory(device_wrapper->handle, resource_data.unmap_memory);
             }
+        }
+
+        // The pending resource data is no longer valid after it has been written.
+        for (auto content_hash : pending_content_hashes_)
+        {
+            resource_contents_.erase(content_hash);
+        }
+
+        pending_content_hashes_.clear();
+        pending_resource_data_.clear();
+    }
+}
+
+void VulkanStateWriter::RunResourceDataTasks(size_t task_count, const util::ThreadPool::TaskFunc& task)
+{
+    if ((thread_pool_ != nullptr) && (task_count > 1))
+    {
+        thread_pool_->Run(task_count, task);
+    }
+    else
+    {
+        for (size_t i = 0; i < task_count; ++i)
+        {
+            task(i);
+        }
+    }
+}
+
+void VulkanStateWriter::FindDuplicateResourceData(ResourceData* resource_data)
+{
+    assert(resource_data != nullptr);
+
+    if (resource_data->bytes != nullptr)
+    {
+        ResourceContent content;
+        content.data_size = resource_data->data_size;
+
+        if (resource_data->buffer_wrapper != nullptr)
+        {
+            content.resource_id = resource_data->buffer_wrapper->handle_id;
+        }
+        else
+        {
+            assert(resource_data->image_info != nullptr);
 
-            // Calculate size of packet with compressed or uncompressed data size.
-            assert(!snapshot_entry.level_sizes.empty() &&
-                   (snapshot_entry.level_sizes.size() == upload_cmd.level_count));
-            size_t levels_size = snapshot_entry.level_sizes.size() * sizeof(snapshot_entry.level_sizes[0]);
+            content.resource_id = resource_data->image_info->image_wrapper->handle_id;
+            content.aspect      = resource_data->image_info->aspect;
+            content.level_sizes = &resource_data->image_info->level_sizes;
+        }
 
-            upload_cmd.meta_header.block_header.size += levels_size + data_size;
+        auto entry = resource_contents_.find(resource_data->content_hash);
 
-            output_stream_->Write(&upload_cmd, sizeof(upload_cmd));
-            output_stream_->Write(snapshot_entry.level_sizes.data(), levels_size);
-            output_stream_->Write(bytes, data_size);
+        if (entry == resource_contents_.end())
+        {
+            ResourceContent& source = resource_contents_[resource_data->content_hash];
+            source                  = std::move(content);
 
-            if (snapshot_entry.need_staging_copy)
+            if ((retained_content_size_ + source.data_size) <= kMaxRetainedContentSize)
             {
-                device_table->UnmapMemory(device_wrapper->handle, staging_memory);
+                source.retained_data.assign(resource_data->bytes, resource_data->bytes + source.data_size);
+                source.bytes = source.retained_data.data();
+                retained_content_size_ += source.data_size;
             }
             else
             {
-                if (memory_wrapper->mapped_data == nullptr)
+                source.bytes = resource_data->bytes;
+                pending_content_hashes_.push_back(resource_data->content_hash);
+            }
+        }
+        else
+        {
+            const ResourceContent& source = entry->second;
+
+            // The duplicate is initialized from the source's init block, so the blocks must have the same structure as
+            // well as the same data.  The data is compared because different data can produce the same hash.
+            // Resources with a matching hash that fail the check are written normally.
+            if ((source.data_size == content.data_size) && (source.aspect == content.aspect) &&
+                ((source.level_sizes == nullptr) == (content.level_sizes == nullptr)) &&
+                ((content.level_sizes == nullptr) || (*source.level_sizes == *content.level_sizes)) &&
+                (memcmp(source.bytes, resource_data->bytes, content.data_size) == 0))
+            {
+                resource_data->is_duplicate = true;
+                resource_data->source_id    = source.resource_id;
+            }
+        }
+    }
+}
+
+void VulkanStateWriter::WriteBufferData(const ResourceData& resource_data, const uint8_t* compressed_data)
+{
+    const BufferWrapper* buffer_wrapper = resource_data.buffer_wrapper;
+    const uint8_t*       bytes          = resource_data.bytes;
+
+    assert(buffer_wrapper != nullptr);
+
+    if (bytes != nullptr)
+    {
+        size_t                          data_size = resource_data.data_size;
+        format::InitBufferCommandHeader upload_cmd;
+
+        upload_cmd.meta_header.block_header.type = format::kMetaDataBlock;
+        upload_cmd.meta_header.meta_data_type    = format::kInitBufferCommand;
+        upload_cmd.thread_id                     = thread_id_;
+        upload_cmd.device_id                     = resource_data.device_wrapper->handle_id;
+        upload_cmd.buffer_id                     = buffer_wrapper->handle_id;
+        upload_cmd.data_size                     = data_size;
+
+        if ((resource_data.compressed_size > 0) && (resource_data.compressed_size < data_size))
+        {
+            upload_cmd.meta_header.block_header.type = format::BlockType::kCompressedMetaDataBlock;
+
+            bytes     = compressed_data;
+            data_size = resource_data.compressed_size;
+        }
+
+        // Calculate size of packet with compressed or uncompressed data size.
+        upload_cmd.meta_header.block_header.size =
+            (sizeof(upload_cmd) - sizeof(upload_cmd.meta_header.block_header)) + data_size;
+
+        output_stream_->Write(&upload_cmd, sizeof(upload_cmd));
+        output_stream_->Write(bytes, data_size);
+
+        RecordSnapshotResource(buffer_wrapper->handle_id, 0, 0, false);
+    }
+    else
+    {
+        GFXRECON_LOG_ERROR("Trimming state snapshot failed to retrieve memory content for buffer %" PRIu64,
+                           buffer_wrapper->handle_id);
+    }
+}
+
+void VulkanStateWriter::WriteImageData(const ResourceData& resource_data, const uint8_t* compressed_data)
+{
+    assert(resource_data.image_info != nullptr);
+
+    const ImageSnapshotInfo& snapshot_entry = *resource_data.image_info;
+    const ImageWrapper*      image_wrapper  = snapshot_entry.image_wrapper;
+    const uint8_t*           bytes          = resource_data.bytes;
+
+    format::InitImageCommandHeader upload_cmd;
+
+    // Packet size without the resource data.
+    upload_cmd.meta_header.block_header.size = (sizeof(upload_cmd) - sizeof(upload_cmd.meta_header.block_header));
+    upload_cmd.meta_header.block_header.type = format::kMetaDataBlock;
+    upload_cmd.meta_header.meta_data_type    = format::kInitImageCommand;
+    upload_cmd.thread_id                     = thread_id_;
+    upload_cmd.device_id                     = resource_data.device_wrapper->handle_id;
+    upload_cmd.image_id                      = image_wrapper->handle_id;
+    upload_cmd.aspect                        = snapshot_entry.aspect;
+    upload_cmd.layout                        = image_wrapper->current_layout;
+
+    RecordSnapshotResource(image_wrapper->handle_id, upload_cmd.aspect, upload_cmd.layout, false);
+
+    if (bytes != nullptr)
+    {
+        size_t data_size = resource_data.data_size;
+
+        // Store uncompressed data size in packet.
+        upload_cmd.data_size   = data_size;
+        upload_cmd.level_count = image_wrapper->mip_levels;
+
+        if ((resource_data.compressed_size > 0) && (resource_data.compressed_size < data_size))
+        {
+            upload_cmd.meta_header.block_header.type = format::BlockType::kCompressedMetaDataBlock;
+
+            bytes     = compressed_data;
+            data_size = resource_data.compressed_size;
+        }
+
+        // Calculate size of packet with compressed or uncompressed data size.
+        assert(!snapshot_entry.level_sizes.empty() && (snapshot_entry.level_sizes.size() == upload_cmd.level_count));
+        size_t levels_size = snapshot_entry.level_sizes.size() * sizeof(snapshot_entry.level_sizes[0]);
+
+        upload_cmd.meta_header.block_header.size += levels_size + data_size;
+
+        output_stream_->Write(&upload_cmd, sizeof(upload_cmd));
+        output_stream_->Write(snapshot_entry.level_sizes.data(), levels_size);
+        output_stream_->Write(bytes, data_size);
+    }
+    else
+    {
+        // Write a packet without resource data; replay must still perform a layout transition at image
+        // initialization.
+        upload_cmd.data_size   = 0;
+        upload_cmd.level_count = 0;
+
+        output_stream_->Write(&upload_cmd, sizeof(upload_cmd));
+    }
+}
+
+VkResult VulkanStateWriter::CreateStagingCopies(const DeviceWrapper*    device_wrapper,
+                                                VkDeviceSize            size,
+                                                const VulkanStateTable& state_table)
+{
+    assert((device_wrapper != nullptr) && (size > 0) && staging_copies_.empty());
+
+    const DeviceTable* device_table = &device_wrapper->layer_table;
+
+    // Additional staging buffers are only created while their combined size is within the limit, to bound the amount
+    // of memory used by the snapshot.
+    size_t max_count = kMaxStagingCopies;
+    if (thread_pool_ != nullptr)
+    {
+        // Provide enough staging buffers for the data from one half of the buffers to be compressed in parallel while
+        // the other half are being copied.
+        max_count = std::max(max_count, thread_pool_->GetThreadCount() * 2);
+    }
+
+    size_t count =
+        std::max<size_t>(1, std::min<size_t>(max_count, static_cast<size_t>(kMaxStagingCopiesSize / size)));
+    VkResult result = VK_SUCCESS;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        StagingCopy           staging_copy;
+        VkMemoryPropertyFlags memory_properties = 0;
+
+        result = CreateStagingBuffer(
+            device_wrapper, size, &staging_copy.buffer, &staging_copy.memory, &memory_properties, state_table);
+
+        if (result == VK_SUCCESS)
+        {
+            VkFenceCreateInfo fence_info = { VK_STRUCTURE_TYPE_FENCE_CREATE_INFO };
+            fence_info.pNext             = nullptr;
+            fence_info.flags             = 0;
+
+            result = device_table->CreateFence(device_wrapper->handle, &fence_info, nullptr, &staging_copy.fence);
+
+            if (result == VK_SUCCESS)
+            {
+                // The staging memory remains mapped until all copies have completed.
+                void* data = nullptr;
+                result = device_table->MapMemory(device_wrapper->handle, staging_copy.memory, 0, size, 0, &data);
+
+                if (result == VK_SUCCESS)
                 {
-                    device_table->UnmapMemory(device_wrapper->handle, memory_wrapper->handle);
+                    staging_copy.data        = reinterpret_cast<const uint8_t*>(data);
+                    staging_copy.is_coherent = IsMemoryCoherent(memory_properties);
+                    staging_copies_.push_back(staging_copy);
                 }
+                else
+                {
+                    device_table->DestroyFence(device_wrapper->handle, staging_copy.fence, nullptr);
+                }
+            }
+
+            if (result != VK_SUCCESS)
+            {
+                device_table->DestroyBuffer(device_wrapper->handle, staging_copy.buffer, nullptr);
+                device_table->FreeMemory(device_wrapper->handle, staging_copy.memory, nullptr);
             }
         }
-        else
+
+        if (result != VK_SUCCESS)
+        {
+            break;
+        }
+    }
+
+    next_staging_copy_ = 0;
+
+    // Processing can continue with fewer staging buffers than requested.
+    return staging_copies_.empty() ? result : VK_SUCCESS;
+}
+
+void VulkanStateWriter::DestroyStagingCopies(const DeviceWrapper* device_wrapper)
+{
+    assert(device_wrapper != nullptr);
+
+    const DeviceTable* device_table = &device_wrapper->layer_table;
+
+    for (auto& staging_copy : staging_copies_)
+    {
+        assert((staging_copy.buffer_info == nullptr) && (staging_copy.image_info == nullptr));
+
+        device_table->UnmapMemory(device_wrapper->handle, staging_copy.memory);
+        device_table->DestroyBuffer(device_wrapper->handle, staging_copy.buffer, nullptr);
+        device_table->FreeMemory(device_wrapper->handle, staging_copy.memory, nullptr);
+        device_table->DestroyFence(device_wrapper->handle, staging_copy.fence, nullptr);
+    }
+
+    staging_copies_.clear();
+}
+
+VulkanStateWriter::StagingCopy* VulkanStateWriter::AcquireStagingCopy(const DeviceWrapper* device_wrapper)
+{
+    assert(!staging_copies_.empty());
+
+    // Staging buffers are used in submission order, so the buffer that is reused is the one with the oldest copy.
+    size_t       index        = next_staging_copy_;
+    StagingCopy* staging_copy = &staging_copies_[index];
+    next_staging_copy_        = (next_staging_copy_ + 1) % staging_copies_.size();
+
+    if ((staging_copy->buffer_info != nullptr) || (staging_copy->image_info != nullptr))
+    {
+        // Complete the oldest half of the pending copies, so that their data can be compressed together while the
+        // remaining copies are executing.  The staging buffers cannot be reused until their data has been written.
+        size_t finish_count = std::max<size_t>(1, staging_copies_.size() / 2);
+
+        for (size_t i = 0; i < finish_count; ++i)
+        {
+            StagingCopy* pending_copy = &staging_copies_[(index + i) % staging_copies_.size()];
+
+            if ((pending_copy->buffer_info != nullptr) || (pending_copy->image_info != nullptr))
+            {
+                FinishStagingCopy(device_wrapper, pending_copy);
+            }
+        }
+
+        FlushResourceData();
+    }
+
+    return staging_copy;
+}
+
+VkResult VulkanStateWriter::SubmitStagingCopy(VkQueue queue, StagingCopy* staging_copy, const DeviceTable* device_table)
+{
+    assert((staging_copy != nullptr) && (device_table != nullptr));
+
+    VkSubmitInfo submit_info         = { VK_STRUCTURE_TYPE_SUBMIT_INFO };
+    submit_info.pNext                = nullptr;
+    submit_info.waitSemaphoreCount   = 0;
+    submit_info.pWaitSemaphores      = nullptr;
+    submit_info.pWaitDstStageMask    = nullptr;
+    submit_info.commandBufferCount   = 1;
+    submit_info.pCommandBuffers      = &staging_copy->command_buffer;
+    submit_info.signalSemaphoreCount = 0;
+    submit_info.pSignalSemaphores    = nullptr;
+
+    return device_table->QueueSubmit(queue, 1, &submit_info, staging_copy->fence);
+}
+
+void VulkanStateWriter::FinishStagingCopy(const DeviceWrapper* device_wrapper, StagingCopy* staging_copy)
+{
+    assert((device_wrapper != nullptr) && (staging_copy != nullptr));
+
+    const DeviceTable* device_table = &device_wrapper->layer_table;
+    const uint8_t*     bytes        = nullptr;
+
+    VkResult result = device_table->WaitForFences(
+        device_wrapper->handle, 1, &staging_copy->fence, VK_TRUE, std::numeric_limits<uint64_t>::max());
+    device_table->ResetFences(device_wrapper->handle, 1, &staging_copy->fence);
+
+    if (result == VK_SUCCESS)
+    {
+        bytes = staging_copy->data;
+    }
+
+    if (staging_copy->buffer_info != nullptr)
+    {
+        const BufferWrapper* buffer_wrapper = staging_copy->buffer_info->buffer_wrapper;
+
+        if ((bytes != nullptr) && !staging_copy->is_coherent)
+        {
+            InvalidateMappedMemoryRange(device_wrapper, staging_copy->memory, 0, buffer_wrapper->created_size);
+        }
+
+        AddBufferData(device_wrapper, buffer_wrapper, bytes, VK_NULL_HANDLE);
+    }
+    else
+    {
+        assert(staging_copy->image_info != nullptr);
+
+        if ((bytes != nullptr) && !staging_copy->is_coherent)
+        {
+            InvalidateMappedMemoryRange(
+                device_wrapper, staging_copy->memory, 0, staging_copy->image_info->resource_size);
+        }
+
+        AddImageData(device_wrapper, *staging_copy->image_info, bytes, VK_NULL_HANDLE);
+
+        if (staging_copy->resolve_image != VK_NULL_HANDLE)
         {
-            // Write a packet without resource data; replay must still perform a layout transition at image
-            // initialization.
-            upload_cmd.data_size   = 0;
-            upload_cmd.level_count = 0;
+            device_table->DestroyImage(device_wrapper->handle, staging_copy->resolve_image, nullptr);
+            device_table->FreeMemory(device_wrapper->handle, staging_copy->resolve_memory, nullptr);
+        }
+    }
+
+    staging_copy->buffer_info    = nullptr;
+    staging_copy->image_info     = nullptr;
+    staging_copy->resolve_image  = VK_NULL_HANDLE;
+    staging_copy->resolve_memory = VK_NULL_HANDLE;
+}
+
+void VulkanStateWriter::FinishStagingCopies(const DeviceWrapper* device_wrapper)
+{
+    // Complete the pending copies in submission order, starting with the oldest.
+    for (size_t i = 0; i < staging_copies_.size(); ++i)
+    {
+        StagingCopy* staging_copy = &staging_copies_[(next_staging_copy_ + i) % staging_copies_.size()];
 
-            output_stream_->Write(&upload_cmd, sizeof(upload_cmd));
+        if ((staging_copy->buffer_info != nullptr) || (staging_copy->image_info != nullptr))
+        {
+            FinishStagingCopy(device_wrapper, staging_copy);
         }
     }
+
+    FlushResourceData();
+
+    next_staging_copy_ = 0;
 }
 
 void VulkanStateWriter::WriteBufferMemoryState(const VulkanStateTable& state_table,
@@ -1246,6 +1733,8 @@ void VulkanStateWriter::WriteBufferMemoryState(const VulkanStateTable& state_tab
             snapshot_info.memory_wrapper    = memory_wrapper;
             snapshot_info.memory_properties = GetMemoryProperties(device_wrapper, memory_wrapper, state_table);
             snapshot_info.need_staging_copy = !IsBufferReadable(snapshot_info.memory_properties, memory_wrapper);
+            snapshot_info.is_unmodified =
+                IsResourceUnmodified(wrapper->handle_id, 0, 0, wrapper->modified_generation, memory_wrapper);
 
             if ((*max_resource_size) < wrapper->created_size)
             {
@@ -1321,6 +1810,11 @@ void VulkanStateWriter::WriteImageMemoryState(const VulkanStateTable& state_tabl
                     snapshot_info.memory_properties = memory_properties;
                     snapshot_info.need_staging_copy = need_staging_copy;
                     snapshot_info.aspect            = aspect;
+                    snapshot_info.is_unmodified     = IsResourceUnmodified(wrapper->handle_id,
+                                                                       static_cast<uint32_t>(aspect),
+                                                                       static_cast<uint32_t>(wrapper->current_layout),
+                                                                       wrapper->modified_generation,
+                                                                       memory_wrapper);
 
                     GetImageSizes(wrapper, &snapshot_info);
 
@@ -1353,22 +1847,14 @@ void VulkanStateWriter::WriteResourceMemoryState(const VulkanStateTable& state_t
     // Write resource memory content.
     for (const auto& resource_entry : resources)
     {
-        const DeviceWrapper*  device_wrapper            = resource_entry.first;
-        VkBuffer              staging_buffer            = VK_NULL_HANDLE;
-        VkDeviceMemory        staging_memory            = VK_NULL_HANDLE;
-        VkMemoryPropertyFlags staging_memory_properties = 0;
-        VkResult              result                    = VK_SUCCESS;
+        const DeviceWrapper* device_wrapper = resource_entry.first;
+        VkResult             result         = VK_SUCCESS;
 
         if (max_staging_copy_size > 0)
         {
             assert(device_wrapper != nullptr);
 
-            result = CreateStagingBuffer(device_wrapper,
-                                         max_staging_copy_size,
-                                         &staging_buffer,
-                                         &staging_memory,
-                                         &staging_memory_properties,
-                                         state_table);
+            result = CreateStagingCopies(device_wrapper, max_staging_copy_size, state_table);
         }
 
         if (result == VK_SUCCESS)
@@ -1388,17 +1874,29 @@ void VulkanStateWriter::WriteResourceMemoryState(const VulkanStateTable& state_t
 
             for (const auto& queue_family_entry : resource_entry.second)
             {
-                uint32_t        queue_family_index = queue_family_entry.first;
-                VkQueue         queue              = VK_NULL_HANDLE;
-                VkCommandPool   command_pool       = VK_NULL_HANDLE;
-                VkCommandBuffer command_buffer     = VK_NULL_HANDLE;
+                uint32_t      queue_family_index = queue_family_entry.first;
+                VkQueue       queue              = VK_NULL_HANDLE;
+                VkCommandPool command_pool       = VK_NULL_HANDLE;
+                bool          has_command_buffer = false;
 
                 command_pool = GetCommandPool(device_wrapper, queue_family_index);
                 if (command_pool != VK_NULL_HANDLE)
                 {
-                    command_buffer = GetCommandBuffer(device_wrapper, command_pool);
+                    // Each staging buffer has its own command buffer, so that a new copy can be recorded while
+                    // earlier copies are still executing.
+                    has_command_buffer = true;
+
+                    for (auto& staging_copy : staging_copies_)
+                    {
+                        staging_copy.command_buffer = GetCommandBuffer(device_wrapper, command_pool);
+
+                        if (staging_copy.command_buffer == VK_NULL_HANDLE)
+                        {
+                            has_command_buffer = false;
+                        }
+                    }
 
-                    if (command_buffer == VK_NULL_HANDLE)
+                    if (!has_command_buffer)
                     {
                         GFXRECON_LOG_ERROR("Failed to create a command buffer to process trim state");
                         device_table->DestroyCommandPool(device_wrapper->handle, command_pool, nullptr);
@@ -1410,32 +1908,24 @@ void VulkanStateWriter::WriteResourceMemoryState(const VulkanStateTable& state_t
                     GFXRECON_LOG_ERROR("Failed to create a command pool to process trim state");
                 }
 
-                if (command_buffer != VK_NULL_HANDLE)
+                if (has_command_buffer)
                 {
-                    bool is_staging_memory_coherent = IsMemoryCoherent(staging_memory_properties);
-                    queue                           = GetQueue(device_wrapper, queue_family_index, 0);
-
-                    ProcessBufferMemory(device_wrapper,
-                                        queue_family_entry.second.buffers,
-                                        queue_family_index,
-                                        queue,
-                                        command_buffer,
-                                        staging_buffer,
-                                        staging_memory,
-                                        is_staging_memory_coherent);
-
-                    ProcessImageMemory(device_wrapper,
-                                       queue_family_entry.second.images,
-                                       queue_family_index,
-                                       queue,
-                                       command_buffer,
-                                       staging_buffer,
-                                       staging_memory,
-                                       is_staging_memory_coherent,
-                                       state_table);
+                    queue = GetQueue(device_wrapper, queue_family_index, 0);
+
+                    ProcessBufferMemory(device_wrapper, queue_family_entry.second.buffers, queue_family_index, queue);
+                    ProcessImageMemory(
+                        device_wrapper, queue_family_entry.second.images, queue_family_index, queue, state_table);
+
+                    // Write the data for the copies that are still pending before their command buffers are freed.
+                    FinishStagingCopies(device_wrapper);
 
                     device_table->DestroyCommandPool(device_wrapper->handle, command_pool, nullptr);
                 }
+
+                for (auto& staging_copy : staging_copies_)
+                {
+                    staging_copy.command_buffer = VK_NULL_HANDLE;
+                }
             }
 
             format::EndResourceInitCommand end_cmd;
@@ -1449,8 +1939,7 @@ void VulkanStateWriter::WriteResourceMemoryState(const VulkanStateTable& state_t
 
             if (max_staging_copy_size > 0)
             {
-                device_table->DestroyBuffer(device_wrapper->handle, staging_buffer, nullptr);
-                device_table->FreeMemory(device_wrapper->handle, staging_memory, nullptr);
+                DestroyStagingCopies(device_wrapper);
             }
         }
         else
@@ -1458,6 +1947,118 @@ void VulkanStateWriter::WriteResourceMemoryState(const VulkanStateTable& state_t
             GFXRECON_LOG_ERROR("Failed to create a staging buffer to process trim state");
         }
     }
+
+    // The content entries reference the image snapshot info, which is released when this function returns.
+    resource_contents_.clear();
+    retained_content_size_ = 0;
+}
+
+bool VulkanStateWriter::IsResourceUnmodified(format::HandleId           resource_id,
+                                             uint32_t                   aspect,
+                                             uint32_t                   layout,
+                                             uint64_t                   modified_generation,
+                                             const DeviceMemoryWrapper* memory_wrapper)
+{
+    assert(memory_wrapper != nullptr);
+
+    // Mapped memory may be written by the application at any time, so resources bound to mapped memory are always
+    // written.  Image data is also written when the layout has changed, as the layout is stored with the data.
+    if ((snapshot_history_ == nullptr) || (memory_wrapper->mapped_data != nullptr) ||
+        (memory_wrapper->modified_generation > snapshot_history_->generation) ||
+        (modified_generation > snapshot_history_->generation))
+    {
+        return false;
+    }
+
+    auto entry = snapshot_history_->resources.find(std::make_pair(resource_id, aspect));
+
+    return ((entry != snapshot_history_->resources.end()) && (entry->second.layout == layout));
+}
+
+void VulkanStateWriter::RecordSnapshotResource(format::HandleId resource_id,
+                                               uint32_t         aspect,
+                                               uint32_t         layout,
+                                               bool             is_unmodified)
+{
+    if (snapshot_history_ != nullptr)
+    {
+        auto key = std::make_pair(resource_id, aspect);
+
+        if (is_unmodified)
+        {
+            // References always point to the file containing the data, not to another reference.
+            snapshot_resources_[key] = snapshot_history_->resources[key];
+        }
+        else
+        {
+            assert(!snapshot_history_->filenames.empty());
+
+            VulkanStateSnapshotHistory::ResourceEntry& entry = snapshot_resources_[key];
+            entry.file_index = snapshot_history_->filenames.size() - 1;
+            entry.layout     = layout;
+        }
+    }
+}
+
+void VulkanStateWriter::WriteInitResourceReferenceCmd(format::HandleId device_id,
+                                                      format::HandleId resource_id,
+                                                      uint32_t         aspect)
+{
+    assert(snapshot_history_ != nullptr);
+
+    const auto& entry = snapshot_history_->resources[std::make_pair(resource_id, aspect)];
+    assert(entry.file_index < snapshot_history_->filenames.size());
+
+    // All snapshot files are written to the same directory, so the reference only needs the name of the file.
+    std::string filename = util::filepath::GetFilename(snapshot_history_->filenames[entry.file_index]);
+
+    format::InitResourceReferenceCommandHeader reference_cmd;
+
+    reference_cmd.meta_header.block_header.size =
+        (sizeof(reference_cmd) - sizeof(reference_cmd.meta_header.block_header)) + filename.size();
+    reference_cmd.meta_header.block_header.type = format::kMetaDataBlock;
+    reference_cmd.meta_header.meta_data_type    = format::kInitResourceReferenceCommand;
+    reference_cmd.thread_id                     = thread_id_;
+    reference_cmd.device_id                     = device_id;
+    reference_cmd.resource_id                   = resource_id;
+    reference_cmd.aspect                        = aspect;
+
+    output_stream_->Write(&reference_cmd, sizeof(reference_cmd));
+    output_stream_->Write(filename.data(), filename.size());
+}
+
+void VulkanStateWriter::WriteInitDuplicateResourceCmd(const ResourceData& resource_data)
+{
+    assert(resource_data.is_duplicate);
+
+    format::InitDuplicateResourceCommand duplicate_cmd;
+
+    duplicate_cmd.meta_header.block_header.size =
+        sizeof(duplicate_cmd) - sizeof(duplicate_cmd.meta_header.block_header);
+    duplicate_cmd.meta_header.block_header.type = format::kMetaDataBlock;
+    duplicate_cmd.meta_header.meta_data_type    = format::kInitDuplicateResourceCommand;
+    duplicate_cmd.thread_id                     = thread_id_;
+    duplicate_cmd.device_id                     = resource_data.device_wrapper->handle_id;
+    duplicate_cmd.source_id                     = resource_data.source_id;
+
+    if (resource_data.buffer_wrapper != nullptr)
+    {
+        duplicate_cmd.resource_id = resource_data.buffer_wrapper->handle_id;
+        duplicate_cmd.aspect      = 0;
+        duplicate_cmd.layout      = 0;
+    }
+    else
+    {
+        const ImageWrapper* image_wrapper = resource_data.image_info->image_wrapper;
+
+        duplicate_cmd.resource_id = image_wrapper->handle_id;
+        duplicate_cmd.aspect      = resource_data.image_info->aspect;
+        duplicate_cmd.layout      = image_wrapper->current_layout;
+    }
+
+    // The duplicate is not recorded in the snapshot history, because an incremental snapshot can only reference
+    // resources with their own init block.  The resource data will be written again by the next snapshot.
+    output_stream_->Write(&duplicate_cmd, sizeof(duplicate_cmd));
 }
 
 void VulkanStateWriter::WriteMappedMemoryState(const VulkanStateTable& state_table)
@@ -2389,10 +2990,14 @@ VkCommandBuffer VulkanStateWriter::GetCommandBuffer(const DeviceWrapper* device_
     return command_buffer;
 }
 
-VkResult
-VulkanStateWriter::SubmitCommandBuffer(VkQueue queue, VkCommandBuffer command_buffer, const DeviceTable* device_table)
+VkResult VulkanStateWriter::SubmitCommandBuffer(const DeviceWrapper* device_wrapper,
+                                                VkQueue              queue,
+                                                VkCommandBuffer      command_buffer,
+                                                VkFence              fence)
 {
-    assert(device_table != nullptr);
+    assert(device_wrapper != nullptr);
+
+    const DeviceTable* device_table = &device_wrapper->layer_table;
 
     VkSubmitInfo submit_info         = { VK_STRUCTURE_TYPE_SUBMIT_INFO };
     submit_info.pNext                = nullptr;
@@ -2404,9 +3009,17 @@ VulkanStateWriter::SubmitCommandBuffer(VkQueue queue, VkCommandBuffer command_bu
     submit_info.signalSemaphoreCount = 0;
     submit_info.pSignalSemaphores    = nullptr;
 
-    device_table->QueueSubmit(queue, 1, &submit_info, VK_NULL_HANDLE);
+    // Wait for the fence instead of the queue, to avoid waiting for staging copies that are still pending.
+    VkResult result = device_table->QueueSubmit(queue, 1, &submit_info, fence);
+
+    if (result == VK_SUCCESS)
+    {
+        result = device_table->WaitForFences(
+            device_wrapper->handle, 1, &fence, VK_TRUE, std::numeric_limits<uint64_t>::max());
+        device_table->ResetFences(device_wrapper->handle, 1, &fence);
+    }
 
-    return device_table->QueueWaitIdle(queue);
+    return result;
 }
 
 VkResult VulkanStateWriter::CreateStagingBuffer(const DeviceWrapper*    device_wrapper,
@@ -2481,6 +3094,7 @@ VkResult VulkanStateWriter::ResolveImage(const DeviceWrapper*    device_wrapper,
                                          const ImageWrapper*     image_wrapper,
                                          VkQueue                 queue,
                                          VkCommandBuffer         command_buffer,
+                                         VkFence                 fence,
                                          VkImage*                resolve_image,
                                          VkDeviceMemory*         resolve_memory,
                                          const VulkanStateTable& state_table)
@@ -2653,7 +3267,7 @@ VkResult VulkanStateWriter::ResolveImage(const DeviceWrapper*    device_wrapper,
 
                     device_table->EndCommandBuffer(command_buffer);
 
-                    result = SubmitCommandBuffer(queue, command_buffer, device_table);
+                    result = SubmitCommandBuffer(device_wrapper, queue, command_buffer, fence);
 
                     if (result == VK_SUCCESS)
                     {
@@ -24,27 +24,65 @@
 #include "generated/generated_vulkan_dispatch_table.h"
 #include "util/compressor.h"
 #include "util/defines.h"
-#include "util/file_output_stream.h"
 #include "util/memory_output_stream.h"
+#include "util/output_stream.h"
+#include "util/thread_pool.h"
 
 #include "vulkan/vulkan.h"
 
+#include <map>
 #include <set>
+#include <string>
+#include <utility>
 #include <vector>
 
 GFXRECON_BEGIN_NAMESPACE(gfxrecon)
 GFXRECON_BEGIN_NAMESPACE(encode)
 
+// Capture files containing the resource data written by earlier state snapshots, which an incremental state snapshot
+// references for resources that have not been modified since the most recent snapshot.
+struct VulkanStateSnapshotHistory
+{
+    struct ResourceEntry
+    {
+        size_t   file_index{ 0 }; // Index of the capture file that contains the resource data.
+        uint32_t layout{ 0 };     // Image layout written with the resource data.
+    };
+
+    // Resource handle ID and image aspect, which is 0 for buffers.
+    typedef std::pair<format::HandleId, uint32_t> ResourceKey;
+    typedef std::map<ResourceKey, ResourceEntry>  ResourceTable;
+
+    uint64_t                 generation{ 0 }; // State tracker generation of the most recent snapshot.
+    std::vector<std::string> filenames;
+    ResourceTable            resources;
+};
+
 class VulkanStateWriter
 {
   public:
-    VulkanStateWriter(util::FileOutputStream* output_stream, util::Compressor* compressor, format::ThreadId thread_id);
+    VulkanStateWriter(util::OutputStream* output_stream, util::Compressor* compressor, format::ThreadId thread_id);
 
     ~VulkanStateWriter();
 
+    // Name of the capture file that the state is written to, which is required for incremental state snapshots.
+    void SetCaptureFilename(const std::string& filename) { capture_filename_ = filename; }
+
+    // Thread pool for compressing resource data in parallel.  When not specified, resource data is compressed on the
+    // thread that writes the state.
+    void SetThreadPool(util::ThreadPool* thread_pool) { thread_pool_ = thread_pool; }
+
     // Returns number of bytes written to the output_stream.
     void WriteState(const VulkanStateTable& state_table, uint64_t frame_number);
 
+    // Writes an incremental state snapshot, which references the resource data from the capture files in the snapshot
+    // history for resources that were not modified after the previous snapshot, and then updates the history.  Wrappers
+    // modified after the previous snapshot have a modified_generation that is greater than the history's generation.
+    void WriteState(const VulkanStateTable&     state_table,
+                    uint64_t                    frame_number,
+                    uint64_t                    generation,
+                    VulkanStateSnapshotHistory* history);
+
   private:
     // Data structures for processing resource memory snapshots.
     struct BufferSnapshotInfo
@@ -53,6 +91,7 @@ class VulkanStateWriter
         const DeviceMemoryWrapper* memory_wrapper{ nullptr };
         VkMemoryPropertyFlags      memory_properties{};
         bool                       need_staging_copy{ false };
+        bool                       is_unmodified{ false }; // Data is referenced from an earlier snapshot.
     };
 
     struct ImageSnapshotInfo
@@ -64,6 +103,7 @@ class VulkanStateWriter
         VkImageAspectFlagBits      aspect{};
         VkDeviceSize               resource_size{ 0 }; // Combined size of all sub-resources.
         std::vector<uint64_t>      level_sizes;        // Combined size of all layers in a mip level.
+        bool                       is_unmodified{ false }; // Data is referenced from an earlier snapshot.
     };
 
     struct ResourceSnapshotInfo
@@ -75,6 +115,48 @@ class VulkanStateWriter
     typedef std::unordered_map<uint32_t, ResourceSnapshotInfo>                         ResourceSnapshotQueueFamilyTable;
     typedef std::unordered_map<const DeviceWrapper*, ResourceSnapshotQueueFamilyTable> DeviceResourceTables;
 
+    // Staging buffer for a copy that may still be executing, with the resource that the copy was submitted for.
+    struct StagingCopy
+    {
+        VkBuffer                  buffer{ VK_NULL_HANDLE };
+        VkDeviceMemory            memory{ VK_NULL_HANDLE };
+        const uint8_t*            data{ nullptr }; // Persistently mapped staging memory.
+        bool                      is_coherent{ false };
+        VkFence                   fence{ VK_NULL_HANDLE };
+        VkCommandBuffer           command_buffer{ VK_NULL_HANDLE };
+        const BufferSnapshotInfo* buffer_info{ nullptr }; // Buffer with a pending copy.
+        const ImageSnapshotInfo*  image_info{ nullptr };  // Image with a pending copy.
+        VkImage                   resolve_image{ VK_NULL_HANDLE };
+        VkDeviceMemory            resolve_memory{ VK_NULL_HANDLE };
+    };
+
+    // Resource data that has been retrieved for the snapshot, waiting to be compressed and written.
+    struct ResourceData
+    {
+        const DeviceWrapper*     device_wrapper{ nullptr };
+        const BufferWrapper*     buffer_wrapper{ nullptr };
+        const ImageSnapshotInfo* image_info{ nullptr };
+        const uint8_t*           bytes{ nullptr };
+        size_t                   data_size{ 0 };
+        size_t                   compressed_size{ 0 };
+        VkDeviceMemory           unmap_memory{ VK_NULL_HANDLE }; // Memory to unmap after the data has been written.
+        uint64_t                 content_hash{ 0 };
+        bool                     is_duplicate{ false }; // Data matches the data of a resource that was already written.
+        format::HandleId         source_id{ 0 };        // Resource with the same data, for duplicates.
+    };
+
+    // Resource that was written with data matching a content hash.  The data is compared with the data of resources
+    // with the same hash before they are written as duplicates, so it must remain valid while the entry exists.
+    struct ResourceContent
+    {
+        format::HandleId             resource_id{ 0 };
+        uint32_t                     aspect{ 0 };
+        size_t                       data_size{ 0 };
+        const std::vector<uint64_t>* level_sizes{ nullptr }; // Image level sizes; null for buffers.
+        const uint8_t*               bytes{ nullptr };       // Retained data, or the data of a pending resource.
+        std::vector<uint8_t>         retained_data;          // Copy of the data that remains valid after a flush.
+    };
+
     struct QueryActivationData
     {
         format::HandleId    pool_id{ 0 };
@@ -121,22 +203,58 @@ class VulkanStateWriter
     void ProcessBufferMemory(const DeviceWrapper*                   device_wrapper,
                              const std::vector<BufferSnapshotInfo>& buffer_snapshot_info,
                              uint32_t                               queue_family_index,
-                             VkQueue                                queue,
-                             VkCommandBuffer                        command_buffer,
-                             VkBuffer                               staging_buffer,
-                             VkDeviceMemory                         staging_memory,
-                             bool                                   is_staging_memory_coherent);
+                             VkQueue                                queue);
 
     void ProcessImageMemory(const DeviceWrapper*                  device_wrapper,
                             const std::vector<ImageSnapshotInfo>& image_snapshot_info,
                             uint32_t                              queue_family_index,
                             VkQueue                               queue,
-                            VkCommandBuffer                       command_buffer,
-                            VkBuffer                              staging_buffer,
-                            VkDeviceMemory                        staging_memory,
-                            bool                                  is_staging_memory_coherent,
                             const VulkanStateTable&               state_table);
 
+    // Adds resource data to the pending batch, which is compressed and written when the batch is full or is flushed.
+    // The data must remain valid until it has been written.
+    void AddBufferData(const DeviceWrapper* device_wrapper,
+                       const BufferWrapper* buffer_wrapper,
+                       const uint8_t*       bytes,
+                       VkDeviceMemory       unmap_memory);
+
+    void AddImageData(const DeviceWrapper*     device_wrapper,
+                      const ImageSnapshotInfo& snapshot_entry,
+                      const uint8_t*           bytes,
+                      VkDeviceMemory           unmap_memory);
+
+    size_t GetResourceDataBatchSize() const;
+
+    bool IsPendingUnmap(VkDeviceMemory memory) const;
+
+    // Compresses the pending resource data in parallel, then writes it in the order that it was added.  Resource data
+    // that matches the data of a resource that was already written is replaced with a reference to that resource.
+    void FlushResourceData();
+
+    void RunResourceDataTasks(size_t task_count, const util::ThreadPool::TaskFunc& task);
+
+    void FindDuplicateResourceData(ResourceData* resource_data);
+
+    void WriteBufferData(const ResourceData& resource_data, const uint8_t* compressed_data);
+
+    void WriteImageData(const ResourceData& resource_data, const uint8_t* compressed_data);
+
+    void WriteInitDuplicateResourceCmd(const ResourceData& resource_data);
+
+    VkResult
+    CreateStagingCopies(const DeviceWrapper* device_wrapper, VkDeviceSize size, const VulkanStateTable& state_table);
+
+    void DestroyStagingCopies(const DeviceWrapper* device_wrapper);
+
+    // Returns the staging buffer with the oldest copy, first writing the data for that copy if it is still pending.
+    StagingCopy* AcquireStagingCopy(const DeviceWrapper* device_wrapper);
+
+    VkResult SubmitStagingCopy(VkQueue queue, StagingCopy* staging_copy, const DeviceTable* device_table);
+
+    void FinishStagingCopy(const DeviceWrapper* device_wrapper, StagingCopy* staging_copy);
+
+    void FinishStagingCopies(const DeviceWrapper* device_wrapper);
+
     void WriteBufferMemoryState(const VulkanStateTable& state_table,
                                 DeviceResourceTables*   resources,
                                 VkDeviceSize*           max_resource_size,
@@ -149,6 +267,16 @@ class VulkanStateWriter
 
     void WriteResourceMemoryState(const VulkanStateTable& state_table);
 
+    bool IsResourceUnmodified(format::HandleId           resource_id,
+                              uint32_t                   aspect,
+                              uint32_t                   layout,
+                              uint64_t                   modified_generation,
+                              const DeviceMemoryWrapper* memory_wrapper);
+
+    void RecordSnapshotResource(format::HandleId resource_id, uint32_t aspect, uint32_t layout, bool is_unmodified);
+
+    void WriteInitResourceReferenceCmd(format::HandleId device_id, format::HandleId resource_id, uint32_t aspect);
+
     void WriteMappedMemoryState(const VulkanStateTable& state_table);
 
     void WriteSwapchainImageState(const VulkanStateTable& state_table);
@@ -273,7 +401,10 @@ class VulkanStateWriter
 
     VkCommandBuffer GetCommandBuffer(const DeviceWrapper* device_wrapper, VkCommandPool command_pool);
 
-    VkResult SubmitCommandBuffer(VkQueue queue, VkCommandBuffer command_buffer, const DeviceTable* device_table);
+    VkResult SubmitCommandBuffer(const DeviceWrapper* device_wrapper,
+                                 VkQueue              queue,
+                                 VkCommandBuffer      command_buffer,
+                                 VkFence              fence);
 
     VkResult CreateStagingBuffer(const DeviceWrapper*    device_wrapper,
                                  VkDeviceSize            size,
@@ -286,6 +417,7 @@ class VulkanStateWriter
                           const ImageWrapper*     image_wrapper,
                           VkQueue                 queue,
                           VkCommandBuffer         command_buffer,
+                          VkFence                 fence,
                           VkImage*                resolve_image,
                           VkDeviceMemory*         resolve_memory,
                           const VulkanStateTable& state_table);
@@ -318,12 +450,33 @@ class VulkanStateWriter
     bool IsFramebufferValid(const FramebufferWrapper* framebuffer_wrapper, const VulkanStateTable& state_table);
 
   private:
-    util::FileOutputStream*  output_stream_;
+    util::OutputStream*      output_stream_;
     util::Compressor*        compressor_;
     std::vector<uint8_t>     compressed_parameter_buffer_;
     format::ThreadId         thread_id_;
     util::MemoryOutputStream parameter_stream_;
     ParameterEncoder         encoder_;
+
+    // Incremental state snapshot support.
+    std::string                               capture_filename_;
+    VulkanStateSnapshotHistory*               snapshot_history_;
+    VulkanStateSnapshotHistory::ResourceTable snapshot_resources_; // Resource entries for the snapshot being written.
+
+    // Staging buffers for resource memory copies, used round robin so that the data for one copy can be compressed
+    // and written while the copies that follow are executing.
+    std::vector<StagingCopy> staging_copies_;
+    size_t                   next_staging_copy_;
+
+    // Parallel resource data compression.
+    util::ThreadPool*                 thread_pool_;
+    std::vector<ResourceData>         pending_resource_data_;
+    std::vector<std::vector<uint8_t>> resource_data_buffers_; // Compressed data for the pending resource data.
+
+    // Resource data deduplication, keyed by the hash of the data.  Entries without retained data reference the data of
+    // the pending resources, and are removed when the pending resources are flushed.
+    std::unordered_map<uint64_t, ResourceContent> resource_contents_;
+    std::vector<uint64_t>                         pending_content_hashes_;
+    size_t                                        retained_content_size_;
 };
 
 GFXRECON_END_NAMESPACE(encode)
@@ -43,13 +43,19 @@ typedef uint64_t AddressEncodeType;
 typedef HandleEncodeType HandleId;
 typedef uint64_t         ThreadId;
 
-const uint32_t kCompressedBlockTypeBit = 0x80000000;
+const uint32_t kCompressedBlockTypeBit       = 0x80000000;
+const uint32_t kStreamCompressedBlockTypeBit = 0x40000000; // Combined with kCompressedBlockTypeBit.
 
 constexpr uint32_t MakeCompressedBlockType(uint32_t block_type)
 {
     return kCompressedBlockTypeBit | block_type;
 }
 
+constexpr uint32_t MakeStreamCompressedBlockType(uint32_t block_type)
+{
+    return kStreamCompressedBlockTypeBit | kCompressedBlockTypeBit | block_type;
+}
+
 // clang-format off
 enum BlockType : uint32_t
 {
@@ -58,8 +64,14 @@ enum BlockType : uint32_t
     kStateMarkerBlock            = 2, // Marker to denote state snapshot status, such as the start or end of a state snapshot.
     kMetaDataBlock               = 3,
     kFunctionCallBlock           = 4,
+    kBlockGroup                  = 5, // Container for a sequence of complete blocks.  Only written in compressed form.
     kCompressedMetaDataBlock     = MakeCompressedBlockType(kMetaDataBlock),
-    kCompressedFunctionCallBlock = MakeCompressedBlockType(kFunctionCallBlock)
+    kCompressedFunctionCallBlock = MakeCompressedBlockType(kFunctionCallBlock),
+    kCompressedBlockGroup        = MakeCompressedBlockType(kBlockGroup),
+
+    // Function call block compressed with the per-thread compression stream identified by the block's thread ID, which
+    // must be decompressed in block order, starting from the thread's most recent kResetCompressionStreamCommand.
+    kStreamCompressedFunctionCallBlock = MakeStreamCompressedBlockType(kFunctionCallBlock)
 };
 
 enum MarkerType : uint32_t
@@ -83,21 +95,42 @@ enum MetaDataType : uint32_t
     kBeginResourceInitCommand      = 5,
     kEndResourceInitCommand        = 6,
     kInitBufferCommand             = 7,
-    kInitImageCommand              = 8
+    kInitImageCommand              = 8,
+
+    // Commands for capture files that are split into multiple streams.
+    kAddStreamFileCommand = 9,
+
+    // Commands for streaming compression.
+    kResetCompressionStreamCommand = 10,
+
+    // Commands for incremental trimmed frame state setup.
+    kInitResourceReferenceCommand = 11,
+
+    // Commands for deduplicated trimmed frame state setup.
+    kInitDuplicateResourceCommand = 12
 };
 
 enum CompressionType : uint32_t
 {
     kNone = 0,
     kLz4  = 1,
-    kZlib = 2
+    kZlib = 2,
+    kZstd = 3
 };
 
 enum FileOption : uint32_t
 {
-    kUnknownFileOption     = 0,
-    kCompressionType       = 1, // One of the CompressionType values defining the compression algorithm used with parameter
-                                // encoding. Default = CompressionType::kNone.
+    kUnknownFileOption          = 0,
+    kCompressionType            = 1, // One of the CompressionType values defining the compression algorithm used with
+                                     // parameter encoding. Default = CompressionType::kNone.
+    kBlockSequenceNumbers       = 2, // When non-zero, each block header is followed by a 64-bit sequence number, which
+                                     // is included in the block size and defines the order of blocks across stream
+                                     // files. Default = 0.
+    kCompressionStreamBlockSize = 3, // When non-zero, the maximum uncompressed size of the function call blocks that
+                                     // are written as kStreamCompressedFunctionCallBlock. Default = 0.
+    kCompressionDictionarySize  = 4, // When non-zero, the size of a compression dictionary that immediately follows the
+                                     // file option list, which is used to compress all blocks. Only valid with
+                                     // CompressionType::kZstd. Default = 0.
 };
 
 enum PointerAttributes : uint32_t
@@ -122,6 +155,9 @@ enum PointerAttributes : uint32_t
 struct EnabledOptions
 {
     CompressionType compression_type{ CompressionType::kNone };
+    bool            block_sequence_numbers{ false };
+    uint32_t        compression_stream_block_size{ 0 };
+    uint32_t        compression_dictionary_size{ 0 };
 };
 
 #pragma pack(push)
@@ -169,6 +205,15 @@ struct CompressedFunctionCallHeader
     uint64_t         uncompressed_size;
 };
 
+// Group of consecutive blocks that are compressed together, to reduce the overhead of compressing many small blocks
+// individually.  The compressed data decompresses to the complete blocks, including their block headers, which are
+// processed in order as if they had been read from the file.
+struct CompressedBlockGroupHeader
+{
+    BlockHeader block_header;
+    uint64_t    uncompressed_size;
+};
+
 struct MethodCallHeader
 {
     BlockHeader      block_header;
@@ -274,6 +319,50 @@ struct InitImageCommandHeader
     uint32_t         level_count;
 };
 
+struct AddStreamFileCommandHeader
+{
+    MetaDataHeader   meta_header;
+    format::ThreadId thread_id;
+    // NOTE: Filename length is determined by subtracting the sizeof(MetaDataType) + sizeof(ThreadId) from
+    // BlockHeader::size.  The filename is relative to the directory containing the primary capture file, and is not
+    // null terminated.
+};
+
+// All of the command data is present in the struct.
+struct ResetCompressionStreamCommand
+{
+    MetaDataHeader   meta_header;
+    format::ThreadId thread_id;
+};
+
+// Replaces a kInitBufferCommand or kInitImageCommand for a resource that was not modified since an earlier state
+// snapshot, which is replayed from the resource data written to the earlier snapshot's capture file.
+struct InitResourceReferenceCommandHeader
+{
+    MetaDataHeader   meta_header;
+    format::ThreadId thread_id;
+    format::HandleId device_id;
+    format::HandleId resource_id; // Buffer or image ID.
+    uint32_t         aspect;      // Image aspect of the referenced kInitImageCommand; 0 for buffers.
+    // NOTE: Filename length is determined by subtracting the size of the preceding members, excluding the BlockHeader,
+    // from BlockHeader::size.  The filename is relative to the directory containing the capture file, and is not null
+    // terminated.
+};
+
+// Replaces a kInitBufferCommand or kInitImageCommand for a resource with the same data as a resource that was
+// initialized earlier in the same state snapshot, which is replayed from the earlier resource's kInitBufferCommand or
+// kInitImageCommand.  All of the command data is present in the struct.
+struct InitDuplicateResourceCommand
+{
+    MetaDataHeader   meta_header;
+    format::ThreadId thread_id;
+    format::HandleId device_id;
+    format::HandleId resource_id; // Buffer or image ID.
+    format::HandleId source_id;   // Buffer or image that was initialized with the same data.
+    uint32_t         aspect;      // Image aspect of the resource and the source; 0 for buffers.
+    uint32_t         layout;      // Image layout of the resource; 0 for buffers.
+};
+
 #pragma pack(pop)
 
 GFXRECON_END_NAMESPACE(format)
@@ -19,7 +19,9 @@
 
 #include "util/logging.h"
 #include "util/lz4_compressor.h"
+#include "util/lz4_stream_compressor.h"
 #include "util/zlib_compressor.h"
+#include "util/zstd_compressor.h"
 
 GFXRECON_BEGIN_NAMESPACE(gfxrecon)
 GFXRECON_BEGIN_NAMESPACE(format)
@@ -40,9 +42,19 @@ bool ValidateFileHeader(const FileHeader& header)
 }
 
 util::Compressor* CreateCompressor(CompressionType type)
+{
+    return CreateCompressor(type, std::vector<uint8_t>());
+}
+
+util::Compressor* CreateCompressor(CompressionType type, const std::vector<uint8_t>& dictionary)
 {
     util::Compressor* compressor = nullptr;
 
+    if (!dictionary.empty() && (type != kZstd))
+    {
+        GFXRECON_LOG_WARNING("Ignoring compression dictionary: Dictionaries are only supported for zstd compression.");
+    }
+
     switch (type)
     {
         case kLz4:
@@ -61,6 +73,14 @@ util::Compressor* CreateCompressor(CompressionType type)
             assert(false);
 #endif // ENABLE_ZLIB_COMPRESSION
             break;
+        case kZstd:
+#ifdef ENABLE_ZSTD_COMPRESSION
+            compressor = new util::ZstdCompressor(dictionary);
+#else
+            GFXRECON_LOG_ERROR("Failed to initialize compression module: zstd compression is disabled.");
+            assert(false);
+#endif // ENABLE_ZSTD_COMPRESSION
+            break;
         case kNone:
             // Nothing to do here.
             break;
@@ -73,5 +93,29 @@ util::Compressor* CreateCompressor(CompressionType type)
     return compressor;
 }
 
+util::Compressor* CreateStreamCompressor(CompressionType type, size_t max_block_size)
+{
+    util::Compressor* compressor = nullptr;
+
+    switch (type)
+    {
+        case kLz4:
+#ifdef ENABLE_LZ4_COMPRESSION
+            compressor = new util::Lz4StreamCompressor(max_block_size);
+#else
+            GFXRECON_LOG_ERROR("Failed to initialize compression module: LZ4 compression is disabled.");
+            assert(false);
+#endif // ENABLE_LZ4_COMPRESSION
+            break;
+        default:
+            GFXRECON_LOG_ERROR("Failed to initialize compression module: Streaming compression is not supported for "
+                               "compression type ID %d",
+                               type);
+            break;
+    }
+
+    return compressor;
+}
+
 GFXRECON_END_NAMESPACE(format)
 GFXRECON_END_NAMESPACE(gfxrecon)
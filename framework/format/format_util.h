@@ -56,6 +56,11 @@ inline bool IsBlockCompressed(BlockType type)
     return ((type & kCompressedBlockTypeBit) == kCompressedBlockTypeBit);
 }
 
+inline bool IsBlockStreamCompressed(BlockType type)
+{
+    return ((type & kStreamCompressedBlockTypeBit) == kStreamCompressedBlockTypeBit);
+}
+
 inline BlockType AddCompressedBlockBit(BlockType type)
 {
     return static_cast<BlockType>(type | kCompressedBlockTypeBit);
@@ -63,7 +68,7 @@ inline BlockType AddCompressedBlockBit(BlockType type)
 
 inline BlockType RemoveCompressedBlockBit(BlockType type)
 {
-    return static_cast<BlockType>(type & ~kCompressedBlockTypeBit);
+    return static_cast<BlockType>(type & ~(kCompressedBlockTypeBit | kStreamCompressedBlockTypeBit));
 }
 
 // Utilities for format validation.
@@ -72,6 +77,12 @@ bool ValidateFileHeader(const FileHeader& header);
 // Utilities for object creation.
 util::Compressor* CreateCompressor(CompressionType type);
 
+// Creates a compressor that uses the specified dictionary, when supported by the compression type.
+util::Compressor* CreateCompressor(CompressionType type, const std::vector<uint8_t>& dictionary);
+
+// Returns nullptr if the compression type does not support streaming compression.
+util::Compressor* CreateStreamCompressor(CompressionType type, size_t max_block_size);
+
 GFXRECON_END_NAMESPACE(format)
 GFXRECON_END_NAMESPACE(gfxrecon)
 
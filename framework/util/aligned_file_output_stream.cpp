@@ -0,0 +1,203 @@
+/*
+** Copyright (c) 2019 LunarG, Inc.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+#include "util/aligned_file_output_stream.h"
+
+#include "util/logging.h"
+#include "util/platform.h"
+
+#if !defined(WIN32)
+
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <cinttypes>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+GFXRECON_BEGIN_NAMESPACE(gfxrecon)
+GFXRECON_BEGIN_NAMESPACE(util)
+
+const size_t AlignedFileOutputStream::kAlignment;
+const size_t AlignedFileOutputStream::kDefaultBufferSize;
+
+AlignedFileOutputStream::AlignedFileOutputStream(const std::string& filename, bool direct_io, size_t buffer_size) :
+    file_descriptor_(-1), filename_(filename), buffer_(nullptr), buffer_size_(0), buffer_offset_(0), file_offset_(0),
+    write_failed_(false)
+{
+    const int flags = O_WRONLY | O_CREAT | O_TRUNC;
+    const int mode  = S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH;
+
+#if defined(O_DIRECT)
+    if (direct_io)
+    {
+        file_descriptor_ = open(filename.c_str(), flags | O_DIRECT, mode);
+
+        if (file_descriptor_ < 0)
+        {
+            GFXRECON_LOG_WARNING("Direct I/O is not supported for %s (errno = %d); using buffered writes",
+                                 filename.c_str(),
+                                 errno);
+        }
+    }
+#else
+    if (direct_io)
+    {
+        GFXRECON_LOG_WARNING("Direct I/O is not supported on this platform; using buffered writes");
+    }
+#endif
+
+    if (file_descriptor_ < 0)
+    {
+        file_descriptor_ = open(filename.c_str(), flags, mode);
+    }
+
+    if (file_descriptor_ >= 0)
+    {
+        // Round the buffer size up to a multiple of the alignment, so that full buffer writes remain aligned.
+        buffer_size_ = ((std::max(buffer_size, kAlignment) + kAlignment - 1) / kAlignment) * kAlignment;
+
+        void* buffer = nullptr;
+        if (posix_memalign(&buffer, kAlignment, buffer_size_) == 0)
+        {
+            buffer_ = reinterpret_cast<uint8_t*>(buffer);
+        }
+        else
+        {
+            GFXRECON_LOG_ERROR(
+                "Failed to allocate %" PRIuPTR " byte aligned buffer for %s", buffer_size_, filename.c_str());
+        }
+    }
+    else
+    {
+        GFXRECON_LOG_ERROR("open(%s) failed (errno = %d)", filename.c_str(), errno);
+    }
+}
+
+AlignedFileOutputStream::~AlignedFileOutputStream()
+{
+    if (file_descriptor_ >= 0)
+    {
+        if (buffer_ != nullptr)
+        {
+            // Write the remaining data with padding, then truncate the file to remove the padding.
+            off_t file_size = file_offset_ + buffer_offset_;
+
+            if ((buffer_offset_ > 0) && WriteBuffer(buffer_offset_))
+            {
+                if (ftruncate(file_descriptor_, file_size) != 0)
+                {
+                    GFXRECON_LOG_ERROR("ftruncate(%s) failed (errno = %d)", filename_.c_str(), errno);
+                }
+            }
+        }
+
+        close(file_descriptor_);
+    }
+
+    free(buffer_);
+}
+
+size_t AlignedFileOutputStream::Write(const void* data, size_t len)
+{
+    assert(IsValid());
+
+    const uint8_t* bytes         = reinterpret_cast<const uint8_t*>(data);
+    size_t         bytes_written = 0;
+
+    while ((bytes_written < len) && !write_failed_)
+    {
+        size_t copy_size = std::min(len - bytes_written, buffer_size_ - buffer_offset_);
+
+        util::platform::MemoryCopy(buffer_ + buffer_offset_, copy_size, bytes + bytes_written, copy_size);
+
+        buffer_offset_ += copy_size;
+        bytes_written += copy_size;
+
+        if (buffer_offset_ == buffer_size_)
+        {
+            if (WriteBuffer(buffer_size_))
+            {
+                file_offset_ += buffer_size_;
+                buffer_offset_ = 0;
+            }
+        }
+    }
+
+    return bytes_written;
+}
+
+void AlignedFileOutputStream::Flush()
+{
+    assert(IsValid());
+
+    if ((buffer_offset_ > 0) && WriteBuffer(buffer_offset_))
+    {
+        // Keep the final partial block in the buffer, to be rewritten at the same file offset by the next write.
+        size_t committed_size = (buffer_offset_ / kAlignment) * kAlignment;
+        size_t remaining_size = buffer_offset_ - committed_size;
+
+        if (committed_size > 0)
+        {
+            memmove(buffer_, buffer_ + committed_size, remaining_size);
+
+            file_offset_ += committed_size;
+            buffer_offset_ = remaining_size;
+        }
+    }
+}
+
+bool AlignedFileOutputStream::WriteBuffer(size_t write_size)
+{
+    assert(write_size <= buffer_size_);
+
+    // Pad the write to the alignment size with zeros.
+    size_t aligned_size = ((write_size + kAlignment - 1) / kAlignment) * kAlignment;
+    memset(buffer_ + write_size, 0, aligned_size - write_size);
+
+    size_t total_written = 0;
+
+    while (total_written < aligned_size)
+    {
+        ssize_t result = pwrite(
+            file_descriptor_, buffer_ + total_written, aligned_size - total_written, file_offset_ + total_written);
+
+        if (result > 0)
+        {
+            total_written += result;
+        }
+        else if ((result < 0) && (errno == EINTR))
+        {
+            continue;
+        }
+        else
+        {
+            GFXRECON_LOG_ERROR("pwrite(%s) failed (errno = %d)", filename_.c_str(), errno);
+            write_failed_ = true;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+GFXRECON_END_NAMESPACE(util)
+GFXRECON_END_NAMESPACE(gfxrecon)
+
+#endif // !WIN32
@@ -0,0 +1,78 @@
+/*
+** Copyright (c) 2019 LunarG, Inc.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+#ifndef GFXRECON_UTIL_ALIGNED_FILE_OUTPUT_STREAM_H
+#define GFXRECON_UTIL_ALIGNED_FILE_OUTPUT_STREAM_H
+
+#include "util/defines.h"
+#include "util/output_stream.h"
+
+#include <cstdint>
+#include <string>
+
+#if !defined(WIN32)
+#include <sys/types.h>
+#endif
+
+GFXRECON_BEGIN_NAMESPACE(gfxrecon)
+GFXRECON_BEGIN_NAMESPACE(util)
+
+#if !defined(WIN32)
+
+// File output stream that accumulates data in an aligned buffer, which is written to the file with pwrite() when full,
+// bypassing the C runtime's buffering.  When direct I/O is requested, the file is opened with O_DIRECT so that writes
+// also bypass the page cache, avoiding page cache thrashing and writeback stalls for very large files.  If the file
+// system does not support direct I/O, the stream falls back to regular writes.
+//
+// All writes are a multiple of kAlignment bytes and start at an aligned file offset, as required for direct I/O.  When
+// the stream is flushed, the final partial block is written with zero padding and is rewritten by the next flush.  The
+// padding is removed when the stream is closed.
+class AlignedFileOutputStream : public OutputStream
+{
+  public:
+    static const size_t kAlignment         = 4096;
+    static const size_t kDefaultBufferSize = 4 * 1024 * 1024;
+
+  public:
+    AlignedFileOutputStream(const std::string& filename, bool direct_io, size_t buffer_size = kDefaultBufferSize);
+
+    virtual ~AlignedFileOutputStream() override;
+
+    virtual bool IsValid() override { return (file_descriptor_ >= 0) && (buffer_ != nullptr); }
+
+    virtual size_t Write(const void* data, size_t len) override;
+
+    virtual void Flush() override;
+
+  private:
+    bool WriteBuffer(size_t write_size);
+
+  private:
+    int         file_descriptor_;
+    std::string filename_;
+    uint8_t*    buffer_;
+    size_t      buffer_size_;
+    size_t      buffer_offset_; // Number of bytes in the buffer that have not been committed to the file.
+    off_t       file_offset_;   // Aligned file offset corresponding to the start of the buffer.
+    bool        write_failed_;
+};
+
+#endif // !WIN32
+
+GFXRECON_END_NAMESPACE(util)
+GFXRECON_END_NAMESPACE(gfxrecon)
+
+#endif // GFXRECON_UTIL_ALIGNED_FILE_OUTPUT_STREAM_H
@@ -0,0 +1,216 @@
+/*
+** Copyright (c) 2019 LunarG, Inc.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+#include "util/block_ring_buffer.h"
+
+#include "util/logging.h"
+#include "util/platform.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cinttypes>
+
+#if defined(WIN32)
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+GFXRECON_BEGIN_NAMESPACE(gfxrecon)
+GFXRECON_BEGIN_NAMESPACE(util)
+
+BlockRingBuffer::BlockRingBuffer(size_t capacity) :
+    buffer_(nullptr), capacity_(0), write_offset_(0), used_size_(0), start_point_count_(0), size_since_start_point_(0),
+    next_block_starts_point_(true)
+{
+    if (capacity > 0)
+    {
+        // Pages of the mapping are not committed until the buffer is written, so memory usage grows with the amount of
+        // data that has been captured up to the buffer capacity.
+#if defined(WIN32)
+        void* memory = VirtualAlloc(nullptr, capacity, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+#else
+        void* memory = mmap(nullptr, capacity, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (memory == MAP_FAILED)
+        {
+            memory = nullptr;
+        }
+#endif
+
+        if (memory != nullptr)
+        {
+            buffer_   = reinterpret_cast<uint8_t*>(memory);
+            capacity_ = capacity;
+        }
+        else
+        {
+            GFXRECON_LOG_ERROR("BlockRingBuffer failed to allocate memory with size = %" PRIuPTR, capacity);
+        }
+    }
+}
+
+BlockRingBuffer::~BlockRingBuffer()
+{
+    if (buffer_ != nullptr)
+    {
+#if defined(WIN32)
+        VirtualFree(buffer_, 0, MEM_RELEASE);
+#else
+        munmap(buffer_, capacity_);
+#endif
+    }
+}
+
+bool BlockRingBuffer::Write(const void* header, size_t header_size, const void* data, size_t data_size)
+{
+    assert(IsValid());
+
+    size_t block_size = header_size + data_size;
+
+    if (block_size > capacity_)
+    {
+        Clear();
+        return false;
+    }
+
+    // Discard the oldest blocks until there is space for the new block.
+    while ((capacity_ - used_size_) < block_size)
+    {
+        assert(!blocks_.empty());
+
+        const BlockInfo& oldest_block = blocks_.front();
+        if (oldest_block.starts_point)
+        {
+            --start_point_count_;
+        }
+
+        used_size_ -= oldest_block.size;
+        blocks_.pop_front();
+    }
+
+    if (next_block_starts_point_)
+    {
+        ++start_point_count_;
+        size_since_start_point_  = 0;
+        next_block_starts_point_ = false;
+        blocks_.push_back({ write_offset_, block_size, true });
+    }
+    else
+    {
+        blocks_.push_back({ write_offset_, block_size, false });
+    }
+
+    used_size_ += block_size;
+    size_since_start_point_ += block_size;
+
+    CopyToBuffer(header, header_size);
+
+    if (data_size > 0)
+    {
+        CopyToBuffer(data, data_size);
+    }
+
+    return true;
+}
+
+size_t BlockRingBuffer::Dump(OutputStream* stream) const
+{
+    assert(stream != nullptr);
+
+    // Blocks that precede the oldest start point depend on blocks that have been discarded, and are not written.
+    auto first_block = std::find_if(
+        blocks_.begin(), blocks_.end(), [](const BlockInfo& block) { return block.starts_point; });
+
+    size_t bytes_written = 0;
+
+    if (first_block != blocks_.end())
+    {
+        const BlockInfo& last_block = blocks_.back();
+        size_t           end_offset = last_block.offset + last_block.size;
+        size_t           dump_size  = 0;
+
+        if (end_offset > first_block->offset)
+        {
+            dump_size = end_offset - first_block->offset;
+        }
+        else
+        {
+            // The stored data wraps around the end of the buffer.
+            dump_size = (capacity_ - first_block->offset) + (end_offset % capacity_);
+        }
+
+        bytes_written = WriteToStream(stream, first_block->offset, dump_size);
+    }
+
+    return bytes_written;
+}
+
+void BlockRingBuffer::Clear()
+{
+    blocks_.clear();
+    write_offset_            = 0;
+    used_size_               = 0;
+    start_point_count_       = 0;
+    size_since_start_point_  = 0;
+    next_block_starts_point_ = false;
+}
+
+void BlockRingBuffer::CopyToBuffer(const void* data, size_t size)
+{
+    const uint8_t* bytes      = reinterpret_cast<const uint8_t*>(data);
+    size_t         first_size = std::min(size, capacity_ - write_offset_);
+
+    util::platform::MemoryCopy(buffer_ + write_offset_, first_size, bytes, first_size);
+
+    if (first_size < size)
+    {
+        util::platform::MemoryCopy(buffer_, size - first_size, bytes + first_size, size - first_size);
+    }
+
+    write_offset_ = (write_offset_ + size) % capacity_;
+}
+
+size_t BlockRingBuffer::WriteToStream(OutputStream* stream, size_t offset, size_t size) const
+{
+    size_t first_size    = std::min(size, capacity_ - offset);
+    size_t bytes_written = stream->Write(buffer_ + offset, first_size);
+
+    if (first_size < size)
+    {
+        bytes_written += stream->Write(buffer_, size - first_size);
+    }
+
+    return bytes_written;
+}
+
+BlockRingBufferOutputStream::BlockRingBufferOutputStream(BlockRingBuffer* buffer) : buffer_(buffer), valid_(true)
+{
+    assert(buffer_ != nullptr);
+    buffer_->MarkStartPoint();
+}
+
+size_t BlockRingBufferOutputStream::Write(const void* data, size_t len)
+{
+    if (valid_)
+    {
+        valid_ = buffer_->Write(data, len, nullptr, 0);
+    }
+
+    return valid_ ? len : 0;
+}
+
+GFXRECON_END_NAMESPACE(util)
+GFXRECON_END_NAMESPACE(gfxrecon)
@@ -0,0 +1,116 @@
+/*
+** Copyright (c) 2019 LunarG, Inc.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+#ifndef GFXRECON_UTIL_BLOCK_RING_BUFFER_H
+#define GFXRECON_UTIL_BLOCK_RING_BUFFER_H
+
+#include "util/defines.h"
+#include "util/output_stream.h"
+
+#include <cstdint>
+#include <deque>
+
+GFXRECON_BEGIN_NAMESPACE(gfxrecon)
+GFXRECON_BEGIN_NAMESPACE(util)
+
+// Fixed size, memory mapped ring buffer that stores complete capture file blocks.  When there is not enough space to
+// store a new block, the oldest blocks are discarded.  Block boundaries are tracked, along with the blocks that start
+// a replayable sequence of blocks, such as the first block of the capture or the first block of a state snapshot, so
+// that the buffer contents can be written to a capture file starting from a point that replay can start from.
+// The buffer is not thread safe; access must be synchronized by the caller.
+class BlockRingBuffer
+{
+  public:
+    BlockRingBuffer(size_t capacity);
+
+    ~BlockRingBuffer();
+
+    BlockRingBuffer(const BlockRingBuffer&) = delete;
+    BlockRingBuffer& operator=(const BlockRingBuffer&) = delete;
+
+    bool IsValid() const { return (buffer_ != nullptr); }
+
+    size_t GetCapacity() const { return capacity_; }
+
+    // Returns false if the block is larger than the buffer, in which case the buffer is cleared to avoid storing an
+    // incomplete sequence of blocks.
+    bool Write(const void* header, size_t header_size, const void* data, size_t data_size);
+
+    // Marks the next block written to the buffer as a start point.  The first block written to a new buffer is a start
+    // point.
+    void MarkStartPoint() { next_block_starts_point_ = true; }
+
+    // Returns true if a stored block, or the next block written to the buffer, is a start point.
+    bool HasStartPoint() const { return (next_block_starts_point_ || (start_point_count_ > 0)); }
+
+    // Returns the number of bytes written to the buffer since the most recent start point.
+    size_t GetSizeSinceStartPoint() const { return size_since_start_point_; }
+
+    // Writes the stored blocks, starting from the oldest start point, to the output stream.  Returns the number of
+    // bytes written, which is 0 if the buffer does not contain a start point.
+    size_t Dump(OutputStream* stream) const;
+
+    // Discards the stored blocks.  Blocks written after the buffer is cleared continue the sequence of blocks that was
+    // discarded, so the next block is not a start point unless it is marked as one.
+    void Clear();
+
+  private:
+    struct BlockInfo
+    {
+        size_t offset;
+        size_t size;
+        bool   starts_point;
+    };
+
+  private:
+    void CopyToBuffer(const void* data, size_t size);
+
+    size_t WriteToStream(OutputStream* stream, size_t offset, size_t size) const;
+
+  private:
+    uint8_t*              buffer_;
+    size_t                capacity_;
+    size_t                write_offset_;
+    size_t                used_size_;
+    std::deque<BlockInfo> blocks_;
+    size_t                start_point_count_;
+    size_t                size_since_start_point_;
+    bool                  next_block_starts_point_;
+};
+
+// Output stream that stores each write as a block of a BlockRingBuffer, for writing a sequence of blocks that is only
+// useful as a whole, such as a state snapshot.  The first write is marked as a start point.  If a write does not fit in
+// the buffer, the buffer is cleared, the remaining writes are ignored, and IsValid() returns false.
+class BlockRingBufferOutputStream : public OutputStream
+{
+  public:
+    BlockRingBufferOutputStream(BlockRingBuffer* buffer);
+
+    virtual ~BlockRingBufferOutputStream() override {}
+
+    virtual bool IsValid() override { return valid_; }
+
+    virtual size_t Write(const void* data, size_t len) override;
+
+  private:
+    BlockRingBuffer* buffer_;
+    bool             valid_;
+};
+
+GFXRECON_END_NAMESPACE(util)
+GFXRECON_END_NAMESPACE(gfxrecon)
+
+#endif // GFXRECON_UTIL_BLOCK_RING_BUFFER_H
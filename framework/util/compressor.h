@@ -42,6 +42,11 @@ class Compressor
                               const std::vector<uint8_t>& compressed_data,
                               const size_t                expected_uncompressed_size,
                               std::vector<uint8_t>*       uncompressed_data) = 0;
+
+    // Discards the history retained by a compressor that compresses blocks as a continuous stream, so that the next
+    // block does not reference data from previous blocks.  Has no effect for compressors that process each block
+    // independently.
+    virtual void Reset() {}
 };
 
 GFXRECON_END_NAMESPACE(util)
@@ -142,6 +142,41 @@ std::string Join(const std::string& lhs, const std::string& rhs)
     return joined;
 }
 
+static size_t FindLastPathSeparator(const std::string& path)
+{
+#if defined(WIN32)
+    // For Windows, we can accept either path separator.
+    return path.find_last_of(std::string(kPathSepStr) + kAltPathSepStr);
+#else
+    return path.rfind(kPathSep);
+#endif
+}
+
+std::string GetFilename(const std::string& path)
+{
+    size_t sep_index = FindLastPathSeparator(path);
+
+    if (sep_index != std::string::npos)
+    {
+        return path.substr(sep_index + 1);
+    }
+
+    return path;
+}
+
+std::string GetDirectory(const std::string& path)
+{
+    size_t sep_index = FindLastPathSeparator(path);
+
+    if (sep_index != std::string::npos)
+    {
+        // Keep the separator for paths to files in the root directory.
+        return path.substr(0, (sep_index == 0) ? 1 : sep_index);
+    }
+
+    return std::string();
+}
+
 std::string InsertFilenamePostfix(const std::string& filename, const std::string postfix)
 {
     std::string file_extension;
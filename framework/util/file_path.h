@@ -34,6 +34,13 @@ bool IsDirectory(const std::string& path);
 
 std::string Join(const std::string& lhs, const std::string& rhs);
 
+// Returns the portion of the path following the last path separator.
+std::string GetFilename(const std::string& path);
+
+// Returns the portion of the path preceding the last path separator, or an empty string if the path does not contain a
+// path separator.
+std::string GetDirectory(const std::string& path);
+
 std::string InsertFilenamePostfix(const std::string& filename, const std::string postfix);
 
 std::string GenerateTimestampedFilename(const std::string& filename, bool use_gmt = false);
@@ -0,0 +1,134 @@
+/*
+** Copyright (c) 2019 LunarG, Inc.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+#include "util/hash.h"
+
+#include <cstring>
+
+GFXRECON_BEGIN_NAMESPACE(gfxrecon)
+GFXRECON_BEGIN_NAMESPACE(util)
+GFXRECON_BEGIN_NAMESPACE(hash)
+
+const uint64_t kPrime1 = 11400714785074694791ull;
+const uint64_t kPrime2 = 14029467366897019727ull;
+const uint64_t kPrime3 = 1609587929392839161ull;
+const uint64_t kPrime4 = 9650029242287828579ull;
+const uint64_t kPrime5 = 2870177450012600261ull;
+
+static uint64_t RotateLeft(uint64_t value, uint32_t bits)
+{
+    return (value << bits) | (value >> (64 - bits));
+}
+
+// Unaligned little-endian loads.
+static uint64_t Read64(const uint8_t* data)
+{
+    uint64_t value;
+    memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+static uint32_t Read32(const uint8_t* data)
+{
+    uint32_t value;
+    memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+static uint64_t Round(uint64_t accumulator, uint64_t input)
+{
+    accumulator += input * kPrime2;
+    accumulator = RotateLeft(accumulator, 31);
+    return accumulator * kPrime1;
+}
+
+static uint64_t MergeRound(uint64_t accumulator, uint64_t value)
+{
+    accumulator ^= Round(0, value);
+    return (accumulator * kPrime1) + kPrime4;
+}
+
+uint64_t ComputeHash64(const void* data, size_t size, uint64_t seed)
+{
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data);
+    const uint8_t* end   = bytes + size;
+    uint64_t       hash  = 0;
+
+    if (size >= 32)
+    {
+        const uint8_t* limit = end - 32;
+        uint64_t       v1    = seed + kPrime1 + kPrime2;
+        uint64_t       v2    = seed + kPrime2;
+        uint64_t       v3    = seed;
+        uint64_t       v4    = seed - kPrime1;
+
+        do
+        {
+            v1 = Round(v1, Read64(bytes));
+            v2 = Round(v2, Read64(bytes + 8));
+            v3 = Round(v3, Read64(bytes + 16));
+            v4 = Round(v4, Read64(bytes + 24));
+            bytes += 32;
+        } while (bytes <= limit);
+
+        hash = RotateLeft(v1, 1) + RotateLeft(v2, 7) + RotateLeft(v3, 12) + RotateLeft(v4, 18);
+        hash = MergeRound(hash, v1);
+        hash = MergeRound(hash, v2);
+        hash = MergeRound(hash, v3);
+        hash = MergeRound(hash, v4);
+    }
+    else
+    {
+        hash = seed + kPrime5;
+    }
+
+    hash += static_cast<uint64_t>(size);
+
+    // Process the remaining bytes.
+    while ((bytes + 8) <= end)
+    {
+        hash ^= Round(0, Read64(bytes));
+        hash = (RotateLeft(hash, 27) * kPrime1) + kPrime4;
+        bytes += 8;
+    }
+
+    if ((bytes + 4) <= end)
+    {
+        hash ^= static_cast<uint64_t>(Read32(bytes)) * kPrime1;
+        hash = (RotateLeft(hash, 23) * kPrime2) + kPrime3;
+        bytes += 4;
+    }
+
+    while (bytes < end)
+    {
+        hash ^= static_cast<uint64_t>(*bytes) * kPrime5;
+        hash = RotateLeft(hash, 11) * kPrime1;
+        ++bytes;
+    }
+
+    // Final avalanche.
+    hash ^= hash >> 33;
+    hash *= kPrime2;
+    hash ^= hash >> 29;
+    hash *= kPrime3;
+    hash ^= hash >> 32;
+
+    return hash;
+}
+
+GFXRECON_END_NAMESPACE(hash)
+GFXRECON_END_NAMESPACE(util)
+GFXRECON_END_NAMESPACE(gfxrecon)
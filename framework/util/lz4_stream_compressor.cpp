@@ -0,0 +1,150 @@
+/*
+** Copyright (c) 2019 LunarG, Inc.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+#ifdef ENABLE_LZ4_COMPRESSION
+
+#include "util/lz4_stream_compressor.h"
+
+#include "lz4.h"
+
+#include <cassert>
+#include <cstring>
+
+GFXRECON_BEGIN_NAMESPACE(gfxrecon)
+GFXRECON_BEGIN_NAMESPACE(util)
+
+// LZ4 references up to 64 KB of previously processed data.
+const size_t kLz4HistorySize = 64 * 1024;
+
+struct Lz4StreamCompressor::Lz4StreamState
+{
+    LZ4_stream_t       stream;
+    LZ4_streamDecode_t stream_decode;
+};
+
+Lz4StreamCompressor::Lz4StreamCompressor(size_t max_block_size) :
+    state_(std::make_unique<Lz4StreamState>()), max_block_size_(max_block_size),
+    ring_buffer_(kLz4HistorySize + max_block_size), ring_buffer_offset_(0)
+{
+    Reset();
+}
+
+Lz4StreamCompressor::~Lz4StreamCompressor() {}
+
+size_t Lz4StreamCompressor::Compress(const size_t          uncompressed_size,
+                                     const uint8_t*        uncompressed_data,
+                                     std::vector<uint8_t>* compressed_data)
+{
+    size_t copy_size = 0;
+
+    if ((nullptr == compressed_data) || (uncompressed_size > max_block_size_))
+    {
+        return 0;
+    }
+
+    // The history referenced by the LZ4 stream must remain at the same address, so each block is copied to the ring
+    // buffer before it is compressed.
+    size_t offset = GetRingBufferOffset(uncompressed_size);
+    memcpy(ring_buffer_.data() + offset, uncompressed_data, uncompressed_size);
+
+    size_t lz4_compressed_size = LZ4_COMPRESSBOUND(uncompressed_size);
+
+    if (lz4_compressed_size > compressed_data->size())
+    {
+        compressed_data->resize(lz4_compressed_size);
+    }
+
+    const int compressed_size_generated =
+        LZ4_compress_fast_continue(&state_->stream,
+                                   reinterpret_cast<const char*>(ring_buffer_.data() + offset),
+                                   reinterpret_cast<char*>(compressed_data->data()),
+                                   static_cast<int32_t>(uncompressed_size),
+                                   static_cast<int32_t>(lz4_compressed_size),
+                                   1);
+
+    if (compressed_size_generated > 0)
+    {
+        copy_size = compressed_size_generated;
+    }
+
+    return copy_size;
+}
+
+size_t Lz4StreamCompressor::Decompress(const size_t                compressed_size,
+                                       const std::vector<uint8_t>& compressed_data,
+                                       const size_t                expected_uncompressed_size,
+                                       std::vector<uint8_t>*       uncompressed_data)
+{
+    size_t copy_size = 0;
+
+    if ((nullptr == uncompressed_data) || (expected_uncompressed_size > max_block_size_))
+    {
+        return 0;
+    }
+
+    // Blocks are decompressed to the same ring buffer offsets that were used for compression, which allows the
+    // decompressor to reference the history at the locations expected by the LZ4 stream.
+    size_t offset = GetRingBufferOffset(expected_uncompressed_size);
+
+    const int uncompressed_size_generated =
+        LZ4_decompress_safe_continue(&state_->stream_decode,
+                                     reinterpret_cast<const char*>(compressed_data.data()),
+                                     reinterpret_cast<char*>(ring_buffer_.data() + offset),
+                                     static_cast<int32_t>(compressed_size),
+                                     static_cast<int32_t>(expected_uncompressed_size));
+
+    if (uncompressed_size_generated > 0)
+    {
+        copy_size = uncompressed_size_generated;
+
+        if (copy_size > uncompressed_data->size())
+        {
+            uncompressed_data->resize(copy_size);
+        }
+
+        memcpy(uncompressed_data->data(), ring_buffer_.data() + offset, copy_size);
+    }
+
+    return copy_size;
+}
+
+void Lz4StreamCompressor::Reset()
+{
+    LZ4_resetStream(&state_->stream);
+    LZ4_setStreamDecode(&state_->stream_decode, nullptr, 0);
+    ring_buffer_offset_ = 0;
+}
+
+size_t Lz4StreamCompressor::GetRingBufferOffset(size_t block_size)
+{
+    assert(block_size <= max_block_size_);
+
+    // Wrap to the start of the ring buffer when the block does not fit in the remaining space.
+    if ((ring_buffer_offset_ + block_size) > ring_buffer_.size())
+    {
+        ring_buffer_offset_ = 0;
+    }
+
+    size_t offset = ring_buffer_offset_;
+    ring_buffer_offset_ += block_size;
+
+    return offset;
+}
+
+GFXRECON_END_NAMESPACE(util)
+GFXRECON_END_NAMESPACE(gfxrecon)
+
+#endif // ENABLE_LZ4_COMPRESSION
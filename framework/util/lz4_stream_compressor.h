@@ -0,0 +1,66 @@
+/*
+** Copyright (c) 2019 LunarG, Inc.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+#ifndef GFXRECON_UTIL_LZ4_STREAM_COMPRESSOR_H
+#define GFXRECON_UTIL_LZ4_STREAM_COMPRESSOR_H
+
+#include "util/compressor.h"
+
+#include <memory>
+
+GFXRECON_BEGIN_NAMESPACE(gfxrecon)
+GFXRECON_BEGIN_NAMESPACE(util)
+
+// LZ4 compressor that retains the history of previously compressed blocks, so that each block can reference data from
+// the blocks that preceded it.  Blocks must be decompressed in the order that they were compressed, by a decompressor
+// created with the same maximum block size, and Reset() must be called for the compressor and decompressor at the same
+// point in the block sequence.  A single instance should be used for either compression or decompression, not both.
+class Lz4StreamCompressor : public Compressor
+{
+  public:
+    // Uncompressed blocks passed to Compress() and Decompress() may not be larger than max_block_size.
+    Lz4StreamCompressor(size_t max_block_size);
+
+    virtual ~Lz4StreamCompressor() override;
+
+    virtual size_t Compress(const size_t          uncompressed_size,
+                            const uint8_t*        uncompressed_data,
+                            std::vector<uint8_t>* compressed_data) override;
+
+    virtual size_t Decompress(const size_t                compressed_size,
+                              const std::vector<uint8_t>& compressed_data,
+                              const size_t                expected_uncompressed_size,
+                              std::vector<uint8_t>*       uncompressed_data) override;
+
+    virtual void Reset() override;
+
+  private:
+    size_t GetRingBufferOffset(size_t block_size);
+
+  private:
+    struct Lz4StreamState;
+
+  private:
+    std::unique_ptr<Lz4StreamState> state_;
+    size_t                          max_block_size_;
+    std::vector<uint8_t>            ring_buffer_;
+    size_t                          ring_buffer_offset_;
+};
+
+GFXRECON_END_NAMESPACE(util)
+GFXRECON_END_NAMESPACE(gfxrecon)
+
+#endif // GFXRECON_UTIL_LZ4_STREAM_COMPRESSOR_H
@@ -0,0 +1,148 @@
+/*
+** Copyright (c) 2019 LunarG, Inc.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+#include "util/memory_copy.h"
+
+#include "util/platform.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#include <smmintrin.h>
+#if defined(__GNUC__)
+#define MEMORY_COPY_TARGET_SSE41 __attribute__((target("sse4.1")))
+#define MEMORY_COPY_ENABLE_SSE41
+#elif defined(_MSC_VER)
+#include <intrin.h>
+#define MEMORY_COPY_TARGET_SSE41
+#define MEMORY_COPY_ENABLE_SSE41
+#endif
+#elif defined(__aarch64__) && defined(__GNUC__)
+#define MEMORY_COPY_ENABLE_LDNP
+#endif
+
+GFXRECON_BEGIN_NAMESPACE(gfxrecon)
+GFXRECON_BEGIN_NAMESPACE(util)
+
+typedef void (*StreamingCopyFunc)(uint8_t*, const uint8_t*, size_t);
+
+static void StreamingCopyScalar(uint8_t* destination, const uint8_t* source, size_t size)
+{
+    util::platform::MemoryCopy(destination, size, source, size);
+}
+
+#if defined(MEMORY_COPY_ENABLE_SSE41)
+MEMORY_COPY_TARGET_SSE41 static void StreamingCopySse41(uint8_t* destination, const uint8_t* source, size_t size)
+{
+    // MOVNTDQA requires a 16 byte aligned source address, so any unaligned bytes at the start are copied first.
+    size_t head_size = std::min((16 - (reinterpret_cast<uintptr_t>(source) & 15)) & 15, size);
+
+    StreamingCopyScalar(destination, source, head_size);
+
+    destination += head_size;
+    source += head_size;
+    size -= head_size;
+
+    // The intrinsic takes a non-const pointer with some compilers.
+    auto   aligned_source = reinterpret_cast<__m128i*>(const_cast<uint8_t*>(source));
+    size_t i              = 0;
+
+    for (; (i + 64) <= size; i += 64)
+    {
+        // Issue all four loads before storing, so that they are satisfied by a single fill of the streaming load
+        // buffer for the 64 byte line.
+        __m128i v0 = _mm_stream_load_si128(aligned_source);
+        __m128i v1 = _mm_stream_load_si128(aligned_source + 1);
+        __m128i v2 = _mm_stream_load_si128(aligned_source + 2);
+        __m128i v3 = _mm_stream_load_si128(aligned_source + 3);
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), v0);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i + 16), v1);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i + 32), v2);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i + 48), v3);
+
+        aligned_source += 4;
+    }
+
+    for (; (i + 16) <= size; i += 16)
+    {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), _mm_stream_load_si128(aligned_source));
+        ++aligned_source;
+    }
+
+    StreamingCopyScalar(destination + i, source + i, size - i);
+}
+
+static bool IsSse41Supported()
+{
+#if defined(__GNUC__)
+    return __builtin_cpu_supports("sse4.1");
+#else
+    int info[4] = {};
+    __cpuid(info, 1);
+    return ((info[2] & (1 << 19)) != 0);
+#endif
+}
+#endif
+
+#if defined(MEMORY_COPY_ENABLE_LDNP)
+static void StreamingCopyLdnp(uint8_t* destination, const uint8_t* source, size_t size)
+{
+    size_t i = 0;
+
+    for (; (i + 64) <= size; i += 64)
+    {
+        // LDNP provides a non-temporal hint for the loads.  There is no intrinsic for the instruction.
+        __asm__ volatile("ldnp q0, q1, [%[src]]\n\t"
+                         "ldnp q2, q3, [%[src], #32]\n\t"
+                         "stp q0, q1, [%[dst]]\n\t"
+                         "stp q2, q3, [%[dst], #32]\n\t"
+                         :
+                         : [src] "r"(source + i), [dst] "r"(destination + i)
+                         : "v0", "v1", "v2", "v3", "memory");
+    }
+
+    StreamingCopyScalar(destination + i, source + i, size - i);
+}
+#endif
+
+static StreamingCopyFunc SelectStreamingCopyFunc()
+{
+#if defined(MEMORY_COPY_ENABLE_SSE41)
+    if (IsSse41Supported())
+    {
+        return StreamingCopySse41;
+    }
+#elif defined(MEMORY_COPY_ENABLE_LDNP)
+    return StreamingCopyLdnp;
+#endif
+
+    return StreamingCopyScalar;
+}
+
+void StreamingMemoryCopy(void* destination, const void* source, size_t size)
+{
+    assert(((destination != nullptr) && (source != nullptr)) || (size == 0));
+
+    static const StreamingCopyFunc streaming_copy = SelectStreamingCopyFunc();
+
+    streaming_copy(static_cast<uint8_t*>(destination), static_cast<const uint8_t*>(source), size);
+}
+
+GFXRECON_END_NAMESPACE(util)
+GFXRECON_END_NAMESPACE(gfxrecon)
@@ -0,0 +1,36 @@
+/*
+** Copyright (c) 2019 LunarG, Inc.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+#ifndef GFXRECON_UTIL_MEMORY_COPY_H
+#define GFXRECON_UTIL_MEMORY_COPY_H
+
+#include "util/defines.h"
+
+#include <cstddef>
+
+GFXRECON_BEGIN_NAMESPACE(gfxrecon)
+GFXRECON_BEGIN_NAMESPACE(util)
+
+// Copies memory with streaming loads, for reading from write-combined or uncached memory, such as host visible device
+// memory without VK_MEMORY_PROPERTY_HOST_CACHED_BIT, where regular loads are very slow.  Uses SSE4.1 MOVNTDQA on x86
+// when supported by the CPU and LDNP on AArch64, and falls back to memcpy otherwise.  Streaming loads from cached
+// memory behave as regular loads.
+void StreamingMemoryCopy(void* destination, const void* source, size_t size);
+
+GFXRECON_END_NAMESPACE(util)
+GFXRECON_END_NAMESPACE(gfxrecon)
+
+#endif // GFXRECON_UTIL_MEMORY_COPY_H
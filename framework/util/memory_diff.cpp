@@ -0,0 +1,192 @@
+/*
+** Copyright (c) 2019 LunarG, Inc.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+#include "util/memory_diff.h"
+
+#include "util/platform.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#include <emmintrin.h>
+#if defined(__GNUC__)
+#include <immintrin.h>
+#define MEMORY_DIFF_ENABLE_AVX2
+#endif
+#define MEMORY_DIFF_ENABLE_SSE2
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define MEMORY_DIFF_ENABLE_NEON
+#endif
+
+GFXRECON_BEGIN_NAMESPACE(gfxrecon)
+GFXRECON_BEGIN_NAMESPACE(util)
+
+typedef bool (*IsEqualFunc)(const uint8_t*, const uint8_t*, size_t);
+
+static bool IsEqualScalar(const uint8_t* lhs, const uint8_t* rhs, size_t size)
+{
+    return (memcmp(lhs, rhs, size) == 0);
+}
+
+#if defined(MEMORY_DIFF_ENABLE_SSE2)
+static bool IsEqualSse2(const uint8_t* lhs, const uint8_t* rhs, size_t size)
+{
+    size_t i = 0;
+
+    for (; (i + 64) <= size; i += 64)
+    {
+        __m128i eq0 = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(lhs + i)),
+                                     _mm_loadu_si128(reinterpret_cast<const __m128i*>(rhs + i)));
+        __m128i eq1 = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(lhs + i + 16)),
+                                     _mm_loadu_si128(reinterpret_cast<const __m128i*>(rhs + i + 16)));
+        __m128i eq2 = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(lhs + i + 32)),
+                                     _mm_loadu_si128(reinterpret_cast<const __m128i*>(rhs + i + 32)));
+        __m128i eq3 = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(lhs + i + 48)),
+                                     _mm_loadu_si128(reinterpret_cast<const __m128i*>(rhs + i + 48)));
+
+        if (_mm_movemask_epi8(_mm_and_si128(_mm_and_si128(eq0, eq1), _mm_and_si128(eq2, eq3))) != 0xFFFF)
+        {
+            return false;
+        }
+    }
+
+    for (; (i + 16) <= size; i += 16)
+    {
+        __m128i eq = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(lhs + i)),
+                                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(rhs + i)));
+
+        if (_mm_movemask_epi8(eq) != 0xFFFF)
+        {
+            return false;
+        }
+    }
+
+    return IsEqualScalar(lhs + i, rhs + i, size - i);
+}
+#endif
+
+#if defined(MEMORY_DIFF_ENABLE_AVX2)
+__attribute__((target("avx2"))) static bool IsEqualAvx2(const uint8_t* lhs, const uint8_t* rhs, size_t size)
+{
+    size_t i = 0;
+
+    for (; (i + 64) <= size; i += 64)
+    {
+        __m256i eq0 = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(lhs + i)),
+                                        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rhs + i)));
+        __m256i eq1 = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(lhs + i + 32)),
+                                        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rhs + i + 32)));
+
+        if (_mm256_movemask_epi8(_mm256_and_si256(eq0, eq1)) != -1)
+        {
+            return false;
+        }
+    }
+
+    return IsEqualSse2(lhs + i, rhs + i, size - i);
+}
+#endif
+
+#if defined(MEMORY_DIFF_ENABLE_NEON)
+static bool IsEqualNeon(const uint8_t* lhs, const uint8_t* rhs, size_t size)
+{
+    size_t i = 0;
+
+    for (; (i + 64) <= size; i += 64)
+    {
+        uint8x16_t eq0 = vceqq_u8(vld1q_u8(lhs + i), vld1q_u8(rhs + i));
+        uint8x16_t eq1 = vceqq_u8(vld1q_u8(lhs + i + 16), vld1q_u8(rhs + i + 16));
+        uint8x16_t eq2 = vceqq_u8(vld1q_u8(lhs + i + 32), vld1q_u8(rhs + i + 32));
+        uint8x16_t eq3 = vceqq_u8(vld1q_u8(lhs + i + 48), vld1q_u8(rhs + i + 48));
+
+        if (vminvq_u8(vandq_u8(vandq_u8(eq0, eq1), vandq_u8(eq2, eq3))) != 0xFF)
+        {
+            return false;
+        }
+    }
+
+    return IsEqualScalar(lhs + i, rhs + i, size - i);
+}
+#endif
+
+static IsEqualFunc SelectIsEqualFunc()
+{
+#if defined(MEMORY_DIFF_ENABLE_AVX2)
+    if (__builtin_cpu_supports("avx2"))
+    {
+        return IsEqualAvx2;
+    }
+#endif
+
+#if defined(MEMORY_DIFF_ENABLE_SSE2)
+    return IsEqualSse2;
+#elif defined(MEMORY_DIFF_ENABLE_NEON)
+    return IsEqualNeon;
+#else
+    return IsEqualScalar;
+#endif
+}
+
+void FindModifiedRanges(
+    const void* memory, void* snapshot, size_t size, size_t granularity, const ModifiedRangeFunc& handle_modified)
+{
+    assert((memory != nullptr) && (snapshot != nullptr) && (granularity > 0));
+
+    static const IsEqualFunc is_equal = SelectIsEqualFunc();
+
+    auto current  = static_cast<const uint8_t*>(memory);
+    auto previous = static_cast<uint8_t*>(snapshot);
+
+    auto process_range = [&](size_t start, size_t end) {
+        size_t range_size = end - start;
+        util::platform::MemoryCopy(previous + start, range_size, current + start, range_size);
+        handle_modified(start, range_size);
+    };
+
+    bool   active_range = false;
+    size_t range_start  = 0;
+
+    for (size_t offset = 0; offset < size; offset += granularity)
+    {
+        size_t block_size = std::min(granularity, size - offset);
+
+        if (!is_equal(current + offset, previous + offset, block_size))
+        {
+            if (!active_range)
+            {
+                active_range = true;
+                range_start  = offset;
+            }
+        }
+        else if (active_range)
+        {
+            active_range = false;
+            process_range(range_start, offset);
+        }
+    }
+
+    if (active_range)
+    {
+        process_range(range_start, size);
+    }
+}
+
+GFXRECON_END_NAMESPACE(util)
+GFXRECON_END_NAMESPACE(gfxrecon)
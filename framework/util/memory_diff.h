@@ -0,0 +1,42 @@
+/*
+** Copyright (c) 2019 LunarG, Inc.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+#ifndef GFXRECON_UTIL_MEMORY_DIFF_H
+#define GFXRECON_UTIL_MEMORY_DIFF_H
+
+#include "util/defines.h"
+
+#include <cstddef>
+#include <functional>
+
+GFXRECON_BEGIN_NAMESPACE(gfxrecon)
+GFXRECON_BEGIN_NAMESPACE(util)
+
+// Callback for processing a modified range.  The function parameters are the offset from the start of the compared
+// memory and the size of the modified range.
+typedef std::function<void(size_t, size_t)> ModifiedRangeFunc;
+
+// Compares memory with a snapshot of its previous content, in blocks of the specified granularity.  Adjacent modified
+// blocks are coalesced into a single range, which is copied to the snapshot before the callback is invoked, so that the
+// callback can read the range from the snapshot without racing with writes to the compared memory.  Block comparisons
+// use AVX2 or SSE2 on x86 and NEON on AArch64.
+void FindModifiedRanges(
+    const void* memory, void* snapshot, size_t size, size_t granularity, const ModifiedRangeFunc& handle_modified);
+
+GFXRECON_END_NAMESPACE(util)
+GFXRECON_END_NAMESPACE(gfxrecon)
+
+#endif // GFXRECON_UTIL_MEMORY_DIFF_H
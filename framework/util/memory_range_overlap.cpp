@@ -0,0 +1,101 @@
+/*
+** Copyright (c) 2019 LunarG, Inc.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+#include "util/memory_range_overlap.h"
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+
+GFXRECON_BEGIN_NAMESPACE(gfxrecon)
+GFXRECON_BEGIN_NAMESPACE(util)
+
+void MarkOverlappingRanges(std::vector<MemoryRange>* ranges)
+{
+    assert(ranges != nullptr);
+
+    std::sort(ranges->begin(), ranges->end(), [](const MemoryRange& lhs, const MemoryRange& rhs) {
+        if (lhs.memory_id != rhs.memory_id)
+        {
+            return lhs.memory_id < rhs.memory_id;
+        }
+
+        return lhs.begin < rhs.begin;
+    });
+
+    std::vector<bool> input_marked(ranges->size());
+
+    for (size_t i = 0; i < ranges->size(); ++i)
+    {
+        const MemoryRange& range = (*ranges)[i];
+        input_marked[i]          = range.marked && (range.end > range.begin);
+    }
+
+    size_t group_start = 0;
+
+    while (group_start < ranges->size())
+    {
+        uint64_t memory_id = (*ranges)[group_start].memory_id;
+        size_t   group_end = group_start + 1;
+
+        while ((group_end < ranges->size()) && ((*ranges)[group_end].memory_id == memory_id))
+        {
+            ++group_end;
+        }
+
+        // A range overlaps a marked range that starts before it when it starts before the end of that range.
+        uint64_t marked_end = 0;
+
+        for (size_t i = group_start; i < group_end; ++i)
+        {
+            MemoryRange& range = (*ranges)[i];
+
+            if ((range.end > range.begin) && (range.begin < marked_end))
+            {
+                range.marked = true;
+            }
+
+            if (input_marked[i])
+            {
+                marked_end = std::max(marked_end, range.end);
+            }
+        }
+
+        // A range overlaps a marked range that starts at or after its own start when the first such range starts
+        // before its end.
+        uint64_t marked_begin = std::numeric_limits<uint64_t>::max();
+
+        for (size_t i = group_end; i > group_start; --i)
+        {
+            MemoryRange& range = (*ranges)[i - 1];
+
+            if ((range.end > range.begin) && (marked_begin < range.end))
+            {
+                range.marked = true;
+            }
+
+            if (input_marked[i - 1])
+            {
+                marked_begin = range.begin;
+            }
+        }
+
+        group_start = group_end;
+    }
+}
+
+GFXRECON_END_NAMESPACE(util)
+GFXRECON_END_NAMESPACE(gfxrecon)
@@ -0,0 +1,47 @@
+/*
+** Copyright (c) 2019 LunarG, Inc.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+#ifndef GFXRECON_UTIL_MEMORY_RANGE_OVERLAP_H
+#define GFXRECON_UTIL_MEMORY_RANGE_OVERLAP_H
+
+#include "util/defines.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+GFXRECON_BEGIN_NAMESPACE(gfxrecon)
+GFXRECON_BEGIN_NAMESPACE(util)
+
+// A range [begin, end) of a memory object, such as the range that a resource is bound to.
+struct MemoryRange
+{
+    uint64_t memory_id;
+    uint64_t begin;
+    uint64_t end;
+    size_t   index;  // Identifies the range for the caller, and is not used for the comparison.
+    bool     marked;
+};
+
+// Marks every range that overlaps a marked range of the same memory object.  Marking is not transitive: a range is only
+// marked when it overlaps a range that was marked on input.  Empty ranges do not overlap any range.  The ranges are
+// sorted by memory object and start offset.
+void MarkOverlappingRanges(std::vector<MemoryRange>* ranges);
+
+GFXRECON_END_NAMESPACE(util)
+GFXRECON_END_NAMESPACE(gfxrecon)
+
+#endif // GFXRECON_UTIL_MEMORY_RANGE_OVERLAP_H
@@ -0,0 +1,105 @@
+/*
+** Copyright (c) 2019 LunarG, Inc.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+#ifndef GFXRECON_UTIL_MPSC_QUEUE_H
+#define GFXRECON_UTIL_MPSC_QUEUE_H
+
+#include "util/defines.h"
+
+#include <atomic>
+#include <cassert>
+#include <utility>
+
+GFXRECON_BEGIN_NAMESPACE(gfxrecon)
+GFXRECON_BEGIN_NAMESPACE(util)
+
+// Unbounded multiple-producer, single-consumer FIFO queue.  Push() is wait-free for producers, requiring a single
+// atomic exchange.  TryPop() must only be called from one consumer thread at a time.  A push that is in progress may
+// not be visible to TryPop() until the producer has finished linking its node, so an empty result from TryPop() does
+// not guarantee that no other thread is pushing.
+template <typename T>
+class MpscQueue
+{
+  public:
+    MpscQueue() : tail_(new Node) { head_.store(tail_, std::memory_order_relaxed); }
+
+    ~MpscQueue()
+    {
+        // Release the stub node and any entries that were never popped.
+        Node* node = tail_;
+        while (node != nullptr)
+        {
+            Node* next = node->next.load(std::memory_order_relaxed);
+            delete node;
+            node = next;
+        }
+    }
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    void Push(T&& value)
+    {
+        Node* node = new Node(std::move(value));
+
+        // Publish the node as the new head, then link it to the previous head.  The consumer will not observe the node
+        // until the link has been stored.
+        Node* prev = head_.exchange(node, std::memory_order_acq_rel);
+        prev->next.store(node, std::memory_order_release);
+    }
+
+    bool TryPop(T* value)
+    {
+        assert(value != nullptr);
+
+        Node* tail = tail_;
+        Node* next = tail->next.load(std::memory_order_acquire);
+
+        if (next == nullptr)
+        {
+            return false;
+        }
+
+        // The next node becomes the new stub node, after its value has been moved out.
+        (*value) = std::move(next->value);
+        tail_    = next;
+
+        delete tail;
+
+        return true;
+    }
+
+    bool IsEmpty() const { return (tail_->next.load(std::memory_order_acquire) == nullptr); }
+
+  private:
+    struct Node
+    {
+        Node() : next(nullptr) {}
+        Node(T&& v) : next(nullptr), value(std::move(v)) {}
+
+        std::atomic<Node*> next;
+        T                  value;
+    };
+
+  private:
+    std::atomic<Node*> head_; // Producer side.
+    Node*              tail_; // Consumer side; always points to the current stub node.
+};
+
+GFXRECON_END_NAMESPACE(util)
+GFXRECON_END_NAMESPACE(gfxrecon)
+
+#endif // GFXRECON_UTIL_MPSC_QUEUE_H
@@ -19,10 +19,29 @@
 #include "util/page_guard_manager.h"
 
 #include "util/logging.h"
+#include "util/memory_copy.h"
+#include "util/memory_diff.h"
 #include "util/platform.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cinttypes>
+#include <cstdio>
+#include <cstring>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <linux/userfaultfd.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#if defined(UFFDIO_WRITEPROTECT) && defined(__NR_userfaultfd)
+#define PAGE_GUARD_USERFAULTFD_SUPPORTED
+#endif
+#endif
 
 GFXRECON_BEGIN_NAMESPACE(gfxrecon)
 GFXRECON_BEGIN_NAMESPACE(util)
@@ -177,28 +196,113 @@ static void PageGuardExceptionHandler(int id, siginfo_t* info, void* data)
 }
 #endif
 
+#if defined(PAGE_GUARD_USERFAULTFD_SUPPORTED)
+const size_t kUserfaultfdMaxEvents = 16;
+
+// Definitions for asynchronous userfaultfd write protection and the PAGEMAP_SCAN ioctl from Linux 6.7, which may not
+// be provided by the kernel headers used for the build.
+struct PagemapRegion
+{
+    uint64_t start;
+    uint64_t end;
+    uint64_t categories;
+};
+
+struct PagemapScanArgs
+{
+    uint64_t size;
+    uint64_t flags;
+    uint64_t start;
+    uint64_t end;
+    uint64_t walk_end;
+    uint64_t vec;
+    uint64_t vec_len;
+    uint64_t max_pages;
+    uint64_t category_inverted;
+    uint64_t category_mask;
+    uint64_t category_anyof_mask;
+    uint64_t return_mask;
+};
+
+const unsigned long kPagemapScan              = _IOWR('f', 16, PagemapScanArgs);
+const uint64_t      kPagemapScanWpMatching    = 1ull << 0;
+const uint64_t      kPagemapScanCheckWpAsync  = 1ull << 1;
+const uint64_t      kPagemapPageIsWritten     = 1ull << 1;
+const uint64_t      kUffdFeatureWpUnpopulated = 1ull << 13;
+const uint64_t      kUffdFeatureWpAsync       = 1ull << 15;
+const size_t        kPagemapScanMaxRegions    = 256;
+#endif
+
+const size_t kPrefetchBlockSize = 1024 * 1024;
+
 PageGuardManager* PageGuardManager::instance_ = nullptr;
 
 PageGuardManager::PageGuardManager() :
     exception_handler_(nullptr), exception_handler_count_(0), system_page_size_(GetSystemPageSize()),
     enable_shadow_memory_(kDefaultEnableShadowMemory), enable_copy_on_map_(kDefaultEnableCopyOnMap),
     enable_lazy_copy_(kDefaultEnableLazyCopy), enable_separate_read_(kDefaultEnableSeparateRead),
-    enable_read_write_same_page_(kDefaultEnableReadWriteSamePage)
+    enable_read_write_same_page_(kDefaultEnableReadWriteSamePage), diff_granularity_(0), uffd_(-1),
+    uffd_wake_event_(-1), scan_uffd_(-1), pagemap_fd_(-1), huge_page_size_(0), huge_page_allocation_count_(0),
+    huge_page_allocation_size_(0), enable_prefetch_(false), prefetch_exit_(false), prefetch_memory_id_(0),
+    guard_fault_count_(0)
 {}
 
-PageGuardManager::PageGuardManager(bool enable_shadow_memory,
-                                   bool enable_copy_on_map,
-                                   bool enable_lazy_copy,
-                                   bool enable_separate_read,
-                                   bool expect_read_write_same_page) :
+PageGuardManager::PageGuardManager(bool   enable_shadow_memory,
+                                   bool   enable_copy_on_map,
+                                   bool   enable_lazy_copy,
+                                   bool   enable_prefetch,
+                                   bool   enable_separate_read,
+                                   bool   expect_read_write_same_page,
+                                   bool   enable_userfaultfd,
+                                   bool   enable_write_scan,
+                                   bool   enable_huge_pages,
+                                   size_t diff_granularity) :
     exception_handler_(nullptr),
     exception_handler_count_(0), system_page_size_(GetSystemPageSize()), enable_shadow_memory_(enable_shadow_memory),
     enable_copy_on_map_(enable_copy_on_map), enable_lazy_copy_(enable_lazy_copy),
-    enable_separate_read_(enable_separate_read), enable_read_write_same_page_(expect_read_write_same_page)
-{}
+    enable_separate_read_(enable_separate_read), enable_read_write_same_page_(expect_read_write_same_page),
+    diff_granularity_(diff_granularity), uffd_(-1), uffd_wake_event_(-1), scan_uffd_(-1), pagemap_fd_(-1),
+    huge_page_size_(0), huge_page_allocation_count_(0), huge_page_allocation_size_(0), enable_prefetch_(false),
+    prefetch_exit_(false), prefetch_memory_id_(0), guard_fault_count_(0)
+{
+    if (enable_huge_pages && enable_shadow_memory_ && !InitializeHugePages())
+    {
+        GFXRECON_LOG_WARNING("PageGuardManager failed to initialize huge page shadow memory; falling back to system "
+                             "page size allocations");
+    }
+
+    // Write tracking with page table scans or userfaultfd is only applied to shadow memory.
+    if (enable_write_scan && enable_shadow_memory_ && !InitializeWriteScan())
+    {
+        GFXRECON_LOG_WARNING("PageGuardManager failed to initialize page table scan write tracking; falling back to "
+                             "signal based write tracking");
+    }
+
+    if (enable_userfaultfd && enable_shadow_memory_ && (pagemap_fd_ == -1) && !InitializeUserfaultfd())
+    {
+        GFXRECON_LOG_WARNING("PageGuardManager failed to initialize userfaultfd write tracking; falling back to signal "
+                             "based write tracking");
+    }
+
+    if (enable_prefetch && enable_shadow_memory_ && enable_copy_on_map_)
+    {
+        if ((uffd_ != -1) || (pagemap_fd_ != -1))
+        {
+            GFXRECON_LOG_WARNING("PageGuardManager shadow memory prefetch is not supported with userfaultfd or "
+                                 "page table scan write tracking");
+        }
+        else if (!InitializePrefetch())
+        {
+            GFXRECON_LOG_WARNING("PageGuardManager failed to initialize shadow memory prefetch; falling back to copy "
+                                 "on map");
+        }
+    }
+}
 
 PageGuardManager::~PageGuardManager()
 {
+    DestroyPrefetch();
+
     if (exception_handler_ != nullptr)
     {
         ClearExceptionHandler(exception_handler_);
@@ -212,21 +316,39 @@ PageGuardManager::~PageGuardManager()
             FreeMemory(memory_info.shadow_memory, memory_info.shadow_range);
         }
     }
+
+    DestroyUserfaultfd();
+    DestroyWriteScan();
+
+    if (huge_page_size_ != 0)
+    {
+        LogHugePageStatistics();
+    }
 }
 
-void PageGuardManager::Create(bool enable_shadow_memory,
-                              bool enable_copy_on_map,
-                              bool enable_lazy_copy,
-                              bool enable_separate_read,
-                              bool expect_read_write_same_page)
+void PageGuardManager::Create(bool   enable_shadow_memory,
+                              bool   enable_copy_on_map,
+                              bool   enable_lazy_copy,
+                              bool   enable_prefetch,
+                              bool   enable_separate_read,
+                              bool   expect_read_write_same_page,
+                              bool   enable_userfaultfd,
+                              bool   enable_write_scan,
+                              bool   enable_huge_pages,
+                              size_t diff_granularity)
 {
     if (instance_ == nullptr)
     {
         instance_ = new PageGuardManager(enable_shadow_memory,
                                          enable_copy_on_map,
                                          enable_lazy_copy,
+                                         enable_prefetch,
                                          enable_separate_read,
-                                         expect_read_write_same_page);
+                                         expect_read_write_same_page,
+                                         enable_userfaultfd,
+                                         enable_write_scan,
+                                         enable_huge_pages,
+                                         diff_granularity);
     }
     else
     {
@@ -284,7 +406,15 @@ void* PageGuardManager::AllocateMemory(size_t aligned_size)
 
         memory = VirtualAlloc(nullptr, aligned_size, flags, PAGE_READWRITE);
 #else
-        memory = mmap(nullptr, aligned_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if ((huge_page_size_ != 0) && (aligned_size >= huge_page_size_))
+        {
+            memory = AllocateHugePageMemory(aligned_size);
+        }
+
+        if (memory == nullptr)
+        {
+            memory = mmap(nullptr, aligned_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        }
 #endif
     }
 
@@ -397,30 +527,39 @@ size_t PageGuardManager::GetMemorySegmentSize(const MemoryInfo* memory_info, siz
     return ((page_index + 1) < memory_info->total_pages) ? system_page_size_ : memory_info->last_segment_size;
 }
 
-void PageGuardManager::MemoryCopy(void* destination, const void* source, size_t size)
+void PageGuardManager::MemoryCopy(void* destination, const void* source, size_t size, bool uncached_source)
 {
     // TODO: parallel copy? (vktrace has options for this).
-    util::platform::MemoryCopy(destination, size, source, size);
+    if (uncached_source)
+    {
+        StreamingMemoryCopy(destination, source, size);
+    }
+    else
+    {
+        util::platform::MemoryCopy(destination, size, source, size);
+    }
 }
 
 bool PageGuardManager::FindMemory(void* address, MemoryInfo** watched_memory_info)
 {
     assert((address != nullptr) && (watched_memory_info != nullptr));
 
-    bool found = false;
-    for (auto entry = memory_info_.begin(); entry != memory_info_.end(); ++entry)
+    // Find the region with the greatest start address that is less than or equal to the specified address.
+    auto entry = memory_regions_.upper_bound(reinterpret_cast<uintptr_t>(address));
+    if (entry != memory_regions_.begin())
     {
-        MemoryInfo* memory_info = &(entry->second);
+        --entry;
+
+        MemoryInfo* memory_info = entry->second;
 
         if ((address >= memory_info->start_address) && (address < memory_info->end_address))
         {
-            found                  = true;
             (*watched_memory_info) = memory_info;
-            break;
+            return true;
         }
     }
 
-    return found;
+    return false;
 }
 
 bool PageGuardManager::SetMemoryProtection(void* protect_address, size_t protect_size, uint32_t protect_mask)
@@ -457,273 +596,1230 @@ bool PageGuardManager::SetMemoryProtection(void* protect_address, size_t protect
     return success;
 }
 
-void PageGuardManager::LoadActiveWriteStates(MemoryInfo* memory_info)
+bool PageGuardManager::GuardShadowMemory(void* address, size_t size)
 {
-    assert((memory_info != nullptr) && (memory_info->shadow_memory == nullptr));
-
-#if defined(WIN32)
-    auto      modified_addresses = memory_info->modified_addresses.get();
-    ULONG_PTR modified_count     = memory_info->total_pages;
-    DWORD     granularity        = 0;
-
-    if (GetWriteWatch(WRITE_WATCH_FLAG_RESET,
-                      memory_info->aligned_address,
-                      memory_info->mapped_range + memory_info->aligned_offset,
-                      modified_addresses,
-                      &modified_count,
-                      &granularity) == 0)
+    if (pagemap_fd_ != -1)
     {
-        if (modified_count > 0)
-        {
-            memory_info->is_modified = true;
-
-            for (ULONG_PTR i = 0; i < modified_count; ++i)
-            {
-                // Get offset from the page-aligned start address of the mapped memory to the address of the modified
-                // page.
-                size_t start_offset =
-                    static_cast<uint8_t*>(modified_addresses[i]) - static_cast<uint8_t*>(memory_info->aligned_address);
-                size_t page_index = start_offset / system_page_size_;
-
-                memory_info->status_tracker.SetActiveWriteBlock(page_index, true);
-            }
-        }
+        return RegisterWriteScanMemory(address, size);
     }
-    else
+
+    if (uffd_ != -1)
     {
-        GFXRECON_LOG_ERROR("PageGuardManager failed to retrieve write-modified pages for memory region [start address "
-                           "= %p, size = %" PRIuPTR "] (GetWriteWatch() produced error code %u)",
-                           memory_info->mapped_memory,
-                           memory_info->mapped_range,
-                           GetLastError());
+        return RegisterUserfaultfdMemory(address, size);
     }
-#endif
+
+    AddExceptionHandler();
+
+    // Enable page guard for read and write operations so that shadow memory can be synchronized with the mapped
+    // memory on both read and write access.
+    return SetMemoryProtection(address, size, kGuardReadWriteProtect);
 }
 
-void PageGuardManager::ProcessEntry(uint64_t memory_id, MemoryInfo* memory_info, ModifiedMemoryFunc handle_modified)
+bool PageGuardManager::WriteProtectShadowMemory(void* address, size_t size)
 {
-    assert(memory_info != nullptr);
+    if (pagemap_fd_ != -1)
+    {
+        // The scan that found the modified pages also write-protected them, so writes made during processing will be
+        // found by the next scan.
+        return true;
+    }
 
-    bool   active_range = false;
-    size_t start_index  = 0;
+    if (uffd_ != -1)
+    {
+        return SetUserfaultfdWriteProtect(address, GetAlignedSize(size), true);
+    }
 
-    memory_info->is_modified = false;
+    return SetMemoryProtection(address, size, kGuardReadOnlyProtect);
+}
 
-    for (size_t i = 0; i < memory_info->total_pages; ++i)
+void PageGuardManager::ResetShadowMemory(void* address, size_t size)
+{
+    if (pagemap_fd_ != -1)
     {
-        // Concatenate dirty pages to handle as large a range as possible with a single modified memory handler
-        // invocation.
-        if (memory_info->status_tracker.IsActiveWriteBlock(i))
-        {
-            memory_info->status_tracker.SetActiveWriteBlock(i, false);
-            memory_info->status_tracker.SetActiveReadBlock(i, false);
+        return;
+    }
 
-            if (!active_range)
-            {
-                active_range = true;
-                start_index  = i;
-            }
-        }
-        else
+    if (uffd_ != -1)
+    {
+#if defined(PAGE_GUARD_USERFAULTFD_SUPPORTED)
+        // Release the pages so that the next access, for read or write, faults and reloads the page from mapped memory.
+        if (madvise(address, size, MADV_DONTNEED) == -1)
         {
-            // If there was no write operation on the current page, check to see if there was a read operation.
-            // If a read operation triggered the page guard handler, it needs to be reset.
-            // Note that it is only possible to reach this state when enable_shadow_memory_ is true and
-            // enable_read_write_same_page_ is false.
-            if (memory_info->status_tracker.IsActiveReadBlock(i))
-            {
-                assert(memory_info->shadow_memory != nullptr);
-
-                void*  page_address = static_cast<uint8_t*>(memory_info->aligned_address) + (i * system_page_size_);
-                size_t segment_size = GetMemorySegmentSize(memory_info, i);
-
-                memory_info->status_tracker.SetActiveReadBlock(i, false);
-
-                SetMemoryProtection(page_address, segment_size, kGuardReadWriteProtect);
-            }
-
-            // If the previous pages were modified by a write operation, process the modified range now.
-            if (active_range)
-            {
-                active_range = false;
-
-                ProcessActiveRange(memory_id, memory_info, start_index, i, handle_modified);
-            }
+            GFXRECON_LOG_ERROR(
+                "PageGuardManager failed to release shadow memory pages [start address = %p, size = %" PRIuPTR
+                "] (madvise() produced error code %d)",
+                address,
+                size,
+                errno);
         }
+#endif
     }
-
-    if (active_range)
+    else
     {
-        ProcessActiveRange(memory_id, memory_info, start_index, memory_info->total_pages, handle_modified);
+        SetMemoryProtection(address, size, kGuardReadWriteProtect);
     }
 }
 
-void PageGuardManager::ProcessActiveRange(uint64_t           memory_id,
-                                          MemoryInfo*        memory_info,
-                                          size_t             start_index,
-                                          size_t             end_index,
-                                          ModifiedMemoryFunc handle_modified)
+bool PageGuardManager::InitializeUserfaultfd()
 {
-    assert((memory_info != nullptr) && (memory_info->aligned_address != nullptr));
-    assert(end_index > start_index);
+#if defined(PAGE_GUARD_USERFAULTFD_SUPPORTED)
+    int flags = O_CLOEXEC | O_NONBLOCK;
+    int uffd  = -1;
+
+#if defined(UFFD_USER_MODE_ONLY)
+    // Only user mode faults need to be handled, which allows userfaultfd to be used by unprivileged processes when
+    // vm.unprivileged_userfaultfd is disabled.  Older kernels reject the flag, so retry without it on failure.
+    uffd = static_cast<int>(syscall(__NR_userfaultfd, flags | UFFD_USER_MODE_ONLY));
+#endif
 
-    size_t page_count  = end_index - start_index;
-    size_t page_offset = start_index * system_page_size_;
-    size_t page_range  = page_count * system_page_size_;
+    if (uffd == -1)
+    {
+        uffd = static_cast<int>(syscall(__NR_userfaultfd, flags));
+    }
 
-    if (end_index == memory_info->total_pages)
+    if (uffd == -1)
     {
-        // Adjust range for memory ranges that end with a partial page.
-        page_range -= system_page_size_ - memory_info->last_segment_size;
+        GFXRECON_LOG_WARNING("PageGuardManager failed to create userfaultfd object (errno = %d)", errno);
+        return false;
     }
 
-    if (memory_info->shadow_memory != nullptr)
+    struct uffdio_api api = {};
+    api.api               = UFFD_API;
+    api.features          = UFFD_FEATURE_PAGEFAULT_FLAG_WP;
+
+    if ((ioctl(uffd, UFFDIO_API, &api) == -1) || ((api.features & UFFD_FEATURE_PAGEFAULT_FLAG_WP) == 0))
     {
-        void* start_address = static_cast<uint8_t*>(memory_info->shadow_memory) + page_offset;
+        GFXRECON_LOG_WARNING("PageGuardManager userfaultfd does not support write-protect mode (errno = %d)", errno);
+        close(uffd);
+        return false;
+    }
 
-        // Page guard was disabled when these pages were accessed.  We enable it now for write, to
-        // trap any writes made to the memory while we are performing the copy from shadow memory
-        // to mapped memory.
-        SetMemoryProtection(start_address, page_range, kGuardReadOnlyProtect);
+    int wake_event = eventfd(0, EFD_CLOEXEC);
+    if (wake_event == -1)
+    {
+        GFXRECON_LOG_WARNING("PageGuardManager failed to create userfaultfd wake event (errno = %d)", errno);
+        close(uffd);
+        return false;
+    }
 
-        // Copy from shadow memory to the original mapped memory
-        void* destination_address = static_cast<uint8_t*>(memory_info->mapped_memory) + page_offset;
-        MemoryCopy(destination_address, start_address, page_range);
+    uffd_             = uffd;
+    uffd_wake_event_  = wake_event;
+    uffd_page_buffer_ = std::make_unique<uint8_t[]>(system_page_size_);
+    uffd_thread_      = std::thread(&PageGuardManager::ProcessUserfaultfdEvents, this);
 
-        // The shadow memory address, page offset, and range values to be provided to the callback, which will process
-        // the memory range.
-        handle_modified(memory_id, memory_info->shadow_memory, page_offset, page_range);
+    return true;
+#else
+    GFXRECON_LOG_WARNING("PageGuardManager userfaultfd write tracking is not supported on this platform");
+    return false;
+#endif
+}
 
-        // Reset page guard to detect both read and write protection when using shadow memory.
-        SetMemoryProtection(start_address, page_range, kGuardReadWriteProtect);
-    }
-    else
+void PageGuardManager::DestroyUserfaultfd()
+{
+#if defined(PAGE_GUARD_USERFAULTFD_SUPPORTED)
+    if (uffd_ != -1)
     {
-        // Copy directly from the mapped memory.
-        if (start_index == 0)
+        uint64_t value = 1;
+        if (write(uffd_wake_event_, &value, sizeof(value)) != sizeof(value))
         {
-            // If the watch pointer was aligned to the start of a page, the alignment offset needs to be
-            // deducted from the page range.
-            page_range -= memory_info->aligned_offset;
+            GFXRECON_LOG_ERROR("PageGuardManager failed to signal userfaultfd handler thread (errno = %d)", errno);
         }
-        else
+
+        if (uffd_thread_.joinable())
         {
-            // If the start address was aligned to the start of a page, the alignment offset needs to be deducted from
-            // the start offset.
-            page_offset -= memory_info->aligned_offset;
+            uffd_thread_.join();
         }
 
-        // The mapped memory address, page offset, and range values to be provided to the callback, which will process
-        // the memory range.
-        handle_modified(memory_id, memory_info->mapped_memory, page_offset, page_range);
+        close(uffd_wake_event_);
+        close(uffd_);
+
+        uffd_wake_event_ = -1;
+        uffd_            = -1;
     }
+#endif
 }
 
-bool PageGuardManager::GetMemory(uint64_t memory_id, void** memory)
+bool PageGuardManager::RegisterUserfaultfdMemory(void* address, size_t size)
 {
-    assert(memory != nullptr);
+#if defined(PAGE_GUARD_USERFAULTFD_SUPPORTED)
+    assert((address != nullptr) && (uffd_ != -1));
 
-    std::lock_guard<std::mutex> lock(tracked_memory_lock_);
+    struct uffdio_register reg = {};
+    reg.range.start            = reinterpret_cast<uintptr_t>(address);
+    reg.range.len              = GetAlignedSize(size);
+    reg.mode                   = UFFDIO_REGISTER_MODE_MISSING | UFFDIO_REGISTER_MODE_WP;
 
-    auto entry = memory_info_.find(memory_id);
-    if (entry != memory_info_.end())
+    if (ioctl(uffd_, UFFDIO_REGISTER, &reg) == -1)
     {
-        if (entry->second.shadow_memory != nullptr)
-        {
-            (*memory) = entry->second.shadow_memory;
-        }
-        else
-        {
-            (*memory) = entry->second.mapped_memory;
-        }
-
-        return true;
+        GFXRECON_LOG_ERROR("PageGuardManager failed to register memory region with userfaultfd [start address = %p, "
+                           "size = %" PRIuPTR "] (errno = %d)",
+                           address,
+                           size,
+                           errno);
+        return false;
     }
 
+    // Pages that were populated by copy on map need write protection.  Unpopulated pages will raise missing page
+    // faults instead.
+    return SetUserfaultfdWriteProtect(address, reg.range.len, true);
+#else
+    GFXRECON_UNREFERENCED_PARAMETER(address);
+    GFXRECON_UNREFERENCED_PARAMETER(size);
     return false;
+#endif
 }
 
-void* PageGuardManager::AddMemory(uint64_t memory_id, void* mapped_memory, size_t size)
+bool PageGuardManager::SetUserfaultfdWriteProtect(void* address, size_t size, bool enable)
 {
-    void*  aligned_address = nullptr;
-    void*  shadow_memory   = nullptr;
-    size_t shadow_size     = 0;
-    size_t aligned_offset  = 0;
-
-    if (enable_shadow_memory_)
-    {
-        shadow_size   = GetAlignedSize(size);
-        shadow_memory = AllocateMemory(shadow_size);
+#if defined(PAGE_GUARD_USERFAULTFD_SUPPORTED)
+    assert(uffd_ != -1);
 
-        if (shadow_memory != nullptr)
-        {
-            aligned_address = shadow_memory;
+    struct uffdio_writeprotect wp = {};
+    wp.range.start                = reinterpret_cast<uintptr_t>(address);
+    wp.range.len                  = size;
+    wp.mode                       = enable ? UFFDIO_WRITEPROTECT_MODE_WP : 0;
 
-            if (enable_copy_on_map_ && !enable_lazy_copy_)
-            {
-                MemoryCopy(shadow_memory, mapped_memory, size);
-            }
-        }
-    }
-    else
+    if (ioctl(uffd_, UFFDIO_WRITEPROTECT, &wp) == -1)
     {
-        // Align the mapped memory pointer to the start of its page.
-        aligned_address = AlignToPageStart(mapped_memory);
-        aligned_offset  = GetOffsetFromPageStart(mapped_memory);
+        GFXRECON_LOG_ERROR("PageGuardManager failed to set userfaultfd write protection for memory region [start "
+                           "address = %p, size = %" PRIuPTR "] (errno = %d)",
+                           address,
+                           size,
+                           errno);
+        return false;
     }
 
-    if (aligned_address != nullptr)
-    {
-        size_t guard_range       = size + aligned_offset;
-        size_t total_pages       = guard_range / system_page_size_;
-        size_t last_segment_size = guard_range % system_page_size_;
-
-        if (last_segment_size != 0)
-        {
-            ++total_pages;
-        }
-        else
-        {
-            last_segment_size = system_page_size_;
-        }
+    return true;
+#else
+    GFXRECON_UNREFERENCED_PARAMETER(address);
+    GFXRECON_UNREFERENCED_PARAMETER(size);
+    GFXRECON_UNREFERENCED_PARAMETER(enable);
+    return false;
+#endif
+}
 
-        const void* start_address = mapped_memory;
-        bool        success       = true;
+void PageGuardManager::ProcessUserfaultfdEvents()
+{
+#if defined(PAGE_GUARD_USERFAULTFD_SUPPORTED)
+    struct pollfd poll_fds[2] = {};
+    poll_fds[0].fd            = uffd_;
+    poll_fds[0].events        = POLLIN;
+    poll_fds[1].fd            = uffd_wake_event_;
+    poll_fds[1].events        = POLLIN;
 
-        std::lock_guard<std::mutex> lock(tracked_memory_lock_);
+    struct uffd_msg messages[kUserfaultfdMaxEvents];
 
-        if (shadow_memory != nullptr)
+    for (;;)
+    {
+        if (poll(poll_fds, 2, -1) == -1)
         {
-            start_address = shadow_memory;
+            if (errno == EINTR)
+            {
+                continue;
+            }
 
-            AddExceptionHandler();
+            GFXRECON_LOG_ERROR("PageGuardManager userfaultfd poll failed (errno = %d)", errno);
+            break;
+        }
 
-            // Enable page guard for read and write operations so that shadow memory can be synchronized with the mapped
-            // memory on both read and write access.
-            success = SetMemoryProtection(shadow_memory, guard_range, kGuardReadWriteProtect);
+        if (poll_fds[1].revents != 0)
+        {
+            // Shutdown was requested.
+            break;
         }
 
-        if (success)
+        ssize_t bytes_read = read(uffd_, messages, sizeof(messages));
+        if (bytes_read == -1)
         {
-            assert(memory_info_.find(memory_id) == memory_info_.end());
+            if ((errno != EAGAIN) && (errno != EINTR))
+            {
+                GFXRECON_LOG_ERROR("PageGuardManager failed to read userfaultfd events (errno = %d)", errno);
+                break;
+            }
 
-            auto entry = memory_info_.emplace(std::piecewise_construct,
-                                              std::forward_as_tuple(memory_id),
-                                              std::forward_as_tuple(mapped_memory,
-                                                                    size,
-                                                                    shadow_memory,
-                                                                    shadow_size,
-                                                                    aligned_address,
-                                                                    aligned_offset,
-                                                                    total_pages,
-                                                                    last_segment_size,
-                                                                    start_address,
-                                                                    static_cast<const uint8_t*>(start_address) + size));
+            continue;
+        }
 
-            if (!entry.second && (shadow_memory != nullptr))
+        size_t count = static_cast<size_t>(bytes_read) / sizeof(messages[0]);
+        for (size_t i = 0; i < count; ++i)
+        {
+            const struct uffd_msg& message = messages[i];
+            if (message.event == UFFD_EVENT_PAGEFAULT)
             {
-                FreeMemory(shadow_memory, shadow_size);
-                shadow_memory = nullptr;
+                void* address = reinterpret_cast<void*>(static_cast<uintptr_t>(message.arg.pagefault.address));
+                bool  is_write_protect = ((message.arg.pagefault.flags & UFFD_PAGEFAULT_FLAG_WP) != 0);
+                bool  is_write         = ((message.arg.pagefault.flags & UFFD_PAGEFAULT_FLAG_WRITE) != 0);
+
+                HandleUserfaultfdFault(address, is_write || is_write_protect, is_write_protect);
+            }
+        }
+    }
+#endif
+}
+
+void PageGuardManager::HandleUserfaultfdFault(void* address, bool is_write, bool is_write_protect)
+{
+#if defined(PAGE_GUARD_USERFAULTFD_SUPPORTED)
+    MemoryInfo* memory_info  = nullptr;
+    void*       page_address = AlignToPageStart(address);
+
+    std::lock_guard<std::mutex> lock(tracked_memory_lock_);
+
+    if (!FindMemory(address, &memory_info))
+    {
+        // The memory was released while the fault was pending; wake the faulting thread so that it can retry.
+        struct uffdio_range range = {};
+        range.start               = reinterpret_cast<uintptr_t>(page_address);
+        range.len                 = system_page_size_;
+        ioctl(uffd_, UFFDIO_WAKE, &range);
+        return;
+    }
+
+    assert(memory_info->shadow_memory != nullptr);
+
+    size_t start_offset = static_cast<uint8_t*>(page_address) - static_cast<uint8_t*>(memory_info->aligned_address);
+    size_t page_index   = start_offset / system_page_size_;
+
+    memory_info->is_modified = true;
+    ++guard_fault_count_;
+
+    if (is_write_protect)
+    {
+        // Write to a page that was populated by a read or by copy on map.
+        memory_info->status_tracker.SetActiveWriteBlock(page_index, true);
+        SetUserfaultfdWriteProtect(page_address, system_page_size_, false);
+        return;
+    }
+
+    // First access to a page since it was last processed; fill it with the current content of the mapped memory.
+    // Pages that are filled for a read remain write protected, so unlike signal based tracking, a subsequent write to
+    // the page is detected regardless of enable_read_write_same_page_.
+    size_t      segment_size = GetMemorySegmentSize(memory_info, page_index);
+    const void* source       = static_cast<uint8_t*>(memory_info->mapped_memory) + start_offset;
+
+    if ((segment_size < system_page_size_) || (GetOffsetFromPageStart(const_cast<void*>(source)) != 0) ||
+        memory_info->uncached)
+    {
+        // UFFDIO_COPY requires a full, page-aligned source page.  Uncached memory is also copied to the page buffer, so
+        // that it is read with streaming loads instead of by the kernel.
+        MemoryCopy(uffd_page_buffer_.get(), source, segment_size, memory_info->uncached);
+        source = uffd_page_buffer_.get();
+    }
+
+    struct uffdio_copy copy = {};
+    copy.dst                = reinterpret_cast<uintptr_t>(page_address);
+    copy.src                = reinterpret_cast<uintptr_t>(source);
+    copy.len                = system_page_size_;
+    copy.mode               = is_write ? 0 : UFFDIO_COPY_MODE_WP;
+
+    if (ioctl(uffd_, UFFDIO_COPY, &copy) == -1)
+    {
+        if (errno == EEXIST)
+        {
+            // The page was populated by another fault; wake the faulting thread so that it can retry.
+            struct uffdio_range range = {};
+            range.start               = copy.dst;
+            range.len                 = copy.len;
+            ioctl(uffd_, UFFDIO_WAKE, &range);
+        }
+        else
+        {
+            GFXRECON_LOG_ERROR("PageGuardManager failed to populate shadow memory page at address %p (errno = %d)",
+                               page_address,
+                               errno);
+        }
+    }
+
+    if (is_write)
+    {
+        memory_info->status_tracker.SetActiveWriteBlock(page_index, true);
+    }
+    else
+    {
+        memory_info->status_tracker.SetActiveReadBlock(page_index, true);
+    }
+#else
+    GFXRECON_UNREFERENCED_PARAMETER(address);
+    GFXRECON_UNREFERENCED_PARAMETER(is_write);
+    GFXRECON_UNREFERENCED_PARAMETER(is_write_protect);
+#endif
+}
+
+bool PageGuardManager::InitializeWriteScan()
+{
+#if defined(PAGE_GUARD_USERFAULTFD_SUPPORTED)
+    int flags = O_CLOEXEC;
+    int uffd  = -1;
+
+#if defined(UFFD_USER_MODE_ONLY)
+    uffd = static_cast<int>(syscall(__NR_userfaultfd, flags | UFFD_USER_MODE_ONLY));
+#endif
+
+    if (uffd == -1)
+    {
+        uffd = static_cast<int>(syscall(__NR_userfaultfd, flags));
+    }
+
+    if (uffd == -1)
+    {
+        GFXRECON_LOG_WARNING("PageGuardManager failed to create userfaultfd object (errno = %d)", errno);
+        return false;
+    }
+
+    // With asynchronous write protection, the kernel resolves write faults for write-protected pages without a
+    // handler thread, and records the write in the page table entry for PAGEMAP_SCAN.  Unpopulated pages are also
+    // write-protected, so the first write to every page is recorded.
+    struct uffdio_api api = {};
+    api.api               = UFFD_API;
+    api.features          = UFFD_FEATURE_PAGEFAULT_FLAG_WP | kUffdFeatureWpAsync | kUffdFeatureWpUnpopulated;
+
+    if (ioctl(uffd, UFFDIO_API, &api) == -1)
+    {
+        GFXRECON_LOG_WARNING("PageGuardManager userfaultfd does not support asynchronous write-protect mode (errno = "
+                             "%d)",
+                             errno);
+        close(uffd);
+        return false;
+    }
+
+    int pagemap_fd = open("/proc/self/pagemap", O_RDONLY | O_CLOEXEC);
+    if (pagemap_fd == -1)
+    {
+        GFXRECON_LOG_WARNING("PageGuardManager failed to open /proc/self/pagemap (errno = %d)", errno);
+        close(uffd);
+        return false;
+    }
+
+    scan_uffd_  = uffd;
+    pagemap_fd_ = pagemap_fd;
+
+    // A write to a protected page must be reported by the first scan, and not by the second scan, which requires
+    // PAGEMAP_SCAN support from the kernel.
+    bool   supported  = false;
+    size_t probe_size = system_page_size_;
+    void*  probe      = AllocateMemory(probe_size);
+
+    if ((probe != nullptr) && RegisterWriteScanMemory(probe, probe_size))
+    {
+        PageStatusTracker probe_tracker(1);
+
+        static_cast<volatile uint8_t*>(probe)[0] = 1;
+
+        supported = ScanWrittenPages(probe, probe_size, &probe_tracker) &&
+                    !ScanWrittenPages(probe, probe_size, &probe_tracker);
+    }
+
+    if (probe != nullptr)
+    {
+        FreeMemory(probe, probe_size);
+    }
+
+    if (!supported)
+    {
+        GFXRECON_LOG_WARNING("PageGuardManager page table scan write tracking is not supported by the kernel");
+        DestroyWriteScan();
+    }
+
+    return supported;
+#else
+    GFXRECON_LOG_WARNING("PageGuardManager page table scan write tracking is not supported on this platform");
+    return false;
+#endif
+}
+
+void PageGuardManager::DestroyWriteScan()
+{
+#if defined(PAGE_GUARD_USERFAULTFD_SUPPORTED)
+    if (pagemap_fd_ != -1)
+    {
+        close(pagemap_fd_);
+        close(scan_uffd_);
+
+        pagemap_fd_ = -1;
+        scan_uffd_  = -1;
+    }
+#endif
+}
+
+bool PageGuardManager::RegisterWriteScanMemory(void* address, size_t size)
+{
+#if defined(PAGE_GUARD_USERFAULTFD_SUPPORTED)
+    assert((address != nullptr) && (scan_uffd_ != -1));
+
+    struct uffdio_register reg = {};
+    reg.range.start            = reinterpret_cast<uintptr_t>(address);
+    reg.range.len              = GetAlignedSize(size);
+    reg.mode                   = UFFDIO_REGISTER_MODE_WP;
+
+    if (ioctl(scan_uffd_, UFFDIO_REGISTER, &reg) == -1)
+    {
+        GFXRECON_LOG_ERROR("PageGuardManager failed to register memory region with userfaultfd [start address = %p, "
+                           "size = %" PRIuPTR "] (errno = %d)",
+                           address,
+                           size,
+                           errno);
+        return false;
+    }
+
+    // The shadow memory was filled by the copy on map before it was registered, so the copy is not reported as a write.
+    struct uffdio_writeprotect wp = {};
+    wp.range                      = reg.range;
+    wp.mode                       = UFFDIO_WRITEPROTECT_MODE_WP;
+
+    if (ioctl(scan_uffd_, UFFDIO_WRITEPROTECT, &wp) == -1)
+    {
+        GFXRECON_LOG_ERROR("PageGuardManager failed to set userfaultfd write protection for memory region [start "
+                           "address = %p, size = %" PRIuPTR "] (errno = %d)",
+                           address,
+                           size,
+                           errno);
+        return false;
+    }
+
+    return true;
+#else
+    GFXRECON_UNREFERENCED_PARAMETER(address);
+    GFXRECON_UNREFERENCED_PARAMETER(size);
+    return false;
+#endif
+}
+
+bool PageGuardManager::ScanWrittenPages(void* address, size_t size, PageStatusTracker* status_tracker)
+{
+    bool modified = false;
+
+#if defined(PAGE_GUARD_USERFAULTFD_SUPPORTED)
+    assert((address != nullptr) && (status_tracker != nullptr) && (pagemap_fd_ != -1));
+
+    PagemapRegion regions[kPagemapScanMaxRegions];
+    uint64_t      base  = reinterpret_cast<uintptr_t>(address);
+    uint64_t      start = base;
+    uint64_t      end   = base + GetAlignedSize(size);
+
+    // Written pages are reported and write-protected again in the same page table walk, so a write that is made
+    // while the scan is in progress is reported by either this scan or the next one.
+    PagemapScanArgs args = {};
+    args.size            = sizeof(args);
+    args.flags           = kPagemapScanWpMatching | kPagemapScanCheckWpAsync;
+    args.end             = end;
+    args.vec             = reinterpret_cast<uintptr_t>(regions);
+    args.vec_len         = kPagemapScanMaxRegions;
+    args.category_mask   = kPagemapPageIsWritten;
+    args.return_mask     = kPagemapPageIsWritten;
+
+    while (start < end)
+    {
+        args.start    = start;
+        args.walk_end = 0;
+
+        int region_count = ioctl(pagemap_fd_, kPagemapScan, &args);
+        if (region_count == -1)
+        {
+            GFXRECON_LOG_ERROR("PageGuardManager failed to scan written pages for memory region [start address = %p, "
+                               "size = %" PRIuPTR "] (errno = %d)",
+                               address,
+                               size,
+                               errno);
+            break;
+        }
+
+        for (int i = 0; i < region_count; ++i)
+        {
+            size_t first_page = static_cast<size_t>((regions[i].start - base) / system_page_size_);
+            size_t end_page   = static_cast<size_t>((regions[i].end - base) / system_page_size_);
+
+            for (size_t page = first_page; page < end_page; ++page)
+            {
+                status_tracker->SetActiveWriteBlock(page, true);
+            }
+
+            modified = true;
+        }
+
+        // The walk ends early when the region array is full.
+        if (args.walk_end <= start)
+        {
+            break;
+        }
+
+        start = args.walk_end;
+    }
+#else
+    GFXRECON_UNREFERENCED_PARAMETER(address);
+    GFXRECON_UNREFERENCED_PARAMETER(size);
+    GFXRECON_UNREFERENCED_PARAMETER(status_tracker);
+#endif
+
+    return modified;
+}
+
+void PageGuardManager::LoadScannedWriteStates(MemoryInfo* memory_info)
+{
+    assert((memory_info != nullptr) && (memory_info->shadow_memory != nullptr));
+
+    if (ScanWrittenPages(memory_info->shadow_memory, memory_info->shadow_range, &memory_info->status_tracker))
+    {
+        memory_info->is_modified = true;
+    }
+}
+
+bool PageGuardManager::InitializeHugePages()
+{
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+    FILE* mode_file = nullptr;
+    char  mode[128] = {};
+
+    // Allocations that are marked with MADV_HUGEPAGE are only backed by huge pages when the mode is "always" or
+    // "madvise".
+    if (platform::FileOpen(&mode_file, "/sys/kernel/mm/transparent_hugepage/enabled", "r") != 0)
+    {
+        GFXRECON_LOG_WARNING("PageGuardManager transparent huge pages are not supported by the kernel");
+        return false;
+    }
+
+    bool enabled = ((fgets(mode, sizeof(mode), mode_file) != nullptr) && (strstr(mode, "[never]") == nullptr));
+    platform::FileClose(mode_file);
+
+    if (!enabled)
+    {
+        GFXRECON_LOG_WARNING("PageGuardManager transparent huge pages are disabled by the system configuration");
+        return false;
+    }
+
+    FILE*              size_file = nullptr;
+    unsigned long long page_size = 0;
+
+    if (platform::FileOpen(&size_file, "/sys/kernel/mm/transparent_hugepage/hpage_pmd_size", "r") == 0)
+    {
+        if (fscanf(size_file, "%llu", &page_size) != 1)
+        {
+            page_size = 0;
+        }
+
+        platform::FileClose(size_file);
+    }
+
+    if ((page_size <= system_page_size_) || ((page_size & (page_size - 1)) != 0))
+    {
+        GFXRECON_LOG_WARNING("PageGuardManager failed to determine the transparent huge page size");
+        return false;
+    }
+
+    huge_page_size_ = static_cast<size_t>(page_size);
+
+    return true;
+#else
+    GFXRECON_LOG_WARNING("PageGuardManager huge page shadow memory is not supported on this platform");
+    return false;
+#endif
+}
+
+void* PageGuardManager::AllocateHugePageMemory(size_t aligned_size)
+{
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+    assert(huge_page_size_ != 0);
+
+    // Reserve enough extra memory to align the start of the allocation to a huge page boundary, then release the
+    // unused memory before and after the aligned allocation.
+    size_t reserve_size = aligned_size + huge_page_size_;
+    void*  reserve      = mmap(nullptr, reserve_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    if (reserve == MAP_FAILED)
+    {
+        return nullptr;
+    }
+
+    uintptr_t reserve_start = reinterpret_cast<uintptr_t>(reserve);
+    uintptr_t memory_start  = (reserve_start + huge_page_size_ - 1) & ~(static_cast<uintptr_t>(huge_page_size_) - 1);
+    size_t    head_size     = memory_start - reserve_start;
+    size_t    tail_size     = reserve_size - head_size - aligned_size;
+    void*     memory        = reinterpret_cast<void*>(memory_start);
+
+    if (head_size > 0)
+    {
+        munmap(reserve, head_size);
+    }
+
+    if (tail_size > 0)
+    {
+        munmap(static_cast<uint8_t*>(memory) + aligned_size, tail_size);
+    }
+
+    if (madvise(memory, aligned_size, MADV_HUGEPAGE) == -1)
+    {
+        GFXRECON_LOG_DEBUG("PageGuardManager failed to enable huge pages for shadow memory [start address = %p, size = "
+                           "%" PRIuPTR "] (madvise() produced error code %d)",
+                           memory,
+                           aligned_size,
+                           errno);
+    }
+    else
+    {
+        ++huge_page_allocation_count_;
+        huge_page_allocation_size_ += aligned_size;
+    }
+
+    return memory;
+#else
+    GFXRECON_UNREFERENCED_PARAMETER(aligned_size);
+    return nullptr;
+#endif
+}
+
+size_t PageGuardManager::GetHugePageBackedSize(const void* address, size_t size) const
+{
+    size_t backed_size = 0;
+
+#if defined(__linux__)
+    FILE* smaps = nullptr;
+
+    if (platform::FileOpen(&smaps, "/proc/self/smaps", "r") == 0)
+    {
+        uintptr_t range_start = reinterpret_cast<uintptr_t>(address);
+        uintptr_t range_end   = range_start + size;
+        bool      in_range    = false;
+        bool      line_start  = true;
+        char      line[256];
+
+        // Protection changes split the shadow memory into multiple mappings, so the AnonHugePages entries are summed
+        // for all mappings within the range.  Long lines are read in pieces, and only the first piece of each line is
+        // parsed.
+        while (fgets(line, sizeof(line), smaps) != nullptr)
+        {
+            bool               parse = line_start;
+            unsigned long long start = 0;
+            unsigned long long end   = 0;
+            unsigned long long kb    = 0;
+
+            line_start = (strchr(line, '\n') != nullptr);
+
+            if (!parse)
+            {
+                continue;
+            }
+
+            if (sscanf(line, "%llx-%llx ", &start, &end) == 2)
+            {
+                in_range = ((start >= range_start) && (end <= range_end));
+            }
+            else if (in_range && (sscanf(line, "AnonHugePages: %llu kB", &kb) == 1))
+            {
+                backed_size += static_cast<size_t>(kb * 1024);
+            }
+        }
+
+        platform::FileClose(smaps);
+    }
+#else
+    GFXRECON_UNREFERENCED_PARAMETER(address);
+    GFXRECON_UNREFERENCED_PARAMETER(size);
+#endif
+
+    return backed_size;
+}
+
+void PageGuardManager::LogHugePageStatistics() const
+{
+    // Each fault changes the protection of a system page, which splits the huge page mapping that contains it.
+    GFXRECON_LOG_INFO("PageGuardManager allocated %" PRIuPTR " shadow memory regions with a total size of %" PRIuPTR
+                      " bytes with huge pages of size %" PRIuPTR "; %" PRIuPTR " shadow memory faults were handled",
+                      huge_page_allocation_count_.load(),
+                      huge_page_allocation_size_.load(),
+                      huge_page_size_,
+                      guard_fault_count_);
+}
+
+bool PageGuardManager::InitializePrefetch()
+{
+#if defined(__linux__) && defined(MREMAP_FIXED)
+    enable_prefetch_ = true;
+    prefetch_exit_   = false;
+    prefetch_thread_ = std::thread(&PageGuardManager::ProcessPrefetchQueue, this);
+
+    return true;
+#else
+    GFXRECON_LOG_WARNING("PageGuardManager shadow memory prefetch is not supported on this platform");
+    return false;
+#endif
+}
+
+void PageGuardManager::DestroyPrefetch()
+{
+    if (prefetch_thread_.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(tracked_memory_lock_);
+            prefetch_exit_ = true;
+        }
+
+        prefetch_condition_.notify_one();
+        prefetch_thread_.join();
+    }
+}
+
+void PageGuardManager::ProcessPrefetchQueue()
+{
+    std::unique_lock<std::mutex> lock(tracked_memory_lock_);
+
+    while (!prefetch_exit_)
+    {
+        if (prefetch_queue_.empty())
+        {
+            prefetch_condition_.wait(lock);
+            continue;
+        }
+
+        uint64_t memory_id = prefetch_queue_.front();
+        auto     entry     = memory_info_.find(memory_id);
+
+        if ((entry == memory_info_.end()) || !PrefetchShadowMemory(memory_id, &entry->second, &lock))
+        {
+            // The memory was removed or all of its pages have been loaded.
+            prefetch_queue_.pop_front();
+        }
+
+        // Release the lock between blocks so that page guard faults and memory processing are not blocked for the
+        // duration of the prefetch.
+        lock.unlock();
+        std::this_thread::yield();
+        lock.lock();
+    }
+}
+
+bool PageGuardManager::PrefetchShadowMemory(uint64_t                      memory_id,
+                                            MemoryInfo*                   memory_info,
+                                            std::unique_lock<std::mutex>* lock)
+{
+#if defined(__linux__) && defined(MREMAP_FIXED)
+    assert((memory_info != nullptr) && (memory_info->shadow_memory != nullptr));
+    assert((lock != nullptr) && lock->owns_lock());
+
+    PageStatusTracker& status_tracker = memory_info->status_tracker;
+    size_t             total_pages    = memory_info->total_pages;
+    size_t             start_index    = status_tracker.FindNextUnloadedBlock(memory_info->prefetch_cursor);
+
+    if (start_index == total_pages)
+    {
+        start_index = status_tracker.FindNextUnloadedBlock(0);
+
+        if (start_index == total_pages)
+        {
+            return false;
+        }
+    }
+
+    size_t end_index  = std::min(status_tracker.FindNextLoadedBlock(start_index),
+                                std::min(start_index + (kPrefetchBlockSize / system_page_size_), total_pages));
+    size_t offset     = start_index * system_page_size_;
+    size_t block_size = (end_index - start_index) * system_page_size_;
+    size_t copy_size  = block_size;
+
+    if (end_index == total_pages)
+    {
+        // Adjust range for memory ranges that end with a partial page.
+        copy_size -= system_page_size_ - memory_info->last_segment_size;
+    }
+
+    // The pages are loaded into a separate allocation, which is guarded and then moved over the shadow memory pages.
+    // The move replaces the guarded shadow memory pages atomically, so the application cannot access the pages without
+    // triggering the page guard while they are loaded.  The lock is released while the pages are copied, so that page
+    // guard faults and memory map and unmap are not blocked by the copy.  RemoveMemory() waits for the copy to complete
+    // before the mapped memory can be unmapped.
+    void*       destination = static_cast<uint8_t*>(memory_info->shadow_memory) + offset;
+    const void* source      = static_cast<uint8_t*>(memory_info->mapped_memory) + offset;
+    bool        uncached    = memory_info->uncached;
+
+    prefetch_memory_id_ = memory_id;
+    lock->unlock();
+
+    bool  loaded = false;
+    void* block  = mmap(nullptr, block_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    if (block != MAP_FAILED)
+    {
+        MemoryCopy(block, source, copy_size, uncached);
+        loaded = SetMemoryProtection(block, block_size, kGuardReadWriteProtect);
+    }
+
+    lock->lock();
+    prefetch_memory_id_ = 0;
+    prefetch_complete_condition_.notify_all();
+
+    if (block == MAP_FAILED)
+    {
+        GFXRECON_LOG_ERROR("PageGuardManager failed to allocate shadow memory prefetch block with size = %" PRIuPTR,
+                           block_size);
+        return false;
+    }
+
+    if (loaded && (status_tracker.FindNextLoadedBlock(start_index) < end_index))
+    {
+        // Pages that were loaded by the page guard handler during the copy may have been modified by the application,
+        // so the block is discarded and the remaining pages are loaded by the next prefetch.
+        munmap(block, block_size);
+        return true;
+    }
+
+    if (!loaded || (mremap(block, block_size, block_size, MREMAP_MAYMOVE | MREMAP_FIXED, destination) == MAP_FAILED))
+    {
+        GFXRECON_LOG_ERROR("PageGuardManager failed to prefetch shadow memory [start address = %p, size = %" PRIuPTR
+                           "] (errno = %d)",
+                           destination,
+                           block_size,
+                           errno);
+        munmap(block, block_size);
+        return false;
+    }
+
+#if defined(MADV_HUGEPAGE)
+    if ((huge_page_size_ != 0) && (memory_info->shadow_range >= huge_page_size_))
+    {
+        // The moved pages replace the shadow memory mapping for the block, which does not have the huge page advice
+        // that was applied when the shadow memory was allocated.
+        madvise(destination, block_size, MADV_HUGEPAGE);
+    }
+#endif
+
+    for (size_t i = start_index; i < end_index; ++i)
+    {
+        status_tracker.SetBlockLoaded(i, true);
+    }
+
+    memory_info->prefetch_cursor = end_index;
+
+    return true;
+#else
+    GFXRECON_UNREFERENCED_PARAMETER(memory_id);
+    GFXRECON_UNREFERENCED_PARAMETER(memory_info);
+    GFXRECON_UNREFERENCED_PARAMETER(lock);
+    return false;
+#endif
+}
+
+void PageGuardManager::LoadActiveWriteStates(MemoryInfo* memory_info)
+{
+    assert((memory_info != nullptr) && (memory_info->shadow_memory == nullptr));
+
+#if defined(WIN32)
+    auto      modified_addresses = memory_info->modified_addresses.get();
+    ULONG_PTR modified_count     = memory_info->total_pages;
+    DWORD     granularity        = 0;
+
+    if (GetWriteWatch(WRITE_WATCH_FLAG_RESET,
+                      memory_info->aligned_address,
+                      memory_info->mapped_range + memory_info->aligned_offset,
+                      modified_addresses,
+                      &modified_count,
+                      &granularity) == 0)
+    {
+        if (modified_count > 0)
+        {
+            memory_info->is_modified = true;
+
+            for (ULONG_PTR i = 0; i < modified_count; ++i)
+            {
+                // Get offset from the page-aligned start address of the mapped memory to the address of the modified
+                // page.
+                size_t start_offset =
+                    static_cast<uint8_t*>(modified_addresses[i]) - static_cast<uint8_t*>(memory_info->aligned_address);
+                size_t page_index = start_offset / system_page_size_;
+
+                memory_info->status_tracker.SetActiveWriteBlock(page_index, true);
+            }
+        }
+    }
+    else
+    {
+        GFXRECON_LOG_ERROR("PageGuardManager failed to retrieve write-modified pages for memory region [start address "
+                           "= %p, size = %" PRIuPTR "] (GetWriteWatch() produced error code %u)",
+                           memory_info->mapped_memory,
+                           memory_info->mapped_range,
+                           GetLastError());
+    }
+#endif
+}
+
+void PageGuardManager::ProcessEntry(uint64_t                 memory_id,
+                                    MemoryInfo*              memory_info,
+                                    ModifiedMemoryFunc       handle_modified,
+                                    std::vector<GuardRange>* guard_ranges)
+{
+    assert(memory_info != nullptr);
+
+    // Range of pages, [guard_start, guard_end), with page guards that need to be reset.  Pages that were written and
+    // pages that were only read are combined into contiguous runs, so that the guard for each run can be reset with a
+    // single call.
+    size_t guard_start = 0;
+    size_t guard_end   = 0;
+
+    memory_info->is_modified = false;
+
+    size_t index = memory_info->status_tracker.FindNextActiveBlock(0);
+
+    while (index < memory_info->total_pages)
+    {
+        size_t end_index = index + 1;
+
+        if (memory_info->status_tracker.IsActiveWriteBlock(index))
+        {
+            // Concatenate dirty pages to handle as large a range as possible with a single modified memory handler
+            // invocation.
+            end_index = memory_info->status_tracker.FindActiveWriteRunEnd(index);
+
+            ProcessActiveRange(memory_id, memory_info, index, end_index, handle_modified);
+        }
+        else
+        {
+            // If there was no write operation on the current page, there was a read operation.  If a read operation
+            // triggered the page guard handler, it needs to be reset.  Note that it is only possible to reach this
+            // state when enable_shadow_memory_ is true and enable_read_write_same_page_ is false.
+            assert(memory_info->status_tracker.IsActiveReadBlock(index));
+            assert(memory_info->shadow_memory != nullptr);
+        }
+
+        memory_info->status_tracker.ClearActiveBlocks(index, end_index);
+
+        if (memory_info->shadow_memory != nullptr)
+        {
+            if ((guard_end != index) || (guard_start == guard_end))
+            {
+                ResetGuardRange(memory_info, guard_start, guard_end, guard_ranges);
+                guard_start = index;
+            }
+
+            guard_end = end_index;
+        }
+
+        index = memory_info->status_tracker.FindNextActiveBlock(end_index);
+    }
+
+    ResetGuardRange(memory_info, guard_start, guard_end, guard_ranges);
+}
+
+void PageGuardManager::ResetGuardRange(MemoryInfo*              memory_info,
+                                       size_t                   start_index,
+                                       size_t                   end_index,
+                                       std::vector<GuardRange>* guard_ranges)
+{
+    assert(memory_info != nullptr);
+
+    if (end_index > start_index)
+    {
+        assert(memory_info->shadow_memory != nullptr);
+
+        void*  start_address = static_cast<uint8_t*>(memory_info->shadow_memory) + (start_index * system_page_size_);
+        size_t page_range    = (end_index - start_index) * system_page_size_;
+
+        if (end_index == memory_info->total_pages)
+        {
+            // Adjust range for memory ranges that end with a partial page.
+            page_range -= system_page_size_ - memory_info->last_segment_size;
+        }
+
+        // Reset page guard to detect both read and write protection when using shadow memory.
+        if (guard_ranges == nullptr)
+        {
+            ResetShadowMemory(start_address, page_range);
+        }
+        else
+        {
+            guard_ranges->push_back({ start_address, page_range });
+        }
+    }
+}
+
+void PageGuardManager::ProcessActiveRange(uint64_t           memory_id,
+                                          MemoryInfo*        memory_info,
+                                          size_t             start_index,
+                                          size_t             end_index,
+                                          ModifiedMemoryFunc handle_modified)
+{
+    assert((memory_info != nullptr) && (memory_info->aligned_address != nullptr));
+    assert(end_index > start_index);
+
+    size_t page_count  = end_index - start_index;
+    size_t page_offset = start_index * system_page_size_;
+    size_t page_range  = page_count * system_page_size_;
+
+    if (end_index == memory_info->total_pages)
+    {
+        // Adjust range for memory ranges that end with a partial page.
+        page_range -= system_page_size_ - memory_info->last_segment_size;
+    }
+
+    if (memory_info->shadow_memory != nullptr)
+    {
+        void* start_address = static_cast<uint8_t*>(memory_info->shadow_memory) + page_offset;
+
+        // Page guard was disabled when these pages were accessed.  We enable it now for write, to
+        // trap any writes made to the memory while we are performing the copy from shadow memory
+        // to mapped memory.
+        WriteProtectShadowMemory(start_address, page_range);
+
+        void* destination_address = static_cast<uint8_t*>(memory_info->mapped_memory) + page_offset;
+
+        if (diff_granularity_ > 0)
+        {
+            // The mapped memory contains the content of the range from before it was modified, so the modified pages
+            // can be refined to the blocks that differ.  The differing blocks are copied from shadow memory to mapped
+            // memory, and the shadow memory address, offset, and size of each block is provided to the callback.
+            FindModifiedRanges(start_address,
+                               destination_address,
+                               page_range,
+                               diff_granularity_,
+                               [&](size_t range_offset, size_t range_size) {
+                                   handle_modified(
+                                       memory_id, memory_info->shadow_memory, page_offset + range_offset, range_size);
+                               });
+        }
+        else
+        {
+            // Copy from shadow memory to the original mapped memory
+            MemoryCopy(destination_address, start_address, page_range, false);
+
+            // The shadow memory address, page offset, and range values to be provided to the callback, which will
+            // process the memory range.
+            handle_modified(memory_id, memory_info->shadow_memory, page_offset, page_range);
+        }
+    }
+    else
+    {
+        // Copy directly from the mapped memory.
+        if (start_index == 0)
+        {
+            // If the watch pointer was aligned to the start of a page, the alignment offset needs to be
+            // deducted from the page range.
+            page_range -= memory_info->aligned_offset;
+        }
+        else
+        {
+            // If the start address was aligned to the start of a page, the alignment offset needs to be deducted from
+            // the start offset.
+            page_offset -= memory_info->aligned_offset;
+        }
+
+        // The mapped memory address, page offset, and range values to be provided to the callback, which will process
+        // the memory range.
+        handle_modified(memory_id, memory_info->mapped_memory, page_offset, page_range);
+    }
+}
+
+bool PageGuardManager::GetMemory(uint64_t memory_id, void** memory)
+{
+    assert(memory != nullptr);
+
+    std::lock_guard<std::mutex> lock(tracked_memory_lock_);
+
+    auto entry = memory_info_.find(memory_id);
+    if (entry != memory_info_.end())
+    {
+        if (entry->second.shadow_memory != nullptr)
+        {
+            (*memory) = entry->second.shadow_memory;
+        }
+        else
+        {
+            (*memory) = entry->second.mapped_memory;
+        }
+
+        return true;
+    }
+
+    return false;
+}
+
+void* PageGuardManager::AddMemory(uint64_t memory_id, void* mapped_memory, size_t size, bool uncached)
+{
+    void*  aligned_address = nullptr;
+    void*  shadow_memory   = nullptr;
+    size_t shadow_size     = 0;
+    size_t aligned_offset  = 0;
+
+    if (enable_shadow_memory_)
+    {
+        shadow_size   = GetAlignedSize(size);
+        shadow_memory = AllocateMemory(shadow_size);
+
+        if (shadow_memory != nullptr)
+        {
+            aligned_address = shadow_memory;
+
+            // With userfaultfd, pages are always filled from mapped memory on first access, so the copy is not
+            // performed at map time.  Leaving the pages unpopulated also ensures that the first read of each page is
+            // synchronized with the mapped memory.  With prefetch, the copy is performed by the prefetch thread.
+            if ((enable_copy_on_map_ && !enable_lazy_copy_ && !enable_prefetch_ && (uffd_ == -1)) ||
+                (pagemap_fd_ != -1))
+            {
+                // Page table scans cannot detect reads, so the copy is always performed at map time.
+                MemoryCopy(shadow_memory, mapped_memory, size, uncached);
+            }
+        }
+    }
+    else
+    {
+        // Align the mapped memory pointer to the start of its page.
+        aligned_address = AlignToPageStart(mapped_memory);
+        aligned_offset  = GetOffsetFromPageStart(mapped_memory);
+    }
+
+    if (aligned_address != nullptr)
+    {
+        size_t guard_range       = size + aligned_offset;
+        size_t total_pages       = guard_range / system_page_size_;
+        size_t last_segment_size = guard_range % system_page_size_;
+
+        if (last_segment_size != 0)
+        {
+            ++total_pages;
+        }
+        else
+        {
+            last_segment_size = system_page_size_;
+        }
+
+        const void* start_address = mapped_memory;
+        bool        success       = true;
+
+        std::lock_guard<std::mutex> lock(tracked_memory_lock_);
+
+        if (shadow_memory != nullptr)
+        {
+            start_address = shadow_memory;
+            success       = GuardShadowMemory(shadow_memory, guard_range);
+        }
+
+        if (success)
+        {
+            assert(memory_info_.find(memory_id) == memory_info_.end());
+
+            auto entry = memory_info_.emplace(std::piecewise_construct,
+                                              std::forward_as_tuple(memory_id),
+                                              std::forward_as_tuple(mapped_memory,
+                                                                    size,
+                                                                    shadow_memory,
+                                                                    shadow_size,
+                                                                    aligned_address,
+                                                                    aligned_offset,
+                                                                    total_pages,
+                                                                    last_segment_size,
+                                                                    start_address,
+                                                                    static_cast<const uint8_t*>(start_address) + size,
+                                                                    uncached));
+
+            if (entry.second)
+            {
+                memory_regions_[reinterpret_cast<uintptr_t>(start_address)] = &entry.first->second;
+
+                if (enable_prefetch_ && (shadow_memory != nullptr))
+                {
+                    prefetch_queue_.push_back(memory_id);
+                    prefetch_condition_.notify_one();
+                }
+            }
+            else if (shadow_memory != nullptr)
+            {
+                FreeMemory(shadow_memory, shadow_size);
+                shadow_memory = nullptr;
             }
         }
     }
@@ -733,7 +1829,10 @@ void* PageGuardManager::AddMemory(uint64_t memory_id, void* mapped_memory, size_
 
 void PageGuardManager::RemoveMemory(uint64_t memory_id)
 {
-    std::lock_guard<std::mutex> lock(tracked_memory_lock_);
+    std::unique_lock<std::mutex> lock(tracked_memory_lock_);
+
+    // The mapped memory cannot be unmapped while the prefetch thread is copying from it.
+    prefetch_complete_condition_.wait(lock, [this, memory_id]() { return prefetch_memory_id_ != memory_id; });
 
     auto entry = memory_info_.find(memory_id);
     if (entry != memory_info_.end())
@@ -743,10 +1842,25 @@ void PageGuardManager::RemoveMemory(uint64_t memory_id)
 
         if (memory_info.shadow_memory != nullptr)
         {
-            RemoveExceptionHandler();
+            if ((uffd_ == -1) && (pagemap_fd_ == -1))
+            {
+                RemoveExceptionHandler();
+            }
+
+            if ((huge_page_size_ != 0) && (memory_info.shadow_range >= huge_page_size_) &&
+                Log::WillOutputMessage(Log::kDebugSeverity))
+            {
+                GFXRECON_LOG_DEBUG("PageGuardManager shadow memory [start address = %p, size = %" PRIuPTR
+                                   "] was backed by %" PRIuPTR " bytes of huge pages",
+                                   memory_info.shadow_memory,
+                                   memory_info.shadow_range,
+                                   GetHugePageBackedSize(memory_info.shadow_memory, memory_info.shadow_range));
+            }
+
             FreeMemory(memory_info.shadow_memory, memory_info.shadow_range);
         }
 
+        memory_regions_.erase(reinterpret_cast<uintptr_t>(memory_info.start_address));
         memory_info_.erase(entry);
     }
 }
@@ -767,10 +1881,14 @@ void PageGuardManager::ProcessMemoryEntry(uint64_t memory_id, ModifiedMemoryFunc
             // When not using shadow memory, we need to query for active write status.
             LoadActiveWriteStates(memory_info);
         }
+        else if (pagemap_fd_ != -1)
+        {
+            LoadScannedWriteStates(memory_info);
+        }
 
         if (memory_info->is_modified)
         {
-            ProcessEntry(entry->first, memory_info, handle_modified);
+            ProcessEntry(entry->first, memory_info, handle_modified, nullptr);
         }
     }
 }
@@ -783,6 +1901,64 @@ void PageGuardManager::ProcessMemoryEntries(ModifiedMemoryFunc handle_modified)
     {
         auto memory_info = &entry->second;
 
+        if (memory_info->shadow_memory == nullptr)
+        {
+            // Active memory tracking with VirtualProtect()/mprotect() is only applied to shadow memory.
+            // When not using shadow memory, we need to query for active write status.
+            LoadActiveWriteStates(memory_info);
+        }
+        else if (pagemap_fd_ != -1)
+        {
+            LoadScannedWriteStates(memory_info);
+        }
+
+        if (memory_info->is_modified)
+        {
+            ProcessEntry(entry->first, memory_info, handle_modified, nullptr);
+        }
+    }
+}
+
+void PageGuardManager::ProcessMemoryEntries(ThreadPool* thread_pool, ModifiedMemoryRangesFunc handle_modified_ranges)
+{
+    assert(thread_pool != nullptr);
+
+    std::lock_guard<std::mutex> lock(tracked_memory_lock_);
+
+    // Entries are collected in the iteration order of the serial path, so the modified ranges are reported in the same
+    // order regardless of how the work is distributed across threads.
+    size_t pending_count = 0;
+
+    for (auto entry = memory_info_.begin(); entry != memory_info_.end(); ++entry)
+    {
+        auto memory_info = &entry->second;
+
+        if ((memory_info->shadow_memory != nullptr) && (pagemap_fd_ != -1))
+        {
+            LoadScannedWriteStates(memory_info);
+        }
+
+        if ((memory_info->shadow_memory == nullptr) || memory_info->is_modified)
+        {
+            if (pending_count == pending_entries_.size())
+            {
+                pending_entries_.emplace_back();
+            }
+
+            PendingEntry& pending = pending_entries_[pending_count++];
+            pending.memory_id     = entry->first;
+            pending.memory_info   = memory_info;
+            pending.modified_ranges.clear();
+            pending.guard_ranges.clear();
+        }
+    }
+
+    // Copy modified shadow memory to mapped memory, leaving the page guards for the modified ranges in the read-only
+    // state so that the shadow memory content remains stable until the ranges have been processed.
+    thread_pool->Run(pending_count, [this](size_t index) {
+        PendingEntry& pending     = pending_entries_[index];
+        MemoryInfo*   memory_info = pending.memory_info;
+
         if (memory_info->shadow_memory == nullptr)
         {
             // Active memory tracking with VirtualProtect()/mprotect() is only applied to shadow memory.
@@ -792,9 +1968,35 @@ void PageGuardManager::ProcessMemoryEntries(ModifiedMemoryFunc handle_modified)
 
         if (memory_info->is_modified)
         {
-            ProcessEntry(entry->first, memory_info, handle_modified);
+            ProcessEntry(
+                pending.memory_id,
+                memory_info,
+                [&pending](uint64_t memory_id, void* start_address, size_t offset, size_t size) {
+                    pending.modified_ranges.push_back({ memory_id, start_address, offset, size });
+                },
+                &pending.guard_ranges);
         }
+    });
+
+    modified_ranges_.clear();
+
+    for (size_t i = 0; i < pending_count; ++i)
+    {
+        const auto& ranges = pending_entries_[i].modified_ranges;
+        modified_ranges_.insert(modified_ranges_.end(), ranges.begin(), ranges.end());
+    }
+
+    if (!modified_ranges_.empty())
+    {
+        handle_modified_ranges(modified_ranges_);
     }
+
+    thread_pool->Run(pending_count, [this](size_t index) {
+        for (const auto& guard_range : pending_entries_[index].guard_ranges)
+        {
+            ResetShadowMemory(guard_range.address, guard_range.size);
+        }
+    });
 }
 
 bool PageGuardManager::HandleGuardPageViolation(void* address, bool is_write, bool clear_guard)
@@ -810,6 +2012,7 @@ bool PageGuardManager::HandleGuardPageViolation(void* address, bool is_write, bo
         assert(reinterpret_cast<uintptr_t>(address) >= reinterpret_cast<uintptr_t>(memory_info->aligned_address));
 
         memory_info->is_modified = true;
+        ++guard_fault_count_;
 
         // Get the offset from the start of the first protected memory page to the current address.
         size_t start_offset = static_cast<uint8_t*>(address) - static_cast<uint8_t*>(memory_info->aligned_address);
@@ -819,6 +2022,13 @@ bool PageGuardManager::HandleGuardPageViolation(void* address, bool is_write, bo
         void*  page_address = AlignToPageStart(address);
         size_t segment_size = GetMemorySegmentSize(memory_info, page_index);
 
+        if (enable_prefetch_ && !memory_info->status_tracker.IsBlockLoaded(page_index))
+        {
+            // The first access to a page that has not been loaded is likely to be followed by accesses to the pages
+            // that follow it, so the prefetch thread resumes loading from the next page.
+            memory_info->prefetch_cursor = page_index + 1;
+        }
+
         // Remove protection from page before accessing memory, if required by current guard type (required for all
         // types except WIN32 PAGE_GUARD).
         if (clear_guard)
@@ -840,7 +2050,8 @@ bool PageGuardManager::HandleGuardPageViolation(void* address, bool is_write, bo
             //   If the optimization is enabled, but this is not the first access to the block since it was mapped, the
             //   copy is unnecessary.
             if ((memory_info->shadow_memory != nullptr) &&
-                (enable_copy_on_map_ && enable_lazy_copy_ && !memory_info->status_tracker.IsBlockLoaded(page_index)))
+                (enable_copy_on_map_ && (enable_lazy_copy_ || enable_prefetch_) &&
+                 !memory_info->status_tracker.IsBlockLoaded(page_index)))
             {
                 // Advance the mapped memory pointer by the offset from the start of the shadow memory to the start of
                 // the modified page.
@@ -848,7 +2059,7 @@ bool PageGuardManager::HandleGuardPageViolation(void* address, bool is_write, bo
                 assert(modified_page_start == (page_index * system_page_size_));
                 void* source_address = static_cast<uint8_t*>(memory_info->mapped_memory) + modified_page_start;
 
-                MemoryCopy(page_address, source_address, segment_size);
+                MemoryCopy(page_address, source_address, segment_size, memory_info->uncached);
                 memory_info->status_tracker.SetBlockLoaded(page_index, true);
             }
 
@@ -860,7 +2071,7 @@ bool PageGuardManager::HandleGuardPageViolation(void* address, bool is_write, bo
             assert(memory_info->shadow_memory != nullptr);
 
             // This is a read from shadow memory with separate read tracking enabled.
-            if (enable_copy_on_map_ && enable_lazy_copy_)
+            if (enable_copy_on_map_ && (enable_lazy_copy_ || enable_prefetch_))
             {
                 // Mark the page as loaded for lazy copy on map.
                 memory_info->status_tracker.SetBlockLoaded(page_index, true);
@@ -871,7 +2082,7 @@ bool PageGuardManager::HandleGuardPageViolation(void* address, bool is_write, bo
             size_t modified_page_start = start_offset - page_offset;
             assert(modified_page_start == (page_index * system_page_size_));
             void* source_address = reinterpret_cast<uint8_t*>(memory_info->mapped_memory) + modified_page_start;
-            MemoryCopy(page_address, source_address, segment_size);
+            MemoryCopy(page_address, source_address, segment_size, memory_info->uncached);
 
             memory_info->status_tracker.SetActiveReadBlock(page_index, true);
 
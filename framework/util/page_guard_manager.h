@@ -21,13 +21,20 @@
 
 #include "util/defines.h"
 #include "util/page_status_tracker.h"
+#include "util/thread_pool.h"
 
+#include <atomic>
+#include <condition_variable>
 #include <cstddef>
 #include <cstdint>
+#include <deque>
 #include <functional>
+#include <map>
 #include <memory>
 #include <mutex>
+#include <thread>
 #include <unordered_map>
+#include <vector>
 
 GFXRECON_BEGIN_NAMESPACE(gfxrecon)
 GFXRECON_BEGIN_NAMESPACE(util)
@@ -38,8 +45,11 @@ class PageGuardManager
     static const bool kDefaultEnableShadowMemory      = true;
     static const bool kDefaultEnableCopyOnMap         = true;
     static const bool kDefaultEnableLazyCopy          = false;
+    static const bool kDefaultEnablePrefetch          = false;
     static const bool kDefaultEnableSeparateRead      = true;
     static const bool kDefaultEnableReadWriteSamePage = true;
+    static const bool kDefaultEnableUserfaultfd       = false;
+    static const bool kDefaultEnableHugePages         = false;
 
   public:
     // Callback for processing modified memory.  The function parameters are the ID of the modified memory object,
@@ -47,12 +57,31 @@ class PageGuardManager
     // the modified range pointer, and the size of the modified range.
     typedef std::function<void(uint64_t, void*, size_t, size_t)> ModifiedMemoryFunc;
 
+    // A modified memory range, described by the same values that are provided to ModifiedMemoryFunc.
+    struct ModifiedMemoryRange
+    {
+        uint64_t memory_id;
+        void*    start_address;
+        size_t   offset;
+        size_t   size;
+    };
+
+    // Callback for processing all of the ranges that were modified since the last call to ProcessMemoryEntries.  The
+    // ranges are provided in the order that ProcessMemoryEntries would have provided them to ModifiedMemoryFunc, and
+    // their content may only be accessed until the callback returns.
+    typedef std::function<void(const std::vector<ModifiedMemoryRange>&)> ModifiedMemoryRangesFunc;
+
   public:
-    static void Create(bool enable_shadow_memory,
-                       bool enable_copy_on_map,
-                       bool enable_lazy_copy,
-                       bool enable_separate_read,
-                       bool expect_read_write_same_page);
+    static void Create(bool   enable_shadow_memory,
+                       bool   enable_copy_on_map,
+                       bool   enable_lazy_copy,
+                       bool   enable_prefetch,
+                       bool   enable_separate_read,
+                       bool   expect_read_write_same_page,
+                       bool   enable_userfaultfd,
+                       bool   enable_write_scan,
+                       bool   enable_huge_pages,
+                       size_t diff_granularity);
 
     static void Destroy();
 
@@ -62,7 +91,9 @@ class PageGuardManager
 
     bool GetMemory(uint64_t memory_id, void** memory);
 
-    void* AddMemory(uint64_t memory_id, void* mapped_memory, size_t size);
+    // The uncached parameter indicates that the mapped memory is write-combined or uncached, and is read with streaming
+    // loads.
+    void* AddMemory(uint64_t memory_id, void* mapped_memory, size_t size, bool uncached);
 
     void RemoveMemory(uint64_t memory_id);
 
@@ -70,6 +101,10 @@ class PageGuardManager
 
     void ProcessMemoryEntries(ModifiedMemoryFunc handle_modified);
 
+    // Processes the tracked memory objects in parallel with the thread pool, then provides the modified ranges of all
+    // objects to a single callback invocation.
+    void ProcessMemoryEntries(ThreadPool* thread_pool, ModifiedMemoryRangesFunc handle_modified_ranges);
+
     bool HandleGuardPageViolation(void* address, bool is_write, bool clear_guard);
 
     size_t GetAlignedSize(size_t size) const;
@@ -81,11 +116,16 @@ class PageGuardManager
   protected:
     PageGuardManager();
 
-    PageGuardManager(bool enable_shadow_memory,
-                     bool enable_copy_on_map,
-                     bool enable_lazy_copy,
-                     bool enable_separate_read,
-                     bool expect_read_write_same_page);
+    PageGuardManager(bool   enable_shadow_memory,
+                     bool   enable_copy_on_map,
+                     bool   enable_lazy_copy,
+                     bool   enable_prefetch,
+                     bool   enable_separate_read,
+                     bool   expect_read_write_same_page,
+                     bool   enable_userfaultfd,
+                     bool   enable_write_scan,
+                     bool   enable_huge_pages,
+                     size_t diff_granularity);
 
     ~PageGuardManager();
 
@@ -101,11 +141,12 @@ class PageGuardManager
                    size_t      tp,
                    size_t      lss,
                    const void* sa,
-                   const void* ea) :
+                   const void* ea,
+                   bool        uc) :
             status_tracker(tp),
             mapped_memory(mm), mapped_range(mr), shadow_memory(sm), shadow_range(sr), aligned_address(aa),
             aligned_offset(ao), total_pages(tp), last_segment_size(lss), start_address(sa), end_address(ea),
-            is_modified(false)
+            is_modified(false), prefetch_cursor(0), uncached(uc)
         {
 #if defined(WIN32)
             if (shadow_memory == nullptr)
@@ -130,6 +171,8 @@ class PageGuardManager
         const void* start_address;     // Start address for the protected memory region.
         const void* end_address;       // Address immediately after the end of the protected memory region.
         bool        is_modified;
+        size_t      prefetch_cursor; // Page to resume loading from when shadow memory prefetch is enabled.
+        bool        uncached;        // Mapped memory is write-combined or uncached, and is read with streaming loads.
 
 #if defined(WIN32)
         // Memory for retrieving modified pages with GetWriteWatch.
@@ -139,6 +182,26 @@ class PageGuardManager
 
     typedef std::unordered_map<uint64_t, MemoryInfo> MemoryInfoMap;
 
+    // Page range with a page guard that needs to be reset after the modified memory it contains has been processed.
+    struct GuardRange
+    {
+        void*  address;
+        size_t size;
+    };
+
+    // Per-entry state for parallel processing of modified memory.
+    struct PendingEntry
+    {
+        uint64_t                         memory_id;
+        MemoryInfo*                      memory_info;
+        std::vector<ModifiedMemoryRange> modified_ranges;
+        std::vector<GuardRange>          guard_ranges;
+    };
+
+    // Tracked memory regions ordered by start address, for locating the region containing a faulting address in
+    // O(log n) time.  Values point into MemoryInfoMap, whose node-based storage keeps element addresses stable.
+    typedef std::map<uintptr_t, MemoryInfo*> MemoryRegionMap;
+
   private:
     size_t GetSystemPageSize() const;
 
@@ -147,16 +210,71 @@ class PageGuardManager
     void ClearExceptionHandler(void* exception_handler);
 
     size_t GetMemorySegmentSize(const MemoryInfo* memory_info, size_t page_index) const;
-    void   MemoryCopy(void* destination, const void* source, size_t size);
+    void   MemoryCopy(void* destination, const void* source, size_t size, bool uncached_source);
     bool   FindMemory(void* address, MemoryInfo** watched_memory_info);
     bool   SetMemoryProtection(void* protect_address, size_t protect_size, uint32_t protect_mask);
     void   LoadActiveWriteStates(MemoryInfo* memory_info);
-    void   ProcessEntry(uint64_t memory_id, MemoryInfo* memory_info, ModifiedMemoryFunc handle_modified);
-    void   ProcessActiveRange(uint64_t           memory_id,
-                              MemoryInfo*        memory_info,
-                              size_t             start_index,
-                              size_t             end_index,
-                              ModifiedMemoryFunc handle_modified);
+    // When guard_ranges is not null, the page guards for the modified ranges are not reset, and the ranges that need
+    // to be reset are appended to guard_ranges.
+    void ProcessEntry(uint64_t                 memory_id,
+                      MemoryInfo*              memory_info,
+                      ModifiedMemoryFunc       handle_modified,
+                      std::vector<GuardRange>* guard_ranges);
+    void ProcessActiveRange(uint64_t           memory_id,
+                            MemoryInfo*        memory_info,
+                            size_t             start_index,
+                            size_t             end_index,
+                            ModifiedMemoryFunc handle_modified);
+
+    // Resets the guard for the shadow memory pages [start_index, end_index), or adds the range to guard_ranges to be
+    // reset later when guard_ranges is not null.
+    void ResetGuardRange(MemoryInfo*              memory_info,
+                         size_t                   start_index,
+                         size_t                   end_index,
+                         std::vector<GuardRange>* guard_ranges);
+
+    // Shadow memory protection, implemented with either memory protection and an exception handler or userfaultfd.
+    bool GuardShadowMemory(void* address, size_t size);
+    bool WriteProtectShadowMemory(void* address, size_t size);
+    void ResetShadowMemory(void* address, size_t size);
+
+    // Linux userfaultfd write tracking, which reports faults for shadow memory to a handler thread instead of a signal
+    // handler.  Pages that have not been accessed since they were last processed are not populated, and are filled
+    // from the mapped memory on first access.  Pages that have been read are populated with write protection enabled.
+    bool InitializeUserfaultfd();
+    void DestroyUserfaultfd();
+    bool RegisterUserfaultfdMemory(void* address, size_t size);
+    bool SetUserfaultfdWriteProtect(void* address, size_t size, bool enable);
+    void ProcessUserfaultfdEvents();
+    void HandleUserfaultfdFault(void* address, bool is_write, bool is_write_protect);
+
+    // Linux page table scan write tracking, which write-protects shadow memory with asynchronous userfaultfd write
+    // protection and finds modified pages with the PAGEMAP_SCAN ioctl instead of handling faults.  Each scan reports
+    // the written pages of a single memory object and write-protects them again atomically, so writes made by other
+    // threads during processing are reported by the next scan.
+    bool InitializeWriteScan();
+    void DestroyWriteScan();
+    bool RegisterWriteScanMemory(void* address, size_t size);
+    bool ScanWrittenPages(void* address, size_t size, PageStatusTracker* status_tracker);
+    void LoadScannedWriteStates(MemoryInfo* memory_info);
+
+    // Linux transparent huge page support for shadow memory, which reduces the number of page faults for the copy on
+    // map and the number of TLB entries needed to access large shadow memory allocations.  Write tracking remains at
+    // system page granularity, and can be refined further with diff_granularity_.
+    bool   InitializeHugePages();
+    void*  AllocateHugePageMemory(size_t aligned_size);
+    size_t GetHugePageBackedSize(const void* address, size_t size) const;
+    void   LogHugePageStatistics() const;
+
+    // Background loading of shadow memory from mapped memory for copy on map, which allows AddMemory to return
+    // without copying the mapped memory.  Pages that are accessed before they have been loaded are loaded by the page
+    // guard handler, and loading continues from the page following the access.  Only applies to Linux/Android builds
+    // with signal based write tracking.
+    bool InitializePrefetch();
+    void DestroyPrefetch();
+    void ProcessPrefetchQueue();
+    // Called with lock holding tracked_memory_lock_, which is released while the mapped memory is copied.
+    bool PrefetchShadowMemory(uint64_t memory_id, MemoryInfo* memory_info, std::unique_lock<std::mutex>* lock);
 
     size_t GetOffsetFromPageStart(void* address) const
     {
@@ -171,6 +289,7 @@ class PageGuardManager
   private:
     static PageGuardManager* instance_;
     MemoryInfoMap            memory_info_;
+    MemoryRegionMap          memory_regions_;
     std::mutex               tracked_memory_lock_;
     void*                    exception_handler_;
     uint32_t                 exception_handler_count_;
@@ -182,6 +301,43 @@ class PageGuardManager
 
     // Only applies to WIN32 builds and Linux/Android builds with PAGE_GUARD_ENABLE_UCONTEXT_WRITE_DETECTION defined.
     const bool enable_read_write_same_page_;
+
+    // When non-zero, modified shadow memory pages are compared with the mapped memory in blocks of this size, and only
+    // the blocks that differ are reported as modified.
+    const size_t diff_granularity_;
+
+    // Only applies to Linux/Android builds; -1 when userfaultfd is disabled or unavailable.
+    int                        uffd_;
+    int                        uffd_wake_event_;
+    std::thread                uffd_thread_;
+    std::unique_ptr<uint8_t[]> uffd_page_buffer_;
+
+    // Only applies to Linux/Android builds; -1 when page table scan write tracking is disabled or unavailable.
+    int scan_uffd_;
+    int pagemap_fd_;
+
+    // Only applies to Linux/Android builds; 0 when huge page shadow memory is disabled or unavailable.  Shadow memory
+    // allocations that are at least this size are aligned to huge page boundaries and backed by huge pages.
+    size_t              huge_page_size_;
+    std::atomic<size_t> huge_page_allocation_count_;
+    std::atomic<size_t> huge_page_allocation_size_;
+
+    // Only applies to Linux/Android builds.  The queue, exit flag, and the ID of the memory that is being copied by the
+    // prefetch thread, which is 0 when no copy is in progress, are guarded by tracked_memory_lock_.
+    bool                    enable_prefetch_;
+    bool                    prefetch_exit_;
+    std::deque<uint64_t>    prefetch_queue_;
+    std::condition_variable prefetch_condition_;
+    std::thread             prefetch_thread_;
+    uint64_t                prefetch_memory_id_;
+    std::condition_variable prefetch_complete_condition_;
+
+    // Number of shadow memory faults handled; guarded by tracked_memory_lock_.
+    size_t guard_fault_count_;
+
+    // Reused by ProcessMemoryEntries for parallel processing.
+    std::vector<PendingEntry>        pending_entries_;
+    std::vector<ModifiedMemoryRange> modified_ranges_;
 };
 
 GFXRECON_END_NAMESPACE(util)
@@ -21,34 +21,166 @@
 
 #include "util/defines.h"
 
+#include <cassert>
 #include <cstddef>
 #include <cstdint>
 #include <vector>
 
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
 GFXRECON_BEGIN_NAMESPACE(gfxrecon)
 GFXRECON_BEGIN_NAMESPACE(util)
 
+// Tracks the status of each page of a memory range with one bit per page, so that ranges of pages can be scanned and
+// cleared a 64-bit word at a time.
 class PageStatusTracker
 {
   public:
     PageStatusTracker(size_t page_count) :
-        active_writes_(page_count, 0), active_reads_(page_count, 0), page_loaded_(page_count, 0)
+        page_count_(page_count), active_writes_(GetWordCount(page_count), 0),
+        active_reads_(GetWordCount(page_count), 0), page_loaded_(GetWordCount(page_count), 0)
     {}
 
     ~PageStatusTracker() {}
 
-    bool IsActiveWriteBlock(size_t index) const { return (active_writes_[index] == 1); }
-    bool IsActiveReadBlock(size_t index) const { return (active_reads_[index] == 1); }
-    bool IsBlockLoaded(size_t index) const { return (page_loaded_[index] == 1); }
+    bool IsActiveWriteBlock(size_t index) const { return GetBit(active_writes_, index); }
+    bool IsActiveReadBlock(size_t index) const { return GetBit(active_reads_, index); }
+    bool IsBlockLoaded(size_t index) const { return GetBit(page_loaded_, index); }
+
+    void SetActiveWriteBlock(size_t index, bool value) { SetBit(&active_writes_, index, value); }
+    void SetActiveReadBlock(size_t index, bool value) { SetBit(&active_reads_, index, value); }
+    void SetBlockLoaded(size_t index, bool value) { SetBit(&page_loaded_, index, value); }
+
+    // Returns the index of the first block at or after index with an active read or write, or the page count if there
+    // are no active blocks.
+    size_t FindNextActiveBlock(size_t index) const
+    {
+        return FindNextBlock(index, [this](size_t i) { return active_writes_[i] | active_reads_[i]; });
+    }
+
+    // Returns the index of the first block at or after index without an active write, or the page count if all of the
+    // remaining blocks have active writes.
+    size_t FindActiveWriteRunEnd(size_t index) const
+    {
+        return FindNextBlock(index, [this](size_t i) { return ~active_writes_[i]; });
+    }
+
+    // Returns the index of the first block at or after index that has been loaded, or the page count if there are no
+    // loaded blocks.
+    size_t FindNextLoadedBlock(size_t index) const
+    {
+        return FindNextBlock(index, [this](size_t i) { return page_loaded_[i]; });
+    }
+
+    // Returns the index of the first block at or after index that has not been loaded, or the page count if all of the
+    // remaining blocks have been loaded.
+    size_t FindNextUnloadedBlock(size_t index) const
+    {
+        return FindNextBlock(index, [this](size_t i) { return ~page_loaded_[i]; });
+    }
 
-    void SetActiveWriteBlock(size_t index, bool value) { active_writes_[index] = value ? 1 : 0; }
-    void SetActiveReadBlock(size_t index, bool value) { active_reads_[index] = value ? 1 : 0; }
-    void SetBlockLoaded(size_t index, bool value) { page_loaded_[index] = value ? 1 : 0; }
+    // Clears the active read and write status of blocks in the range [first_index, last_index).
+    void ClearActiveBlocks(size_t first_index, size_t last_index)
+    {
+        assert((first_index <= last_index) && (last_index <= page_count_));
+
+        while (first_index < last_index)
+        {
+            size_t   word_index = first_index / kBitsPerWord;
+            size_t   word_end   = (word_index + 1) * kBitsPerWord;
+            uint64_t mask       = GetMaskFrom(first_index);
+
+            if (last_index < word_end)
+            {
+                // Exclude the bits at and above last_index.
+                mask &= ~GetMaskFrom(last_index);
+                word_end = last_index;
+            }
+
+            active_writes_[word_index] &= ~mask;
+            active_reads_[word_index] &= ~mask;
+
+            first_index = word_end;
+        }
+    }
 
   private:
-    typedef std::vector<uint8_t> PageStatus;
+    typedef std::vector<uint64_t> PageStatus;
+
+    static const size_t kBitsPerWord = 64;
+
+  private:
+    static size_t GetWordCount(size_t page_count) { return (page_count + kBitsPerWord - 1) / kBitsPerWord; }
+
+    static uint64_t GetBitMask(size_t index) { return (1ull << (index % kBitsPerWord)); }
+
+    // Mask for the bits at and above index in the word containing index.
+    static uint64_t GetMaskFrom(size_t index) { return (~0ull << (index % kBitsPerWord)); }
+
+    static bool GetBit(const PageStatus& status, size_t index)
+    {
+        return ((status[index / kBitsPerWord] & GetBitMask(index)) != 0);
+    }
+
+    static void SetBit(PageStatus* status, size_t index, bool value)
+    {
+        if (value)
+        {
+            (*status)[index / kBitsPerWord] |= GetBitMask(index);
+        }
+        else
+        {
+            (*status)[index / kBitsPerWord] &= ~GetBitMask(index);
+        }
+    }
+
+    // Scans the words produced by get_word for the first set bit at or after index.
+    template <typename GetWordFunc>
+    size_t FindNextBlock(size_t index, GetWordFunc get_word) const
+    {
+        while (index < page_count_)
+        {
+            size_t   word_index = index / kBitsPerWord;
+            uint64_t word       = get_word(word_index) & GetMaskFrom(index);
+
+            if (word != 0)
+            {
+                return Clamp((word_index * kBitsPerWord) + FindFirstSetBit(word));
+            }
+
+            index = (word_index + 1) * kBitsPerWord;
+        }
+
+        return page_count_;
+    }
+
+    static size_t FindFirstSetBit(uint64_t word)
+    {
+        assert(word != 0);
+#if defined(_MSC_VER) && defined(_WIN64)
+        unsigned long index = 0;
+        _BitScanForward64(&index, word);
+        return static_cast<size_t>(index);
+#elif defined(_MSC_VER)
+        unsigned long index = 0;
+        if (_BitScanForward(&index, static_cast<unsigned long>(word)) == 0)
+        {
+            _BitScanForward(&index, static_cast<unsigned long>(word >> 32));
+            index += 32;
+        }
+        return static_cast<size_t>(index);
+#else
+        return static_cast<size_t>(__builtin_ctzll(word));
+#endif
+    }
+
+    // Unused bits of the last word are never set for the status bits, but are set in the inverted status bits.
+    size_t Clamp(size_t index) const { return (index < page_count_) ? index : page_count_; }
 
   private:
+    size_t     page_count_;
     PageStatus active_writes_; //< Track blocks that have been written.
     PageStatus active_reads_;  //< Track blocks that have been read.
     PageStatus page_loaded_;   //< Tracks status of pages that have or have not been previously used.
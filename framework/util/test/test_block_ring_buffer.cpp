@@ -0,0 +1,257 @@
+/*
+** Copyright (c) 2019 LunarG, Inc.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+#include "util/block_ring_buffer.h"
+#include "util/memory_output_stream.h"
+
+#include <catch2/catch.hpp>
+
+#include <cstdint>
+#include <vector>
+
+using gfxrecon::util::BlockRingBuffer;
+using gfxrecon::util::BlockRingBufferOutputStream;
+using gfxrecon::util::MemoryOutputStream;
+
+namespace
+{
+
+// Blocks are filled with a header byte followed by data bytes derived from the block value, so that the dumped bytes
+// identify the blocks and their order.
+std::vector<uint8_t> MakeBlock(uint8_t value, size_t size)
+{
+    std::vector<uint8_t> block(size);
+    for (size_t i = 0; i < size; ++i)
+    {
+        block[i] = static_cast<uint8_t>(value + i);
+    }
+    return block;
+}
+
+bool WriteBlock(BlockRingBuffer* buffer, const std::vector<uint8_t>& block)
+{
+    // Split the block into a header and data, as the capture file writes do.
+    return buffer->Write(block.data(), 1, block.data() + 1, block.size() - 1);
+}
+
+std::vector<uint8_t> Concatenate(const std::vector<std::vector<uint8_t>>& blocks)
+{
+    std::vector<uint8_t> result;
+    for (const auto& block : blocks)
+    {
+        result.insert(result.end(), block.begin(), block.end());
+    }
+    return result;
+}
+
+std::vector<uint8_t> Dump(const BlockRingBuffer& buffer)
+{
+    MemoryOutputStream stream;
+    size_t             size = buffer.Dump(&stream);
+    REQUIRE(size == stream.GetDataSize());
+    return std::vector<uint8_t>(stream.GetData(), stream.GetData() + stream.GetDataSize());
+}
+
+} // namespace
+
+TEST_CASE("BlockRingBuffer dumps stored blocks from the first block", "[block_ring_buffer]")
+{
+    BlockRingBuffer buffer(64);
+    REQUIRE(buffer.IsValid());
+    REQUIRE(buffer.GetCapacity() == 64);
+
+    SECTION("Empty buffer")
+    {
+        REQUIRE(Dump(buffer).empty());
+    }
+
+    SECTION("Partially filled buffer")
+    {
+        auto block0 = MakeBlock(0x10, 10);
+        auto block1 = MakeBlock(0x20, 20);
+        REQUIRE(WriteBlock(&buffer, block0));
+        REQUIRE(WriteBlock(&buffer, block1));
+
+        REQUIRE(buffer.HasStartPoint());
+        REQUIRE(buffer.GetSizeSinceStartPoint() == 30);
+        REQUIRE(Dump(buffer) == Concatenate({ block0, block1 }));
+    }
+
+    SECTION("Exactly full buffer")
+    {
+        std::vector<std::vector<uint8_t>> blocks;
+        for (uint8_t i = 0; i < 4; ++i)
+        {
+            blocks.push_back(MakeBlock(i * 0x10, 16));
+            REQUIRE(WriteBlock(&buffer, blocks.back()));
+        }
+
+        REQUIRE(buffer.HasStartPoint());
+        REQUIRE(Dump(buffer) == Concatenate(blocks));
+    }
+}
+
+TEST_CASE("BlockRingBuffer discards the oldest blocks when full", "[block_ring_buffer]")
+{
+    BlockRingBuffer buffer(64);
+    REQUIRE(buffer.IsValid());
+
+    auto block0 = MakeBlock(0x10, 24);
+    auto block1 = MakeBlock(0x40, 24);
+    auto block2 = MakeBlock(0x70, 24);
+
+    REQUIRE(WriteBlock(&buffer, block0));
+
+    SECTION("Discarding the only start point leaves nothing to dump")
+    {
+        REQUIRE(WriteBlock(&buffer, block1));
+        REQUIRE(WriteBlock(&buffer, block2));
+
+        REQUIRE(!buffer.HasStartPoint());
+        REQUIRE(Dump(buffer).empty());
+    }
+
+    SECTION("Block that wraps around the end of the buffer")
+    {
+        buffer.MarkStartPoint();
+        REQUIRE(WriteBlock(&buffer, block1));
+        REQUIRE(buffer.GetSizeSinceStartPoint() == 24);
+
+        // The third block starts at offset 48 and continues at the start of the buffer.
+        REQUIRE(WriteBlock(&buffer, block2));
+
+        REQUIRE(buffer.HasStartPoint());
+        REQUIRE(buffer.GetSizeSinceStartPoint() == 48);
+        REQUIRE(Dump(buffer) == Concatenate({ block1, block2 }));
+    }
+}
+
+TEST_CASE("BlockRingBuffer dumps an exactly full buffer that has wrapped around", "[block_ring_buffer]")
+{
+    BlockRingBuffer buffer(48);
+    REQUIRE(buffer.IsValid());
+
+    std::vector<std::vector<uint8_t>> blocks;
+    for (uint8_t i = 0; i < 5; ++i)
+    {
+        blocks.push_back(MakeBlock(i * 0x20, 16));
+    }
+
+    REQUIRE(WriteBlock(&buffer, blocks[0]));
+    buffer.MarkStartPoint();
+    REQUIRE(WriteBlock(&buffer, blocks[1]));
+    REQUIRE(WriteBlock(&buffer, blocks[2]));
+
+    // Discards the first block, leaving the buffer full with the oldest retained block at offset 16 and the newest
+    // block ending at offset 16.
+    REQUIRE(WriteBlock(&buffer, blocks[3]));
+    REQUIRE(Dump(buffer) == Concatenate({ blocks[1], blocks[2], blocks[3] }));
+
+    // Discards the second block, which was the only start point.
+    REQUIRE(WriteBlock(&buffer, blocks[4]));
+    REQUIRE(!buffer.HasStartPoint());
+    REQUIRE(Dump(buffer).empty());
+}
+
+TEST_CASE("BlockRingBuffer dumps from the oldest start point", "[block_ring_buffer]")
+{
+    BlockRingBuffer buffer(64);
+    REQUIRE(buffer.IsValid());
+
+    auto block0 = MakeBlock(0x10, 16);
+    auto block1 = MakeBlock(0x20, 16);
+    auto block2 = MakeBlock(0x30, 16);
+    auto block3 = MakeBlock(0x40, 16);
+    auto block4 = MakeBlock(0x50, 16);
+
+    REQUIRE(WriteBlock(&buffer, block0));
+    REQUIRE(WriteBlock(&buffer, block1));
+    buffer.MarkStartPoint();
+    REQUIRE(WriteBlock(&buffer, block2));
+    buffer.MarkStartPoint();
+    REQUIRE(WriteBlock(&buffer, block3));
+    REQUIRE(buffer.GetSizeSinceStartPoint() == 16);
+
+    REQUIRE(Dump(buffer) == Concatenate({ block0, block1, block2, block3 }));
+
+    // Discarding the first block moves the oldest start point to the third block.
+    REQUIRE(WriteBlock(&buffer, block4));
+    REQUIRE(Dump(buffer) == Concatenate({ block2, block3, block4 }));
+}
+
+TEST_CASE("BlockRingBuffer clears when a block exceeds the capacity", "[block_ring_buffer]")
+{
+    BlockRingBuffer buffer(64);
+    REQUIRE(buffer.IsValid());
+
+    auto block0 = MakeBlock(0x10, 16);
+    auto block1 = MakeBlock(0x20, 65);
+    auto block2 = MakeBlock(0x30, 16);
+
+    REQUIRE(WriteBlock(&buffer, block0));
+    REQUIRE(!WriteBlock(&buffer, block1));
+
+    // Blocks written after the buffer is cleared depend on the discarded blocks.
+    REQUIRE(!buffer.HasStartPoint());
+    REQUIRE(WriteBlock(&buffer, block2));
+    REQUIRE(!buffer.HasStartPoint());
+    REQUIRE(Dump(buffer).empty());
+
+    buffer.MarkStartPoint();
+    REQUIRE(buffer.HasStartPoint());
+    REQUIRE(WriteBlock(&buffer, block0));
+    REQUIRE(Dump(buffer) == block0);
+}
+
+TEST_CASE("BlockRingBufferOutputStream writes a start point", "[block_ring_buffer]")
+{
+    BlockRingBuffer buffer(64);
+    REQUIRE(buffer.IsValid());
+
+    auto block0 = MakeBlock(0x10, 16);
+    auto block1 = MakeBlock(0x20, 16);
+    auto block2 = MakeBlock(0x30, 16);
+
+    REQUIRE(WriteBlock(&buffer, block0));
+    buffer.Clear();
+    REQUIRE(WriteBlock(&buffer, block1));
+
+    SECTION("Writes that fit in the buffer")
+    {
+        BlockRingBufferOutputStream stream(&buffer);
+        REQUIRE(stream.Write(block2.data(), block2.size()) == block2.size());
+        REQUIRE(stream.Write(block0.data(), block0.size()) == block0.size());
+        REQUIRE(stream.IsValid());
+
+        REQUIRE(buffer.GetSizeSinceStartPoint() == 32);
+        REQUIRE(Dump(buffer) == Concatenate({ block2, block0 }));
+    }
+
+    SECTION("Write that exceeds the buffer size")
+    {
+        auto large_block = MakeBlock(0x40, 65);
+
+        BlockRingBufferOutputStream stream(&buffer);
+        REQUIRE(stream.Write(block2.data(), block2.size()) == block2.size());
+        REQUIRE(stream.Write(large_block.data(), large_block.size()) == 0);
+        REQUIRE(!stream.IsValid());
+
+        // Writes after the failure are ignored.
+        REQUIRE(stream.Write(block0.data(), block0.size()) == 0);
+        REQUIRE(!buffer.HasStartPoint());
+        REQUIRE(Dump(buffer).empty());
+    }
+}
@@ -0,0 +1,82 @@
+/*
+** Copyright (c) 2019 LunarG, Inc.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+#include "util/hash.h"
+
+#include <catch2/catch.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+using gfxrecon::util::hash::ComputeHash64;
+
+namespace
+{
+
+uint64_t HashString(const char* value, uint64_t seed = 0)
+{
+    return ComputeHash64(value, strlen(value), seed);
+}
+
+} // namespace
+
+TEST_CASE("ComputeHash64 matches the XXH64 test vectors", "[hash]")
+{
+    // Inputs shorter than 4, 8, and 32 bytes, and an input that is processed as 32 byte stripes followed by a tail of
+    // 31 bytes.
+    REQUIRE(HashString("") == 0xef46db3751d8e999ull);
+    REQUIRE(HashString("abc") == 0x44bc2cf5ad770999ull);
+    REQUIRE(HashString("hello, world") == 0xb33a384e6d1b1242ull);
+    REQUIRE(HashString("abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789$") == 0x1032d841e824f998ull);
+}
+
+TEST_CASE("ComputeHash64 matches the XXH64 reference implementation with a seed", "[hash]")
+{
+    REQUIRE(HashString("abc", 1) == 0xbea9ca8199328908ull);
+    REQUIRE(HashString("hello, world", 0x9e3779b185ebca87ull) == 0x58c22c1b8d24a000ull);
+    REQUIRE(HashString("abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789$", 2654435761ull) ==
+            0x677d1c47d9d5cb26ull);
+}
+
+TEST_CASE("ComputeHash64 does not depend on data alignment", "[hash]")
+{
+    std::vector<uint8_t> data(1031);
+    for (size_t i = 0; i < data.size(); ++i)
+    {
+        data[i] = static_cast<uint8_t>((i * 31) + 7);
+    }
+
+    std::vector<uint8_t> unaligned(data.size() + 3);
+    memcpy(unaligned.data() + 3, data.data(), data.size());
+
+    for (size_t size : { 0, 1, 3, 4, 7, 8, 31, 32, 33, 63, 64, 1000, 1031 })
+    {
+        REQUIRE(ComputeHash64(data.data(), size, 5) == ComputeHash64(unaligned.data() + 3, size, 5));
+    }
+}
+
+TEST_CASE("ComputeHash64 distinguishes data and seeds", "[hash]")
+{
+    std::vector<uint8_t> data(256, 0);
+    uint64_t             hash = ComputeHash64(data.data(), data.size());
+
+    REQUIRE(ComputeHash64(data.data(), data.size() - 1) != hash);
+    REQUIRE(ComputeHash64(data.data(), data.size(), 1) != hash);
+
+    data[200] = 1;
+    REQUIRE(ComputeHash64(data.data(), data.size()) != hash);
+}
@@ -0,0 +1,64 @@
+/*
+** Copyright (c) 2019 LunarG, Inc.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+#ifdef ENABLE_LZ4_COMPRESSION
+
+#include "util/lz4_stream_compressor.h"
+
+#include <catch2/catch.hpp>
+
+#include <cstdint>
+#include <vector>
+
+using gfxrecon::util::Lz4StreamCompressor;
+
+TEST_CASE("Lz4StreamCompressor decompresses blocks in compression order", "[lz4_stream_compressor]")
+{
+    const size_t max_block_size = 1024;
+
+    Lz4StreamCompressor compressor(max_block_size);
+    Lz4StreamCompressor decompressor(max_block_size);
+
+    // Enough blocks to wrap the ring buffer, with sizes up to the maximum block size.
+    for (size_t i = 0; i < 200; ++i)
+    {
+        std::vector<uint8_t> block(1 + ((i * 97) % max_block_size));
+        for (size_t j = 0; j < block.size(); ++j)
+        {
+            block[j] = static_cast<uint8_t>((j % 16) + (i % 3));
+        }
+
+        std::vector<uint8_t> compressed;
+        size_t               compressed_size = compressor.Compress(block.size(), block.data(), &compressed);
+        REQUIRE(compressed_size > 0);
+
+        // The output vector is empty, and must be resized by the decompressor.
+        std::vector<uint8_t> uncompressed;
+        REQUIRE(decompressor.Decompress(compressed_size, compressed, block.size(), &uncompressed) == block.size());
+        REQUIRE(uncompressed == block);
+    }
+}
+
+TEST_CASE("Lz4StreamCompressor rejects blocks larger than the maximum block size", "[lz4_stream_compressor]")
+{
+    Lz4StreamCompressor  compressor(64);
+    std::vector<uint8_t> block(65);
+    std::vector<uint8_t> compressed;
+
+    REQUIRE(compressor.Compress(block.size(), block.data(), &compressed) == 0);
+}
+
+#endif // ENABLE_LZ4_COMPRESSION
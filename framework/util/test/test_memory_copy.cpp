@@ -0,0 +1,93 @@
+/*
+** Copyright (c) 2019 LunarG, Inc.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+#include "util/memory_copy.h"
+
+#include <catch2/catch.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+using gfxrecon::util::StreamingMemoryCopy;
+
+namespace
+{
+
+const uint8_t kGuardValue = 0xCD;
+
+// Copies size bytes from source_offset to destination_offset, and checks that the bytes before and after the
+// destination range were not modified.
+bool CopyAndCompare(const std::vector<uint8_t>& source, size_t source_offset, size_t destination_offset, size_t size)
+{
+    std::vector<uint8_t> destination(destination_offset + size + 64, kGuardValue);
+
+    StreamingMemoryCopy(destination.data() + destination_offset, source.data() + source_offset, size);
+
+    for (size_t i = 0; i < destination_offset; ++i)
+    {
+        if (destination[i] != kGuardValue)
+        {
+            return false;
+        }
+    }
+
+    for (size_t i = destination_offset + size; i < destination.size(); ++i)
+    {
+        if (destination[i] != kGuardValue)
+        {
+            return false;
+        }
+    }
+
+    return (memcmp(destination.data() + destination_offset, source.data() + source_offset, size) == 0);
+}
+
+} // namespace
+
+TEST_CASE("StreamingMemoryCopy copies unaligned ranges", "[memory_copy]")
+{
+    std::vector<uint8_t> source(512);
+    for (size_t i = 0; i < source.size(); ++i)
+    {
+        source[i] = static_cast<uint8_t>((i * 13) + 1);
+    }
+
+    // Source offsets cover each alignment of the head that precedes the 16 byte aligned streaming loads, and sizes
+    // cover the 64 byte loop, the 16 byte loop, and the tail.
+    for (size_t source_offset = 0; source_offset < 32; ++source_offset)
+    {
+        for (size_t destination_offset : { 0, 1, 8, 15 })
+        {
+            for (size_t size = 0; size <= 200; ++size)
+            {
+                REQUIRE(CopyAndCompare(source, source_offset, destination_offset, size));
+            }
+        }
+    }
+}
+
+TEST_CASE("StreamingMemoryCopy copies large ranges", "[memory_copy]")
+{
+    std::vector<uint8_t> source((4 * 1024 * 1024) + 77);
+    for (size_t i = 0; i < source.size(); ++i)
+    {
+        source[i] = static_cast<uint8_t>(i ^ (i >> 8));
+    }
+
+    REQUIRE(CopyAndCompare(source, 0, 0, source.size()));
+    REQUIRE(CopyAndCompare(source, 5, 3, source.size() - 5));
+}
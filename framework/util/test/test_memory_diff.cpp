@@ -0,0 +1,151 @@
+/*
+** Copyright (c) 2019 LunarG, Inc.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+#include "util/memory_diff.h"
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <utility>
+#include <vector>
+
+using gfxrecon::util::FindModifiedRanges;
+
+namespace
+{
+
+typedef std::vector<std::pair<size_t, size_t>> RangeList;
+
+RangeList FindRanges(const std::vector<uint8_t>& memory, std::vector<uint8_t>* snapshot, size_t granularity)
+{
+    RangeList ranges;
+    FindModifiedRanges(memory.data(), snapshot->data(), memory.size(), granularity, [&](size_t offset, size_t size) {
+        ranges.emplace_back(offset, size);
+    });
+    return ranges;
+}
+
+// Reference implementation that compares one block at a time with memcmp.
+RangeList FindRangesReference(const std::vector<uint8_t>& memory,
+                              const std::vector<uint8_t>& snapshot,
+                              size_t                      granularity)
+{
+    RangeList ranges;
+    for (size_t offset = 0; offset < memory.size(); offset += granularity)
+    {
+        size_t block_size = std::min(granularity, memory.size() - offset);
+        if (memcmp(memory.data() + offset, snapshot.data() + offset, block_size) != 0)
+        {
+            if (!ranges.empty() && ((ranges.back().first + ranges.back().second) == offset))
+            {
+                ranges.back().second += block_size;
+            }
+            else
+            {
+                ranges.emplace_back(offset, block_size);
+            }
+        }
+    }
+    return ranges;
+}
+
+} // namespace
+
+TEST_CASE("FindModifiedRanges reports modified blocks", "[memory_diff]")
+{
+    const size_t granularity = 64;
+
+    std::vector<uint8_t> memory(1000);
+    for (size_t i = 0; i < memory.size(); ++i)
+    {
+        memory[i] = static_cast<uint8_t>(i);
+    }
+
+    std::vector<uint8_t> snapshot = memory;
+
+    SECTION("Unmodified memory")
+    {
+        REQUIRE(FindRanges(memory, &snapshot, granularity).empty());
+    }
+
+    SECTION("Single modified byte")
+    {
+        memory[130] ^= 0xFF;
+        REQUIRE(FindRanges(memory, &snapshot, granularity) == RangeList{ { 128, 64 } });
+    }
+
+    SECTION("Adjacent modified blocks are merged")
+    {
+        memory[127] ^= 0xFF;
+        memory[128] ^= 0xFF;
+        memory[255] ^= 0xFF;
+        REQUIRE(FindRanges(memory, &snapshot, granularity) == RangeList{ { 64, 192 } });
+    }
+
+    SECTION("Separate modified blocks")
+    {
+        memory[0] ^= 0xFF;
+        memory[500] ^= 0xFF;
+        REQUIRE(FindRanges(memory, &snapshot, granularity) == RangeList({ { 0, 64 }, { 448, 64 } }));
+    }
+
+    SECTION("Partial last block")
+    {
+        // The last block starts at offset 960 and has 40 bytes.
+        memory[999] ^= 0xFF;
+        REQUIRE(FindRanges(memory, &snapshot, granularity) == RangeList{ { 960, 40 } });
+    }
+
+    SECTION("Modified ranges are copied to the snapshot")
+    {
+        memory[10] ^= 0xFF;
+        memory[700] ^= 0xFF;
+        REQUIRE(FindRanges(memory, &snapshot, granularity).size() == 2);
+        REQUIRE(snapshot == memory);
+        REQUIRE(FindRanges(memory, &snapshot, granularity).empty());
+    }
+}
+
+TEST_CASE("FindModifiedRanges matches a byte comparison for each granularity", "[memory_diff]")
+{
+    std::mt19937 random(1);
+
+    for (size_t granularity : { 1, 3, 16, 64, 100, 256, 4096 })
+    {
+        for (size_t size : { 1, 63, 64, 65, 4096, 10000 })
+        {
+            std::vector<uint8_t> memory(size);
+            for (auto& value : memory)
+            {
+                value = static_cast<uint8_t>(random());
+            }
+
+            std::vector<uint8_t> snapshot = memory;
+
+            for (size_t i = 0; i < 8; ++i)
+            {
+                memory[random() % size] ^= 0x01;
+            }
+
+            RangeList expected = FindRangesReference(memory, snapshot, granularity);
+            REQUIRE(FindRanges(memory, &snapshot, granularity) == expected);
+            REQUIRE(snapshot == memory);
+        }
+    }
+}
@@ -0,0 +1,102 @@
+/*
+** Copyright (c) 2019 LunarG, Inc.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+#include "util/memory_range_overlap.h"
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+using gfxrecon::util::MarkOverlappingRanges;
+using gfxrecon::util::MemoryRange;
+
+namespace
+{
+
+// Returns the marked state of each range, ordered by index.
+std::vector<bool> GetMarkedStates(const std::vector<MemoryRange>& ranges)
+{
+    std::vector<bool> marked(ranges.size());
+    for (const auto& range : ranges)
+    {
+        marked[range.index] = range.marked;
+    }
+    return marked;
+}
+
+} // namespace
+
+TEST_CASE("MarkOverlappingRanges marks ranges that alias a marked range", "[memory_range_overlap]")
+{
+    std::vector<MemoryRange> ranges = {
+        { 1, 0, 256, 0, true },      // Marked range.
+        { 1, 128, 512, 1, false },   // Overlaps the end of range 0.
+        { 1, 256, 1024, 2, false },  // Adjacent to range 0, but overlaps range 1.
+        { 1, 0, 64, 3, false },      // Contained by range 0.
+        { 2, 0, 256, 4, false },     // Same offsets as range 0, but bound to other memory.
+        { 1, 100, 100, 5, false },   // Empty.
+        { 2, 512, 1024, 6, true },   // Marked range that starts after range 7.
+        { 2, 300, 600, 7, false },   // Overlaps the start of range 6.
+        { 2, 1024, 2048, 8, false }, // Adjacent to range 6.
+    };
+
+    MarkOverlappingRanges(&ranges);
+
+    std::vector<bool> expected = { true, true, false, true, false, false, true, true, false };
+    REQUIRE(GetMarkedStates(ranges) == expected);
+}
+
+TEST_CASE("MarkOverlappingRanges matches pairwise comparison", "[memory_range_overlap]")
+{
+    std::mt19937 random(7);
+
+    for (size_t round = 0; round < 100; ++round)
+    {
+        std::vector<MemoryRange> ranges(1 + (random() % 64));
+
+        for (size_t i = 0; i < ranges.size(); ++i)
+        {
+            uint64_t begin = random() % 1024;
+            ranges[i]      = { random() % 3, begin, begin + (random() % 256), i, (random() % 8) == 0 };
+        }
+
+        std::vector<bool> expected = GetMarkedStates(ranges);
+
+        for (const auto& marked : ranges)
+        {
+            if (!marked.marked || (marked.end == marked.begin))
+            {
+                continue;
+            }
+
+            for (const auto& range : ranges)
+            {
+                if ((range.memory_id == marked.memory_id) && (range.begin < marked.end) &&
+                    (marked.begin < range.end) && (range.end > range.begin))
+                {
+                    expected[range.index] = true;
+                }
+            }
+        }
+
+        MarkOverlappingRanges(&ranges);
+
+        REQUIRE(GetMarkedStates(ranges) == expected);
+    }
+}
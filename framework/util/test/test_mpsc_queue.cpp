@@ -0,0 +1,126 @@
+/*
+** Copyright (c) 2019 LunarG, Inc.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+#include "util/mpsc_queue.h"
+
+#include <catch2/catch.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using gfxrecon::util::MpscQueue;
+
+TEST_CASE("MpscQueue pops values in push order", "[mpsc_queue]")
+{
+    MpscQueue<int> queue;
+    int            value = 0;
+
+    REQUIRE(queue.IsEmpty());
+    REQUIRE(!queue.TryPop(&value));
+
+    for (int i = 0; i < 10; ++i)
+    {
+        queue.Push(std::move(i));
+    }
+
+    REQUIRE(!queue.IsEmpty());
+
+    for (int i = 0; i < 10; ++i)
+    {
+        REQUIRE(queue.TryPop(&value));
+        REQUIRE(value == i);
+    }
+
+    REQUIRE(queue.IsEmpty());
+    REQUIRE(!queue.TryPop(&value));
+
+    // The queue is reusable after it has been emptied.
+    queue.Push(42);
+    REQUIRE(queue.TryPop(&value));
+    REQUIRE(value == 42);
+}
+
+TEST_CASE("MpscQueue moves values and releases unpopped values", "[mpsc_queue]")
+{
+    auto tracked = std::make_shared<int>(1);
+
+    {
+        MpscQueue<std::shared_ptr<int>> queue;
+        queue.Push(std::shared_ptr<int>(tracked));
+        queue.Push(std::shared_ptr<int>(tracked));
+        REQUIRE(tracked.use_count() == 3);
+
+        std::shared_ptr<int> value;
+        REQUIRE(queue.TryPop(&value));
+        REQUIRE(value == tracked);
+
+        value = nullptr;
+        REQUIRE(tracked.use_count() == 2);
+    }
+
+    // The value that was not popped is released by the queue destructor.
+    REQUIRE(tracked.use_count() == 1);
+}
+
+TEST_CASE("MpscQueue preserves per-producer order with concurrent producers", "[mpsc_queue]")
+{
+    const uint64_t producer_count = 4;
+    const uint64_t value_count    = 20000;
+
+    MpscQueue<uint64_t>      queue;
+    std::vector<std::thread> producers;
+
+    for (uint64_t producer = 0; producer < producer_count; ++producer)
+    {
+        producers.emplace_back([&queue, producer, value_count]() {
+            for (uint64_t i = 0; i < value_count; ++i)
+            {
+                queue.Push((producer << 32) | i);
+            }
+        });
+    }
+
+    // Consume while the producers are running.
+    std::vector<uint64_t> next_value(producer_count, 0);
+    uint64_t              total = 0;
+
+    while (total < (producer_count * value_count))
+    {
+        uint64_t value = 0;
+        if (queue.TryPop(&value))
+        {
+            uint64_t producer = value >> 32;
+            REQUIRE(producer < producer_count);
+            REQUIRE((value & 0xFFFFFFFF) == next_value[producer]);
+            ++next_value[producer];
+            ++total;
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    for (auto& producer : producers)
+    {
+        producer.join();
+    }
+
+    REQUIRE(queue.IsEmpty());
+}
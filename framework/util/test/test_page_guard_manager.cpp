@@ -0,0 +1,379 @@
+/*
+** Copyright (c) 2019 LunarG, Inc.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+#include "util/page_guard_manager.h"
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <thread>
+#include <vector>
+
+#if !defined(WIN32)
+#include <sys/mman.h>
+#endif
+
+using gfxrecon::util::PageGuardManager;
+
+namespace
+{
+
+struct TrackedRegion
+{
+    uint64_t             memory_id;
+    std::vector<uint8_t> mapped_memory;
+    uint8_t*             start;
+    uint8_t*             end;
+    bool                 removed;
+};
+
+// Creates the PageGuardManager singleton with shadow memory and copy on map, and destroys it when the test completes.
+class ScopedPageGuardManager
+{
+  public:
+    ScopedPageGuardManager(bool enable_prefetch = false, bool enable_huge_pages = false, bool enable_write_scan = false)
+    {
+        PageGuardManager::Create(
+            true, true, false, enable_prefetch, false, true, false, enable_write_scan, enable_huge_pages, 0);
+        manager_ = PageGuardManager::Get();
+    }
+
+    ~ScopedPageGuardManager() { PageGuardManager::Destroy(); }
+
+    PageGuardManager* Get() const { return manager_; }
+
+  private:
+    PageGuardManager* manager_;
+};
+
+// Returns the ID of the region containing address, or 0 if no region contains the address, by checking each region.
+uint64_t FindRegionReference(const std::vector<TrackedRegion>& regions, const uint8_t* address)
+{
+    for (const auto& region : regions)
+    {
+        if (!region.removed && (address >= region.start) && (address < region.end))
+        {
+            return region.memory_id;
+        }
+    }
+    return 0;
+}
+
+// Reports a guard page violation for address, and returns the ID of the memory that the PageGuardManager reports as
+// modified, or 0 if the address was not found.
+uint64_t FindRegion(PageGuardManager* manager, uint8_t* address)
+{
+    uint64_t found_id = 0;
+
+    if (manager->HandleGuardPageViolation(address, true, true))
+    {
+        size_t modified_count = 0;
+
+        manager->ProcessMemoryEntries([&](uint64_t memory_id, void*, size_t, size_t) {
+            found_id = memory_id;
+            ++modified_count;
+        });
+
+        // Only the memory containing the address should have been modified.
+        REQUIRE(modified_count == 1);
+    }
+
+    return found_id;
+}
+
+} // namespace
+
+TEST_CASE("PageGuardManager finds tracked memory by address", "[page_guard_manager]")
+{
+    ScopedPageGuardManager scoped_manager;
+    PageGuardManager*      manager = scoped_manager.Get();
+    REQUIRE(manager != nullptr);
+
+    const size_t page_size    = manager->GetAlignedSize(1);
+    const size_t region_count = 64;
+
+    // Regions smaller than a page, with sizes that are a multiple of the page size, and with sizes that end within a
+    // page, added in random order.
+    std::mt19937               random(3);
+    std::vector<TrackedRegion> regions(region_count);
+    std::vector<size_t>        order(region_count);
+
+    for (size_t i = 0; i < region_count; ++i)
+    {
+        size_t size = 0;
+        switch (i % 4)
+        {
+            case 0:
+                size = 1 + (random() % (page_size - 1));
+                break;
+            case 1:
+                size = page_size * (1 + (random() % 4));
+                break;
+            default:
+                size = (page_size * (1 + (random() % 4))) + 1 + (random() % (page_size - 1));
+                break;
+        }
+
+        regions[i].memory_id = i + 1;
+        regions[i].mapped_memory.resize(size, static_cast<uint8_t>(i));
+        regions[i].removed = false;
+        order[i]           = i;
+    }
+
+    std::shuffle(order.begin(), order.end(), random);
+
+    for (size_t i : order)
+    {
+        TrackedRegion& region = regions[i];
+        size_t         size   = region.mapped_memory.size();
+        region.start          = static_cast<uint8_t*>(
+            manager->AddMemory(region.memory_id, region.mapped_memory.data(), size, false));
+        REQUIRE(region.start != nullptr);
+        region.end = region.start + size;
+    }
+
+    // Addresses at the start, interior, and end of each region, and the addresses around each region, which are in
+    // the unused part of a shadow memory page or in a gap between regions, unless another region is adjacent.
+    auto check_regions = [&]() {
+        for (const auto& region : regions)
+        {
+            size_t size = region.end - region.start;
+
+            for (uint8_t* address : { region.start - 1,
+                                      region.start,
+                                      region.start + 1,
+                                      region.start + (size / 2),
+                                      region.end - 1,
+                                      region.end,
+                                      region.end + (page_size / 2) })
+            {
+                REQUIRE(FindRegion(manager, address) == FindRegionReference(regions, address));
+            }
+        }
+    };
+
+    check_regions();
+
+    for (const auto& region : regions)
+    {
+        REQUIRE(FindRegion(manager, region.start) == region.memory_id);
+        REQUIRE(FindRegion(manager, region.end - 1) == region.memory_id);
+    }
+
+    // Untracked memory.
+    std::vector<uint8_t> untracked(page_size);
+    REQUIRE(FindRegion(manager, untracked.data()) == 0);
+    REQUIRE(FindRegion(manager, untracked.data() + page_size - 1) == 0);
+
+    // Removed regions are no longer found, and the remaining regions are unaffected.
+    for (size_t i = 0; i < region_count; i += 3)
+    {
+        manager->RemoveMemory(regions[i].memory_id);
+        regions[i].removed = true;
+    }
+
+    check_regions();
+
+    for (const auto& region : regions)
+    {
+        if (!region.removed)
+        {
+            manager->RemoveMemory(region.memory_id);
+        }
+    }
+}
+
+TEST_CASE("PageGuardManager fault throughput with many tracked regions", "[page_guard_manager]")
+{
+    ScopedPageGuardManager scoped_manager;
+    PageGuardManager*      manager = scoped_manager.Get();
+    REQUIRE(manager != nullptr);
+
+    const size_t page_size    = manager->GetAlignedSize(1);
+    const size_t region_count = 2000;
+
+    // Single page regions, so that each write to a region is handled by a separate fault that must locate the region.
+    std::vector<std::vector<uint8_t>> mapped_memory(region_count, std::vector<uint8_t>(page_size));
+    std::vector<uint8_t*>             shadow_memory(region_count);
+
+    for (size_t i = 0; i < region_count; ++i)
+    {
+        void* shadow = manager->AddMemory(i + 1, mapped_memory[i].data(), page_size, false);
+        REQUIRE(shadow != nullptr);
+
+        shadow_memory[i] = static_cast<uint8_t*>(shadow);
+    }
+
+    // Regions are written in a random order, so the lookups do not favor the most recently added regions.
+    std::vector<size_t> order(region_count);
+    for (size_t i = 0; i < region_count; ++i)
+    {
+        order[i] = i;
+    }
+
+    std::shuffle(order.begin(), order.end(), std::mt19937(7));
+
+    size_t modified_count = 0;
+
+    BENCHMARK("Write to 2000 guarded single page regions")
+    {
+        for (size_t i : order)
+        {
+            ++shadow_memory[i][i % page_size];
+        }
+
+        manager->ProcessMemoryEntries([&](uint64_t, void*, size_t, size_t) { ++modified_count; });
+    }
+
+    // Each write faulted and was attributed to its region, which was reported once per iteration.
+    REQUIRE(modified_count > 0);
+    REQUIRE((modified_count % region_count) == 0);
+
+    for (size_t i = 0; i < region_count; ++i)
+    {
+        REQUIRE(mapped_memory[i][i % page_size] == static_cast<uint8_t>(modified_count / region_count));
+        manager->RemoveMemory(i + 1);
+    }
+}
+
+#if defined(__linux__)
+TEST_CASE("PageGuardManager prefetch loads shadow memory while memory is added and removed", "[page_guard_manager]")
+{
+    ScopedPageGuardManager scoped_manager(true, true);
+    PageGuardManager*      manager = scoped_manager.Get();
+    REQUIRE(manager != nullptr);
+
+    const size_t region_size  = (4 * 1024 * 1024) + 123;
+    const size_t region_count = 4;
+
+    std::mt19937 random(5);
+
+    for (uint64_t round = 0; round < 8; ++round)
+    {
+        std::vector<uint8_t*> mapped_memory(region_count);
+        std::vector<uint8_t*> shadow_memory(region_count);
+
+        // The mapped memory is unmapped as soon as it is removed, so a prefetch that copies from it after it has been
+        // removed will fault.
+        for (size_t i = 0; i < region_count; ++i)
+        {
+            void* memory = mmap(nullptr, region_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            REQUIRE(memory != MAP_FAILED);
+
+            mapped_memory[i] = static_cast<uint8_t*>(memory);
+            for (size_t j = 0; j < region_size; ++j)
+            {
+                mapped_memory[i][j] = static_cast<uint8_t>(j + (i * 7) + round);
+            }
+
+            uint64_t memory_id = (round * region_count) + i + 1;
+            void*    shadow    = manager->AddMemory(memory_id, mapped_memory[i], region_size, false);
+            REQUIRE(shadow != nullptr);
+
+            shadow_memory[i] = static_cast<uint8_t*>(shadow);
+        }
+
+        // Remove the first region while the prefetch thread is likely to be copying it.
+        manager->RemoveMemory((round * region_count) + 1);
+        munmap(mapped_memory[0], region_size);
+
+        // Shadow memory contents match the mapped memory, whether the pages were loaded by the prefetch thread or by
+        // the page guard handler.  Writes are reported and copied to the mapped memory.
+        std::vector<size_t> write_offsets;
+        for (size_t k = 0; k < 16; ++k)
+        {
+            write_offsets.push_back(random() % region_size);
+        }
+
+        for (size_t i = 1; i < region_count; ++i)
+        {
+            REQUIRE(memcmp(shadow_memory[i], mapped_memory[i], region_size) == 0);
+
+            for (size_t offset : write_offsets)
+            {
+                shadow_memory[i][offset] ^= 0xFF;
+            }
+        }
+
+        // Pages that were read are also reported, as separate read tracking is disabled.
+        size_t modified_count = 0;
+        manager->ProcessMemoryEntries([&](uint64_t, void*, size_t, size_t) { ++modified_count; });
+        REQUIRE(modified_count >= (region_count - 1));
+
+        for (size_t i = 1; i < region_count; ++i)
+        {
+            REQUIRE(memcmp(shadow_memory[i], mapped_memory[i], region_size) == 0);
+
+            manager->RemoveMemory((round * region_count) + i + 1);
+            munmap(mapped_memory[i], region_size);
+        }
+    }
+}
+
+TEST_CASE("PageGuardManager soft-dirty tracking reports writes made while memory is processed", "[page_guard_manager]")
+{
+    // Falls back to signal based write tracking when the kernel does not support page table scans.
+    ScopedPageGuardManager scoped_manager(false, false, true);
+    PageGuardManager*      manager = scoped_manager.Get();
+    REQUIRE(manager != nullptr);
+
+    const size_t page_size   = manager->GetAlignedSize(1);
+    const size_t page_count  = 64;
+    const size_t region_size = page_count * page_size;
+
+    std::vector<uint8_t> mapped_memory(region_size, 0);
+    void*                shadow = manager->AddMemory(1, mapped_memory.data(), region_size, false);
+    REQUIRE(shadow != nullptr);
+
+    uint8_t* shadow_memory = static_cast<uint8_t*>(shadow);
+
+    // Writes are made to every page while the memory is processed, so some of them are made after a page has been
+    // scanned, and before or while its content is copied to the mapped memory.
+    std::atomic<bool> stop_writes{ false };
+    auto              write_pages = [&]() {
+        uint32_t value = 0;
+        while (!stop_writes.load())
+        {
+            ++value;
+            for (size_t i = 0; i < page_count; ++i)
+            {
+                size_t offset = (i * page_size) + ((value % 64) * sizeof(value));
+                *reinterpret_cast<volatile uint32_t*>(shadow_memory + offset) = value;
+            }
+        }
+    };
+
+    std::thread writer(write_pages);
+
+    for (size_t i = 0; i < 2000; ++i)
+    {
+        manager->ProcessMemoryEntries([](uint64_t, void*, size_t, size_t) {});
+    }
+
+    stop_writes = true;
+    writer.join();
+
+    // Every write made after the last copy of its page must be reported by the final scan.
+    manager->ProcessMemoryEntries([](uint64_t, void*, size_t, size_t) {});
+    REQUIRE(memcmp(shadow_memory, mapped_memory.data(), region_size) == 0);
+
+    manager->RemoveMemory(1);
+}
+#endif
@@ -0,0 +1,187 @@
+/*
+** Copyright (c) 2019 LunarG, Inc.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+#include "util/page_status_tracker.h"
+
+#include <catch2/catch.hpp>
+
+#include <random>
+#include <vector>
+
+using gfxrecon::util::PageStatusTracker;
+
+namespace
+{
+
+// Reference implementation that checks one bit at a time.
+template <typename IsSetFunc>
+size_t FindNextReference(size_t page_count, size_t index, IsSetFunc is_set)
+{
+    for (; index < page_count; ++index)
+    {
+        if (is_set(index))
+        {
+            return index;
+        }
+    }
+    return page_count;
+}
+
+} // namespace
+
+TEST_CASE("PageStatusTracker finds loaded and unloaded blocks", "[page_status_tracker]")
+{
+    // Page counts that fill one word, end within a word, and span several words.
+    for (size_t page_count : { 1, 63, 64, 65, 130, 200 })
+    {
+        PageStatusTracker tracker(page_count);
+
+        REQUIRE(tracker.FindNextLoadedBlock(0) == page_count);
+        REQUIRE(tracker.FindNextUnloadedBlock(0) == 0);
+
+        for (size_t i = 0; i < page_count; ++i)
+        {
+            tracker.SetBlockLoaded(i, true);
+        }
+
+        // The unused bits of the last word must not be reported as unloaded blocks.
+        REQUIRE(tracker.FindNextLoadedBlock(0) == 0);
+        REQUIRE(tracker.FindNextUnloadedBlock(0) == page_count);
+        REQUIRE(tracker.FindNextUnloadedBlock(page_count - 1) == page_count);
+
+        tracker.SetBlockLoaded(page_count - 1, false);
+        REQUIRE(tracker.FindNextUnloadedBlock(0) == (page_count - 1));
+        REQUIRE(tracker.FindNextLoadedBlock(page_count - 1) == page_count);
+
+        // Searches that start at or after the page count report the page count.
+        REQUIRE(tracker.FindNextLoadedBlock(page_count) == page_count);
+        REQUIRE(tracker.FindNextUnloadedBlock(page_count) == page_count);
+    }
+}
+
+TEST_CASE("PageStatusTracker finds active blocks and write runs", "[page_status_tracker]")
+{
+    const size_t      page_count = 200;
+    PageStatusTracker tracker(page_count);
+
+    REQUIRE(tracker.FindNextActiveBlock(0) == page_count);
+    REQUIRE(tracker.FindActiveWriteRunEnd(0) == 0);
+
+    // A write run that crosses the word boundaries at 64 and 128, and a read that starts a new run.
+    for (size_t i = 60; i < 140; ++i)
+    {
+        tracker.SetActiveWriteBlock(i, true);
+    }
+    tracker.SetActiveReadBlock(150, true);
+
+    REQUIRE(tracker.FindNextActiveBlock(0) == 60);
+    REQUIRE(tracker.FindActiveWriteRunEnd(60) == 140);
+    REQUIRE(tracker.FindActiveWriteRunEnd(100) == 140);
+    REQUIRE(tracker.FindNextActiveBlock(140) == 150);
+    REQUIRE(tracker.FindNextActiveBlock(151) == page_count);
+
+    // A write run that ends at the last page.
+    tracker.SetActiveWriteBlock(page_count - 1, true);
+    REQUIRE(tracker.FindNextActiveBlock(151) == (page_count - 1));
+    REQUIRE(tracker.FindActiveWriteRunEnd(page_count - 1) == page_count);
+}
+
+TEST_CASE("PageStatusTracker clears active block ranges", "[page_status_tracker]")
+{
+    const size_t      page_count = 300;
+    PageStatusTracker tracker(page_count);
+
+    for (size_t i = 0; i < page_count; ++i)
+    {
+        tracker.SetActiveWriteBlock(i, true);
+        tracker.SetActiveReadBlock(i, (i % 2) == 0);
+        tracker.SetBlockLoaded(i, true);
+    }
+
+    SECTION("Range within a word")
+    {
+        tracker.ClearActiveBlocks(3, 10);
+        REQUIRE(tracker.FindActiveWriteRunEnd(0) == 3);
+        REQUIRE(tracker.FindNextActiveBlock(3) == 10);
+    }
+
+    SECTION("Range across several words")
+    {
+        tracker.ClearActiveBlocks(50, 260);
+        REQUIRE(tracker.FindActiveWriteRunEnd(0) == 50);
+        REQUIRE(tracker.FindNextActiveBlock(50) == 260);
+        REQUIRE(tracker.IsActiveWriteBlock(260));
+        REQUIRE(tracker.IsActiveReadBlock(260));
+    }
+
+    SECTION("Range that ends at a word boundary")
+    {
+        tracker.ClearActiveBlocks(64, 128);
+        REQUIRE(tracker.IsActiveWriteBlock(63));
+        REQUIRE(tracker.FindNextActiveBlock(64) == 128);
+    }
+
+    SECTION("Entire range")
+    {
+        tracker.ClearActiveBlocks(0, page_count);
+        REQUIRE(tracker.FindNextActiveBlock(0) == page_count);
+    }
+
+    SECTION("Empty range")
+    {
+        tracker.ClearActiveBlocks(100, 100);
+        REQUIRE(tracker.FindActiveWriteRunEnd(0) == page_count);
+    }
+
+    // Loaded status is not affected by clearing active blocks.
+    REQUIRE(tracker.FindNextUnloadedBlock(0) == page_count);
+}
+
+TEST_CASE("PageStatusTracker searches match a bit by bit search", "[page_status_tracker]")
+{
+    std::mt19937 random(7);
+
+    for (size_t page_count : { 1, 64, 100, 257 })
+    {
+        PageStatusTracker tracker(page_count);
+        std::vector<bool> writes(page_count);
+        std::vector<bool> reads(page_count);
+        std::vector<bool> loaded(page_count);
+
+        for (size_t i = 0; i < page_count; ++i)
+        {
+            // Sparse bits produce both long runs of set bits and long runs of clear bits.
+            writes[i] = (random() % 4) != 0;
+            reads[i]  = (random() % 16) == 0;
+            loaded[i] = (random() % 8) == 0;
+            tracker.SetActiveWriteBlock(i, writes[i]);
+            tracker.SetActiveReadBlock(i, reads[i]);
+            tracker.SetBlockLoaded(i, loaded[i]);
+        }
+
+        for (size_t index = 0; index <= page_count; ++index)
+        {
+            REQUIRE(tracker.FindNextActiveBlock(index) ==
+                    FindNextReference(page_count, index, [&](size_t i) { return writes[i] || reads[i]; }));
+            REQUIRE(tracker.FindActiveWriteRunEnd(index) ==
+                    FindNextReference(page_count, index, [&](size_t i) { return !writes[i]; }));
+            REQUIRE(tracker.FindNextLoadedBlock(index) ==
+                    FindNextReference(page_count, index, [&](size_t i) { return loaded[i]; }));
+            REQUIRE(tracker.FindNextUnloadedBlock(index) ==
+                    FindNextReference(page_count, index, [&](size_t i) { return !loaded[i]; }));
+        }
+    }
+}
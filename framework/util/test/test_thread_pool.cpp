@@ -0,0 +1,125 @@
+/*
+** Copyright (c) 2019 LunarG, Inc.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+#include "util/thread_pool.h"
+
+#include <catch2/catch.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+using gfxrecon::util::ThreadPool;
+
+TEST_CASE("ThreadPool runs each task index once", "[thread_pool]")
+{
+    ThreadPool pool(4);
+    REQUIRE(pool.GetThreadCount() == 4);
+
+    for (size_t task_count : { 0, 1, 2, 3, 4, 5, 100, 1000 })
+    {
+        std::vector<std::atomic<uint32_t>> calls(task_count);
+        for (auto& count : calls)
+        {
+            count = 0;
+        }
+
+        pool.Run(task_count, [&calls](size_t index) { ++calls[index]; });
+
+        // Run returns after all of the tasks have completed.
+        for (const auto& count : calls)
+        {
+            REQUIRE(count == 1);
+        }
+    }
+}
+
+TEST_CASE("ThreadPool results written by index are in task order", "[thread_pool]")
+{
+    ThreadPool pool(0);
+    REQUIRE(pool.GetThreadCount() >= 1);
+
+    const size_t          task_count = 257;
+    std::vector<uint64_t> results(task_count, 0);
+
+    pool.Run(task_count, [&results](size_t index) {
+        // Delay some of the tasks, so that the tasks complete out of order.
+        if ((index % 3) == 0)
+        {
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+        results[index] = index * index;
+    });
+
+    for (size_t i = 0; i < task_count; ++i)
+    {
+        REQUIRE(results[i] == (i * i));
+    }
+}
+
+TEST_CASE("ThreadPool with one thread runs tasks in order on the calling thread", "[thread_pool]")
+{
+    ThreadPool pool(1);
+    REQUIRE(pool.GetThreadCount() == 1);
+
+    std::vector<size_t> order;
+    std::thread::id     caller      = std::this_thread::get_id();
+    bool                same_thread = true;
+
+    pool.Run(10, [&](size_t index) {
+        order.push_back(index);
+        same_thread = same_thread && (std::this_thread::get_id() == caller);
+    });
+
+    REQUIRE(order == std::vector<size_t>({ 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 }));
+    REQUIRE(same_thread);
+}
+
+TEST_CASE("ThreadPool serializes Run calls from different threads", "[thread_pool]")
+{
+    ThreadPool pool(3);
+
+    const size_t             thread_count = 4;
+    const size_t             run_count    = 50;
+    const size_t             task_count   = 64;
+    std::atomic<uint64_t>    total(0);
+    std::vector<std::thread> threads;
+
+    for (size_t i = 0; i < thread_count; ++i)
+    {
+        threads.emplace_back([&]() {
+            for (size_t run = 0; run < run_count; ++run)
+            {
+                std::vector<uint32_t> calls(task_count, 0);
+                pool.Run(task_count, [&calls](size_t index) { ++calls[index]; });
+
+                for (uint32_t count : calls)
+                {
+                    total += count;
+                }
+            }
+        });
+    }
+
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    REQUIRE(total == (thread_count * run_count * task_count));
+}
@@ -0,0 +1,134 @@
+/*
+** Copyright (c) 2019 LunarG, Inc.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+#include "util/thread_pool.h"
+
+#include <cassert>
+
+GFXRECON_BEGIN_NAMESPACE(gfxrecon)
+GFXRECON_BEGIN_NAMESPACE(util)
+
+ThreadPool::ThreadPool(size_t thread_count) :
+    task_(nullptr), task_count_(0), next_task_(0), pending_tasks_(0), generation_(0), exit_(false)
+{
+    if (thread_count == 0)
+    {
+        thread_count = std::thread::hardware_concurrency();
+    }
+
+    for (size_t i = 1; i < thread_count; ++i)
+    {
+        workers_.emplace_back(&ThreadPool::WorkerMain, this);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(task_lock_);
+        exit_ = true;
+    }
+
+    task_ready_.notify_all();
+
+    for (auto& worker : workers_)
+    {
+        worker.join();
+    }
+}
+
+void ThreadPool::Run(size_t task_count, const TaskFunc& task)
+{
+    if (task_count == 0)
+    {
+        return;
+    }
+
+    if (workers_.empty() || (task_count == 1))
+    {
+        for (size_t i = 0; i < task_count; ++i)
+        {
+            task(i);
+        }
+
+        return;
+    }
+
+    std::lock_guard<std::mutex> run_lock(run_lock_);
+
+    {
+        std::lock_guard<std::mutex> lock(task_lock_);
+        task_          = &task;
+        task_count_    = task_count;
+        next_task_     = 0;
+        pending_tasks_ = task_count;
+        ++generation_;
+    }
+
+    task_ready_.notify_all();
+
+    ProcessTasks();
+
+    std::unique_lock<std::mutex> lock(task_lock_);
+    task_complete_.wait(lock, [this]() { return pending_tasks_ == 0; });
+    task_ = nullptr;
+}
+
+void ThreadPool::ProcessTasks()
+{
+    std::unique_lock<std::mutex> lock(task_lock_);
+
+    while (next_task_ < task_count_)
+    {
+        size_t          index = next_task_++;
+        const TaskFunc* task  = task_;
+
+        lock.unlock();
+        (*task)(index);
+        lock.lock();
+
+        assert(pending_tasks_ > 0);
+        if (--pending_tasks_ == 0)
+        {
+            task_complete_.notify_all();
+        }
+    }
+}
+
+void ThreadPool::WorkerMain()
+{
+    uint64_t generation = 0;
+
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(task_lock_);
+            task_ready_.wait(lock, [this, generation]() { return exit_ || (generation_ != generation); });
+
+            if (exit_)
+            {
+                break;
+            }
+
+            generation = generation_;
+        }
+
+        ProcessTasks();
+    }
+}
+
+GFXRECON_END_NAMESPACE(util)
+GFXRECON_END_NAMESPACE(gfxrecon)
@@ -0,0 +1,74 @@
+/*
+** Copyright (c) 2019 LunarG, Inc.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+#ifndef GFXRECON_UTIL_THREAD_POOL_H
+#define GFXRECON_UTIL_THREAD_POOL_H
+
+#include "util/defines.h"
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+GFXRECON_BEGIN_NAMESPACE(gfxrecon)
+GFXRECON_BEGIN_NAMESPACE(util)
+
+// Fixed-size pool of threads for processing independent tasks in parallel.  The thread calling Run() participates in
+// task processing, so a pool created with a thread count of N starts N - 1 worker threads.
+class ThreadPool
+{
+  public:
+    typedef std::function<void(size_t)> TaskFunc;
+
+  public:
+    // A thread count of 0 selects the number of hardware threads.
+    ThreadPool(size_t thread_count);
+
+    ~ThreadPool();
+
+    size_t GetThreadCount() const { return workers_.size() + 1; }
+
+    // Invokes task with each index from 0 to task_count - 1, distributing the calls across the pool, and returns after
+    // all calls have completed.  Calls to Run() from different threads are serialized.
+    void Run(size_t task_count, const TaskFunc& task);
+
+  private:
+    void ProcessTasks();
+
+    void WorkerMain();
+
+  private:
+    std::vector<std::thread> workers_;
+    std::mutex               run_lock_;
+    std::mutex               task_lock_;
+    std::condition_variable  task_ready_;
+    std::condition_variable  task_complete_;
+    const TaskFunc*          task_;
+    size_t                   task_count_;
+    size_t                   next_task_;
+    size_t                   pending_tasks_;
+    uint64_t                 generation_;
+    bool                     exit_;
+};
+
+GFXRECON_END_NAMESPACE(util)
+GFXRECON_END_NAMESPACE(gfxrecon)
+
+#endif // GFXRECON_UTIL_THREAD_POOL_H
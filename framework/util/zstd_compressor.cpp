@@ -0,0 +1,247 @@
+/*
+** Copyright (c) 2019 LunarG, Inc.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+#ifdef ENABLE_ZSTD_COMPRESSION
+
+#include "util/zstd_compressor.h"
+
+#include "util/logging.h"
+
+#include "zdict.h"
+#include "zstd.h"
+
+#include <cassert>
+
+GFXRECON_BEGIN_NAMESPACE(gfxrecon)
+GFXRECON_BEGIN_NAMESPACE(util)
+
+const int kZstdCompressionLevel = ZSTD_CLEVEL_DEFAULT;
+
+struct ZstdCompressor::ZstdContexts
+{
+    ZSTD_CDict*             compression_dictionary{ nullptr };
+    ZSTD_DDict*             decompression_dictionary{ nullptr };
+    std::vector<ZSTD_CCtx*> compression_contexts;
+    std::vector<ZSTD_DCtx*> decompression_contexts;
+};
+
+ZstdCompressor::ZstdCompressor() : contexts_(std::make_unique<ZstdContexts>()) {}
+
+ZstdCompressor::ZstdCompressor(const std::vector<uint8_t>& dictionary) : contexts_(std::make_unique<ZstdContexts>())
+{
+    if (!dictionary.empty())
+    {
+        // The dictionaries are digested once, and then shared by all compression and decompression operations.
+        contexts_->compression_dictionary =
+            ZSTD_createCDict(dictionary.data(), dictionary.size(), kZstdCompressionLevel);
+        contexts_->decompression_dictionary = ZSTD_createDDict(dictionary.data(), dictionary.size());
+
+        if ((contexts_->compression_dictionary == nullptr) || (contexts_->decompression_dictionary == nullptr))
+        {
+            GFXRECON_LOG_ERROR("Failed to load zstd compression dictionary");
+        }
+    }
+}
+
+ZstdCompressor::~ZstdCompressor()
+{
+    for (auto context : contexts_->compression_contexts)
+    {
+        ZSTD_freeCCtx(context);
+    }
+
+    for (auto context : contexts_->decompression_contexts)
+    {
+        ZSTD_freeDCtx(context);
+    }
+
+    ZSTD_freeCDict(contexts_->compression_dictionary);
+    ZSTD_freeDDict(contexts_->decompression_dictionary);
+}
+
+size_t ZstdCompressor::Compress(const size_t          uncompressed_size,
+                                const uint8_t*        uncompressed_data,
+                                std::vector<uint8_t>* compressed_data)
+{
+    size_t copy_size = 0;
+
+    if (nullptr == compressed_data)
+    {
+        return 0;
+    }
+
+    size_t zstd_compressed_size = ZSTD_compressBound(uncompressed_size);
+
+    if (zstd_compressed_size > compressed_data->size())
+    {
+        compressed_data->resize(zstd_compressed_size);
+    }
+
+    // Take a context from the pool, or create a new context if all contexts are in use by other threads.
+    ZSTD_CCtx* context = nullptr;
+
+    {
+        std::lock_guard<std::mutex> lock(contexts_lock_);
+        if (!contexts_->compression_contexts.empty())
+        {
+            context = contexts_->compression_contexts.back();
+            contexts_->compression_contexts.pop_back();
+        }
+    }
+
+    if (context == nullptr)
+    {
+        context = ZSTD_createCCtx();
+
+        if (context == nullptr)
+        {
+            return 0;
+        }
+    }
+
+    size_t result = 0;
+
+    if (contexts_->compression_dictionary != nullptr)
+    {
+        result = ZSTD_compress_usingCDict(context,
+                                          compressed_data->data(),
+                                          zstd_compressed_size,
+                                          uncompressed_data,
+                                          uncompressed_size,
+                                          contexts_->compression_dictionary);
+    }
+    else
+    {
+        result = ZSTD_compressCCtx(context,
+                                   compressed_data->data(),
+                                   zstd_compressed_size,
+                                   uncompressed_data,
+                                   uncompressed_size,
+                                   kZstdCompressionLevel);
+    }
+
+    if (!ZSTD_isError(result))
+    {
+        copy_size = result;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(contexts_lock_);
+        contexts_->compression_contexts.push_back(context);
+    }
+
+    return copy_size;
+}
+
+size_t ZstdCompressor::Decompress(const size_t                compressed_size,
+                                  const std::vector<uint8_t>& compressed_data,
+                                  const size_t                expected_uncompressed_size,
+                                  std::vector<uint8_t>*       uncompressed_data)
+{
+    size_t copy_size = 0;
+
+    if (nullptr == uncompressed_data)
+    {
+        return 0;
+    }
+
+    ZSTD_DCtx* context = nullptr;
+
+    {
+        std::lock_guard<std::mutex> lock(contexts_lock_);
+        if (!contexts_->decompression_contexts.empty())
+        {
+            context = contexts_->decompression_contexts.back();
+            contexts_->decompression_contexts.pop_back();
+        }
+    }
+
+    if (context == nullptr)
+    {
+        context = ZSTD_createDCtx();
+
+        if (context == nullptr)
+        {
+            return 0;
+        }
+    }
+
+    size_t result = 0;
+
+    if (contexts_->decompression_dictionary != nullptr)
+    {
+        result = ZSTD_decompress_usingDDict(context,
+                                            uncompressed_data->data(),
+                                            expected_uncompressed_size,
+                                            compressed_data.data(),
+                                            compressed_size,
+                                            contexts_->decompression_dictionary);
+    }
+    else
+    {
+        result = ZSTD_decompressDCtx(
+            context, uncompressed_data->data(), expected_uncompressed_size, compressed_data.data(), compressed_size);
+    }
+
+    if (!ZSTD_isError(result))
+    {
+        copy_size = result;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(contexts_lock_);
+        contexts_->decompression_contexts.push_back(context);
+    }
+
+    return copy_size;
+}
+
+bool ZstdCompressor::TrainDictionary(const std::vector<uint8_t>& samples,
+                                     const std::vector<size_t>&  sample_sizes,
+                                     size_t                      max_dictionary_size,
+                                     std::vector<uint8_t>*       dictionary)
+{
+    assert(dictionary != nullptr);
+
+    if (sample_sizes.empty())
+    {
+        return false;
+    }
+
+    dictionary->resize(max_dictionary_size);
+
+    size_t result = ZDICT_trainFromBuffer(dictionary->data(),
+                                          max_dictionary_size,
+                                          samples.data(),
+                                          sample_sizes.data(),
+                                          static_cast<unsigned>(sample_sizes.size()));
+
+    if (ZDICT_isError(result))
+    {
+        GFXRECON_LOG_WARNING("Failed to train zstd compression dictionary: %s", ZDICT_getErrorName(result));
+        dictionary->clear();
+        return false;
+    }
+
+    dictionary->resize(result);
+
+    return true;
+}
+
+GFXRECON_END_NAMESPACE(util)
+GFXRECON_END_NAMESPACE(gfxrecon)
+
+#endif // ENABLE_ZSTD_COMPRESSION
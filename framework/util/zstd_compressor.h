@@ -0,0 +1,67 @@
+/*
+** Copyright (c) 2019 LunarG, Inc.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+#ifndef GFXRECON_UTIL_ZSTD_COMPRESSOR_H
+#define GFXRECON_UTIL_ZSTD_COMPRESSOR_H
+
+#include "util/compressor.h"
+
+#include <memory>
+#include <mutex>
+
+GFXRECON_BEGIN_NAMESPACE(gfxrecon)
+GFXRECON_BEGIN_NAMESPACE(util)
+
+// Zstandard compressor, with optional support for a dictionary that is shared by all blocks.  Blocks compressed with a
+// dictionary must be decompressed with the same dictionary.  Compression contexts are pooled, so a single instance may
+// be used by multiple threads.
+class ZstdCompressor : public Compressor
+{
+  public:
+    ZstdCompressor();
+
+    ZstdCompressor(const std::vector<uint8_t>& dictionary);
+
+    virtual ~ZstdCompressor() override;
+
+    virtual size_t Compress(const size_t          uncompressed_size,
+                            const uint8_t*        uncompressed_data,
+                            std::vector<uint8_t>* compressed_data) override;
+
+    virtual size_t Decompress(const size_t                compressed_size,
+                              const std::vector<uint8_t>& compressed_data,
+                              const size_t                expected_uncompressed_size,
+                              std::vector<uint8_t>*       uncompressed_data) override;
+
+    // Trains a dictionary from a set of sample blocks, which are stored contiguously in samples.  Returns false if a
+    // dictionary could not be generated from the samples.
+    static bool TrainDictionary(const std::vector<uint8_t>& samples,
+                                const std::vector<size_t>&  sample_sizes,
+                                size_t                      max_dictionary_size,
+                                std::vector<uint8_t>*       dictionary);
+
+  private:
+    struct ZstdContexts;
+
+  private:
+    std::unique_ptr<ZstdContexts> contexts_;
+    std::mutex                    contexts_lock_;
+};
+
+GFXRECON_END_NAMESPACE(util)
+GFXRECON_END_NAMESPACE(gfxrecon)
+
+#endif // GFXRECON_UTIL_ZSTD_COMPRESSOR_H
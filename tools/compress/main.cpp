@@ -18,17 +18,32 @@
 #include "project_version.h"
 
 #include "decode/compression_converter.h"
+#include "decode/dictionary_sample_collector.h"
 #include "decode/file_processor.h"
 #include "format/format.h"
 #include "util/argument_parser.h"
 #include "util/compressor.h"
 #include "util/logging.h"
+#include "util/platform.h"
+#include "util/zstd_compressor.h"
 
 #include "vulkan/vulkan_core.h"
 
+#include <algorithm>
 #include <cassert>
+#include <cstdlib>
+#include <thread>
 
-const char kVersionOption[] = "--version";
+const char kVersionOption[]          = "--version";
+const char kDictionarySizeArgument[] = "--dictionary-size";
+const char kSaveDictionaryArgument[] = "--save-dictionary";
+const char kThreadsArgument[]        = "--threads";
+const char kArguments[]              = "--dictionary-size,--save-dictionary,--threads";
+
+// Default dictionary size and training sample limits, based on the zstd command line tool defaults.
+const size_t kDefaultDictionarySize = 112640;
+const size_t kDictionarySampleRatio = 100;
+const size_t kMaxDictionarySample   = 128 * 1024;
 
 static bool PrintVersion(const char* exe_name, const gfxrecon::util::ArgumentParser& arg_parser)
 {
@@ -62,7 +77,9 @@ void PrintUsage(const char* exe_name)
     }
     GFXRECON_WRITE_CONSOLE("\n%s - A tool to compress/decompress GFXReconstruct capture files.\n", app_name.c_str());
     GFXRECON_WRITE_CONSOLE("Usage:");
-    GFXRECON_WRITE_CONSOLE("  %s [--version] <input_file> <output_file> <compression_format>\n", app_name.c_str());
+    GFXRECON_WRITE_CONSOLE("  %s [--version] [--threads <count>] [--dictionary-size <bytes>]", app_name.c_str());
+    GFXRECON_WRITE_CONSOLE("  \t[--save-dictionary <file>]");
+    GFXRECON_WRITE_CONSOLE("  \t<input_file> <output_file> <compression_format>\n");
     GFXRECON_WRITE_CONSOLE("Required arguments:");
     GFXRECON_WRITE_CONSOLE("  <input_file>\t\tPath to the input file to process.");
     GFXRECON_WRITE_CONSOLE("  <output_file>\t\tPath to the output file to generate.");
@@ -70,9 +87,80 @@ void PrintUsage(const char* exe_name)
     GFXRECON_WRITE_CONSOLE("                      \tOptions are: ");
     GFXRECON_WRITE_CONSOLE("                      \t  LZ4  - To output using LZ4 compression.");
     GFXRECON_WRITE_CONSOLE("                      \t  ZLIB - To output using Zlib compression.");
+    GFXRECON_WRITE_CONSOLE("                      \t  ZSTD - To output using Zstandard compression, with a");
+    GFXRECON_WRITE_CONSOLE("                      \t         dictionary trained from the input file.");
     GFXRECON_WRITE_CONSOLE("                      \t  NONE - To output without using compression.");
     GFXRECON_WRITE_CONSOLE("\nOptional arguments:");
     GFXRECON_WRITE_CONSOLE("  --version\t\tPrint version information and exit");
+    GFXRECON_WRITE_CONSOLE("  --threads <count>\tNumber of worker threads to use for compression.  Blocks are");
+    GFXRECON_WRITE_CONSOLE("          \t\tcompressed in parallel and written in their original order.");
+    GFXRECON_WRITE_CONSOLE("          \t\tA value of 0 uses one thread per CPU core.  Default is 1.");
+    GFXRECON_WRITE_CONSOLE("  --dictionary-size <bytes>");
+    GFXRECON_WRITE_CONSOLE("          \t\tMaximum size of the dictionary to train for ZSTD compression.");
+    GFXRECON_WRITE_CONSOLE("          \t\tA value of 0 disables the dictionary.  Default is %" PRIuPTR " bytes.",
+                           kDefaultDictionarySize);
+    GFXRECON_WRITE_CONSOLE("  --save-dictionary <file>");
+    GFXRECON_WRITE_CONSOLE("          \t\tWrite the trained ZSTD dictionary to a file, which can be used");
+    GFXRECON_WRITE_CONSOLE("          \t\twith the capture_compression_dictionary capture option.");
+}
+
+static bool WriteDictionaryFile(const std::string& filename, const std::vector<uint8_t>& dictionary)
+{
+    bool  success = false;
+    FILE* file    = nullptr;
+
+    int32_t result = gfxrecon::util::platform::FileOpen(&file, filename.c_str(), "wb");
+    if ((result == 0) && (file != nullptr))
+    {
+        success = (gfxrecon::util::platform::FileWrite(dictionary.data(), 1, dictionary.size(), file) ==
+                   dictionary.size());
+        gfxrecon::util::platform::FileClose(file);
+    }
+
+    if (!success)
+    {
+        GFXRECON_LOG_ERROR("Failed to write compression dictionary to file %s", filename.c_str());
+    }
+
+    return success;
+}
+
+// Performs a first pass over the capture file to collect function call blocks, which are then used to train a zstd
+// dictionary.  Returns an empty dictionary if training was not possible, in which case the file will be compressed
+// without a dictionary.
+static std::vector<uint8_t> TrainDictionary(const std::string& input_filename, size_t dictionary_size)
+{
+    std::vector<uint8_t> dictionary;
+
+#ifdef ENABLE_ZSTD_COMPRESSION
+    gfxrecon::decode::FileProcessor             file_processor;
+    gfxrecon::decode::DictionarySampleCollector collector(dictionary_size * kDictionarySampleRatio,
+                                                          kMaxDictionarySample);
+
+    if (file_processor.Initialize(input_filename))
+    {
+        file_processor.AddDecoder(&collector);
+
+        if (file_processor.ProcessAllFrames())
+        {
+            if (!gfxrecon::util::ZstdCompressor::TrainDictionary(
+                    collector.GetSamples(), collector.GetSampleSizes(), dictionary_size, &dictionary))
+            {
+                GFXRECON_LOG_WARNING("Failed to train a compression dictionary; compressing without a dictionary");
+                dictionary.clear();
+            }
+        }
+        else
+        {
+            GFXRECON_LOG_WARNING("Failed to collect dictionary samples from capture file %s", input_filename.c_str());
+        }
+    }
+#else
+    GFXRECON_UNREFERENCED_PARAMETER(input_filename);
+    GFXRECON_UNREFERENCED_PARAMETER(dictionary_size);
+#endif
+
+    return dictionary;
 }
 
 int main(int argc, const char** argv)
@@ -84,10 +172,14 @@ int main(int argc, const char** argv)
     int                               return_code            = 0;
     std::string                       input_filename;
     std::string                       output_filename;
+    std::string                       dictionary_filename;
+    size_t                            dictionary_size = kDefaultDictionarySize;
+    uint32_t                          thread_count    = 1;
+    std::vector<uint8_t>              dictionary;
 
     gfxrecon::util::Log::Init();
 
-    gfxrecon::util::ArgumentParser arg_parser(argc, argv, kVersionOption, "");
+    gfxrecon::util::ArgumentParser arg_parser(argc, argv, kVersionOption, kArguments);
 
     if (PrintVersion(argv[0], arg_parser))
     {
@@ -115,12 +207,51 @@ int main(int argc, const char** argv)
             {
                 compression_type = gfxrecon::format::CompressionType::kZlib;
             }
+            else if (dst_compression_string == "ZSTD")
+            {
+                compression_type = gfxrecon::format::CompressionType::kZstd;
+            }
             else
             {
                 GFXRECON_LOG_ERROR("Unsupported compression format \'%s\'", positional_arguments[2].c_str());
                 print_usage = true;
             }
         }
+
+        const std::string& dictionary_size_value = arg_parser.GetArgumentValue(kDictionarySizeArgument);
+        if (!dictionary_size_value.empty())
+        {
+            if (dictionary_size_value.find_first_not_of("0123456789") == std::string::npos)
+            {
+                dictionary_size = static_cast<size_t>(std::strtoull(dictionary_size_value.c_str(), nullptr, 10));
+            }
+            else
+            {
+                GFXRECON_LOG_ERROR("Invalid dictionary size \'%s\'", dictionary_size_value.c_str());
+                print_usage = true;
+            }
+        }
+
+        dictionary_filename = arg_parser.GetArgumentValue(kSaveDictionaryArgument);
+
+        const std::string& thread_count_value = arg_parser.GetArgumentValue(kThreadsArgument);
+        if (!thread_count_value.empty())
+        {
+            if (thread_count_value.find_first_not_of("0123456789") == std::string::npos)
+            {
+                thread_count = static_cast<uint32_t>(std::strtoul(thread_count_value.c_str(), nullptr, 10));
+
+                if (thread_count == 0)
+                {
+                    thread_count = std::max(std::thread::hardware_concurrency(), 1u);
+                }
+            }
+            else
+            {
+                GFXRECON_LOG_ERROR("Invalid thread count \'%s\'", thread_count_value.c_str());
+                print_usage = true;
+            }
+        }
     }
 
     if (print_usage)
@@ -130,17 +261,34 @@ int main(int argc, const char** argv)
         exit(-1);
     }
 
+    if ((compression_type == gfxrecon::format::CompressionType::kZstd) && (dictionary_size > 0))
+    {
+        dictionary = TrainDictionary(input_filename, dictionary_size);
+
+        if (!dictionary.empty() && !dictionary_filename.empty())
+        {
+            WriteDictionaryFile(dictionary_filename, dictionary);
+        }
+    }
+
     if (file_processor.Initialize(input_filename))
     {
         gfxrecon::decode::CompressionConverter decoder;
 
-        if (decoder.Initialize(
-                output_filename, file_processor.GetFileHeader(), file_processor.GetFileOptions(), compression_type))
+        if (decoder.Initialize(output_filename,
+                               file_processor.GetFileHeader(),
+                               file_processor.GetFileOptions(),
+                               compression_type,
+                               dictionary,
+                               thread_count))
         {
             std::string src_compression = "NONE";
             file_processor.AddDecoder(&decoder);
             bool succeeded = file_processor.ProcessAllFrames();
 
+            // Wait for the blocks that are still being compressed by worker threads to be written.
+            decoder.Flush();
+
             if (succeeded)
             {
                 for (const auto& option : file_processor.GetFileOptions())
@@ -158,6 +306,9 @@ int main(int argc, const char** argv)
                             case gfxrecon::format::CompressionType::kZlib:
                                 src_compression = "ZLIB";
                                 break;
+                            case gfxrecon::format::CompressionType::kZstd:
+                                src_compression = "ZSTD";
+                                break;
                             default:
                                 GFXRECON_LOG_ERROR("Unknown source compression type %d", option.value);
                                 assert(false);